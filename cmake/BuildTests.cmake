@@ -16,6 +16,10 @@ FUNCTION(build_tests test_project filter)
     if(NOT BUILD_python)
         string(REGEX REPLACE "${CMAKE_SOURCE_DIR}/modules/python/[^;]+;?" "" SRCS "${SRCS}")
     endif(NOT BUILD_python)
+
+    if(NOT TARGET ${ROOT_PROJECT}_shm)
+        string(REGEX REPLACE "${CMAKE_SOURCE_DIR}/modules/${ROOT_PROJECT}/shm/[^;]+;?" "" SRCS "${SRCS}")
+    endif(NOT TARGET ${ROOT_PROJECT}_shm)
      
     list (LENGTH SRCS nbTestFiles )
     if(nbTestFiles GREATER 0)
@@ -0,0 +1,15 @@
+# ----------------------------------------------------------------------------
+# Threads
+# ----------------------------------------------------------------------------
+#
+# find_package Threads
+# Defines: Threads_FOUND, CMAKE_THREAD_LIBS_INIT
+# ----------------------------------------------------------------------------
+
+status("")
+find_package(Threads REQUIRED)
+if(Threads_FOUND)
+    list(APPEND ${ROOT_PROJECT}_LIBS ${CMAKE_THREAD_LIBS_INIT})
+else(Threads_FOUND)
+    message(FATAL_ERROR "Failed to find a thread library.")
+endif(Threads_FOUND)
@@ -0,0 +1,74 @@
+#include "sem/eval/convergencemonitor.h"
+
+#include "elm/core/exception.h"
+
+const int ConvergenceMonitor::DEFAULT_PATIENCE = 100;
+const int ConvergenceMonitor::DEFAULT_WARM_UP = 1000;
+
+ConvergenceMonitor::ConvergenceMonitor()
+    : threshold_(0.f),
+      patience_(DEFAULT_PATIENCE),
+      warm_up_(DEFAULT_WARM_UP)
+{
+    Reset();
+}
+
+ConvergenceMonitor::ConvergenceMonitor(float threshold, int patience, int warm_up)
+    : threshold_(threshold),
+      patience_(patience),
+      warm_up_(warm_up)
+{
+    if(patience < 1) {
+
+        ELM_THROW_VALUE_ERROR("Patience must be > 0");
+    }
+
+    if(warm_up < 0) {
+
+        ELM_THROW_VALUE_ERROR("Warm-up must be >= 0");
+    }
+
+    Reset();
+}
+
+void ConvergenceMonitor::Reset()
+{
+    nb_checks_ = 0;
+    nb_below_ = 0;
+    is_converged_ = false;
+}
+
+bool ConvergenceMonitor::Check(float change_rate)
+{
+    nb_checks_++;
+
+    if(is_converged_ || threshold_ <= 0.f || nb_checks_ <= warm_up_) {
+
+        return is_converged_;
+    }
+
+    nb_below_ = (change_rate < threshold_)? nb_below_+1 : 0;
+    is_converged_ = nb_below_ >= patience_;
+
+    return is_converged_;
+}
+
+bool ConvergenceMonitor::IsConverged() const
+{
+    return is_converged_;
+}
+
+int ConvergenceMonitor::NbChecks() const
+{
+    return nb_checks_;
+}
+
+int ConvergenceMonitor::NbBelow() const
+{
+    return nb_below_;
+}
+
+float ConvergenceMonitor::Threshold() const
+{
+    return threshold_;
+}
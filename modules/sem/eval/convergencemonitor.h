@@ -0,0 +1,66 @@
+#ifndef SEM_EVAL_CONVERGENCEMONITOR_H_
+#define SEM_EVAL_CONVERGENCEMONITOR_H_
+
+/**
+ * @brief Decide when training has converged from a running weight change rate
+ *
+ * Training is considered converged once the change rate stayed below a threshold
+ * for a no. of consecutive checks (patience), after an initial warm-up.
+ * The warm-up keeps the monitor from firing before learning had a chance to move any weights.
+ *
+ * @see LayerZ::WeightChangeRate()
+ */
+class ConvergenceMonitor
+{
+public:
+    static const int DEFAULT_PATIENCE;      ///< = 100
+    static const int DEFAULT_WARM_UP;       ///< = 1000
+
+    ConvergenceMonitor();
+
+    /**
+     * @brief Construct monitor
+     * @param threshold on change rate, <= 0 to never converge
+     * @param no. of consecutive checks below threshold
+     * @param no. of initial checks to ignore
+     * @throws ExceptionValueError for patience < 1 or negative warm-up
+     */
+    ConvergenceMonitor(float threshold, int patience=DEFAULT_PATIENCE, int warm_up=DEFAULT_WARM_UP);
+
+    /**
+     * @brief Restart monitoring
+     */
+    void Reset();
+
+    /**
+     * @brief Check most recent change rate
+     * @param change rate
+     * @return true once converged, remains true until Reset()
+     */
+    bool Check(float change_rate);
+
+    bool IsConverged() const;
+
+    /**
+     * @brief get no. of checks since construction or last Reset()
+     */
+    int NbChecks() const;
+
+    /**
+     * @brief get no. of consecutive checks below threshold after warm-up
+     */
+    int NbBelow() const;
+
+    float Threshold() const;
+
+protected:
+    float threshold_;       ///< threshold on change rate
+    int patience_;          ///< no. of consecutive checks below threshold needed
+    int warm_up_;           ///< no. of initial checks to ignore
+
+    int nb_checks_;         ///< no. of checks so far
+    int nb_below_;          ///< no. of consecutive checks below threshold
+    bool is_converged_;     ///< converged flag
+};
+
+#endif // SEM_EVAL_CONVERGENCEMONITOR_H_
@@ -0,0 +1,180 @@
+#include "sem/eval/onlineclustereval.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+OnlineClusterEval::OnlineClusterEval()
+    : snapshot_every_(0)
+{
+    Reset(1, 1);
+}
+
+OnlineClusterEval::OnlineClusterEval(int nb_neurons, int nb_labels)
+    : snapshot_every_(0)
+{
+    Reset(nb_neurons, nb_labels);
+}
+
+void OnlineClusterEval::Reset(int nb_neurons, int nb_labels)
+{
+    if(nb_neurons < 1 || nb_labels < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of neurons and labels must be > 0");
+    }
+
+    counts_ = Mat1i::zeros(nb_neurons, nb_labels);
+    counts_neuron_ = Mat1i::zeros(1, nb_neurons);
+    counts_label_ = Mat1i::zeros(1, nb_labels);
+    row_max_ = Mat1i::zeros(1, nb_neurons);
+
+    nb_samples_ = 0;
+    nb_correct_ = 0;
+    sum_nlogn_joint_ = 0.;
+    sum_nlogn_neuron_ = 0.;
+    sum_nlogn_label_ = 0.;
+
+    snapshots_ = Mat1f(0, NB_COLS);
+}
+
+void OnlineClusterEval::SnapshotEvery(int n)
+{
+    if(n < 0) {
+
+        ELM_THROW_VALUE_ERROR("Snapshot interval must be >= 0");
+    }
+    snapshot_every_ = n;
+}
+
+double OnlineClusterEval::DeltaNLogN(int n)
+{
+    // (n+1)log(n+1) - n log(n), with 0 log(0) = 0
+    double n1 = static_cast<double>(n+1);
+    return (n > 0)? n1*std::log(n1)-n*std::log(static_cast<double>(n)) : 0.;
+}
+
+void OnlineClusterEval::Update(int winner, int label)
+{
+    if(winner < 0 || winner >= counts_.rows) {
+
+        ELM_THROW_BAD_DIMS("Winner index out of range.");
+    }
+
+    if(label < 0 || label >= counts_.cols) {
+
+        ELM_THROW_BAD_DIMS("Label out of range.");
+    }
+
+    int &n = counts_(winner, label);
+    sum_nlogn_joint_ += DeltaNLogN(n);
+    n++;
+
+    int &n_neuron = counts_neuron_(winner);
+    sum_nlogn_neuron_ += DeltaNLogN(n_neuron);
+    n_neuron++;
+
+    int &n_label = counts_label_(label);
+    sum_nlogn_label_ += DeltaNLogN(n_label);
+    n_label++;
+
+    // majority counts only ever grow by one
+    if(n > row_max_(winner)) {
+
+        row_max_(winner) = n;
+        nb_correct_++;
+    }
+
+    nb_samples_++;
+
+    if(snapshot_every_ > 0 && nb_samples_ % static_cast<unsigned long long>(snapshot_every_) == 0) {
+
+        Snapshot();
+    }
+}
+
+void OnlineClusterEval::Update(const Mat1f &spikes, int label)
+{
+    for(int i=0; i<static_cast<int>(spikes.total()); i++) {
+
+        if(spikes(i) != 0.f) {
+
+            Update(i, label);
+        }
+    }
+}
+
+unsigned long long OnlineClusterEval::NbSamples() const
+{
+    return nb_samples_;
+}
+
+Mat1i OnlineClusterEval::Confusion() const
+{
+    return counts_.clone();
+}
+
+float OnlineClusterEval::ConditionalEntropy() const
+{
+    if(nb_samples_ == 0) {
+        return 0.f;
+    }
+
+    // H(L|W) = H(W,L) - H(W) = (1/N) [sum_w n_w log n_w - sum_wl n_wl log n_wl]
+    double h = (sum_nlogn_neuron_-sum_nlogn_joint_)/static_cast<double>(nb_samples_);
+    return static_cast<float>(std::max(0., h)/std::log(2.));
+}
+
+float OnlineClusterEval::LabelEntropy() const
+{
+    if(nb_samples_ == 0) {
+        return 0.f;
+    }
+
+    double n = static_cast<double>(nb_samples_);
+    double h = std::log(n)-sum_nlogn_label_/n;
+    return static_cast<float>(std::max(0., h)/std::log(2.));
+}
+
+float OnlineClusterEval::Accuracy() const
+{
+    return (nb_samples_ > 0)? static_cast<float>(nb_correct_/static_cast<double>(nb_samples_)) : 0.f;
+}
+
+Mat1i OnlineClusterEval::NeuronLabels() const
+{
+    Mat1i labels(1, counts_.rows);
+    for(int r=0; r<counts_.rows; r++) {
+
+        int label = -1;
+        if(row_max_(r) > 0) {
+
+            const int *row = counts_.ptr<int>(r);
+            for(int c=0; c<counts_.cols && label < 0; c++) {
+
+                if(row[c] == row_max_(r)) {
+
+                    label = c;
+                }
+            }
+        }
+        labels(r) = label;
+    }
+    return labels;
+}
+
+void OnlineClusterEval::Snapshot()
+{
+    Mat1f row(1, NB_COLS);
+    row(COL_NB_SAMPLES) = static_cast<float>(nb_samples_);
+    row(COL_CONDITIONAL_ENTROPY) = ConditionalEntropy();
+    row(COL_ACCURACY) = Accuracy();
+    snapshots_.push_back(row);
+}
+
+Mat1f OnlineClusterEval::Snapshots() const
+{
+    return snapshots_.clone();
+}
@@ -0,0 +1,129 @@
+#ifndef SEM_EVAL_ONLINECLUSTEREVAL_H_
+#define SEM_EVAL_ONLINECLUSTEREVAL_H_
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Streaming evaluation of clustering quality from WTA spikes and ground-truth labels
+ *
+ * Maintains a winner-vs-label confusion matrix together with
+ * running sums from which the conditional entropy H(label|winner)
+ * and the accuracy of assigning each neuron its majority label are read off.
+ * Every update costs O(1), irrespective of the no. of neurons and labels.
+ * Optionally takes a snapshot of all measures every n updates.
+ */
+class OnlineClusterEval
+{
+public:
+    /** Column layout of a snapshot row
+     */
+    enum Column {
+        COL_NB_SAMPLES = 0,
+        COL_CONDITIONAL_ENTROPY,
+        COL_ACCURACY,
+        NB_COLS
+    };
+
+    OnlineClusterEval();
+
+    /**
+     * @brief Construct evaluator
+     * @param no. of neurons competing in the WTA circuit
+     * @param no. of ground-truth labels
+     */
+    OnlineClusterEval(int nb_neurons, int nb_labels);
+
+    /**
+     * @brief Reset all counts and snapshots
+     * @param no. of neurons competing in the WTA circuit
+     * @param no. of ground-truth labels
+     * @throws ExceptionValueError for non-positive dimensions
+     */
+    void Reset(int nb_neurons, int nb_labels);
+
+    /**
+     * @brief Take a snapshot every n updates
+     * @param interval in no. of updates, 0 to disable (default)
+     */
+    void SnapshotEvery(int n);
+
+    /**
+     * @brief Record a single WTA spike
+     * @param index of winning neuron
+     * @param ground-truth label of current stimulus
+     * @throws ExceptionBadDims on out of range winner or label
+     */
+    void Update(int winner, int label);
+
+    /**
+     * @brief Record all WTA spikes of a single tick
+     * @param output spikes as row vector, non-zero for spiking neuron
+     * @param ground-truth label of current stimulus
+     */
+    void Update(const cv::Mat1f &spikes, int label);
+
+    unsigned long long NbSamples() const;
+
+    /**
+     * @brief get winner-vs-label counts
+     * @return matrix with a row per neuron and a column per label
+     */
+    cv::Mat1i Confusion() const;
+
+    /**
+     * @brief Conditional entropy of labels given the winning neuron
+     * 0 for perfectly label-selective neurons, LabelEntropy() for uninformative ones
+     * @return H(label|winner) [bits]
+     */
+    float ConditionalEntropy() const;
+
+    /**
+     * @brief Entropy of the label distribution seen so far
+     * @return H(label) [bits]
+     */
+    float LabelEntropy() const;
+
+    /**
+     * @brief Fraction of samples whose label matches the majority label of their winning neuron
+     */
+    float Accuracy() const;
+
+    /**
+     * @brief get majority label per neuron
+     * @return row vector with label per neuron, -1 for neurons that never won
+     */
+    cv::Mat1i NeuronLabels() const;
+
+    /**
+     * @brief Record current measures as a snapshot row
+     */
+    void Snapshot();
+
+    /**
+     * @brief get snapshots taken so far
+     * @return matrix with a row per snapshot, columns as in Column enum
+     */
+    cv::Mat1f Snapshots() const;
+
+protected:
+    /**
+     * @brief increment in n*log(n) when incrementing n
+     */
+    static double DeltaNLogN(int n);
+
+    cv::Mat1i counts_;              ///< winner-vs-label counts
+    cv::Mat1i counts_neuron_;       ///< counts per neuron (row sums)
+    cv::Mat1i counts_label_;        ///< counts per label (column sums)
+    cv::Mat1i row_max_;             ///< majority count per neuron
+
+    unsigned long long nb_samples_; ///< total no. of updates
+    unsigned long long nb_correct_; ///< sum of majority counts
+    double sum_nlogn_joint_;        ///< sum of n*log(n) over confusion matrix
+    double sum_nlogn_neuron_;       ///< sum of n*log(n) over counts per neuron
+    double sum_nlogn_label_;        ///< sum of n*log(n) over counts per label
+
+    int snapshot_every_;            ///< snapshot interval, 0 for none
+    cv::Mat1f snapshots_;           ///< snapshot rows
+};
+
+#endif // SEM_EVAL_ONLINECLUSTEREVAL_H_
@@ -0,0 +1,71 @@
+#include "sem/eval/convergencemonitor.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace elm;
+
+namespace {
+
+TEST(ConvergenceMonitorTest, InvalidParams)
+{
+    EXPECT_THROW(ConvergenceMonitor(0.1f, 0, 0), ExceptionValueError);
+    EXPECT_THROW(ConvergenceMonitor(0.1f, 1, -1), ExceptionValueError);
+    EXPECT_NO_THROW(ConvergenceMonitor(0.1f, 1, 0));
+}
+
+TEST(ConvergenceMonitorTest, DisabledByDefault)
+{
+    ConvergenceMonitor to;
+    for(int i=0; i<10*ConvergenceMonitor::DEFAULT_WARM_UP; i++) {
+
+        EXPECT_FALSE(to.Check(0.f));
+    }
+    EXPECT_FALSE(to.IsConverged());
+}
+
+TEST(ConvergenceMonitorTest, Patience)
+{
+    const int PATIENCE = 5;
+    ConvergenceMonitor to(0.1f, PATIENCE, 0);
+
+    for(int i=0; i<PATIENCE-1; i++) {
+
+        EXPECT_FALSE(to.Check(0.05f));
+    }
+    EXPECT_EQ(PATIENCE-1, to.NbBelow());
+
+    // rising above threshold restarts the count
+    EXPECT_FALSE(to.Check(0.2f));
+    EXPECT_EQ(0, to.NbBelow());
+
+    for(int i=0; i<PATIENCE-1; i++) {
+
+        EXPECT_FALSE(to.Check(0.05f));
+    }
+    EXPECT_TRUE(to.Check(0.05f));
+    EXPECT_TRUE(to.IsConverged());
+
+    // sticky until reset
+    EXPECT_TRUE(to.Check(1.f));
+
+    to.Reset();
+    EXPECT_FALSE(to.IsConverged());
+    EXPECT_EQ(0, to.NbChecks());
+    EXPECT_EQ(0, to.NbBelow());
+}
+
+TEST(ConvergenceMonitorTest, WarmUp)
+{
+    const int WARM_UP = 10;
+    ConvergenceMonitor to(0.1f, 1, WARM_UP);
+
+    for(int i=0; i<WARM_UP; i++) {
+
+        EXPECT_FALSE(to.Check(0.f));
+    }
+    EXPECT_EQ(WARM_UP, to.NbChecks());
+    EXPECT_TRUE(to.Check(0.f));
+}
+
+} // annonymous namespace
@@ -0,0 +1,181 @@
+#include "sem/eval/onlineclustereval.h"
+
+#include <cmath>
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+class OnlineClusterEvalTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        nb_neurons_ = 4;
+        nb_labels_ = 3;
+        to_ = OnlineClusterEval(nb_neurons_, nb_labels_);
+    }
+
+    /**
+     * @brief brute force conditional entropy from confusion matrix
+     */
+    static float ConditionalEntropy(const Mat1i &counts)
+    {
+        double n = sum(counts)(0);
+        double h = 0.;
+        for(int r=0; r<counts.rows; r++) {
+
+            double n_r = sum(counts.row(r))(0);
+            for(int c=0; c<counts.cols; c++) {
+
+                if(counts(r, c) > 0) {
+
+                    h -= counts(r, c)/n*std::log(counts(r, c)/n_r);
+                }
+            }
+        }
+        return static_cast<float>(h/std::log(2.));
+    }
+
+    OnlineClusterEval to_;  ///< test object
+    int nb_neurons_;
+    int nb_labels_;
+};
+
+TEST_F(OnlineClusterEvalTest, InvalidDims)
+{
+    EXPECT_THROW(OnlineClusterEval(0, nb_labels_), ExceptionValueError);
+    EXPECT_THROW(OnlineClusterEval(nb_neurons_, 0), ExceptionValueError);
+}
+
+TEST_F(OnlineClusterEvalTest, Empty)
+{
+    EXPECT_EQ(0ULL, to_.NbSamples());
+    EXPECT_FLOAT_EQ(0.f, to_.ConditionalEntropy());
+    EXPECT_FLOAT_EQ(0.f, to_.LabelEntropy());
+    EXPECT_FLOAT_EQ(0.f, to_.Accuracy());
+    EXPECT_EQ(0, countNonZero(to_.Confusion()));
+
+    Mat1i labels = to_.NeuronLabels();
+    for(int i=0; i<nb_neurons_; i++) {
+
+        EXPECT_EQ(-1, labels(i));
+    }
+}
+
+TEST_F(OnlineClusterEvalTest, UpdateOutOfRange)
+{
+    EXPECT_THROW(to_.Update(-1, 0), ExceptionBadDims);
+    EXPECT_THROW(to_.Update(nb_neurons_, 0), ExceptionBadDims);
+    EXPECT_THROW(to_.Update(0, -1), ExceptionBadDims);
+    EXPECT_THROW(to_.Update(0, nb_labels_), ExceptionBadDims);
+    EXPECT_EQ(0ULL, to_.NbSamples());
+}
+
+TEST_F(OnlineClusterEvalTest, PerfectlySelective)
+{
+    for(int i=0; i<10; i++) {
+
+        to_.Update(i % nb_labels_, i % nb_labels_);
+    }
+
+    EXPECT_EQ(10ULL, to_.NbSamples());
+    EXPECT_NEAR(0.f, to_.ConditionalEntropy(), 1e-5f);
+    EXPECT_FLOAT_EQ(1.f, to_.Accuracy());
+    EXPECT_GT(to_.LabelEntropy(), 0.f);
+
+    Mat1i labels = to_.NeuronLabels();
+    for(int i=0; i<nb_labels_; i++) {
+
+        EXPECT_EQ(i, labels(i));
+    }
+    EXPECT_EQ(-1, labels(nb_neurons_-1));
+}
+
+TEST_F(OnlineClusterEvalTest, Uninformative)
+{
+    // single neuron wins for all labels equally often
+    for(int i=0; i<30; i++) {
+
+        to_.Update(0, i % nb_labels_);
+    }
+
+    EXPECT_NEAR(std::log(3.)/std::log(2.), to_.ConditionalEntropy(), 1e-5);
+    EXPECT_NEAR(to_.LabelEntropy(), to_.ConditionalEntropy(), 1e-5);
+    EXPECT_FLOAT_EQ(1.f/3.f, to_.Accuracy());
+}
+
+TEST_F(OnlineClusterEvalTest, MatchesBruteForce)
+{
+    RNG rng(123);
+    for(int i=0; i<500; i++) {
+
+        to_.Update(rng.uniform(0, nb_neurons_), rng.uniform(0, nb_labels_));
+
+        Mat1i counts = to_.Confusion();
+        ASSERT_NEAR(ConditionalEntropy(counts), to_.ConditionalEntropy(), 1e-4);
+
+        int nb_correct = 0;
+        for(int r=0; r<counts.rows; r++) {
+
+            double max_count;
+            minMaxIdx(counts.row(r), 0, &max_count);
+            nb_correct += static_cast<int>(max_count);
+        }
+        ASSERT_FLOAT_EQ(nb_correct/static_cast<float>(i+1), to_.Accuracy());
+    }
+
+    EXPECT_EQ(500, static_cast<int>(sum(to_.Confusion())(0)));
+}
+
+TEST_F(OnlineClusterEvalTest, UpdateFromSpikes)
+{
+    Mat1f spikes = Mat1f::zeros(1, nb_neurons_);
+    to_.Update(spikes, 0);
+    EXPECT_EQ(0ULL, to_.NbSamples());
+
+    spikes(1) = 1.f;
+    spikes(3) = 1.f;
+    to_.Update(spikes, 2);
+
+    Mat1i counts = to_.Confusion();
+    EXPECT_EQ(2ULL, to_.NbSamples());
+    EXPECT_EQ(1, counts(1, 2));
+    EXPECT_EQ(1, counts(3, 2));
+}
+
+TEST_F(OnlineClusterEvalTest, Snapshots)
+{
+    EXPECT_EQ(0, to_.Snapshots().rows);
+
+    to_.SnapshotEvery(5);
+    for(int i=0; i<12; i++) {
+
+        to_.Update(0, 0);
+    }
+
+    Mat1f snapshots = to_.Snapshots();
+    ASSERT_EQ(2, snapshots.rows);
+    ASSERT_EQ(static_cast<int>(OnlineClusterEval::NB_COLS), snapshots.cols);
+    EXPECT_FLOAT_EQ(5.f, snapshots(0, OnlineClusterEval::COL_NB_SAMPLES));
+    EXPECT_FLOAT_EQ(10.f, snapshots(1, OnlineClusterEval::COL_NB_SAMPLES));
+    EXPECT_FLOAT_EQ(1.f, snapshots(1, OnlineClusterEval::COL_ACCURACY));
+
+    to_.Snapshot();
+    EXPECT_EQ(3, to_.Snapshots().rows);
+
+    to_.Reset(nb_neurons_, nb_labels_);
+    EXPECT_EQ(0, to_.Snapshots().rows);
+    EXPECT_EQ(0ULL, to_.NbSamples());
+}
+
+TEST_F(OnlineClusterEvalTest, SnapshotEveryInvalid)
+{
+    EXPECT_THROW(to_.SnapshotEvery(-1), ExceptionValueError);
+}
+
+} // annonymous namespace
@@ -0,0 +1,191 @@
+#include "sem/io/mosaicrenderer.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include "elm/core/exception.h"
+
+using cv::Mat1b;
+using cv::Mat1f;
+
+const int MosaicRenderer::BORDER = 1;
+const uchar MosaicRenderer::BORDER_VALUE = 127;
+
+Mat1b MosaicRenderer::Render(const Mat1f &weights, int tile_rows)
+{
+    const int nb_pixels = weights.cols/2; // per polarity
+    if(weights.empty() || weights.cols % 2 != 0 || tile_rows < 1 || nb_pixels % tile_rows != 0) {
+
+        std::stringstream s;
+        s << "Cannot tile " << weights.cols << " interlaced on/off weights with "
+          << tile_rows << " rows per tile.";
+        ELM_THROW_BAD_DIMS(s.str());
+    }
+
+    const int tile_cols = nb_pixels/tile_rows;
+    const int nb_neurons = weights.rows;
+    const int grid_cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nb_neurons))));
+    const int grid_rows = (nb_neurons+grid_cols-1)/grid_cols;
+
+    const int cell_cols = 2*tile_cols+BORDER;   // on, border, off
+    Mat1b mosaic(grid_rows*(tile_rows+BORDER)+BORDER,
+                 grid_cols*(cell_cols+BORDER)+BORDER,
+                 BORDER_VALUE);
+
+    Mat1f w_exp;
+    Mat1f w_polarity;
+    for(int i=0; i<nb_neurons; i++) {
+
+        cv::exp(weights.row(i), w_exp); // weights are in log scale
+
+        double min_val, max_val;
+        cv::minMaxIdx(w_exp, &min_val, &max_val);
+        const double scale = (max_val > min_val)? 255./(max_val-min_val) : 0.;
+
+        Mat1f w = w_exp.reshape(1, nb_pixels); // on, off per row
+        const int y = (i/grid_cols)*(tile_rows+BORDER)+BORDER;
+        const int x = (i%grid_cols)*(cell_cols+BORDER)+BORDER;
+
+        for(int p=0; p<2; p++) {
+
+            w_polarity = w.col(p).clone();
+
+            Mat1b dst = mosaic(cv::Rect(x+p*(tile_cols+BORDER), y, tile_cols, tile_rows));
+            w_polarity.reshape(1, tile_rows).convertTo(dst, CV_8U, scale, -min_val*scale);
+        }
+    }
+
+    return mosaic;
+}
+
+MosaicRenderer::MosaicRenderer(const std::string &path_prefix, int tile_rows)
+    : path_prefix_(path_prefix),
+      tile_rows_(tile_rows),
+      is_busy_(false),
+      is_stopped_(false),
+      nb_written_(0),
+      nb_dropped_(0)
+{
+    if(tile_rows < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of rows per tile must be > 0");
+    }
+
+    worker_ = std::thread(&MosaicRenderer::WorkerLoop, this);
+}
+
+MosaicRenderer::~MosaicRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+void MosaicRenderer::Submit(const WeightsPublisher::SnapshotPtr &snapshot)
+{
+    if(!snapshot) {
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        RethrowError();
+
+        if(pending_) {
+
+            nb_dropped_++;
+        }
+        pending_ = snapshot;
+    }
+    cv_.notify_all();
+}
+
+void MosaicRenderer::Flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !pending_ && !is_busy_; });
+    RethrowError();
+}
+
+std::string MosaicRenderer::Path(unsigned long long version) const
+{
+    std::stringstream s;
+    s << path_prefix_ << std::setfill('0') << std::setw(10) << version << ".png";
+    return s.str();
+}
+
+unsigned long long MosaicRenderer::NbWritten() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nb_written_;
+}
+
+unsigned long long MosaicRenderer::NbDropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nb_dropped_;
+}
+
+void MosaicRenderer::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true) {
+
+        cv_.wait(lock, [this] { return pending_ || is_stopped_; });
+        if(!pending_) {
+
+            return; // stopped, nothing left to render
+        }
+
+        WeightsPublisher::SnapshotPtr snapshot = pending_;
+        pending_.reset();
+        is_busy_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        bool is_written = false;
+        try {
+
+            const std::string path = Path(snapshot->Version());
+            is_written = cv::imwrite(path, Render(snapshot->Weights(), tile_rows_));
+            if(!is_written) {
+
+                ELM_THROW_FILEIO_ERROR("Failed to write weights mosaic to " + path);
+            }
+        }
+        catch(...) {
+
+            error = std::current_exception();
+        }
+        snapshot.reset(); // let the learner reuse the buffer
+
+        lock.lock();
+        is_busy_ = false;
+        if(is_written) {
+
+            nb_written_++;
+        }
+        if(error) {
+
+            error_ = error;
+        }
+        cv_.notify_all();
+    }
+}
+
+void MosaicRenderer::RethrowError()
+{
+    if(error_) {
+
+        std::exception_ptr e = error_;
+        error_ = std::exception_ptr();
+        std::rethrow_exception(e);
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef SEM_IO_MOSAICRENDERER_H_
+#define SEM_IO_MOSAICRENDERER_H_
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <opencv2/core/core.hpp>
+
+#include "sem/layers/weightssnapshot.h"
+
+/**
+ * @brief Render weights of all neurons into a single image on a background thread and write it to disk
+ *
+ * Weights are expected to interlace on and off afferents (e.g. from a mutex population code),
+ * each neuron becomes a tile with its on weights left of its off weights,
+ * tiles are arranged row by row in a near-square grid.
+ * Weights are exponentiated from log scale and each tile is scaled to the full 8-bit range.
+ *
+ * The learner only hands over a snapshot of its weights (see LayerZ::Snapshot()) and never waits for rendering.
+ * If the renderer is still busy, a newer snapshot replaces one not rendered yet.
+ * Submit() and Flush() from a single thread.
+ */
+class MosaicRenderer
+{
+public:
+    static const int BORDER;    ///< = 1, pixels between on and off weights and between tiles
+    static const uchar BORDER_VALUE; ///< = 127, intensity of border pixels
+
+    /**
+     * @brief Render mosaic
+     * @param weights, one row per neuron, on and off afferents interlaced, log scale
+     * @param no. of image rows per tile
+     * @return mosaic
+     * @throws ExceptionBadDims if a neuron's on and off weights do not reshape into tiles with the given no. of rows
+     */
+    static cv::Mat1b Render(const cv::Mat1f &weights, int tile_rows);
+
+    /**
+     * @brief Start background thread
+     * @param prefix of mosaic files, followed by weights version and ".png", e.g. "weights_"
+     * @param no. of image rows per tile, e.g. 28 for MNIST
+     * @throws ExceptionValueError for non-positive tile rows
+     */
+    MosaicRenderer(const std::string &path_prefix, int tile_rows);
+
+    /**
+     * @brief Render pending snapshot, then stop background thread
+     */
+    ~MosaicRenderer();
+
+    MosaicRenderer(const MosaicRenderer&) = delete;
+    MosaicRenderer& operator=(const MosaicRenderer&) = delete;
+
+    /**
+     * @brief Hand over snapshot for rendering without waiting
+     * @param snapshot, ignored if null
+     * @throws error of a previous rendering, if any
+     */
+    void Submit(const WeightsPublisher::SnapshotPtr &snapshot);
+
+    /**
+     * @brief Wait until all submitted snapshots are rendered or replaced
+     * @throws error of a previous rendering, if any
+     */
+    void Flush();
+
+    /**
+     * @brief get path of mosaic file for a given weights version
+     * @param version
+     * @return path
+     */
+    std::string Path(unsigned long long version) const;
+
+    /**
+     * @brief get no. of mosaic files written
+     */
+    unsigned long long NbWritten() const;
+
+    /**
+     * @brief get no. of snapshots replaced by newer ones before rendering
+     */
+    unsigned long long NbDropped() const;
+
+protected:
+    /**
+     * @brief Render snapshots as they come in until stopped
+     */
+    void WorkerLoop();
+
+    /**
+     * @brief Rethrow and clear error of a previous rendering
+     * With the lock held
+     */
+    void RethrowError();
+
+    std::string path_prefix_;               ///< prefix of mosaic files
+    int tile_rows_;                         ///< no. of image rows per tile
+
+    mutable std::mutex mutex_;              ///< guards all members below
+    std::condition_variable cv_;            ///< signals new snapshot, completed rendering or stop
+    WeightsPublisher::SnapshotPtr pending_; ///< snapshot to render next, null if none
+    bool is_busy_;                          ///< worker rendering a snapshot
+    bool is_stopped_;                       ///< worker to exit once nothing is pending
+    unsigned long long nb_written_;         ///< no. of mosaic files written
+    unsigned long long nb_dropped_;         ///< no. of snapshots replaced before rendering
+    std::exception_ptr error_;              ///< error of most recent failed rendering, if any
+
+    std::thread worker_;                    ///< background thread, started last
+};
+
+#endif // SEM_IO_MOSAICRENDERER_H_
@@ -0,0 +1,281 @@
+#include "sem/io/spikerecording.h"
+
+#include <cstring>
+
+#include "elm/core/exception.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+const char MAGIC[] = "SEMREC01";   ///< file signature incl. format version
+const size_t LEN_MAGIC = 8;
+
+const char TAG_TICK  = 'T';
+const char TAG_CLEAR = 'C';
+const char TAG_END   = 'E';
+
+template <class T>
+void WriteRaw(ofstream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool ReadRaw(ifstream &in, T &value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return static_cast<bool>(in);
+}
+
+/**
+ * @brief get indices of non-zero elements
+ * @param matrix of any type and shape
+ * @param[out] indices in row-major order
+ */
+void NonZeroIndices(const Mat &m, vector<int> &indices)
+{
+    indices.clear();
+    Mat1b mask = m != 0;    // continuous, single channel
+    const uchar *p = mask.ptr<uchar>(0);
+    for(int i=0; i<static_cast<int>(mask.total()); i++) {
+
+        if(p[i] != 0) {
+
+            indices.push_back(i);
+        }
+    }
+}
+
+} // annonymous namespace
+
+SpikeRecordHeader::SpikeRecordHeader()
+    : nb_afferents(0),
+      nb_outputs(0),
+      len_history(0),
+      wta_f(0.f),
+      delta_t(0.f),
+      seed(0)
+{
+}
+
+SpikeRecordSummary::SpikeRecordSummary()
+    : nb_ticks(0),
+      nb_spikes(0),
+      checksum_initial(0.),
+      checksum_final(0.)
+{
+}
+
+double WeightChecksum(const Mat1f &weights, const Mat1f &bias)
+{
+    double checksum = 0.;
+    for(int r=0; r<weights.rows; r++) {
+
+        for(int c=0; c<weights.cols; c++) {
+
+            checksum += weights(r, c) * static_cast<double>((r*weights.cols+c) % 97 + 1);
+        }
+    }
+
+    for(int i=0; i<static_cast<int>(bias.total()); i++) {
+
+        checksum += bias(i) * static_cast<double>(i % 89 + 1);
+    }
+    return checksum;
+}
+
+SpikeRecordWriter::SpikeRecordWriter()
+    : nb_ticks_(0),
+      nb_spikes_(0)
+{
+}
+
+SpikeRecordWriter::~SpikeRecordWriter()
+{
+    if(IsOpen()) {
+
+        out_.close();
+    }
+}
+
+void SpikeRecordWriter::Open(const string &path, const SpikeRecordHeader &header)
+{
+    out_.open(path.c_str(), ios::out | ios::binary | ios::trunc);
+    if(!out_.is_open()) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open file for writing: " + path);
+    }
+
+    header_ = header;
+    nb_ticks_ = 0;
+    nb_spikes_ = 0;
+
+    out_.write(MAGIC, LEN_MAGIC);
+    WriteRaw(out_, header_.nb_afferents);
+    WriteRaw(out_, header_.nb_outputs);
+    WriteRaw(out_, header_.len_history);
+    WriteRaw(out_, header_.wta_f);
+    WriteRaw(out_, header_.delta_t);
+    WriteRaw(out_, header_.seed);
+}
+
+void SpikeRecordWriter::Tick(const Mat &spikes_in, const Mat &spikes_out)
+{
+    if(spikes_in.total() != static_cast<size_t>(header_.nb_afferents) ||
+            spikes_out.total() != static_cast<size_t>(header_.nb_outputs)) {
+
+        ELM_THROW_BAD_DIMS("Spikes do not match dimensions of recording.");
+    }
+
+    vector<int> indices;
+    NonZeroIndices(spikes_out, indices);
+    int winner = indices.empty()? -1 : indices[0];
+
+    NonZeroIndices(spikes_in, indices);
+
+    WriteRaw(out_, TAG_TICK);
+    WriteRaw(out_, static_cast<int>(indices.size()));
+    if(!indices.empty()) {
+
+        out_.write(reinterpret_cast<const char*>(&indices[0]), indices.size()*sizeof(int));
+    }
+    WriteRaw(out_, winner);
+
+    nb_ticks_++;
+    nb_spikes_ += (winner >= 0)? 1 : 0;
+}
+
+void SpikeRecordWriter::Clear()
+{
+    WriteRaw(out_, TAG_CLEAR);
+}
+
+void SpikeRecordWriter::Close(SpikeRecordSummary summary)
+{
+    summary.nb_ticks = nb_ticks_;
+    summary.nb_spikes = nb_spikes_;
+
+    WriteRaw(out_, TAG_END);
+    WriteRaw(out_, summary.nb_ticks);
+    WriteRaw(out_, summary.nb_spikes);
+    WriteRaw(out_, summary.checksum_initial);
+    WriteRaw(out_, summary.checksum_final);
+
+    out_.close();
+}
+
+bool SpikeRecordWriter::IsOpen() const
+{
+    return out_.is_open();
+}
+
+SpikeRecordReader::SpikeRecordReader()
+{
+}
+
+void SpikeRecordReader::Open(const string &path)
+{
+    in_.open(path.c_str(), ios::in | ios::binary);
+    if(!in_.is_open()) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open file for reading: " + path);
+    }
+
+    char magic[LEN_MAGIC];
+    in_.read(magic, LEN_MAGIC);
+    if(!in_ || memcmp(magic, MAGIC, LEN_MAGIC) != 0) {
+
+        ELM_THROW_FILEIO_ERROR("Unrecognized spike recording format: " + path);
+    }
+
+    bool is_valid = ReadRaw(in_, header_.nb_afferents) &&
+            ReadRaw(in_, header_.nb_outputs) &&
+            ReadRaw(in_, header_.len_history) &&
+            ReadRaw(in_, header_.wta_f) &&
+            ReadRaw(in_, header_.delta_t) &&
+            ReadRaw(in_, header_.seed);
+
+    if(!is_valid || header_.nb_afferents < 1 || header_.nb_outputs < 1) {
+
+        ELM_THROW_FILEIO_ERROR("Invalid spike recording header: " + path);
+    }
+
+    summary_ = SpikeRecordSummary();
+}
+
+const SpikeRecordHeader& SpikeRecordReader::Header() const
+{
+    return header_;
+}
+
+SpikeRecordReader::Event SpikeRecordReader::Next(Mat1f &spikes_in, int &winner)
+{
+    char tag;
+    if(!ReadRaw(in_, tag)) {
+
+        ELM_THROW_FILEIO_ERROR("Spike recording truncated, missing end of recording.");
+    }
+
+    if(tag == TAG_CLEAR) {
+
+        return EVENT_CLEAR;
+    }
+    else if(tag == TAG_END) {
+
+        bool is_valid = ReadRaw(in_, summary_.nb_ticks) &&
+                ReadRaw(in_, summary_.nb_spikes) &&
+                ReadRaw(in_, summary_.checksum_initial) &&
+                ReadRaw(in_, summary_.checksum_final);
+
+        if(!is_valid) {
+
+            ELM_THROW_FILEIO_ERROR("Spike recording truncated, incomplete summary.");
+        }
+        return EVENT_END;
+    }
+    else if(tag != TAG_TICK) {
+
+        ELM_THROW_FILEIO_ERROR("Corrupt spike recording, unknown event.");
+    }
+
+    int nb_active;
+    if(!ReadRaw(in_, nb_active) || nb_active < 0 || nb_active > header_.nb_afferents) {
+
+        ELM_THROW_FILEIO_ERROR("Corrupt spike recording, invalid no. of active afferents.");
+    }
+
+    indices_.resize(nb_active);
+    if(nb_active > 0) {
+
+        in_.read(reinterpret_cast<char*>(&indices_[0]), nb_active*sizeof(int));
+    }
+
+    if(!ReadRaw(in_, winner)) {
+
+        ELM_THROW_FILEIO_ERROR("Spike recording truncated, incomplete tick.");
+    }
+
+    if(spikes_in.rows != 1 || spikes_in.cols != header_.nb_afferents) {
+
+        spikes_in = Mat1f(1, header_.nb_afferents);
+    }
+    spikes_in.setTo(0.f);
+
+    for(int i=0; i<nb_active; i++) {
+
+        if(indices_[i] < 0 || indices_[i] >= header_.nb_afferents) {
+
+            ELM_THROW_FILEIO_ERROR("Corrupt spike recording, afferent index out of range.");
+        }
+        spikes_in(indices_[i]) = 1.f;
+    }
+
+    return EVENT_TICK;
+}
+
+const SpikeRecordSummary& SpikeRecordReader::Summary() const
+{
+    return summary_;
+}
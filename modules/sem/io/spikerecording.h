@@ -0,0 +1,150 @@
+#ifndef SEM_IO_SPIKERECORDING_H_
+#define SEM_IO_SPIKERECORDING_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Configuration of a recorded run
+ */
+struct SpikeRecordHeader
+{
+    SpikeRecordHeader();
+
+    int nb_afferents;           ///< no. of afferent inputs
+    int nb_outputs;             ///< no. of output neurons
+    int len_history;            ///< length of spiking history
+    float wta_f;                ///< WTA's spiking frequency [Hz]
+    float delta_t;              ///< time resolution [milliseconds]
+    unsigned long long seed;    ///< seed of cv::theRNG() prior to layer initialization, see cv::RNG(uint64)
+};
+
+/**
+ * @brief Summary written at the end of a recording
+ */
+struct SpikeRecordSummary
+{
+    SpikeRecordSummary();
+
+    unsigned long long nb_ticks;    ///< no. of recorded ticks
+    unsigned long long nb_spikes;   ///< no. of recorded WTA spikes
+    double checksum_initial;        ///< checksum of weights and bias before the first tick
+    double checksum_final;          ///< checksum of weights and bias after the last tick
+};
+
+/**
+ * @brief Checksum of layer weights and bias for detecting behavior drift
+ *
+ * Sum of all elements weighted by their position,
+ * such that permutations of neurons or afferents are detected as well.
+ *
+ * @param weights (nb_outputs x nb_afferents)
+ * @param bias (1 x nb_outputs)
+ * @return checksum
+ */
+double WeightChecksum(const cv::Mat1f &weights, const cv::Mat1f &bias);
+
+/**
+ * @brief Write the input spike stream and WTA spikes of a run to a binary file
+ *
+ * File layout (native byte order):
+ *  magic, header,
+ *  sequence of events:
+ *      tick:  'T', no. of active afferents, indices of active afferents, index of WTA winner or -1
+ *      clear: 'C'
+ *  end: 'E', summary
+ */
+class SpikeRecordWriter
+{
+public:
+    SpikeRecordWriter();
+
+    ~SpikeRecordWriter();
+
+    /**
+     * @brief Open file for writing and write header
+     * @param path to file
+     * @param header describing configuration of run
+     * @throws ExceptionFileIOError on failure to open file
+     */
+    void Open(const std::string &path, const SpikeRecordHeader &header);
+
+    /**
+     * @brief Record a single tick
+     * @param input spikes (nb_afferents elements, non-zero for spiking afferent)
+     * @param output spikes (nb_outputs elements, non-zero for WTA winner)
+     * @throws ExceptionBadDims on dimensions deviating from header
+     */
+    void Tick(const cv::Mat &spikes_in, const cv::Mat &spikes_out);
+
+    /**
+     * @brief Record clearing of layer state (e.g. end of stimulus presentation)
+     */
+    void Clear();
+
+    /**
+     * @brief Write summary and close file
+     * @param summary, no. of ticks and spikes are filled in from recorded events
+     */
+    void Close(SpikeRecordSummary summary);
+
+    bool IsOpen() const;
+
+protected:
+    std::ofstream out_;             ///< output file stream
+    SpikeRecordHeader header_;      ///< configuration of recorded run
+    unsigned long long nb_ticks_;   ///< no. of ticks recorded so far
+    unsigned long long nb_spikes_;  ///< no. of WTA spikes recorded so far
+};
+
+/**
+ * @brief Read spike stream recorded by SpikeRecordWriter
+ */
+class SpikeRecordReader
+{
+public:
+    /** Events in recorded stream
+     */
+    enum Event {
+        EVENT_TICK = 0, ///< a single simulation tick
+        EVENT_CLEAR,    ///< clearing of layer state
+        EVENT_END       ///< end of recording, summary available
+    };
+
+    SpikeRecordReader();
+
+    /**
+     * @brief Open file and read header
+     * @param path to file
+     * @throws ExceptionFileIOError on failure to open file or unrecognized format
+     */
+    void Open(const std::string &path);
+
+    const SpikeRecordHeader& Header() const;
+
+    /**
+     * @brief Read next event
+     * @param[out] input spikes of tick event as 0/1 row vector, buffer re-used across calls
+     * @param[out] index of WTA winner of tick event, -1 for no spike
+     * @return type of event read
+     * @throws ExceptionFileIOError on truncated file
+     */
+    Event Next(cv::Mat1f &spikes_in, int &winner);
+
+    /**
+     * @brief get summary, only valid after reaching EVENT_END
+     * @return summary
+     */
+    const SpikeRecordSummary& Summary() const;
+
+protected:
+    std::ifstream in_;              ///< input file stream
+    SpikeRecordHeader header_;      ///< configuration of recorded run
+    SpikeRecordSummary summary_;    ///< summary of recorded run
+    std::vector<int> indices_;      ///< buffer for indices of active afferents
+};
+
+#endif // SEM_IO_SPIKERECORDING_H_
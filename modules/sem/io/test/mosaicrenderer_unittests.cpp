@@ -0,0 +1,171 @@
+#include "sem/io/mosaicrenderer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_NEURONS = 5;
+const int TILE_ROWS = 3;
+const int TILE_COLS = 2;
+const int NB_AFFERENTS = 2*TILE_ROWS*TILE_COLS; // on and off interlaced
+
+class MosaicRendererTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        stringstream s;
+        s << "mosaicrenderer_test_" << getpid() << "_";
+        prefix_ = s.str();
+
+        weights_ = Mat1f(NB_NEURONS, NB_AFFERENTS);
+        randn(weights_, -1.f, 0.5f);
+    }
+
+    virtual void TearDown()
+    {
+        for(size_t i=0; i<paths_.size(); i++) {
+
+            std::remove(paths_[i].c_str());
+        }
+    }
+
+    /**
+     * @brief Snapshot of weights with random bias
+     */
+    WeightsPublisher::SnapshotPtr Snapshot(unsigned long long version) const
+    {
+        Mat1f bias(NB_NEURONS, 1);
+        randn(bias, 0.f, 1.f);
+
+        Mat1f weights_all;
+        hconcat(bias, weights_, weights_all);
+        return WeightsPublisher::SnapshotPtr(new WeightsSnapshot(weights_all, version));
+    }
+
+    string prefix_;         ///< prefix of mosaic files
+    vector<string> paths_;  ///< files to clean up
+    Mat1f weights_;         ///< weights excluding bias, log scale
+};
+
+TEST_F(MosaicRendererTest, Render_Dims)
+{
+    Mat1b mosaic = MosaicRenderer::Render(weights_, TILE_ROWS);
+
+    // 3 x 2 grid of tiles, each with on and off weights side by side
+    const int B = MosaicRenderer::BORDER;
+    EXPECT_MAT_DIMS_EQ(mosaic, Size(3*(2*TILE_COLS+2*B)+B, 2*(TILE_ROWS+B)+B));
+
+    // unused grid cell
+    Mat1b unused = mosaic(Rect(2*(2*TILE_COLS+2*B)+B, TILE_ROWS+2*B, 2*TILE_COLS+B, TILE_ROWS));
+    EXPECT_EQ(0, countNonZero(unused != MosaicRenderer::BORDER_VALUE));
+}
+
+/**
+ * @brief Tiles show on and off weights of a neuron in linear scale
+ */
+TEST_F(MosaicRendererTest, Render_Tile)
+{
+    Mat1f weights = Mat1f::zeros(1, NB_AFFERENTS);
+    weights(0) = std::log(4.f);  // first on weight
+    weights(1) = std::log(2.f);  // first off weight
+
+    Mat1b mosaic = MosaicRenderer::Render(weights, TILE_ROWS);
+
+    const int B = MosaicRenderer::BORDER;
+    EXPECT_MAT_DIMS_EQ(mosaic, Size(2*TILE_COLS+3*B, TILE_ROWS+2*B));
+
+    Mat1b on = mosaic(Rect(B, B, TILE_COLS, TILE_ROWS));
+    Mat1b off = mosaic(Rect(2*B+TILE_COLS, B, TILE_COLS, TILE_ROWS));
+
+    EXPECT_EQ(255, on(0, 0));
+    EXPECT_EQ(85, off(0, 0));   // (2-1)/(4-1)
+    EXPECT_EQ(0, on(TILE_ROWS-1, TILE_COLS-1));
+    EXPECT_EQ(0, off(TILE_ROWS-1, TILE_COLS-1));
+    EXPECT_EQ(MosaicRenderer::BORDER_VALUE, mosaic(B, B+TILE_COLS)) << "Expecting border between on and off";
+}
+
+TEST_F(MosaicRendererTest, Render_Invalid)
+{
+    EXPECT_THROW(MosaicRenderer::Render(Mat1f(), TILE_ROWS), ExceptionBadDims);
+    EXPECT_THROW(MosaicRenderer::Render(Mat1f::zeros(NB_NEURONS, NB_AFFERENTS+1), TILE_ROWS), ExceptionBadDims);
+    EXPECT_THROW(MosaicRenderer::Render(weights_, TILE_ROWS+1), ExceptionBadDims);
+    EXPECT_THROW(MosaicRenderer(prefix_, 0), ExceptionValueError);
+}
+
+TEST_F(MosaicRendererTest, Submit)
+{
+    MosaicRenderer to(prefix_, TILE_ROWS);
+    paths_.push_back(to.Path(7));
+
+    to.Submit(WeightsPublisher::SnapshotPtr());
+    to.Submit(Snapshot(7));
+    to.Flush();
+
+    EXPECT_EQ(1ULL, to.NbWritten());
+    EXPECT_EQ(0ULL, to.NbDropped());
+
+    Mat1b mosaic = imread(to.Path(7), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(mosaic.empty());
+    EXPECT_MAT_EQ(MosaicRenderer::Render(weights_, TILE_ROWS), mosaic);
+}
+
+/**
+ * @brief Every snapshot submitted is either written or dropped for a newer one, the most recent always written
+ */
+TEST_F(MosaicRendererTest, Submit_Many)
+{
+    const int N = 20;
+    {
+        MosaicRenderer to(prefix_, TILE_ROWS);
+        for(int i=0; i<N; i++) {
+
+            paths_.push_back(to.Path(i));
+            to.Submit(Snapshot(i));
+        }
+        to.Flush();
+
+        EXPECT_EQ(static_cast<unsigned long long>(N), to.NbWritten()+to.NbDropped());
+    }
+
+    EXPECT_FALSE(imread(paths_.back(), IMREAD_GRAYSCALE).empty());
+}
+
+TEST_F(MosaicRendererTest, Submit_Invalid)
+{
+    MosaicRenderer to(prefix_, TILE_ROWS+1);
+    to.Submit(Snapshot(0));
+    EXPECT_THROW(to.Flush(), ExceptionBadDims);
+    EXPECT_NO_THROW(to.Flush()) << "Expecting error to be reported once";
+    EXPECT_EQ(0ULL, to.NbWritten());
+}
+
+/**
+ * @brief Pending snapshot is rendered before destruction
+ */
+TEST_F(MosaicRendererTest, RenderPendingOnDestruction)
+{
+    string path;
+    {
+        MosaicRenderer to(prefix_, TILE_ROWS);
+        path = to.Path(3);
+        paths_.push_back(path);
+        to.Submit(Snapshot(3));
+    }
+    EXPECT_FALSE(imread(path, IMREAD_GRAYSCALE).empty());
+}
+
+} // annonymous namespace
@@ -0,0 +1,186 @@
+#include "sem/io/spikerecording.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string PATH_RECORDING = "spikerecording_unittests.bin";
+
+class SpikeRecordingTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        header_.nb_afferents = 20;
+        header_.nb_outputs = 4;
+        header_.len_history = 3;
+        header_.wta_f = 40.f;
+        header_.delta_t = 1.f;
+        header_.seed = 123456789ULL;
+    }
+
+    virtual void TearDown()
+    {
+        remove(PATH_RECORDING.c_str());
+    }
+
+    SpikeRecordHeader header_;
+};
+
+TEST_F(SpikeRecordingTest, OpenInvalidPath)
+{
+    SpikeRecordReader reader;
+    EXPECT_THROW(reader.Open("non_existent_dir/recording.bin"), ExceptionFileIOError);
+
+    SpikeRecordWriter writer;
+    EXPECT_THROW(writer.Open("non_existent_dir/recording.bin", header_), ExceptionFileIOError);
+    EXPECT_FALSE(writer.IsOpen());
+}
+
+TEST_F(SpikeRecordingTest, UnrecognizedFormat)
+{
+    {
+        ofstream out(PATH_RECORDING.c_str());
+        out << "not a recording";
+    }
+    SpikeRecordReader reader;
+    EXPECT_THROW(reader.Open(PATH_RECORDING), ExceptionFileIOError);
+}
+
+TEST_F(SpikeRecordingTest, TickDims)
+{
+    SpikeRecordWriter writer;
+    writer.Open(PATH_RECORDING, header_);
+    EXPECT_TRUE(writer.IsOpen());
+
+    EXPECT_THROW(writer.Tick(Mat1f::zeros(1, header_.nb_afferents+1), Mat1f::zeros(1, header_.nb_outputs)), ExceptionBadDims);
+    EXPECT_THROW(writer.Tick(Mat1f::zeros(1, header_.nb_afferents), Mat1f::zeros(1, header_.nb_outputs-1)), ExceptionBadDims);
+    EXPECT_NO_THROW(writer.Tick(Mat1f::zeros(header_.nb_afferents, 1), Mat1f::zeros(1, header_.nb_outputs)));
+}
+
+TEST_F(SpikeRecordingTest, WriteRead)
+{
+    const int N=30;
+    vector<Mat1f> spikes_in;
+    vector<int> winners;
+
+    SpikeRecordSummary summary;
+    summary.checksum_initial = -1.5;
+    summary.checksum_final = 2.25;
+    {
+        SpikeRecordWriter writer;
+        writer.Open(PATH_RECORDING, header_);
+
+        for(int i=0; i<N; i++) {
+
+            Mat1f r(1, header_.nb_afferents);
+            randu(r, 0.f, 1.f);
+            Mat1f spikes = r > 0.7f;    // non-zero spikes other than 1 are recorded as 1
+            spikes_in.push_back(spikes);
+
+            int winner = (i % 3 == 0)? i % header_.nb_outputs : -1;
+            Mat1f spikes_out = Mat1f::zeros(1, header_.nb_outputs);
+            if(winner >= 0) {
+
+                spikes_out(winner) = 1.f;
+            }
+            winners.push_back(winner);
+
+            writer.Tick(spikes, spikes_out);
+            if(i % 10 == 9) {
+
+                writer.Clear();
+            }
+        }
+        writer.Close(summary);
+        EXPECT_FALSE(writer.IsOpen());
+    }
+
+    SpikeRecordReader reader;
+    reader.Open(PATH_RECORDING);
+
+    EXPECT_EQ(header_.nb_afferents, reader.Header().nb_afferents);
+    EXPECT_EQ(header_.nb_outputs, reader.Header().nb_outputs);
+    EXPECT_EQ(header_.len_history, reader.Header().len_history);
+    EXPECT_FLOAT_EQ(header_.wta_f, reader.Header().wta_f);
+    EXPECT_FLOAT_EQ(header_.delta_t, reader.Header().delta_t);
+    EXPECT_EQ(header_.seed, reader.Header().seed);
+
+    Mat1f spikes;
+    int winner;
+    int nb_ticks = 0, nb_clear = 0, nb_spikes = 0;
+    SpikeRecordReader::Event e;
+    while((e = reader.Next(spikes, winner)) != SpikeRecordReader::EVENT_END) {
+
+        if(e == SpikeRecordReader::EVENT_TICK) {
+
+            ASSERT_LT(nb_ticks, N);
+            Mat1f expected = spikes_in[nb_ticks] / 255.f;
+            EXPECT_MAT_EQ(spikes, expected);
+            EXPECT_EQ(winners[nb_ticks], winner);
+            nb_spikes += (winner >= 0)? 1 : 0;
+            nb_ticks++;
+        }
+        else {
+
+            EXPECT_EQ(SpikeRecordReader::EVENT_CLEAR, e);
+            EXPECT_EQ(0, nb_ticks % 10);
+            nb_clear++;
+        }
+    }
+
+    EXPECT_EQ(N, nb_ticks);
+    EXPECT_EQ(N/10, nb_clear);
+    EXPECT_EQ(static_cast<unsigned long long>(N), reader.Summary().nb_ticks);
+    EXPECT_EQ(static_cast<unsigned long long>(nb_spikes), reader.Summary().nb_spikes);
+    EXPECT_DOUBLE_EQ(summary.checksum_initial, reader.Summary().checksum_initial);
+    EXPECT_DOUBLE_EQ(summary.checksum_final, reader.Summary().checksum_final);
+}
+
+TEST_F(SpikeRecordingTest, Truncated)
+{
+    {
+        SpikeRecordWriter writer;
+        writer.Open(PATH_RECORDING, header_);
+        writer.Tick(Mat1f::ones(1, header_.nb_afferents), Mat1f::zeros(1, header_.nb_outputs));
+    } // closed without summary
+
+    SpikeRecordReader reader;
+    reader.Open(PATH_RECORDING);
+
+    Mat1f spikes;
+    int winner;
+    EXPECT_EQ(SpikeRecordReader::EVENT_TICK, reader.Next(spikes, winner));
+    EXPECT_EQ(-1, winner);
+    EXPECT_EQ(header_.nb_afferents, countNonZero(spikes));
+    EXPECT_THROW(reader.Next(spikes, winner), ExceptionFileIOError);
+}
+
+TEST_F(SpikeRecordingTest, WeightChecksum)
+{
+    Mat1f w(3, 5);
+    randn(w, 0.f, 1.f);
+    Mat1f b(1, 3);
+    randn(b, 0.f, 1.f);
+
+    const double checksum = WeightChecksum(w, b);
+    EXPECT_DOUBLE_EQ(checksum, WeightChecksum(w.clone(), b.clone()));
+
+    Mat1f w2 = w.clone();
+    std::swap(w2(0, 0), w2(1, 0));
+    EXPECT_NE(checksum, WeightChecksum(w2, b)) << "Permutation of weights not detected";
+
+    Mat1f b2 = b.clone();
+    b2(2) += 1e-3f;
+    EXPECT_NE(checksum, WeightChecksum(w, b2));
+}
+
+} // annonymous namespace
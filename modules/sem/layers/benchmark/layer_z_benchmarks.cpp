@@ -0,0 +1,248 @@
+/** @file Benchmark LayerZ kernels
+ */
+#include "sem/layers/layer_z.h"
+
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string NAME_INPUT_SPIKES   = "in";
+const string NAME_OUTPUT_SPIKES  = "out";
+const string NAME_OUTPUT_WEIGHTS = "weights";
+
+/**
+ * @brief class for benchmarking layer Z over different geometries
+ */
+class LayerZBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+
+        params_ = PTree();
+        params_.put(LayerZ::PARAM_NB_AFFERENTS, g.nb_afferents);
+        params_.put(LayerZ::PARAM_NB_OUTPUT_NODES, g.nb_outputs);
+        params_.put(LayerZ::PARAM_LEN_HISTORY, g.len_history);
+        params_.put(LayerZ::PARAM_DELTA_T, 1.f);
+
+        config_.Input(LayerZ::KEY_INPUT_SPIKES, NAME_INPUT_SPIKES);
+        config_.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_OUTPUT_SPIKES);
+
+        signal_.Append(NAME_INPUT_SPIKES, RandomSpikes(g.nb_afferents, g.density));
+    }
+
+    /**
+     * @brief Reset test object
+     * @param WTA firing rate [Hz]
+     */
+    void ResetLayer(float wta_f)
+    {
+        params_.put(LayerZ::PARAM_WTA_FREQ, wta_f);
+        config_.Params(params_);
+        to_.Reset(config_);
+        to_.IONames(config_);
+    }
+
+    LayerZ to_;             ///< test object
+    LayerConfig config_;
+    PTree params_;
+    Signal signal_;
+};
+
+/**
+ * @brief Activate with WTA firing on every tick
+ */
+TEST_P(LayerZBenchmark, Activate_Fire)
+{
+    ResetLayer(1e5f);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Activate(signal_); }, nb_iterations);
+    RecordBenchmark("LayerZ::Activate_Fire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Activate with WTA in refractory period
+ */
+TEST_P(LayerZBenchmark, Activate_NoFire)
+{
+    ResetLayer(0.f);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Activate(signal_); }, nb_iterations);
+    RecordBenchmark("LayerZ::Activate_NoFire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Learn with a winner, one neuron undergoes STDP, others update bias
+ */
+TEST_P(LayerZBenchmark, Learn_Fire)
+{
+    ResetLayer(1e5f);
+    to_.Activate(signal_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Learn(); }, nb_iterations);
+    RecordBenchmark("LayerZ::Learn_Fire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Learn without a winner, bias updates only
+ */
+TEST_P(LayerZBenchmark, Learn_NoFire)
+{
+    ResetLayer(0.f);
+    to_.Activate(signal_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Learn(); }, nb_iterations);
+    RecordBenchmark("LayerZ::Learn_NoFire", GetParam(), nb_iterations, ns);
+}
+
+TEST_P(LayerZBenchmark, Response)
+{
+    ResetLayer(0.f);
+    to_.Activate(signal_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() {
+
+        Signal s;
+        to_.Response(s);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Response", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Response including export of all neuron weights
+ */
+TEST_P(LayerZBenchmark, Response_Weights)
+{
+    config_.Output(LayerZ::KEY_OUTPUT_WEIGHTS, NAME_OUTPUT_WEIGHTS);
+    ResetLayer(0.f);
+    to_.Activate(signal_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() {
+
+        Signal s;
+        to_.Response(s);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Response_Weights", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief A full simulation tick with default WTA rate at 1 ms resolution
+ */
+TEST_P(LayerZBenchmark, Tick)
+{
+    ResetLayer(LayerZ::DEFAULT_WTA_FREQ);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() {
+
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Tick", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief A full simulation tick with default WTA rate at 1 ms resolution, event-driven
+ * Potentials only computed on WTA spike ticks
+ */
+TEST_P(LayerZBenchmark, Tick_EventDriven)
+{
+    params_.put(LayerZ::PARAM_EVENT_DRIVEN, true);
+    ResetLayer(LayerZ::DEFAULT_WTA_FREQ);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() {
+
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Tick_EventDriven", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief A full simulation tick as above, generic kernels even for registered geometries
+ * Compare against Tick for the gain of specialized kernels, see LayerZKernelFactory
+ */
+TEST_P(LayerZBenchmark, Tick_Generic)
+{
+    params_.put(LayerZ::PARAM_SPECIALIZED, false);
+    ResetLayer(LayerZ::DEFAULT_WTA_FREQ);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() {
+
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Tick_Generic", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief A full simulation tick as above, I/O through slots bound once instead of lookups by name
+ * Compare against Tick for the cost of string-keyed I/O, see LayerZ::Bind()
+ */
+TEST_P(LayerZBenchmark, Tick_Bound)
+{
+    ResetLayer(LayerZ::DEFAULT_WTA_FREQ);
+
+    BoundSignal bound;
+    to_.Bind(bound);
+    bound.Import(signal_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this, &bound]() {
+
+        to_.Activate(bound);
+        to_.Learn();
+        to_.Response(bound);
+
+    }, nb_iterations);
+    RecordBenchmark("LayerZ::Tick_Bound", GetParam(), nb_iterations, ns);
+}
+
+const int AFFERENTS[] = {784, 1568, 10000, 100000};
+const int OUTPUTS_FEW[] = {10, 100};
+const int OUTPUTS_MANY[] = {1000, 10000};
+const int HISTORY[] = {5, 10};
+const float DENSITY[] = {0.05f, 0.2f};
+
+/** sweep afferent count at typical no. of outputs
+ */
+INSTANTIATE_TEST_CASE_P(SweepAfferents,
+                        LayerZBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+4),
+                                                        vector<int>(OUTPUTS_FEW, OUTPUTS_FEW+2),
+                                                        vector<int>(HISTORY, HISTORY+2),
+                                                        vector<float>(DENSITY, DENSITY+2))));
+
+/** sweep large no. of outputs at MNIST input size
+ */
+INSTANTIATE_TEST_CASE_P(SweepOutputs,
+                        LayerZBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(1, 784),
+                                                        vector<int>(OUTPUTS_MANY, OUTPUTS_MANY+2),
+                                                        vector<int>(HISTORY, HISTORY+2),
+                                                        vector<float>(DENSITY, DENSITY+2))));
+
+} // annonymous namespace
@@ -0,0 +1,156 @@
+/** @file Benchmark LayerZ time-to-quality for constant and adaptive learning rates
+ *
+ * Streams stimuli drawn from a few random prototypes through the layer
+ * until the majority-label accuracy over a window of stimuli reaches a target.
+ * Reports the no. of stimuli and seconds it took.
+ */
+#include "sem/layers/layer_z.h"
+
+#include <chrono>
+#include <sstream>
+
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "sem/eval/onlineclustereval.h"
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string NAME_INPUT_SPIKES   = "in";
+const string NAME_OUTPUT_SPIKES  = "out";
+
+const int NB_CLUSTERS       = 4;
+const int TICKS             = 20;       ///< ticks per stimulus
+const int WINDOW            = 100;      ///< no. of stimuli per evaluation window
+const int MAX_STIMULI       = 20000;    ///< give up after this many stimuli
+const float TARGET_ACCURACY = 0.9f;
+const uint64 SEED           = 2010;
+
+/**
+ * @brief class for benchmarking convergence of layer Z over different geometries
+ */
+class LayerZConvergenceBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    /**
+     * @brief Stream stimuli until target accuracy is reached and report
+     * @param kernel name
+     * @param enable adaptive learning rate
+     */
+    void TimeToQuality(const string &kernel, bool is_adaptive_rate)
+    {
+        typedef chrono::steady_clock Clock;
+
+        BenchmarkGeometry g = GetParam();
+
+        PTree params;
+        params.put(LayerZ::PARAM_NB_AFFERENTS, g.nb_afferents);
+        params.put(LayerZ::PARAM_NB_OUTPUT_NODES, g.nb_outputs);
+        params.put(LayerZ::PARAM_LEN_HISTORY, g.len_history);
+        params.put(LayerZ::PARAM_WTA_FREQ, 1000.f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+        params.put(LayerZ::PARAM_ADAPTIVE_RATE, is_adaptive_rate);
+
+        LayerConfig config;
+        config.Params(params);
+        config.Input(LayerZ::KEY_INPUT_SPIKES, NAME_INPUT_SPIKES);
+        config.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_OUTPUT_SPIKES);
+
+        // same initial weights and stimuli for both learning rates
+        theRNG() = RNG(SEED);
+        LayerZ to;
+        to.Reset(config);
+        to.IONames(config);
+
+        RNG rng(SEED+1);
+        Mat1f prototypes(NB_CLUSTERS, g.nb_afferents);
+        for(int r=0; r<NB_CLUSTERS; r++) {
+
+            for(int c=0; c<g.nb_afferents; c++) {
+
+                prototypes(r, c) = (rng.uniform(0.f, 1.f) < g.density)? 0.9f : 0.05f*g.density;
+            }
+        }
+
+        OnlineClusterEval eval(g.nb_outputs, NB_CLUSTERS);
+        Signal signal;
+        Mat1f spikes_in(1, g.nb_afferents);
+
+        int nb_stimuli = 0;
+        float accuracy = 0.f;
+        double seconds = 0.;
+        while(nb_stimuli < MAX_STIMULI && accuracy < TARGET_ACCURACY) {
+
+            const int label = rng.uniform(0, NB_CLUSTERS);
+            Mat1f p = prototypes.row(label);
+
+            for(int t=0; t<TICKS; t++) {
+
+                for(int i=0; i<g.nb_afferents; i++) {
+
+                    spikes_in(i) = (rng.uniform(0.f, 1.f) < p(i))? 1.f : 0.f;
+                }
+                signal.Clear();
+                signal.Append(NAME_INPUT_SPIKES, spikes_in);
+
+                Clock::time_point t0 = Clock::now();
+                to.Activate(signal);
+                to.Response(signal);
+                to.Learn();
+                seconds += chrono::duration<double>(Clock::now()-t0).count();
+
+                eval.Update(signal.MostRecentMat1f(NAME_OUTPUT_SPIKES), label);
+            }
+            to.Clear();
+
+            if(++nb_stimuli % WINDOW == 0) {
+
+                accuracy = eval.Accuracy();
+                eval.Reset(g.nb_outputs, NB_CLUSTERS);
+            }
+        }
+
+        stringstream s_sec, s_acc;
+        s_sec << seconds;
+        s_acc << accuracy;
+
+        RecordProperty("kernel", kernel);
+        RecordProperty("nb_afferents", g.nb_afferents);
+        RecordProperty("nb_outputs", g.nb_outputs);
+        RecordProperty("stimuli_to_quality", nb_stimuli);
+        RecordProperty("seconds_to_quality", s_sec.str());
+        RecordProperty("accuracy", s_acc.str());
+        RecordProperty("is_target_reached", static_cast<int>(accuracy >= TARGET_ACCURACY));
+
+        cout << "[ BENCHMARK] " << kernel << " " << g
+             << " stimuli_to_quality=" << nb_stimuli
+             << " seconds_to_quality=" << s_sec.str()
+             << " accuracy=" << s_acc.str() << endl;
+    }
+};
+
+TEST_P(LayerZConvergenceBenchmark, TimeToQuality_ConstantRate)
+{
+    TimeToQuality("LayerZ::TimeToQuality_ConstantRate", false);
+}
+
+TEST_P(LayerZConvergenceBenchmark, TimeToQuality_AdaptiveRate)
+{
+    TimeToQuality("LayerZ::TimeToQuality_AdaptiveRate", true);
+}
+
+const int AFFERENTS[] = {784, 10000};
+const int OUTPUTS[] = {10, 40};
+
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        LayerZConvergenceBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+2),
+                                                        vector<int>(OUTPUTS, OUTPUTS+2),
+                                                        vector<int>(1, 5),
+                                                        vector<float>(1, 0.1f))));
+
+} // annonymous namespace
@@ -0,0 +1,88 @@
+/** @file Benchmark membrane potentials from quantized against float weights
+ */
+#include "sem/layers/quantizedweights.h"
+
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+/**
+ * @brief class for benchmarking integer inference over different geometries
+ */
+class QuantizedWeightsBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+
+        weights_ = Mat1f(g.nb_outputs, g.nb_afferents);
+        randu(weights_, -5.f, 0.f);
+        bias_ = Mat1f(1, g.nb_outputs);
+        randu(bias_, -3.f, 0.f);
+
+        spikes_in_ = RandomSpikes(g.nb_afferents, g.density);
+    }
+
+    /**
+     * @brief Time quantized potentials
+     * @param kernel name
+     * @param depth in bits
+     */
+    void TimePotentials(const string &kernel, int depth)
+    {
+        QuantizedWeights to(weights_, bias_, depth);
+
+        int nb_iterations;
+        Mat1f u;
+        double ns = TimeKernel([&]() { to.Potentials(spikes_in_, u); }, nb_iterations);
+        RecordBenchmark(kernel, GetParam(), nb_iterations, ns);
+    }
+
+    Mat1f weights_;
+    Mat1f bias_;
+    Mat1f spikes_in_;
+};
+
+/**
+ * @brief Float reference, sum over weights times input spikes per neuron
+ */
+TEST_P(QuantizedWeightsBenchmark, Potentials_Float)
+{
+    int nb_iterations;
+    Mat1f u(1, weights_.rows);
+    double ns = TimeKernel([&]() {
+
+        for(int r=0; r<weights_.rows; r++) {
+
+            u(r) = bias_(r) + static_cast<float>(sum(weights_.row(r).mul(spikes_in_))(0));
+        }
+    }, nb_iterations);
+    RecordBenchmark("QuantizedWeights::Potentials_Float", GetParam(), nb_iterations, ns);
+}
+
+TEST_P(QuantizedWeightsBenchmark, Potentials_8)
+{
+    TimePotentials("QuantizedWeights::Potentials_8", QuantizedWeights::DEPTH_8);
+}
+
+TEST_P(QuantizedWeightsBenchmark, Potentials_16)
+{
+    TimePotentials("QuantizedWeights::Potentials_16", QuantizedWeights::DEPTH_16);
+}
+
+const int AFFERENTS[] = {784, 10000, 100000};
+const int OUTPUTS[] = {100, 1000};
+const float DENSITY[] = {0.05f, 0.2f};
+
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        QuantizedWeightsBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+3),
+                                                        vector<int>(OUTPUTS, OUTPUTS+2),
+                                                        vector<int>(1, 1),
+                                                        vector<float>(DENSITY, DENSITY+2))));
+
+} // annonymous namespace
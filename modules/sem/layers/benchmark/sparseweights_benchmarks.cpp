@@ -0,0 +1,75 @@
+/** @file Benchmark membrane potentials from pruned sparse weights
+ *
+ * Geometry density is reused as the fraction of synapses above the clamp,
+ * input spikes are drawn at a fixed density.
+ */
+#include "sem/layers/sparseweights.h"
+
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+const float INPUT_DENSITY = 0.1f;
+
+/**
+ * @brief class for benchmarking sparse potentials over different geometries
+ */
+class SparseWeightsBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+
+        weights_ = Mat1f(g.nb_outputs, g.nb_afferents);
+        randu(weights_, -4.f, 0.f);
+        Mat1f r(g.nb_outputs, g.nb_afferents);
+        randu(r, 0.f, 1.f);
+        weights_.setTo(-5.f, r >= g.density);
+
+        bias_ = Mat1f(1, g.nb_outputs);
+        randu(bias_, -3.f, 0.f);
+
+        spikes_in_ = RandomSpikes(g.nb_afferents, INPUT_DENSITY);
+    }
+
+    Mat1f weights_;
+    Mat1f bias_;
+    Mat1f spikes_in_;
+};
+
+TEST_P(SparseWeightsBenchmark, Potentials)
+{
+    SparseWeights to(weights_, bias_);
+
+    int nb_iterations;
+    Mat1f u;
+    double ns = TimeKernel([&]() { to.Potentials(spikes_in_, u); }, nb_iterations);
+    RecordBenchmark("SparseWeights::Potentials", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Rebuild cost, paid periodically during training
+ */
+TEST_P(SparseWeightsBenchmark, Build)
+{
+    int nb_iterations;
+    double ns = TimeKernel([&]() { SparseWeights to(weights_, bias_); }, nb_iterations);
+    RecordBenchmark("SparseWeights::Build", GetParam(), nb_iterations, ns);
+}
+
+const int AFFERENTS[] = {784, 10000, 100000};
+const int OUTPUTS[] = {100, 1000};
+const float KEPT[] = {0.05f, 0.2f, 1.f};
+
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        SparseWeightsBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+3),
+                                                        vector<int>(OUTPUTS, OUTPUTS+2),
+                                                        vector<int>(1, 1),
+                                                        vector<float>(KEPT, KEPT+3))));
+
+} // annonymous namespace
@@ -0,0 +1,110 @@
+#include "sem/layers/boundsignal.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/signal.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+BoundSignal::Slot::Slot(const string &name)
+    : name_(name),
+      is_set_(false)
+{
+}
+
+const string& BoundSignal::Slot::Name() const
+{
+    return name_;
+}
+
+bool BoundSignal::Slot::IsSet() const
+{
+    return is_set_;
+}
+
+const Mat1f& BoundSignal::Slot::Get() const
+{
+    if(!is_set_) {
+
+        ELM_THROW_KEY_ERROR("No feature set for " + name_);
+    }
+    return feature_;
+}
+
+void BoundSignal::Slot::Set(const Mat1f &feature)
+{
+    feature_ = feature;
+    is_set_ = true;
+}
+
+void BoundSignal::Slot::Write(const Mat1f &feature)
+{
+    feature.copyTo(buffer_); // no allocation while dimensions match
+    feature_ = buffer_;
+    is_set_ = true;
+}
+
+void BoundSignal::Slot::Clear()
+{
+    is_set_ = false;
+}
+
+BoundSignal::BoundSignal()
+{
+}
+
+BoundSignal::Slot* BoundSignal::Bind(const string &name)
+{
+    map<string, Slot*>::iterator itr = index_.find(name);
+    if(itr != index_.end()) {
+
+        return itr->second;
+    }
+
+    slots_.push_back(Slot(name));
+    Slot *slot = &slots_.back();
+    index_[name] = slot;
+    return slot;
+}
+
+bool BoundSignal::Exists(const string &name) const
+{
+    map<string, Slot*>::const_iterator itr = index_.find(name);
+    return itr != index_.end() && itr->second->IsSet();
+}
+
+int BoundSignal::NbSlots() const
+{
+    return static_cast<int>(slots_.size());
+}
+
+void BoundSignal::Clear()
+{
+    for(deque<Slot>::iterator itr=slots_.begin(); itr != slots_.end(); ++itr) {
+
+        itr->Clear();
+    }
+}
+
+void BoundSignal::Import(const Signal &signal)
+{
+    for(deque<Slot>::iterator itr=slots_.begin(); itr != slots_.end(); ++itr) {
+
+        if(signal.Exists(itr->Name())) {
+
+            itr->Set(signal.MostRecentMat1f(itr->Name()));
+        }
+    }
+}
+
+void BoundSignal::Export(Signal &signal) const
+{
+    for(deque<Slot>::const_iterator itr=slots_.begin(); itr != slots_.end(); ++itr) {
+
+        if(itr->IsSet()) {
+
+            signal.Append(itr->Name(), itr->Get());
+        }
+    }
+}
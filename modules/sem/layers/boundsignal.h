@@ -0,0 +1,117 @@
+#ifndef SEM_LAYERS_BOUNDSIGNAL_H_
+#define SEM_LAYERS_BOUNDSIGNAL_H_
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/typedefs_fwd.h"
+
+/**
+ * @brief Named features resolved once, for layers exchanging features without string-keyed lookups per tick
+ *
+ * Layers resolve their I/O names to slots when bound (see LayerZ::Bind()),
+ * keep pointers to those slots and read and write features through them on every tick.
+ * Slots keep their address for the lifetime of the BoundSignal.
+ * Import() and Export() bridge to elm::Signal for layers still using the string-keyed path.
+ */
+class BoundSignal
+{
+public:
+    /**
+     * @brief Single named feature
+     */
+    class Slot
+    {
+    public:
+        Slot(const std::string &name);
+
+        const std::string& Name() const;
+
+        /**
+         * @brief whether a feature was set since the last Clear()
+         */
+        bool IsSet() const;
+
+        /**
+         * @brief get most recent feature
+         * No deep copy
+         * @return feature
+         * @throws ExceptionKeyError if not set
+         */
+        const cv::Mat1f& Get() const;
+
+        /**
+         * @brief Set feature, no deep copy
+         * @param feature
+         */
+        void Set(const cv::Mat1f &feature);
+
+        /**
+         * @brief Set feature by deep copy into the slot's own buffer
+         * Reuses the buffer while dimensions remain the same,
+         * readers holding a previously written feature see it change.
+         * @param feature
+         */
+        void Write(const cv::Mat1f &feature);
+
+        /**
+         * @brief Unset feature, keeps the buffer for Write()
+         */
+        void Clear();
+
+    protected:
+        std::string name_;      ///< feature name, same as in elm::Signal
+        cv::Mat1f feature_;     ///< most recent feature
+        cv::Mat1f buffer_;      ///< slot's own buffer for Write(), never one passed to Set()
+        bool is_set_;           ///< set flag
+    };
+
+    BoundSignal();
+
+    /**
+     * @brief Resolve name to a slot, adding it if not bound yet
+     * Call once when binding a layer, not per tick
+     * @param name
+     * @return pointer to slot, valid for the lifetime of this object
+     */
+    Slot* Bind(const std::string &name);
+
+    /**
+     * @brief whether a feature was set under a name
+     * Involves lookup by name
+     */
+    bool Exists(const std::string &name) const;
+
+    /**
+     * @brief get no. of bound slots
+     */
+    int NbSlots() const;
+
+    /**
+     * @brief Unset all features, slots remain bound
+     */
+    void Clear();
+
+    /**
+     * @brief Set features of bound slots from most recent features of a signal
+     * No deep copy, slots without a feature in the signal remain unchanged
+     * @param signal
+     */
+    void Import(const elm::Signal &signal);
+
+    /**
+     * @brief Append all set features to a signal
+     * No deep copy
+     * @param signal
+     */
+    void Export(elm::Signal &signal) const;
+
+protected:
+    std::deque<Slot> slots_;                ///< slots, deque keeps addresses stable when adding
+    std::map<std::string, Slot*> index_;    ///< slot per name, only used when binding
+};
+
+#endif // SEM_LAYERS_BOUNDSIGNAL_H_
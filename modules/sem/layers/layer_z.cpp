@@ -1,11 +1,14 @@
 #include "sem/layers/layer_z.h"
 
+#include <algorithm>
+
 #include "elm/core/exception.h"
 #include "elm/core/layerionames.h"
 #include "elm/core/inputname.h"
 #include "elm/core/signal.h"
 
 using std::shared_ptr;
+using cv::Mat1b;
 using cv::Mat1f;
 using namespace elm;
 
@@ -14,7 +17,10 @@ const std::string LayerZ::KEY_INPUT_SPIKES          = "spikes_in";
 const std::string LayerZ::KEY_OUTPUT_SPIKES         = "spikes_out";
 const std::string LayerZ::KEY_OUTPUT_MEMBRANE_POT   = "u";
 const std::string LayerZ::KEY_OUTPUT_WEIGHTS        = "w";
+const std::string LayerZ::KEY_OUTPUT_WEIGHTS_DELTA  = "w_delta";
 const std::string LayerZ::KEY_OUTPUT_BIAS           = "w0";         ///< not the same as weights[0]
+const std::string LayerZ::KEY_OUTPUT_STATS          = "stats";
+const std::string LayerZ::KEY_OUTPUT_STATE_DISTR    = "p";
 
 // Parameter keys
 const std::string LayerZ::PARAM_NB_AFFERENTS        = "nb_afferents";
@@ -22,11 +28,150 @@ const std::string LayerZ::PARAM_NB_OUTPUT_NODES     = "nb_outputs";
 const std::string LayerZ::PARAM_LEN_HISTORY         = "len_history";
 const std::string LayerZ::PARAM_DELTA_T             = "delta_t";
 const std::string LayerZ::PARAM_WTA_FREQ            = "wta_f";
+const std::string LayerZ::PARAM_STATS               = "stats";
+const std::string LayerZ::PARAM_CHANGE_SMOOTHING    = "change_smoothing";
+const std::string LayerZ::PARAM_ADAPTIVE_RATE       = "adaptive_rate";
+const std::string LayerZ::PARAM_EVENT_DRIVEN        = "event_driven";
+const std::string LayerZ::PARAM_PRUNE               = "prune";
+const std::string LayerZ::PARAM_SEED_GROWTH         = "seed_growth";
+const std::string LayerZ::PARAM_SPARSE              = "sparse";
+const std::string LayerZ::PARAM_SPARSE_THRESHOLD    = "sparse_threshold";
+const std::string LayerZ::PARAM_SPARSE_REBUILD      = "sparse_rebuild";
+const std::string LayerZ::PARAM_SPECIALIZED         = "specialized";
+const std::string LayerZ::PARAM_PUBLISH_EVERY       = "publish_every";
+const std::string LayerZ::PARAM_NB_COLUMNS          = "nb_columns";
 
 // defaults
 const int LayerZ::DEFAULT_LEN_HISTORY = 5;
 const float LayerZ::DEFAULT_DELTA_T = 1000.f;
 const float LayerZ::DEFAULT_WTA_FREQ = 1.f;
+const bool LayerZ::DEFAULT_STATS = false;
+const float LayerZ::DEFAULT_CHANGE_SMOOTHING = ZNeuron::DEFAULT_CHANGE_SMOOTHING;
+const bool LayerZ::DEFAULT_ADAPTIVE_RATE = false;
+const bool LayerZ::DEFAULT_EVENT_DRIVEN = false;
+const bool LayerZ::DEFAULT_PRUNE = false;
+const bool LayerZ::DEFAULT_SEED_GROWTH = false;
+const bool LayerZ::DEFAULT_SPARSE = false;
+const float LayerZ::DEFAULT_SPARSE_THRESHOLD = SparseWeights::DEFAULT_THRESHOLD;
+const int LayerZ::DEFAULT_SPARSE_REBUILD = 1000;
+const bool LayerZ::DEFAULT_SPECIALIZED = true;
+const int LayerZ::DEFAULT_PUBLISH_EVERY = 0;
+const int LayerZ::DEFAULT_NB_COLUMNS = 1;
+
+const int LayerZ::MAX_SEEDS = 16;
+
+namespace {
+
+int CheckNbOutputs(int nb_outputs)
+{
+    if(nb_outputs < 1) {
+        ELM_THROW_VALUE_ERROR("No. of output nodes must be > 0");
+    }
+    return nb_outputs;
+}
+
+int CheckLenHistory(int len_history)
+{
+    if(len_history < 1) {
+        ELM_THROW_VALUE_ERROR("History length must be > 0");
+    }
+    return len_history;
+}
+
+float CheckChangeSmoothing(float change_smoothing)
+{
+    if(change_smoothing <= 0.f || change_smoothing > 1.f) {
+
+        ELM_THROW_VALUE_ERROR("Smoothing factor of weight change rates must be in (0, 1]");
+    }
+    return change_smoothing;
+}
+
+float CheckWTAFreq(float freq)
+{
+    if(freq < 0.f) {
+
+        ELM_THROW_VALUE_ERROR("Frequency must be >= 0");
+    }
+    // TODO: log warning when freq == 0
+    return freq;
+}
+
+int CheckSparseRebuild(int sparse_rebuild)
+{
+    if(sparse_rebuild < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of potential computations between rebuilding sparse weights must be > 0");
+    }
+    return sparse_rebuild;
+}
+
+int CheckPublishEvery(int publish_every)
+{
+    if(publish_every < 0) {
+
+        ELM_THROW_VALUE_ERROR("No. of learning steps between publishing weights must be >= 0");
+    }
+    return publish_every;
+}
+
+int CheckNbColumns(int nb_columns, int nb_outputs)
+{
+    if(nb_columns < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of columns must be > 0");
+    }
+    if(nb_outputs % nb_columns != 0) {
+
+        ELM_THROW_VALUE_ERROR("No. of output nodes must be a multiple of the no. of columns");
+    }
+    return nb_columns;
+}
+
+float CheckDeltaT(float delta_t)
+{
+    if(delta_t <= 0.f) {
+
+        ELM_THROW_VALUE_ERROR("time resolution delta t must be > 0");
+    }
+    return delta_t;
+}
+
+/**
+ * @brief Apply STDP to the neurons of a range of columns
+ * Columns share no state, neurons learn in place
+ */
+class ParallelLearn : public cv::ParallelLoopBody
+{
+public:
+    /**
+     * @brief body of parallel loop
+     * @param neurons of all columns, consecutive per column
+     * @param output spikes of all neurons
+     * @param no. of neurons per column
+     */
+    ParallelLearn(std::vector<shared_ptr<base_Learner> > &z, const Mat1f &spikes, int column_size)
+        : z_(z),
+          spikes_(spikes),
+          column_size_(column_size)
+    {
+    }
+
+    virtual void operator()(const cv::Range &range) const
+    {
+        for(int i=range.start*column_size_; i<range.end*column_size_; i++) {
+
+            z_[i]->Learn(spikes_.col(i));
+        }
+    }
+
+protected:
+    std::vector<shared_ptr<base_Learner> > &z_;  ///< neurons of all columns
+    Mat1f spikes_;                              ///< output spikes
+    int column_size_;                           ///< no. of neurons per column
+};
+
+} // annonymous namespace
 
 LayerZ::~LayerZ()
 {
@@ -34,7 +179,40 @@ LayerZ::~LayerZ()
 
 LayerZ::LayerZ()
     : base_LearningLayer(),
-      wta_(DEFAULT_WTA_FREQ, DEFAULT_DELTA_T) // will get overriden anyway
+      bound_(0),
+      slot_input_spikes_(0),
+      slot_output_spikes_(0),
+      slot_output_mem_pot_(0),
+      slot_output_weights_(0),
+      slot_output_bias_(0),
+      slot_output_stats_(0),
+      slot_output_state_distr_(0),
+      slot_output_weights_delta_(0),
+      weights_version_(0),
+      delta_version_(0),
+      bias_version_(0),
+      bias_out_version_(0),
+      wta_(1, WTAPoisson(DEFAULT_WTA_FREQ, DEFAULT_DELTA_T)), // will get overriden anyway
+      nb_columns_(DEFAULT_NB_COLUMNS),
+      len_history_(DEFAULT_LEN_HISTORY),
+      is_event_driven_(DEFAULT_EVENT_DRIVEN),
+      is_skipped_(false),
+      is_learn_pending_(false),
+      ticks_to_event_(-1),
+      nb_skipped_(0),
+      wta_f_(DEFAULT_WTA_FREQ),
+      delta_t_(DEFAULT_DELTA_T),
+      change_smoothing_(DEFAULT_CHANGE_SMOOTHING),
+      is_adaptive_rate_(DEFAULT_ADAPTIVE_RATE),
+      is_seed_growth_(DEFAULT_SEED_GROWTH),
+      is_sparse_(DEFAULT_SPARSE),
+      sparse_threshold_(DEFAULT_SPARSE_THRESHOLD),
+      sparse_rebuild_(DEFAULT_SPARSE_REBUILD),
+      nb_since_rebuild_(0),
+      publish_every_(DEFAULT_PUBLISH_EVERY),
+      nb_since_publish_(0),
+      is_specialized_(DEFAULT_SPECIALIZED),
+      kernel_(LayerZKernelFactory::CreateShared(0, DEFAULT_LEN_HISTORY, false))
 {
 }
 
@@ -44,6 +222,7 @@ void LayerZ::Clear()
 
         (*itr)->Clear();
     }
+    kernel_->ClearSkipped(); // history reset, bias updates remain pending
     //todo: either define clear() for wta or re-initialize object..
 }
 
@@ -60,44 +239,210 @@ void LayerZ::Reset(const LayerConfig &config)
     nb_afferents_ = tmp;
 
     // output nodes
-    tmp = params.get<int>(PARAM_NB_OUTPUT_NODES);
-    if(tmp < 1) {
-        ELM_THROW_VALUE_ERROR("No. of output nodes must be > 0");
-    }
-    int nb_outputs = tmp;
+    int nb_outputs = CheckNbOutputs(params.get<int>(PARAM_NB_OUTPUT_NODES));
+    nb_columns_ = CheckNbColumns(params.get<int>(PARAM_NB_COLUMNS, DEFAULT_NB_COLUMNS), nb_outputs);
 
-    tmp = params.get<int>(PARAM_LEN_HISTORY, DEFAULT_LEN_HISTORY);
-    if(tmp < 1) {
-        ELM_THROW_VALUE_ERROR("History length must be > 0");
-    }
-    int len_history = tmp;
+    len_history_ = CheckLenHistory(params.get<int>(PARAM_LEN_HISTORY, DEFAULT_LEN_HISTORY));
 
-    InitLearners(nb_afferents_, nb_outputs, len_history);
+    InitLearners(nb_afferents_, nb_outputs, len_history_);
+    AttachWeights();
 
-    // wta
-    float freq = params.get<float>(PARAM_WTA_FREQ, DEFAULT_WTA_FREQ);
-    if(freq < 0.f) {
+    change_smoothing_ = CheckChangeSmoothing(params.get<float>(PARAM_CHANGE_SMOOTHING, DEFAULT_CHANGE_SMOOTHING));
+    is_adaptive_rate_ = params.get<bool>(PARAM_ADAPTIVE_RATE, DEFAULT_ADAPTIVE_RATE);
 
-        ELM_THROW_VALUE_ERROR("Frequency must be >= 0");
+    for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+
+        shared_ptr<ZNeuron> z = std::static_pointer_cast<ZNeuron>(*itr);
+        z->ChangeSmoothing(change_smoothing_);
+        z->AdaptiveLearningRate(is_adaptive_rate_);
     }
-    // TODO: log warning when freq == 0
 
-    float delta_t = params.get<float>(PARAM_DELTA_T, DEFAULT_DELTA_T);
-    if(delta_t <= 0.f) {
+    // wta
+    wta_f_ = CheckWTAFreq(params.get<float>(PARAM_WTA_FREQ, DEFAULT_WTA_FREQ));
+    delta_t_ = CheckDeltaT(params.get<float>(PARAM_DELTA_T, DEFAULT_DELTA_T));
+    InitWTA();
 
-        ELM_THROW_VALUE_ERROR("time resolution delta t must be > 0");
+    stats_.Enable(params.get<bool>(PARAM_STATS, DEFAULT_STATS));
+    stats_.Reset(nb_outputs);
+
+    is_event_driven_ = params.get<bool>(PARAM_EVENT_DRIVEN, DEFAULT_EVENT_DRIVEN);
+    is_skipped_ = false;
+    is_learn_pending_ = false;
+    ticks_to_event_ = -1;
+    nb_skipped_ = 0;
+    u_ = Mat1f::zeros(1, nb_outputs);
+    spikes_out_ = Mat1f::zeros(1, nb_outputs);
+
+    nb_wins_.assign(nb_outputs, 0);
+    is_seed_growth_ = params.get<bool>(PARAM_SEED_GROWTH, DEFAULT_SEED_GROWTH);
+    seed_scores_.clear();
+    seeds_.clear();
+
+    is_sparse_ = params.get<bool>(PARAM_SPARSE, DEFAULT_SPARSE);
+    sparse_threshold_ = params.get<float>(PARAM_SPARSE_THRESHOLD, DEFAULT_SPARSE_THRESHOLD);
+    sparse_rebuild_ = CheckSparseRebuild(params.get<int>(PARAM_SPARSE_REBUILD, DEFAULT_SPARSE_REBUILD));
+    sparse_ = SparseWeights();
+    nb_since_rebuild_ = 0;
+
+    is_specialized_ = params.get<bool>(PARAM_SPECIALIZED, DEFAULT_SPECIALIZED);
+    kernel_ = LayerZKernelFactory::CreateShared(nb_afferents_, len_history_, is_specialized_);
+
+    // readers keep snapshots of the previous configuration they hold
+    publish_every_ = CheckPublishEvery(params.get<int>(PARAM_PUBLISH_EVERY, DEFAULT_PUBLISH_EVERY));
+    publisher_.Clear();
+    if(publish_every_ > 0) {
+
+        Publish();
     }
-    wta_ = WTAPoisson(freq, delta_t);
 }
 
 void LayerZ::Reconfigure(const LayerConfig &config)
 {
-    ELM_THROW_NOT_IMPLEMENTED;
+    PTree params = config.Params();
+
+    // validate everything before changing anything
+    if(params.get<int>(PARAM_NB_AFFERENTS, nb_afferents_) != nb_afferents_) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change no. of afferents without a Reset");
+    }
+
+    const int nb_outputs = CheckNbOutputs(params.get<int>(PARAM_NB_OUTPUT_NODES, static_cast<int>(z_.size())));
+    const int len_history = CheckLenHistory(params.get<int>(PARAM_LEN_HISTORY, len_history_));
+    const float change_smoothing = CheckChangeSmoothing(params.get<float>(PARAM_CHANGE_SMOOTHING, change_smoothing_));
+    const float wta_f = CheckWTAFreq(params.get<float>(PARAM_WTA_FREQ, wta_f_));
+    const float delta_t = CheckDeltaT(params.get<float>(PARAM_DELTA_T, delta_t_));
+    const int sparse_rebuild = CheckSparseRebuild(params.get<int>(PARAM_SPARSE_REBUILD, sparse_rebuild_));
+    const int publish_every = CheckPublishEvery(params.get<int>(PARAM_PUBLISH_EVERY, publish_every_));
+
+    if(params.get<int>(PARAM_NB_COLUMNS, nb_columns_) != nb_columns_) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change no. of columns without a Reset");
+    }
+
+    if(nb_columns_ > 1 &&
+            (nb_outputs != static_cast<int>(z_.size()) || params.get<bool>(PARAM_PRUNE, DEFAULT_PRUNE))) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change no. of output nodes of a layer with multiple columns");
+    }
+
+    // catch up on skipped ticks under the old configuration
+    Flush();
+    is_skipped_ = false;
+    is_learn_pending_ = false;
+
+    // neurons
+    const int nb_outputs_prev = static_cast<int>(z_.size());
+
+    if(params.get<bool>(PARAM_PRUNE, DEFAULT_PRUNE)) {
+
+        std::vector<bool> is_kept(z_.size());
+        bool is_any_kept = false;
+        for(size_t i=0; i<z_.size(); i++) {
+
+            is_kept[i] = nb_wins_[i] > 0;
+            is_any_kept |= is_kept[i];
+        }
+
+        if(is_any_kept) {
+
+            RemoveLearners(is_kept);
+        }
+    }
+
+    if(static_cast<int>(z_.size()) > nb_outputs) {
+
+        // keep neurons with most wins
+        std::vector<int> order(z_.size());
+        for(size_t i=0; i<order.size(); i++) {
+
+            order[i] = static_cast<int>(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return nb_wins_[a] > nb_wins_[b]; });
+
+        std::vector<bool> is_kept(z_.size(), false);
+        for(int i=0; i<nb_outputs; i++) {
+
+            is_kept[order[i]] = true;
+        }
+        RemoveLearners(is_kept);
+    }
+
+    if(len_history != len_history_) {
+
+        len_history_ = len_history;
+        for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+
+            std::static_pointer_cast<ZNeuron>(*itr)->LenHistory(len_history_);
+        }
+    }
+
+    change_smoothing_ = change_smoothing;
+    is_adaptive_rate_ = params.get<bool>(PARAM_ADAPTIVE_RATE, is_adaptive_rate_);
+
+    // output indices change with any removal or addition, even if prune and growth cancel out
+    const bool is_reindexed = static_cast<int>(z_.size()) != nb_outputs_prev || nb_outputs != nb_outputs_prev;
+
+    AddLearners(nb_outputs-static_cast<int>(z_.size()));
+    AttachWeights();
+
+    for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+
+        shared_ptr<ZNeuron> z = std::static_pointer_cast<ZNeuron>(*itr);
+        z->ChangeSmoothing(change_smoothing_);
+        z->AdaptiveLearningRate(is_adaptive_rate_);
+    }
+
+    // wta, keep pending spike time unless timing changes
+    if(wta_f != wta_f_ || delta_t != delta_t_) {
+
+        wta_f_ = wta_f;
+        delta_t_ = delta_t;
+        InitWTA();
+    }
+    ticks_to_event_ = -1;
+
+    is_event_driven_ = params.get<bool>(PARAM_EVENT_DRIVEN, is_event_driven_);
+    stats_.Enable(params.get<bool>(PARAM_STATS, stats_.IsEnabled()));
+
+    if(is_reindexed) {
+
+        stats_.Reset(nb_outputs);
+        u_ = Mat1f::zeros(1, nb_outputs);
+        spikes_out_ = Mat1f::zeros(1, nb_outputs);
+    }
+
+    nb_wins_.assign(nb_outputs, 0);
+    is_seed_growth_ = params.get<bool>(PARAM_SEED_GROWTH, is_seed_growth_);
+    seed_scores_.clear();
+    seeds_.clear();
+
+    // rebuild sparse weights on next use
+    is_sparse_ = params.get<bool>(PARAM_SPARSE, is_sparse_);
+    sparse_threshold_ = params.get<float>(PARAM_SPARSE_THRESHOLD, sparse_threshold_);
+    sparse_rebuild_ = sparse_rebuild;
+    sparse_ = SparseWeights();
+    nb_since_rebuild_ = 0;
+
+    // nothing pending after Flush(), safe to swap kernels
+    is_specialized_ = params.get<bool>(PARAM_SPECIALIZED, is_specialized_);
+    kernel_ = LayerZKernelFactory::CreateShared(nb_afferents_, len_history_, is_specialized_);
+
+    // neurons may have changed, readers switch over on next Snapshot()
+    publish_every_ = publish_every;
+    if(publish_every_ > 0) {
+
+        Publish();
+    }
 }
 
 void LayerZ::InputNames(const LayerInputNames &in_names)
 {
     name_input_spikes_   = in_names.Input(KEY_INPUT_SPIKES);
+
+    if(bound_) {
+
+        BindSlots();
+    }
 }
 
 void LayerZ::OutputNames(const LayerOutputNames &out_names)
@@ -106,11 +451,31 @@ void LayerZ::OutputNames(const LayerOutputNames &out_names)
     name_output_mem_pot_    = out_names.OutputOpt(KEY_OUTPUT_MEMBRANE_POT);
     name_output_weights_    = out_names.OutputOpt(KEY_OUTPUT_WEIGHTS);
     name_output_bias_       = out_names.OutputOpt(KEY_OUTPUT_BIAS);
+    name_output_stats_      = out_names.OutputOpt(KEY_OUTPUT_STATS);
+    name_output_state_distr_= out_names.OutputOpt(KEY_OUTPUT_STATE_DISTR);
+    name_output_weights_delta_ = out_names.OutputOpt(KEY_OUTPUT_WEIGHTS_DELTA);
+
+    if(bound_) {
+
+        BindSlots();
+    }
 }
 
 void LayerZ::Activate(const Signal &signal)
 {
-    cv::Mat1f spikes_in = signal.MostRecentMat1f(name_input_spikes_);
+    ActivateSpikes(signal.MostRecentMat1f(name_input_spikes_));
+}
+
+void LayerZ::Activate(const BoundSignal &signal)
+{
+    CheckBound(signal);
+    ActivateSpikes(slot_input_spikes_->Get());
+}
+
+void LayerZ::ActivateSpikes(const Mat1f &spikes_in)
+{
+    LayerZStats::Clock::time_point t_activate = stats_.Tic();
+
     if(spikes_in.total() != static_cast<size_t>(nb_afferents_)) {
 
         std::stringstream s;
@@ -118,26 +483,223 @@ void LayerZ::Activate(const Signal &signal)
         ELM_THROW_BAD_DIMS(s.str());
     }
 
+    if(is_event_driven_) {
+
+        if(TicksToNextEvent() > 0) {
+
+            SkipTicks(spikes_in, 1);
+            is_learn_pending_ = true; // bias update of this tick only if followed by Learn()
+            stats_.Toc(LayerZStats::PHASE_ACTIVATE, t_activate);
+            return;
+        }
+    }
+    Flush();
+    is_skipped_ = false;
+    is_learn_pending_ = false;
+
+    const int nb_outputs = static_cast<int>(z_.size());
+    Mat1f spikes_row = spikes_in.reshape(1, 1);
+
     // compute membrane potential for each neuron
-    u_ = Mat1f(1, static_cast<int>(z_.size()));
+    LayerZStats::Clock::time_point t = stats_.Tic();
+    u_.release(); // let the arena reuse the buffer unless referenced elsewhere
+    u_ = arena_.Output(SLOT_MEMBRANE_POT, 1, nb_outputs, CV_32FC1);
+    if(is_sparse_) {
+
+        if(sparse_.empty() || nb_since_rebuild_ >= sparse_rebuild_) {
+
+            sparse_ = Sparsify(sparse_threshold_);
+            nb_since_rebuild_ = 0;
+        }
+        else {
+
+            sparse_.Bias(Bias()); // bias changes on every tick
+        }
+        nb_since_rebuild_++;
+
+        sparse_.Potentials(spikes_in, u_);
+    }
+    else {
+
+        kernel_->Potentials(spikes_row, z_, u_);
+    }
+
+    // spike mask shared by all neurons' spiking histories
+    cv::Mat is_spiking = arena_.Scratch(1, nb_afferents_, CV_8UC1);
+    cv::compare(spikes_row, 0.f, is_spiking, cv::CMP_NE);
+
     int i=0;
     for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
 
-        u_(i++) = (*itr)->Predict(spikes_in.reshape(1, 1)).at<float>(0);
+        std::static_pointer_cast<ZNeuron>(*itr)->ObserveSpiking(is_spiking, u_(i++));
+    }
+    stats_.Toc(LayerZStats::PHASE_PREDICT, t);
+
+    if(is_seed_growth_) {
+
+        TrackSeed(spikes_in);
     }
 
     // let them compete
-    spikes_out_ = wta_.Compete(z_);
+    t = stats_.Tic();
+    Mat1f distr = arena_.Scratch(1, nb_outputs, CV_32FC1);
+    spikes_out_.release();
+    spikes_out_ = arena_.Output(SLOT_SPIKES, 1, nb_outputs, CV_32FC1);
+    const int column_size = nb_outputs/nb_columns_;
+    for(int c=0; c<nb_columns_; c++) {
+
+        // in place, column headers match
+        Mat1f distr_column = distr.colRange(c*column_size, (c+1)*column_size);
+        Mat1f spikes_column = spikes_out_.colRange(c*column_size, (c+1)*column_size);
+        wta_[c].Compete(u_.colRange(c*column_size, (c+1)*column_size), distr_column, spikes_column);
+    }
+    ticks_to_event_ = -1; // WTA may have drawn its next spike time
+    stats_.Toc(LayerZStats::PHASE_COMPETE, t);
+
+    for(int j=0; j<spikes_out_.cols; j++) {
+
+        if(spikes_out_(j) != 0.f) {
+
+            nb_wins_[j]++;
+        }
+    }
     //std::cout<<spikes_out_<<std::endl;
+
+    const int nb_growths = arena_.EndTick();
+    if(stats_.IsEnabled()) {
+
+        stats_.Tick(countNonZero(spikes_in), nb_growths);
+
+        for(int j=0; j<spikes_out_.cols; j++) {
+
+            if(spikes_out_(j) != 0.f) {
+
+                stats_.Spike(j);
+            }
+        }
+    }
+
+    stats_.Toc(LayerZStats::PHASE_ACTIVATE, t_activate);
 }
 
 void LayerZ::Learn()
 {
+    if(is_skipped_) {
+
+        if(is_learn_pending_) {
+
+            nb_skipped_++;
+            is_learn_pending_ = false;
+        }
+        return; // bias updates deferred until next WTA spike
+    }
+
+    LayerZStats::Clock::time_point t_learn = stats_.Tic();
+
+    MarkLearned(spikes_out_);
+
+    if(nb_columns_ > 1) {
+
+        // timed as a whole, per-neuron updates are not timed individually across threads
+        cv::parallel_for_(cv::Range(0, nb_columns_), ParallelLearn(z_, spikes_out_, static_cast<int>(z_.size())/nb_columns_));
+
+        PublishOnCadence();
+        stats_.Toc(LayerZStats::PHASE_LEARN, t_learn);
+        return;
+    }
+
     int i=0;
-    for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+    for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr, i++) {
+
+        if(stats_.IsEnabled() && spikes_out_(i) != 0.f) {
+
+            // spiking neuron undergoes STDP update of all its weights
+            LayerZStats::Clock::time_point t = stats_.Tic();
+            (*itr)->Learn(spikes_out_.col(i));
+            stats_.Toc(LayerZStats::PHASE_UPDATE, t);
+        }
+        else {
+
+            (*itr)->Learn(spikes_out_.col(i));
+        }
+    }
+
+    PublishOnCadence();
+
+    stats_.Toc(LayerZStats::PHASE_LEARN, t_learn);
+}
+
+LayerZStream LayerZ::CreateStream() const
+{
+    return LayerZStream(nb_afferents_, static_cast<int>(z_.size()), len_history_, wta_f_, delta_t_, nb_columns_);
+}
+
+void LayerZ::Learn(const LayerZStream &stream)
+{
+    const Mat1f &spikes = stream.Spikes();
+    if(stream.NbAfferents() != nb_afferents_ || spikes.cols != static_cast<int>(z_.size())) {
+
+        ELM_THROW_BAD_DIMS("Stream does not match the layer's no. of afferents and outputs");
+    }
+
+    // recent spiking in this stream, bias first standing for the neuron's own spike
+    Mat1b has_spiked_recently(1, nb_afferents_+1);
+    has_spiked_recently(0) = 1;
+    Mat1b(stream.RecentAfferents().reshape(1, 1)).copyTo(has_spiked_recently.colRange(1, nb_afferents_+1));
+
+    MarkLearned(spikes);
+
+    for(size_t i=0; i<z_.size(); i++) {
 
-        (*itr)->Learn(spikes_out_.col(i++));
+        std::static_pointer_cast<ZNeuron>(z_[i])->Learn(spikes.col(static_cast<int>(i)), has_spiked_recently);
     }
+
+    PublishOnCadence();
+}
+
+void LayerZ::Learn(const std::vector<LayerZStream> &streams)
+{
+    const int nb_outputs = static_cast<int>(z_.size());
+    for(size_t s=0; s<streams.size(); s++) {
+
+        if(streams[s].NbAfferents() != nb_afferents_ || streams[s].Spikes().cols != nb_outputs) {
+
+            ELM_THROW_BAD_DIMS("Stream does not match the layer's no. of afferents and outputs");
+        }
+    }
+
+    // per neuron: no. of streams won, then per afferent no. of those streams with recent spiking
+    Mat1f nb_spiked_recently = Mat1f::zeros(nb_outputs, nb_afferents_+1);
+    Mat1f spikes = Mat1f::zeros(1, nb_outputs);
+    for(size_t s=0; s<streams.size(); s++) {
+
+        const Mat1f &spikes_stream = streams[s].Spikes();
+        if(countNonZero(spikes_stream) == 0) {
+
+            continue;
+        }
+
+        const cv::Mat recent = streams[s].RecentAfferents().reshape(1, 1);
+        for(int i=0; i<nb_outputs; i++) {
+
+            if(spikes_stream(i) != 0.f) {
+
+                nb_spiked_recently(i, 0) += 1.f;
+                Mat1f counts = nb_spiked_recently.row(i).colRange(1, nb_afferents_+1);
+                cv::add(counts, 1.f, counts, recent);
+                spikes(i) = spikes_stream(i);
+            }
+        }
+    }
+
+    MarkLearned(spikes);
+
+    for(int i=0; i<nb_outputs; i++) {
+
+        std::static_pointer_cast<ZNeuron>(z_[i])->LearnPooled(nb_spiked_recently.row(i));
+    }
+
+    PublishOnCadence();
 }
 
 void LayerZ::Learn(const cv::Mat1f &features, const cv::Mat1f &labels)
@@ -155,6 +717,8 @@ void LayerZ::Learn(const cv::Mat1f &features, const cv::Mat1f &labels)
 
 void LayerZ::Response(Signal &signal)
 {
+    LayerZStats::Clock::time_point t = stats_.Tic();
+
     signal.Append(name_output_spikes_, spikes_out_);
 
     // optional outputs
@@ -163,28 +727,422 @@ void LayerZ::Response(Signal &signal)
         signal.Append(name_output_mem_pot_.get(), u_);
     }
 
+    if(name_output_weights_ || name_output_bias_) {
+
+        Flush();
+    }
+
     if(name_output_weights_) {
 
-        Mat1f weights(z_.size(), nb_afferents_);
-        int r=0;
-        for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+        signal.Append(name_output_weights_.get(), WeightsView()); // no copy
+    }
+
+    if(name_output_bias_) {
+
+        signal.Append(name_output_bias_.get(), ExportBias());
+    }
+
+    if(name_output_weights_delta_ && weights_version_ > delta_version_) {
+
+        signal.Append(name_output_weights_delta_.get(), WeightsDelta(delta_version_));
+        delta_version_ = weights_version_;
+    }
+
+    if(name_output_state_distr_) {
+
+        signal.Append(name_output_state_distr_.get(), StateDistr());
+    }
+
+    stats_.Toc(LayerZStats::PHASE_RESPONSE, t);
 
-            Mat1f w = std::static_pointer_cast<ZNeuron>(*itr)->Weights();
-            w.copyTo(weights.row(r++));
+    if(name_output_stats_) {
+
+        signal.Append(name_output_stats_.get(), stats_.ToMat());
+    }
+}
+
+void LayerZ::Response(BoundSignal &signal)
+{
+    CheckBound(signal);
+
+    LayerZStats::Clock::time_point t = stats_.Tic();
+
+    slot_output_spikes_->Write(spikes_out_);
+
+    // optional outputs
+    if(slot_output_mem_pot_) {
+
+        slot_output_mem_pot_->Write(u_);
+    }
+
+    if(slot_output_weights_ || slot_output_bias_) {
+
+        Flush();
+    }
+
+    if(slot_output_weights_) {
+
+        slot_output_weights_->Set(WeightsView()); // no copy
+    }
+
+    if(slot_output_bias_) {
+
+        slot_output_bias_->Write(ExportBias());
+    }
+
+    if(slot_output_weights_delta_ && weights_version_ > delta_version_) {
+
+        slot_output_weights_delta_->Write(WeightsDelta(delta_version_));
+        delta_version_ = weights_version_;
+    }
+
+    if(slot_output_state_distr_) {
+
+        slot_output_state_distr_->Write(StateDistr());
+    }
+
+    stats_.Toc(LayerZStats::PHASE_RESPONSE, t);
+
+    if(slot_output_stats_) {
+
+        slot_output_stats_->Write(stats_.ToMat());
+    }
+}
+
+void LayerZ::Bind(BoundSignal &signal)
+{
+    bound_ = &signal;
+    BindSlots();
+}
+
+bool LayerZ::IsBound() const
+{
+    return bound_ != 0 && slot_input_spikes_ != 0 && slot_output_spikes_ != 0;
+}
+
+void LayerZ::BindSlots()
+{
+    // names not known yet remain unbound until IONames()
+    slot_input_spikes_ = name_input_spikes_.empty()? 0 : bound_->Bind(name_input_spikes_);
+    slot_output_spikes_ = name_output_spikes_.empty()? 0 : bound_->Bind(name_output_spikes_);
+    slot_output_mem_pot_ = name_output_mem_pot_? bound_->Bind(name_output_mem_pot_.get()) : 0;
+    slot_output_weights_ = name_output_weights_? bound_->Bind(name_output_weights_.get()) : 0;
+    slot_output_bias_ = name_output_bias_? bound_->Bind(name_output_bias_.get()) : 0;
+    slot_output_stats_ = name_output_stats_? bound_->Bind(name_output_stats_.get()) : 0;
+    slot_output_state_distr_ = name_output_state_distr_? bound_->Bind(name_output_state_distr_.get()) : 0;
+    slot_output_weights_delta_ = name_output_weights_delta_? bound_->Bind(name_output_weights_delta_.get()) : 0;
+}
+
+void LayerZ::CheckBound(const BoundSignal &signal) const
+{
+    if(bound_ != &signal || !IsBound()) {
+
+        ELM_THROW_VALUE_ERROR("Layer not bound to this signal, see Bind() and IONames()");
+    }
+}
+
+int LayerZ::TicksToNextEvent()
+{
+    if(ticks_to_event_ < 0) {
+
+        // next spike of any column
+        ticks_to_event_ = wta_[0].TicksToNextSpike();
+        for(int c=1; c<nb_columns_; c++) {
+
+            ticks_to_event_ = std::min(ticks_to_event_, wta_[c].TicksToNextSpike());
         }
-        signal.Append(name_output_weights_.get(), weights);
     }
+    return ticks_to_event_;
+}
 
-    if(name_output_bias_) {
+void LayerZ::Skip(const Signal &signal, int nb_ticks)
+{
+    if(nb_ticks < 1) {
 
-        Mat1f bias(1, z_.size());
-        int i=0;
-        for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+        return;
+    }
+
+    SkipSpikes(signal.MostRecentMat1f(name_input_spikes_), nb_ticks);
+}
+
+void LayerZ::Skip(const BoundSignal &signal, int nb_ticks)
+{
+    CheckBound(signal);
+    if(nb_ticks < 1) {
+
+        return;
+    }
+
+    SkipSpikes(slot_input_spikes_->Get(), nb_ticks);
+}
+
+void LayerZ::SkipSpikes(const Mat1f &spikes_in, int nb_ticks)
+{
+    if(nb_ticks > TicksToNextEvent()) {
+
+        std::stringstream s;
+        s << "Cannot skip " << nb_ticks << " ticks, next WTA spike in " << TicksToNextEvent();
+        ELM_THROW_VALUE_ERROR(s.str());
+    }
+
+    if(spikes_in.total() != static_cast<size_t>(nb_afferents_)) {
+
+        std::stringstream s;
+        s << "Expecting " << nb_afferents_ << " input spikes";
+        ELM_THROW_BAD_DIMS(s.str());
+    }
+
+    SkipTicks(spikes_in, nb_ticks);
+    nb_skipped_ += nb_ticks; // learning included
+    is_learn_pending_ = false;
+}
+
+void LayerZ::SkipTicks(const Mat1f &spikes_in, int nb_ticks)
+{
+    for(int c=0; c<nb_columns_; c++) {
+
+        wta_[c].Skip(nb_ticks);
+    }
+    ticks_to_event_ -= nb_ticks;
+
+    // only the most recent ticks still matter for the spiking history
+    // the current tick of the next spike takes up one more slot
+    kernel_->PushSkipped(spikes_in.reshape(1, 1), nb_ticks);
+
+    if(!is_skipped_) {
+
+        // consecutive skipped ticks share the same all-zero row, don't touch previously appended spikes
+        spikes_out_.release();
+        spikes_out_ = arena_.Output(SLOT_SPIKES, 1, static_cast<int>(z_.size()), CV_32FC1);
+        spikes_out_.setTo(0.f);
+    }
+    is_skipped_ = true;
+
+    const int nb_growths = arena_.EndTick();
+    if(stats_.IsEnabled()) {
+
+        const int nb_active = countNonZero(spikes_in);
+        for(int t=0; t<nb_ticks; t++) {
+
+            stats_.Tick(nb_active, (t == 0)? nb_growths : 0);
+        }
+    }
+}
+
+void LayerZ::Flush()
+{
+    if(nb_skipped_ == 0 && kernel_->NbSkipped() == 0) {
+
+        return;
+    }
+
+    for(VecLPtr::iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+
+        shared_ptr<ZNeuron> z = std::static_pointer_cast<ZNeuron>(*itr);
+        z->LearnSilent(nb_skipped_);
+
+        for(int t=0; t<kernel_->NbSkipped(); t++) {
+
+            z->Observe(kernel_->Skipped(t));
+        }
+    }
+    nb_skipped_ = 0;
+    kernel_->ClearSkipped();
+    bias_version_++;
+}
+
+void LayerZ::EnableStats(bool enable)
+{
+    stats_.Enable(enable);
+}
+
+const LayerZStats& LayerZ::Stats() const
+{
+    return stats_;
+}
+
+void LayerZ::ResetStats()
+{
+    stats_.Reset(static_cast<int>(z_.size()));
+}
+
+int LayerZ::NbColumns() const
+{
+    return nb_columns_;
+}
+
+Mat1f LayerZ::StateDistr() const
+{
+    if(nb_columns_ == 1) {
+
+        return wta_[0].LearnerStateDistr(z_);
+    }
+
+    const int column_size = static_cast<int>(z_.size())/nb_columns_;
+    Mat1f distr(1, static_cast<int>(z_.size()));
+    for(int c=0; c<nb_columns_; c++) {
+
+        VecLPtr column(z_.begin()+c*column_size, z_.begin()+(c+1)*column_size);
+        Mat1f dst = distr.colRange(c*column_size, (c+1)*column_size);
+        Mat1f(wta_[c].LearnerStateDistr(column)).reshape(1, 1).copyTo(dst);
+    }
+    return distr;
+}
+
+Mat1f LayerZ::Spikes() const
+{
+    return spikes_out_;
+}
+
+Mat1f LayerZ::Weights() const
+{
+    return WeightsView().clone();
+}
+
+Mat1f LayerZ::WeightsView() const
+{
+    if(weights_all_.empty()) {
+
+        return Mat1f();
+    }
+    return weights_all_.colRange(1, weights_all_.cols);
+}
+
+unsigned long long LayerZ::WeightsVersion() const
+{
+    return weights_version_;
+}
+
+Mat1f LayerZ::WeightsDelta(unsigned long long since) const
+{
+    int nb_changed = 0;
+    for(size_t i=0; i<row_versions_.size(); i++) {
+
+        nb_changed += static_cast<int>(row_versions_[i] > since);
+    }
+
+    Mat1f delta(nb_changed, weights_all_.cols);
+    int r=0;
+    for(size_t i=0; i<row_versions_.size(); i++) {
+
+        if(row_versions_[i] > since) {
 
-            bias(i++) = std::static_pointer_cast<ZNeuron>(*itr)->Bias()(0);
+            weights_all_.row(static_cast<int>(i)).copyTo(delta.row(r));
+            delta(r++, 0) = static_cast<float>(i); // index in place of bias
         }
-        signal.Append(name_output_bias_.get(), bias);
     }
+    return delta;
+}
+
+Mat1f LayerZ::Bias() const
+{
+    Mat1f bias(1, weights_all_.rows);
+    for(int i=0; i<weights_all_.rows; i++) {
+
+        bias(i) = weights_all_(i, 0);
+    }
+    return bias;
+}
+
+const Mat1f& LayerZ::ExportBias()
+{
+    if(bias_out_.cols != weights_all_.rows || bias_out_version_ != bias_version_) {
+
+        // exported bias is never overwritten while referenced elsewhere
+        bias_out_.release();
+        bias_out_ = arena_.Output(SLOT_BIAS, 1, weights_all_.rows, CV_32FC1);
+        for(int i=0; i<weights_all_.rows; i++) {
+
+            bias_out_(i) = weights_all_(i, 0);
+        }
+        bias_out_version_ = bias_version_;
+    }
+    return bias_out_;
+}
+
+Mat1f LayerZ::WeightsAll() const
+{
+    return weights_all_.clone();
+}
+
+void LayerZ::Restore(const Mat1f &weights_all)
+{
+    if(weights_all.rows != weights_all_.rows || weights_all.cols != weights_all_.cols) {
+
+        ELM_THROW_BAD_DIMS("Weights do not match the layer's no. of outputs and afferents");
+    }
+
+    // skipped ticks apply to the weights they were skipped with
+    Flush();
+
+    weights_all.copyTo(weights_all_); // in place, neurons stay attached
+
+    weights_version_++;
+    row_versions_.assign(row_versions_.size(), weights_version_);
+    bias_version_++;
+    sparse_ = SparseWeights(); // rebuild on next use
+
+    if(publish_every_ > 0) {
+
+        Publish();
+    }
+}
+
+void LayerZ::Publish()
+{
+    publisher_.Publish(weights_all_, weights_version_);
+    nb_since_publish_ = 0;
+}
+
+WeightsPublisher::SnapshotPtr LayerZ::Snapshot() const
+{
+    return publisher_.Acquire();
+}
+
+QuantizedWeights LayerZ::Quantize(int depth) const
+{
+    return QuantizedWeights(Weights(), Bias(), depth);
+}
+
+SparseWeights LayerZ::Sparsify(float threshold) const
+{
+    return SparseWeights(Weights(), Bias(), threshold);
+}
+
+TickArena& LayerZ::Arena()
+{
+    return arena_;
+}
+
+bool LayerZ::IsSpecialized() const
+{
+    return kernel_->IsSpecialized();
+}
+
+cv::Mat1i LayerZ::NbWins() const
+{
+    cv::Mat1i nb_wins(1, static_cast<int>(nb_wins_.size()));
+    for(size_t i=0; i<nb_wins_.size(); i++) {
+
+        nb_wins(static_cast<int>(i)) = nb_wins_[i];
+    }
+    return nb_wins;
+}
+
+Mat1f LayerZ::WeightChangeRates() const
+{
+    Mat1f rates(1, static_cast<int>(z_.size()));
+    int i=0;
+    for(VecLPtr::const_iterator itr=z_.begin(); itr != z_.end(); ++itr) {
+
+        rates(i++) = std::static_pointer_cast<ZNeuron>(*itr)->WeightChangeRate();
+    }
+    return rates;
+}
+
+float LayerZ::WeightChangeRate() const
+{
+    return z_.empty()? 0.f : static_cast<float>(mean(WeightChangeRates())(0));
 }
 
 void LayerZ::InitLearners(int nb_features, int nb_outputs, int len_history)
@@ -199,3 +1157,116 @@ void LayerZ::InitLearners(int nb_features, int nb_outputs, int len_history)
     }
 }
 
+void LayerZ::InitWTA()
+{
+    // copies would share their next spike time
+    wta_.clear();
+    for(int c=0; c<nb_columns_; c++) {
+
+        wta_.push_back(WTAPoisson(wta_f_, delta_t_));
+    }
+}
+
+void LayerZ::MarkLearned(const Mat1f &spikes)
+{
+    // spiking neurons change all of their weights, the others only their bias
+    if(countNonZero(spikes) > 0) {
+
+        weights_version_++;
+        for(int i=0; i<spikes.cols; i++) {
+
+            if(spikes(i) != 0.f) {
+
+                row_versions_[i] = weights_version_;
+            }
+        }
+    }
+    bias_version_++;
+}
+
+void LayerZ::PublishOnCadence()
+{
+    if(publish_every_ > 0 && ++nb_since_publish_ >= publish_every_) {
+
+        Publish();
+    }
+}
+
+void LayerZ::AttachWeights()
+{
+    // earlier views keep the old storage alive
+    weights_all_ = Mat1f(static_cast<int>(z_.size()), nb_afferents_+1);
+    for(int i=0; i<static_cast<int>(z_.size()); i++) {
+
+        std::static_pointer_cast<ZNeuron>(z_[i])->Attach(weights_all_.row(i));
+    }
+
+    weights_version_++;
+    row_versions_.assign(z_.size(), weights_version_);
+    bias_version_++;
+}
+
+void LayerZ::TrackSeed(const Mat1f &spikes_in)
+{
+    double u_max;
+    cv::minMaxIdx(u_, 0, &u_max);
+    const float score = static_cast<float>(u_max)/std::max(1, countNonZero(spikes_in));
+
+    int i;
+    if(static_cast<int>(seeds_.size()) < MAX_SEEDS) {
+
+        i = static_cast<int>(seeds_.size());
+        seed_scores_.push_back(score);
+        seeds_.push_back(Mat1f());
+    }
+    else {
+
+        // replace best explained candidate
+        i = static_cast<int>(std::max_element(seed_scores_.begin(), seed_scores_.end())-seed_scores_.begin());
+        if(score >= seed_scores_[i]) {
+
+            return;
+        }
+        seed_scores_[i] = score;
+    }
+    spikes_in.reshape(1, 1).copyTo(seeds_[i]); // caller may reuse its buffer
+}
+
+void LayerZ::RemoveLearners(const std::vector<bool> &is_kept)
+{
+    VecLPtr z;
+    std::vector<int> nb_wins;
+    for(size_t i=0; i<z_.size(); i++) {
+
+        if(is_kept[i]) {
+
+            z.push_back(z_[i]);
+            nb_wins.push_back(nb_wins_[i]);
+        }
+    }
+    z_.swap(z);
+    nb_wins_.swap(nb_wins);
+}
+
+void LayerZ::AddLearners(int nb_new)
+{
+    // least explained first
+    std::vector<int> order(seeds_.size());
+    for(size_t i=0; i<order.size(); i++) {
+
+        order[i] = static_cast<int>(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return seed_scores_[a] < seed_scores_[b]; });
+
+    for(int i=0; i<nb_new; i++) {
+
+        shared_ptr<ZNeuron> ptr(new ZNeuron);
+        ptr->Init(nb_afferents_, len_history_);
+        if(i < static_cast<int>(order.size())) {
+
+            ptr->Seed(seeds_[order[i]]);
+        }
+        z_.push_back(ptr);
+        nb_wins_.push_back(0);
+    }
+}
@@ -1,10 +1,19 @@
 #ifndef SEM_LAYERS_LAYER_Z_H_
 #define SEM_LAYERS_LAYER_Z_H_
 
+#include <memory>
 #include <vector>
 
 #include "elm/core/layerconfig.h"   // OptS member definition
 #include "elm/layers/layers_interim/base_LearningLayer.h"
+#include "sem/layers/boundsignal.h"
+#include "sem/layers/layer_z_stats.h"
+#include "sem/layers/layerzkernel.h"
+#include "sem/layers/layerzstream.h"
+#include "sem/layers/quantizedweights.h"
+#include "sem/layers/sparseweights.h"
+#include "sem/layers/tickarena.h"
+#include "sem/layers/weightssnapshot.h"
 #include "sem/neuron/zneuron.h"
 #include "sem/neuron/wtapoisson.h"
 
@@ -13,6 +22,10 @@
  *
  *  A set of spiking neurons in a WTA circuit that learn via STDP
  *
+ *  Output nodes may be split into columns, i.e. groups of consecutive neurons
+ *  each with its own WTA circuit, spike timing and soft-max, as an ensemble of independent layers
+ *  sharing a single weight block and input.
+ *
  * @cite Nessler2010
  */
 class LayerZ : public elm::base_LearningLayer
@@ -22,8 +35,11 @@ public:
     static const std::string KEY_INPUT_SPIKES;        ///< key to input spikes
     static const std::string KEY_OUTPUT_SPIKES;       ///< key to output spikes
     static const std::string KEY_OUTPUT_MEMBRANE_POT; ///< key to neuron membrane potentials
-    static const std::string KEY_OUTPUT_WEIGHTS;      ///< key to neuron weights
+    static const std::string KEY_OUTPUT_WEIGHTS;      ///< key to neuron weights, shared read-only view, see WeightsView()
+    static const std::string KEY_OUTPUT_WEIGHTS_DELTA;///< key to rows of weights changed since previous export, see WeightsDelta()
     static const std::string KEY_OUTPUT_BIAS;         ///< key to neuron bias
+    static const std::string KEY_OUTPUT_STATS;        ///< key to hot path stats, see LayerZStats::ToMat()
+    static const std::string KEY_OUTPUT_STATE_DISTR;  ///< key to softmax posterior over neurons, see StateDistr()
 
     // Parmater keys, parameters with defaults are optional
     static const std::string PARAM_NB_AFFERENTS;      ///< no. of afferent inputs
@@ -31,11 +47,37 @@ public:
     static const std::string PARAM_LEN_HISTORY;       ///< length of spiking histry to maintain
     static const std::string PARAM_DELTA_T;           ///< spike time resolution [milliseconds]
     static const std::string PARAM_WTA_FREQ;          ///< WTA's  spiking frequency [Hz]
+    static const std::string PARAM_STATS;             ///< enable hot path instrumentation
+    static const std::string PARAM_CHANGE_SMOOTHING;  ///< smoothing factor of weight change rates, see ZNeuron::WeightChangeRate()
+    static const std::string PARAM_ADAPTIVE_RATE;     ///< adaptive learning rate per weight, see ZNeuron::AdaptiveLearningRate()
+    static const std::string PARAM_EVENT_DRIVEN;      ///< only compute potentials on WTA spike ticks, see Skip()
+    static const std::string PARAM_PRUNE;             ///< Reconfigure() only, remove neurons that never won
+    static const std::string PARAM_SEED_GROWTH;       ///< keep least explained inputs for seeding neurons added by Reconfigure(), costs a scan per tick
+    static const std::string PARAM_SPARSE;            ///< compute potentials from pruned sparse weights, see SparseWeights
+    static const std::string PARAM_SPARSE_THRESHOLD;  ///< drop synapses at or below this weight
+    static const std::string PARAM_SPARSE_REBUILD;    ///< no. of potential computations between rebuilding sparse weights
+    static const std::string PARAM_SPECIALIZED;       ///< use kernels specialized for the layer's geometry if registered, see LayerZKernelFactory
+    static const std::string PARAM_PUBLISH_EVERY;     ///< no. of Learn() calls between publishing weight snapshots, 0 to disable, see Snapshot()
+    static const std::string PARAM_NB_COLUMNS;        ///< no. of independent WTA circuits, splitting output nodes into equal groups, see NbColumns()
 
     // defaults, parameters with defaults are optional
     static const int DEFAULT_LEN_HISTORY;             ///< 5, not a time unit, @todo change to time unit
     static const float DEFAULT_DELTA_T;               ///< = 1000.f;
     static const float DEFAULT_WTA_FREQ;              ///< = 1.f; // 1 Hz
+    static const bool DEFAULT_STATS;                  ///< = false;
+    static const float DEFAULT_CHANGE_SMOOTHING;      ///< = ZNeuron::DEFAULT_CHANGE_SMOOTHING
+    static const bool DEFAULT_ADAPTIVE_RATE;          ///< = false;
+    static const bool DEFAULT_EVENT_DRIVEN;           ///< = false;
+    static const bool DEFAULT_PRUNE;                  ///< = false;
+    static const bool DEFAULT_SEED_GROWTH;            ///< = false;
+    static const bool DEFAULT_SPARSE;                 ///< = false;
+    static const float DEFAULT_SPARSE_THRESHOLD;      ///< = SparseWeights::DEFAULT_THRESHOLD
+    static const int DEFAULT_SPARSE_REBUILD;          ///< = 1000
+    static const bool DEFAULT_SPECIALIZED;            ///< = true;
+    static const int DEFAULT_PUBLISH_EVERY;           ///< = 0, disabled
+    static const int DEFAULT_NB_COLUMNS;              ///< = 1;
+
+    static const int MAX_SEEDS;                       ///< = 16, max. no. of least explained inputs kept for seeding new neurons
 
     ~LayerZ();
 
@@ -45,6 +87,23 @@ public:
 
     void Reset(const elm::LayerConfig &config);
 
+    /**
+     * @brief Change parameters of a live layer, keeping what existing neurons learned
+     *
+     * Parameters missing from the config keep their current values.
+     * The no. of afferents and columns cannot change. Layers with multiple columns keep their no. of outputs.
+     * With PARAM_PRUNE, neurons that never won since the last Reset() or Reconfigure() are removed first,
+     * unless none ever won. Shrinking then removes neurons with the fewest wins,
+     * growing seeds new neurons from the least explained inputs seen with PARAM_SEED_GROWTH (see ZNeuron::Seed()), random otherwise.
+     * Removing neurons shifts output indices, surviving neurons keep their order.
+     * Any change to the set of neurons clears per-neuron statistics and output spikes,
+     * even if the no. of outputs stays the same.
+     * Changing the history length clears spiking histories.
+     * Win counts and seed inputs start over.
+     *
+     * @param config with parameters to change
+     * @throws ExceptionValueError on invalid parameters
+     */
     void Reconfigure(const elm::LayerConfig &config);
 
     virtual void InputNames(const elm::LayerInputNames& in_names);
@@ -60,8 +119,263 @@ public:
 
     void Learn(const cv::Mat1f& features, const cv::Mat1f &labels);
 
+    /**
+     * @brief Create state for an additional input stream through this layer's weights
+     * Streams run against published snapshots (see Snapshot()) and leave the layer's own stream alone.
+     * Recreate streams after changing the no. of outputs.
+     * @return stream with the layer's geometry and WTA timing, empty history
+     */
+    LayerZStream CreateStream() const;
+
+    /**
+     * @brief Apply STDP for learning from the most recent tick of another input stream
+     * Same update as Learn(), with the stream's spiking history and output spikes.
+     * Learner's thread only, streams may keep activating on snapshots in the meantime.
+     * @param stream activated since its most recent learning step
+     * @throws ExceptionBadDims if the stream does not match the layer's geometry
+     */
+    void Learn(const LayerZStream &stream);
+
+    /**
+     * @brief Apply a single STDP update pooled over the most recent tick of several streams
+     * Each neuron averages its weight changes over the streams it won in and updates its bias once,
+     * see ZNeuron::LearnPooled(). Same update as Learn(stream) for a single stream, independent of the order of streams.
+     * Learner's thread only.
+     * @param streams activated since their most recent learning step
+     * @throws ExceptionBadDims if a stream does not match the layer's geometry
+     */
+    void Learn(const std::vector<LayerZStream> &streams);
+
     void Response(elm::Signal &signal);
 
+    /**
+     * @brief Bind inputs and outputs to slots of a signal, resolving names once
+     *
+     * Names set through IONames() before or after binding are resolved right away,
+     * the overloads taking a BoundSignal then read and write through the slots without lookups by name.
+     * Outputs are written into the slots' own buffers, except for weights sharing the layer's storage.
+     * The string-keyed Activate(), Response() and Skip() remain available.
+     *
+     * @param signal to bind to, must outlive the binding
+     */
+    void Bind(BoundSignal &signal);
+
+    /**
+     * @brief whether inputs and outputs are bound to slots, see Bind()
+     */
+    bool IsBound() const;
+
+    /**
+     * @brief Activate on input spikes read through bound slot
+     * @param signal bound to
+     * @throws ExceptionValueError if not bound to this signal
+     * @throws ExceptionKeyError if input spikes not set
+     */
+    void Activate(const BoundSignal &signal);
+
+    /**
+     * @brief Write outputs into bound slots
+     * @param signal bound to
+     * @throws ExceptionValueError if not bound to this signal
+     */
+    void Response(BoundSignal &signal);
+
+    /**
+     * @brief get no. of upcoming ticks without a WTA spike
+     *
+     * Callers may jump over these ticks in a single Skip() call.
+     * In event-driven mode, Activate() also skips them one at a time,
+     * and only computes membrane potentials on the tick after.
+     * A tick skipped by Activate() only updates neuron bias if followed by Learn().
+     *
+     * @return no. of ticks until next WTA spike, 0 when the next tick spikes
+     * @see WTAPoisson::TicksToNextSpike()
+     */
+    int TicksToNextEvent();
+
+    /**
+     * @brief Advance simulation time over ticks without a WTA spike
+     *
+     * Equivalent to as many calls to Activate(), Response(), Learn() with the same input,
+     * without computing membrane potentials. Neuron bias updates are deferred until the next WTA spike,
+     * the input is only kept for the last ticks that still fall within the spiking history.
+     * Outputs no spikes. Membrane potentials and posterior are those of the most recent spike tick.
+     *
+     * @param signal with input spikes held constant over skipped ticks
+     * @param no. of ticks, at most TicksToNextEvent()
+     * @throws ExceptionValueError when skipping over a WTA spike
+     */
+    void Skip(const elm::Signal &signal, int nb_ticks);
+
+    /**
+     * @brief Skip ticks on input spikes read through bound slot, see Skip() and Bind()
+     * @param signal bound to
+     * @param no. of ticks, at most TicksToNextEvent()
+     */
+    void Skip(const BoundSignal &signal, int nb_ticks);
+
+    /**
+     * @brief Apply bookkeeping deferred while skipping ticks
+     * Brings neuron bias and spiking histories up to date, called before reading weights
+     */
+    void Flush();
+
+    /**
+     * @brief Enable or disable hot path instrumentation
+     * @param enable
+     */
+    void EnableStats(bool enable);
+
+    /**
+     * @brief get hot path stats recorded so far
+     * @return reference to stats
+     */
+    const LayerZStats& Stats() const;
+
+    /**
+     * @brief reset recorded stats
+     */
+    void ResetStats();
+
+    /**
+     * @brief get no. of WTA columns
+     * Column c governs output nodes [c*n, (c+1)*n) with n no. of outputs per column
+     */
+    int NbColumns() const;
+
+    /**
+     * @brief get softmax posterior over neurons given most recent stimuli
+     * This is the distribution the WTA circuit samples winners from, one per column
+     * @return row vector with probability per neuron, summing to 1 within each column
+     * @see WTAPoisson::LearnerStateDistr()
+     */
+    cv::Mat1f StateDistr() const;
+
+    /**
+     * @brief get output spikes from most recent stimuli
+     * No deep copy. Buffers come from the layer's TickArena and are only reused
+     * once no longer referenced elsewhere, consecutive skipped ticks share the same all-zero row.
+     * @return row vector, non-zero for spiking neuron
+     */
+    cv::Mat1f Spikes() const;
+
+    /**
+     * @brief get neuron weights
+     * Involves deep copy. Call Flush() first for up-to-date bias in event-driven mode.
+     * @return weights excluding bias, one row per neuron, log scale
+     */
+    cv::Mat1f Weights() const;
+
+    /**
+     * @brief get read-only view of neuron weights
+     * No deep copy, shares the layer's storage and changes in place as neurons learn, do not write to it.
+     * Reset() and Reconfigure() move weights to new storage, leaving earlier views behind as stale snapshots.
+     * @return weights excluding bias, one row per neuron, log scale
+     */
+    cv::Mat1f WeightsView() const;
+
+    /**
+     * @brief get version of neuron weights, excluding bias
+     * Increases whenever any weight changes, i.e. on Learn() with a WTA spike, Reset() and Reconfigure()
+     * @return version
+     */
+    unsigned long long WeightsVersion() const;
+
+    /**
+     * @brief get rows of weights changed since an earlier version
+     * Involves deep copy of changed rows only
+     * @param version as returned by WeightsVersion() before, 0 for all rows
+     * @return one row per changed neuron, neuron index followed by its weights
+     */
+    cv::Mat1f WeightsDelta(unsigned long long since) const;
+
+    /**
+     * @brief get neuron bias terms
+     * @return row vector with bias per neuron, log scale
+     */
+    cv::Mat1f Bias() const;
+
+    /**
+     * @brief get bias and weights of all neurons in a single matrix
+     * Involves deep copy. Call Flush() first for up-to-date bias in event-driven mode.
+     * @return one row per neuron, bias first followed by weights, log scale
+     */
+    cv::Mat1f WeightsAll() const;
+
+    /**
+     * @brief Overwrite bias and weights of all neurons, e.g. from a checkpoint or weights learned elsewhere
+     * Neurons keep their spiking histories and learning rate state. Counts as a change to all weights.
+     * @param one row per neuron, bias first followed by weights, log scale
+     * @throws ExceptionBadDims if not matching the layer's no. of outputs and afferents
+     */
+    void Restore(const cv::Mat1f &weights_all);
+
+    /**
+     * @brief Publish snapshot of current weights and bias to readers of Snapshot()
+     * Involves deep copy. Called from Learn() at the cadence set through PARAM_PUBLISH_EVERY.
+     * Call Flush() first for up-to-date bias in event-driven mode.
+     * Same thread as learning only.
+     */
+    void Publish();
+
+    /**
+     * @brief get most recently published weights for inference
+     *
+     * Safe to call from other threads while this layer keeps learning,
+     * the returned snapshot never changes and remains valid while held.
+     * Never blocks on learning.
+     *
+     * @return snapshot, null if nothing published since the last Reset()
+     * @see WeightsPublisher
+     */
+    WeightsPublisher::SnapshotPtr Snapshot() const;
+
+    /**
+     * @brief Export weights for integer inference
+     * @param depth in bits, QuantizedWeights::DEPTH_8 or QuantizedWeights::DEPTH_16
+     * @return quantized copy of current weights and bias
+     */
+    QuantizedWeights Quantize(int depth) const;
+
+    /**
+     * @brief Export pruned sparse weights for inference
+     * @param drop synapses at or below this weight
+     * @return sparse copy of current weights and bias
+     */
+    SparseWeights Sparsify(float threshold=SparseWeights::DEFAULT_THRESHOLD) const;
+
+    /**
+     * @brief whether per-tick kernels are specialized for the layer's geometry
+     * @see LayerZKernelFactory
+     */
+    bool IsSpecialized() const;
+
+    /**
+     * @brief get pool of per-tick buffers
+     * e.g. to check that it stopped growing or seal it once in steady state
+     * @return reference to arena
+     */
+    TickArena& Arena();
+
+    /**
+     * @brief get no. of WTA spikes per neuron since last Reset() or Reconfigure()
+     * @return row vector with win count per neuron
+     */
+    cv::Mat1i NbWins() const;
+
+    /**
+     * @brief get running magnitude of STDP weight changes per neuron
+     * @return row vector with weight change rate per neuron
+     * @see ZNeuron::WeightChangeRate()
+     */
+    cv::Mat1f WeightChangeRates() const;
+
+    /**
+     * @brief get running magnitude of STDP weight changes across the layer
+     * @return mean weight change rate over all neurons
+     */
+    float WeightChangeRate() const;
+
 protected:
     typedef std::vector<std::shared_ptr<base_Learner> > VecLPtr; ///< vector typedef convinience
 
@@ -72,19 +386,162 @@ protected:
      */
     void InitLearners(int nb_features, int nb_outputs, int len_history);
 
+    /**
+     * @brief (Re-)create WTA circuits, one per column, each drawing its own spike times
+     */
+    void InitWTA();
+
+    /**
+     * @brief Advance weight versions following a learning step
+     * @param output spikes of the learning step
+     */
+    void MarkLearned(const cv::Mat1f &spikes);
+
+    /**
+     * @brief Publish snapshot if due after a learning step
+     */
+    void PublishOnCadence();
+
+    /**
+     * @brief Move weights of all neurons into new contiguous storage, one row per neuron
+     * Marks all rows as changed
+     */
+    void AttachWeights();
+
+    /**
+     * @brief get bias for export, copied from storage only when changed since last call
+     * @return row vector with bias per neuron, from arena
+     */
+    const cv::Mat1f& ExportBias();
+
+    /**
+     * @brief Compute membrane potentials, let neurons compete
+     * @param input spikes
+     */
+    void ActivateSpikes(const cv::Mat1f &spikes_in);
+
+    /**
+     * @brief Validate no. of ticks before skipping them
+     * @param input spikes
+     * @param no. of ticks
+     */
+    void SkipSpikes(const cv::Mat1f &spikes_in, int nb_ticks);
+
+    /**
+     * @brief Resolve I/O names to slots of bound signal
+     */
+    void BindSlots();
+
+    /**
+     * @brief Make sure the layer is bound to a signal
+     * @param signal
+     * @throws ExceptionValueError if not bound to this signal
+     */
+    void CheckBound(const BoundSignal &signal) const;
+
+    /**
+     * @brief Record input of skipped ticks and output no spikes
+     * Leaves counting the ticks' bias updates to the caller
+     * @param input spikes
+     * @param no. of ticks
+     */
+    void SkipTicks(const cv::Mat1f &spikes_in, int nb_ticks);
+
+    /**
+     * @brief Keep input as seed candidate if explained worse than those kept so far
+     * An input is explained by the neuron with max. membrane potential, per spiking afferent
+     * @param input spikes
+     */
+    void TrackSeed(const cv::Mat1f &spikes_in);
+
+    /**
+     * @brief Remove neurons, keeping order of the remaining ones
+     * @param flag per neuron to keep
+     */
+    void RemoveLearners(const std::vector<bool> &is_kept);
+
+    /**
+     * @brief Add neurons seeded from least explained inputs
+     * @param no. of neurons to add
+     */
+    void AddLearners(int nb_new);
+
     std::string name_input_spikes_;     ///< name of input spikes in signal object
     std::string name_output_spikes_;    ///< destination of output spikes in signal object
     elm::OptS name_output_mem_pot_;          ///< optional destination of membrane potential in signal object
     elm::OptS name_output_weights_;          ///< optional destination of neuron weights in signal object
     elm::OptS name_output_bias_;             ///< optional destination of neuron bias in signal object, not the same as weights[0]
+    elm::OptS name_output_stats_;            ///< optional destination of hot path stats in signal object
+    elm::OptS name_output_state_distr_;      ///< optional destination of softmax posterior in signal object
+    elm::OptS name_output_weights_delta_;    ///< optional destination of changed rows of weights in signal object
+
+    BoundSignal *bound_;                        ///< signal bound to, null for string-keyed I/O only
+    BoundSignal::Slot *slot_input_spikes_;      ///< bound input spikes, null until names known
+    BoundSignal::Slot *slot_output_spikes_;     ///< bound output spikes, null until names known
+    BoundSignal::Slot *slot_output_mem_pot_;    ///< bound membrane potential, null unless requested
+    BoundSignal::Slot *slot_output_weights_;    ///< bound neuron weights, null unless requested
+    BoundSignal::Slot *slot_output_bias_;       ///< bound neuron bias, null unless requested
+    BoundSignal::Slot *slot_output_stats_;      ///< bound hot path stats, null unless requested
+    BoundSignal::Slot *slot_output_state_distr_;///< bound softmax posterior, null unless requested
+    BoundSignal::Slot *slot_output_weights_delta_;///< bound changed rows of weights, null unless requested
 
     int nb_afferents_;                  ///< number of afferents to this layer
 
+    /** Output slots of arena_
+     */
+    enum ArenaSlot {
+        SLOT_MEMBRANE_POT = 0,
+        SLOT_SPIKES,
+        SLOT_BIAS
+    };
+
     cv::Mat1f u_;                       ///< membrane potential from most recent stimuli
     cv::Mat1f spikes_out_;              ///< output spikes from most recent stimuli
+    TickArena arena_;                   ///< buffers of outputs and transients of a tick
 
     VecLPtr z_;                         ///< z neurons that learn using STDP
-    WTAPoisson wta_;                    ///< winner-take-all to govern Z neuron spiking
+    cv::Mat1f weights_all_;             ///< storage of bias and weights of all neurons, one row per neuron, bias first
+
+    unsigned long long weights_version_;        ///< version of weights excluding bias
+    std::vector<unsigned long long> row_versions_; ///< version of most recent change per neuron
+    unsigned long long delta_version_;          ///< weights version at most recent delta export
+    unsigned long long bias_version_;           ///< version of bias terms
+    unsigned long long bias_out_version_;       ///< bias version of bias_out_
+    cv::Mat1f bias_out_;                        ///< most recently exported bias
+    std::vector<WTAPoisson> wta_;       ///< winner-take-all per column to govern Z neuron spiking
+    int nb_columns_;                    ///< no. of WTA columns
+
+    LayerZStats stats_;                 ///< hot path instrumentation, disabled by default
+
+    int len_history_;                   ///< length of spiking history
+    bool is_event_driven_;              ///< event-driven simulation flag
+    bool is_skipped_;                   ///< whether most recent tick was skipped
+    bool is_learn_pending_;             ///< whether most recent tick was skipped by Activate() and not yet learned from
+    int ticks_to_event_;                ///< cached no. of ticks until next WTA spike, -1 for unknown
+    int nb_skipped_;                    ///< no. of skipped ticks pending bias updates
+
+    float wta_f_;                       ///< WTA's spiking frequency [Hz]
+    float delta_t_;                     ///< spike time resolution [milliseconds]
+    float change_smoothing_;            ///< smoothing factor of weight change rates
+    bool is_adaptive_rate_;             ///< adaptive learning rate flag
+
+    std::vector<int> nb_wins_;          ///< no. of WTA spikes per neuron
+    bool is_seed_growth_;               ///< track seed candidates flag
+    std::vector<float> seed_scores_;    ///< how well each seed candidate is explained, lower is worse
+    std::vector<cv::Mat1f> seeds_;      ///< least explained inputs, candidates for seeding new neurons
+
+    bool is_sparse_;                    ///< sparse potentials flag
+    float sparse_threshold_;            ///< drop synapses at or below this weight
+    int sparse_rebuild_;                ///< no. of potential computations between rebuilds
+    int nb_since_rebuild_;              ///< no. of potential computations since last rebuild
+    SparseWeights sparse_;              ///< pruned copy of weights, lags behind learning until rebuilt
+
+    int publish_every_;                 ///< no. of Learn() calls between publishing snapshots, 0 for never
+    int nb_since_publish_;              ///< no. of Learn() calls since most recent snapshot
+    WeightsPublisher publisher_;        ///< snapshots of weights for concurrent readers
+
+    bool is_specialized_;               ///< prefer specialized kernels flag
+    std::shared_ptr<base_LayerZKernel> kernel_; ///< potentials and input of skipped ticks pending history updates
 };
 
 #endif // SEM_LAYERS_LAYER_Z_H_
@@ -0,0 +1,151 @@
+#include "sem/layers/layer_z_stats.h"
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+LayerZStats::LayerZStats()
+    : is_enabled_(false)
+{
+    Reset(0);
+}
+
+void LayerZStats::Enable(bool enable)
+{
+    is_enabled_ = enable;
+}
+
+bool LayerZStats::IsEnabled() const
+{
+    return is_enabled_;
+}
+
+void LayerZStats::Reset(int nb_outputs)
+{
+    for(int i=0; i<NB_PHASES; i++) {
+
+        counts_[i] = 0;
+        seconds_[i] = 0.;
+    }
+
+    nb_ticks_ = 0;
+    nb_spikes_ = 0;
+    nb_active_afferents_ = 0;
+    nb_arena_growths_ = 0;
+
+    winners_ = Mat1i::zeros(1, nb_outputs);
+}
+
+LayerZStats::Clock::time_point LayerZStats::Tic() const
+{
+    return is_enabled_? Clock::now() : Clock::time_point();
+}
+
+void LayerZStats::Toc(Phase phase, const Clock::time_point &t0)
+{
+    if(!is_enabled_) {
+        return;
+    }
+
+    seconds_[phase] += std::chrono::duration<double>(Clock::now()-t0).count();
+    counts_[phase]++;
+}
+
+void LayerZStats::Tick(int nb_active_afferents, int nb_arena_growths)
+{
+    if(!is_enabled_) {
+        return;
+    }
+
+    nb_ticks_++;
+    nb_active_afferents_ += static_cast<unsigned long long>(nb_active_afferents);
+    nb_arena_growths_ += static_cast<unsigned long long>(nb_arena_growths);
+}
+
+void LayerZStats::Spike(int winner)
+{
+    if(!is_enabled_) {
+        return;
+    }
+
+    if(winner < 0 || winner >= static_cast<int>(winners_.total())) {
+
+        ELM_THROW_BAD_DIMS("Winner index out of range.");
+    }
+
+    nb_spikes_++;
+    winners_(winner)++;
+}
+
+unsigned long long LayerZStats::Count(Phase phase) const
+{
+    return counts_[phase];
+}
+
+double LayerZStats::Seconds(Phase phase) const
+{
+    return seconds_[phase];
+}
+
+unsigned long long LayerZStats::NbTicks() const
+{
+    return nb_ticks_;
+}
+
+unsigned long long LayerZStats::NbSpikes() const
+{
+    return nb_spikes_;
+}
+
+float LayerZStats::SpikeRate() const
+{
+    return (nb_ticks_ > 0)? nb_spikes_/static_cast<float>(nb_ticks_) : 0.f;
+}
+
+Mat1i LayerZStats::Winners() const
+{
+    return winners_.clone();
+}
+
+float LayerZStats::MeanActiveAfferents() const
+{
+    return (nb_ticks_ > 0)? nb_active_afferents_/static_cast<float>(nb_ticks_) : 0.f;
+}
+
+float LayerZStats::ArenaGrowthsPerTick() const
+{
+    return (nb_ticks_ > 0)? nb_arena_growths_/static_cast<float>(nb_ticks_) : 0.f;
+}
+
+Mat1f LayerZStats::ToMat() const
+{
+    Mat1f m(1, NB_COLS_SUMMARY+2*NB_PHASES);
+
+    m(COL_NB_TICKS)                 = static_cast<float>(nb_ticks_);
+    m(COL_NB_SPIKES)                = static_cast<float>(nb_spikes_);
+    m(COL_SPIKE_RATE)               = SpikeRate();
+    m(COL_MEAN_ACTIVE_AFFERENTS)    = MeanActiveAfferents();
+    m(COL_ARENA_GROWTHS_PER_TICK)   = ArenaGrowthsPerTick();
+
+    for(int i=0; i<NB_PHASES; i++) {
+
+        m(NB_COLS_SUMMARY+2*i)      = static_cast<float>(counts_[i]);
+        m(NB_COLS_SUMMARY+2*i+1)    = static_cast<float>(seconds_[i]);
+    }
+
+    return m;
+}
+
+std::string LayerZStats::PhaseName(Phase phase)
+{
+    switch(phase) {
+
+    case PHASE_ACTIVATE:    return "Activate";
+    case PHASE_PREDICT:     return "Predict";
+    case PHASE_COMPETE:     return "Compete";
+    case PHASE_LEARN:       return "Learn";
+    case PHASE_UPDATE:      return "Update";
+    case PHASE_RESPONSE:    return "Response";
+    default:                ELM_THROW_VALUE_ERROR("Unknown phase.");
+    }
+}
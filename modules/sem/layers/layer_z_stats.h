@@ -0,0 +1,147 @@
+#ifndef SEM_LAYERS_LAYER_Z_STATS_H_
+#define SEM_LAYERS_LAYER_Z_STATS_H_
+
+#include <chrono>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Counters and timers for the hot path of a LayerZ instance
+ *
+ * Disabled by default. While disabled, Tic() and Toc() skip reading the clock
+ * and all recording methods return immediately.
+ * Timings are accumulated in wall clock seconds.
+ */
+class LayerZStats
+{
+public:
+    /** Instrumented phases of a simulation tick
+     */
+    enum Phase {
+        PHASE_ACTIVATE = 0, ///< LayerZ::Activate as a whole
+        PHASE_PREDICT,      ///< membrane potential computation for all neurons
+        PHASE_COMPETE,      ///< WTA competition
+        PHASE_LEARN,        ///< LayerZ::Learn as a whole
+        PHASE_UPDATE,       ///< STDP weight update of spiking neurons, single column only, columns learn in parallel within PHASE_LEARN
+        PHASE_RESPONSE,     ///< LayerZ::Response
+        NB_PHASES
+    };
+
+    /** Column layout of ToMat() row, followed by count and seconds per phase
+     */
+    enum Column {
+        COL_NB_TICKS = 0,
+        COL_NB_SPIKES,
+        COL_SPIKE_RATE,
+        COL_MEAN_ACTIVE_AFFERENTS,
+        COL_ARENA_GROWTHS_PER_TICK,
+        NB_COLS_SUMMARY
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    LayerZStats();
+
+    /**
+     * @brief Enable or disable recording, does not reset recorded values
+     * @param enable
+     */
+    void Enable(bool enable);
+
+    bool IsEnabled() const;
+
+    /**
+     * @brief Reset all counters
+     * @param no. of output neurons to track wins for
+     */
+    void Reset(int nb_outputs);
+
+    /**
+     * @brief start timing a phase
+     * @return current time, or a default time point when disabled
+     */
+    Clock::time_point Tic() const;
+
+    /**
+     * @brief stop timing a phase and accumulate elapsed time
+     * @param phase
+     * @param start time as returned by Tic()
+     */
+    void Toc(Phase phase, const Clock::time_point &t0);
+
+    /**
+     * @brief Record bookkeeping of a single simulation tick
+     * @param no. of afferents active during this tick
+     * @param no. of times the layer's TickArena grew during this tick
+     */
+    void Tick(int nb_active_afferents, int nb_arena_growths);
+
+    /**
+     * @brief Record a WTA spike
+     * @param index of winning neuron
+     */
+    void Spike(int winner);
+
+    /**
+     * @brief get no. of times a phase has been recorded
+     */
+    unsigned long long Count(Phase phase) const;
+
+    /**
+     * @brief get total time spent in phase
+     * @return time [seconds]
+     */
+    double Seconds(Phase phase) const;
+
+    unsigned long long NbTicks() const;
+
+    unsigned long long NbSpikes() const;
+
+    /**
+     * @brief WTA spikes per tick
+     */
+    float SpikeRate() const;
+
+    /**
+     * @brief get no. of wins per neuron
+     * @return row vector of win counts
+     */
+    cv::Mat1i Winners() const;
+
+    float MeanActiveAfferents() const;
+
+    /**
+     * @brief get mean no. of TickArena growths per tick
+     * Not a count of heap allocations, see TickArena
+     * @return growths per tick
+     */
+    float ArenaGrowthsPerTick() const;
+
+    /**
+     * @brief flatten stats into a single row for appending to a signal
+     * Summary columns as in Column enum, followed by (count, seconds) pairs for each phase
+     * @return row vector of NB_COLS_SUMMARY+2*NB_PHASES elements
+     */
+    cv::Mat1f ToMat() const;
+
+    /**
+     * @brief get human readable phase name
+     */
+    static std::string PhaseName(Phase phase);
+
+protected:
+    bool is_enabled_;                           ///< recording flag
+
+    unsigned long long counts_[NB_PHASES];      ///< no. of recorded calls per phase
+    double seconds_[NB_PHASES];                 ///< accumulated time per phase
+
+    unsigned long long nb_ticks_;               ///< no. of simulation ticks
+    unsigned long long nb_spikes_;              ///< no. of WTA spikes
+    unsigned long long nb_active_afferents_;    ///< accumulated no. of active afferents
+    unsigned long long nb_arena_growths_;       ///< accumulated no. of arena growths
+
+    cv::Mat1i winners_;                         ///< win count per neuron
+};
+
+#endif // SEM_LAYERS_LAYER_Z_STATS_H_
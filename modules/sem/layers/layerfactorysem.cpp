@@ -13,6 +13,8 @@
 #include "elm/io/readmnistimages.h"
 #include "elm/io/readmnistlabels.h"
 #include "sem/layers/layer_z.h"
+#include "sem/layers/layerzconv.h"
+#include "sem/layers/layerzstack.h"
 
 using boost::assign::map_list_of;
 
@@ -29,6 +31,8 @@ typedef Registor_<base_Layer>::Registry LayerRegistry;
 
 LayerRegistry g_layerRegistrySEM = map_list_of
         LAYER_REGISTRY_PAIR( LayerZ )
+        LAYER_REGISTRY_PAIR( LayerZConv )
+        LAYER_REGISTRY_PAIR( LayerZStack )
         LAYER_REGISTRY_PAIR( ReadMNISTImages )
         LAYER_REGISTRY_PAIR( ReadMNISTLabels )
         ; ///< <-- add new layer to registry here
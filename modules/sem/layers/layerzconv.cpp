@@ -0,0 +1,281 @@
+#include "sem/layers/layerzconv.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/layerionames.h"
+#include "elm/core/signal.h"
+
+using cv::Mat1f;
+using namespace elm;
+
+// I/O keys
+const std::string LayerZConv::KEY_INPUT_SPIKES      = LayerZ::KEY_INPUT_SPIKES;
+const std::string LayerZConv::KEY_OUTPUT_SPIKES     = LayerZ::KEY_OUTPUT_SPIKES;
+
+// Parameter keys
+const std::string LayerZConv::PARAM_INPUT_ROWS      = "input_rows";
+const std::string LayerZConv::PARAM_INPUT_COLS      = "input_cols";
+const std::string LayerZConv::PARAM_NB_CHANNELS     = "nb_channels";
+const std::string LayerZConv::PARAM_PATCH_ROWS      = "patch_rows";
+const std::string LayerZConv::PARAM_PATCH_COLS      = "patch_cols";
+const std::string LayerZConv::PARAM_STRIDE          = "stride";
+const std::string LayerZConv::PARAM_NB_OUTPUT_NODES = LayerZ::PARAM_NB_OUTPUT_NODES;
+
+// defaults
+const int LayerZConv::DEFAULT_NB_CHANNELS = 1;
+const int LayerZConv::DEFAULT_STRIDE = 1;
+
+/**
+ * @brief Activate a range of positions, each on its own receptive field
+ */
+class LayerZConv::ParallelActivate : public cv::ParallelLoopBody
+{
+public:
+    /**
+     * @brief body of parallel loop
+     * @param layer
+     * @param input map, one row per row of the map, channels consecutive
+     */
+    ParallelActivate(LayerZConv *layer, const Mat1f &in)
+        : layer_(layer),
+          in_(in)
+    {
+    }
+
+    virtual void operator()(const cv::Range &range) const
+    {
+        for(int i=range.start; i<range.end; i++) {
+
+            layer_->ActivatePosition(i, in_);
+        }
+    }
+
+protected:
+    LayerZConv *layer_; ///< layer owning the positions
+    Mat1f in_;          ///< input map
+};
+
+namespace {
+
+int CheckPositive(int value, const std::string &what)
+{
+    if(value < 1) {
+
+        ELM_THROW_VALUE_ERROR(what + " must be > 0");
+    }
+    return value;
+}
+
+} // annonymous namespace
+
+LayerZConv::~LayerZConv()
+{
+}
+
+LayerZConv::LayerZConv()
+    : base_LearningLayer(),
+      input_rows_(0),
+      input_cols_(0),
+      nb_channels_(DEFAULT_NB_CHANNELS),
+      patch_rows_(0),
+      patch_cols_(0),
+      stride_(DEFAULT_STRIDE)
+{
+}
+
+void LayerZConv::Clear()
+{
+    for(size_t i=0; i<positions_.size(); i++) {
+
+        positions_[i].Clear();
+    }
+    spikes_out_ = Mat1f::zeros(1, spikes_out_.cols);
+}
+
+void LayerZConv::Reset(const LayerConfig &config)
+{
+    PTree params = config.Params();
+
+    input_rows_ = CheckPositive(params.get<int>(PARAM_INPUT_ROWS), "No. of input rows");
+    input_cols_ = CheckPositive(params.get<int>(PARAM_INPUT_COLS), "No. of input columns");
+    nb_channels_ = CheckPositive(params.get<int>(PARAM_NB_CHANNELS, DEFAULT_NB_CHANNELS), "No. of channels");
+    patch_rows_ = CheckPositive(params.get<int>(PARAM_PATCH_ROWS), "No. of receptive field rows");
+    patch_cols_ = CheckPositive(params.get<int>(PARAM_PATCH_COLS), "No. of receptive field columns");
+    stride_ = CheckPositive(params.get<int>(PARAM_STRIDE, DEFAULT_STRIDE), "Stride");
+
+    if(patch_rows_ > input_rows_ || patch_cols_ > input_cols_) {
+
+        ELM_THROW_VALUE_ERROR("Receptive field must fit into input map");
+    }
+
+    output_size_ = cv::Size((input_cols_-patch_cols_)/stride_+1,
+                            (input_rows_-patch_rows_)/stride_+1);
+
+    // weight bank sees a single receptive field, published for activating all positions
+    PTree bank_params = params;
+    bank_params.put(LayerZ::PARAM_NB_AFFERENTS, patch_rows_*patch_cols_*nb_channels_);
+    bank_params.put(LayerZ::PARAM_PUBLISH_EVERY, 0);
+
+    LayerConfig bank_config;
+    bank_config.Params(bank_params);
+    bank_.Reset(bank_config);
+    ShareWeights();
+
+    rngs_.clear();
+    rngs_.reserve(NbPositions());
+    for(int i=0; i<NbPositions(); i++) {
+
+        rngs_.push_back(cv::RNG(static_cast<uint64>(cv::theRNG()())));
+    }
+
+    patches_ = Mat1f(NbPositions(), weights_->NbAfferents());
+    arena_.Clear();
+    CreatePositions();
+}
+
+void LayerZConv::Reconfigure(const LayerConfig &config)
+{
+    PTree params = config.Params();
+
+    if(params.get<int>(PARAM_INPUT_ROWS, input_rows_) != input_rows_ ||
+            params.get<int>(PARAM_INPUT_COLS, input_cols_) != input_cols_ ||
+            params.get<int>(PARAM_NB_CHANNELS, nb_channels_) != nb_channels_ ||
+            params.get<int>(PARAM_PATCH_ROWS, patch_rows_) != patch_rows_ ||
+            params.get<int>(PARAM_PATCH_COLS, patch_cols_) != patch_cols_ ||
+            params.get<int>(PARAM_STRIDE, stride_) != stride_) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change geometry of input map or receptive fields without a Reset");
+    }
+
+    PTree bank_params = params;
+    bank_params.erase(LayerZ::PARAM_NB_AFFERENTS);
+    bank_params.put(LayerZ::PARAM_PUBLISH_EVERY, 0);
+
+    LayerConfig bank_config;
+    bank_config.Params(bank_params);
+    bank_.Reconfigure(bank_config);
+    ShareWeights();
+    CreatePositions();
+}
+
+void LayerZConv::InputNames(const LayerInputNames &in_names)
+{
+    name_input_spikes_ = in_names.Input(KEY_INPUT_SPIKES);
+}
+
+void LayerZConv::OutputNames(const LayerOutputNames &out_names)
+{
+    name_output_spikes_ = out_names.Output(KEY_OUTPUT_SPIKES);
+}
+
+void LayerZConv::Activate(const Signal &signal)
+{
+    Mat1f in = signal.MostRecentMat1f(name_input_spikes_);
+    if(static_cast<int>(in.total()) != input_rows_*input_cols_*nb_channels_) {
+
+        ELM_THROW_BAD_DIMS("No. of input spikes does not match input map");
+    }
+
+    if(!in.isContinuous()) {
+
+        in = in.clone();
+    }
+    in = in.reshape(1, input_rows_);
+
+    // exported spikes are never overwritten while referenced elsewhere
+    spikes_out_.release();
+    spikes_out_ = arena_.Output(SLOT_SPIKES, 1, NbPositions()*weights_->NbOutputs(), CV_32FC1);
+
+    cv::parallel_for_(cv::Range(0, NbPositions()), ParallelActivate(this, in));
+}
+
+void LayerZConv::ActivatePosition(int i, const Mat1f &in)
+{
+    const int r = (i/output_size_.width)*stride_;
+    const int c = (i%output_size_.width)*stride_*nb_channels_;
+    const int len_row = patch_cols_*nb_channels_;
+
+    Mat1f patch = patches_.row(i);
+    for(int pr=0; pr<patch_rows_; pr++) {
+
+        Mat1f dst = patch.colRange(pr*len_row, (pr+1)*len_row);
+        in.row(r+pr).colRange(c, c+len_row).copyTo(dst);
+    }
+
+    // position's own random state, independent of the thread running it
+    cv::RNG &rng = cv::theRNG();
+    const cv::RNG caller_rng = rng;
+    rng = rngs_[i];
+
+    positions_[i].Activate(*weights_, patch);
+
+    rngs_[i] = rng;
+    rng = caller_rng;
+
+    const int nb_outputs = weights_->NbOutputs();
+    Mat1f dst = spikes_out_.colRange(i*nb_outputs, (i+1)*nb_outputs);
+    positions_[i].Spikes().copyTo(dst);
+}
+
+void LayerZConv::Learn()
+{
+    bank_.Learn(positions_); // single update pooled over all positions
+    ShareWeights();
+}
+
+void LayerZConv::Learn(const cv::Mat1f &features, const cv::Mat1f &labels)
+{
+    for(int r=0; r<features.rows; r++) {
+
+        Signal s;
+        s.Append(name_input_spikes_, features.row(r));
+        Activate(s);
+        Learn();
+    }
+}
+
+void LayerZConv::Response(Signal &signal)
+{
+    signal.Append(name_output_spikes_, spikes_out_);
+}
+
+int LayerZConv::NbPositions() const
+{
+    return output_size_.area();
+}
+
+cv::Size LayerZConv::OutputSize() const
+{
+    return output_size_;
+}
+
+Mat1f LayerZConv::Weights() const
+{
+    return bank_.Weights();
+}
+
+Mat1f LayerZConv::Bias() const
+{
+    return bank_.Bias();
+}
+
+void LayerZConv::ShareWeights()
+{
+    bank_.Publish();
+    weights_ = bank_.Snapshot();
+}
+
+void LayerZConv::CreatePositions()
+{
+    positions_.clear();
+    positions_.reserve(NbPositions());
+    for(int i=0; i<NbPositions(); i++) {
+
+        positions_.push_back(bank_.CreateStream());
+    }
+    spikes_out_ = Mat1f::zeros(1, NbPositions()*weights_->NbOutputs());
+}
+
+const LayerZStream& LayerZConv::Position(int i) const
+{
+    return positions_[i];
+}
@@ -0,0 +1,174 @@
+#ifndef SEM_LAYERS_LAYERZCONV_H_
+#define SEM_LAYERS_LAYERZCONV_H_
+
+#include <vector>
+
+#include "elm/layers/layers_interim/base_LearningLayer.h"
+#include "sem/layers/layer_z.h"
+#include "sem/layers/layerzstream.h"
+#include "sem/layers/tickarena.h"
+#include "sem/layers/weightssnapshot.h"
+
+/**
+ * @brief Z neurons over local receptive fields of an input map, sharing one set of weights
+ *
+ * The input is tiled into patches of afferents, one patch per position of a sliding window.
+ * Each position has its own WTA circuit and spiking history (see LayerZStream),
+ * all positions compete through the same weight bank, a LayerZ with one afferent per element of a patch.
+ * Learning pools the STDP updates of all positions into a single update of the shared bank per tick:
+ * a neuron averages its weight changes over the positions it won at and updates its bias once,
+ * such that learning depends neither on the order nor on the number of positions.
+ * Memory of the weights is independent of the size of the input.
+ *
+ * Input spikes are a map of input_rows x input_cols elements, nb_channels consecutive afferents per element,
+ * e.g. the on/off afferents of a population code per pixel. Any shape with that many elements in row-major order is accepted.
+ * Output spikes are a row vector, nb_outputs consecutive spikes per position, positions in row-major order,
+ * such that they make up the input map of another such layer with as many channels.
+ *
+ * Positions activate in parallel, each drawing from its own random number generator seeded on Reset(),
+ * such that outcomes do not depend on the no. of threads.
+ */
+class LayerZConv : public elm::base_LearningLayer
+{
+public:
+    // I/O keys
+    static const std::string KEY_INPUT_SPIKES;        ///< key to input spikes
+    static const std::string KEY_OUTPUT_SPIKES;       ///< key to output spikes
+
+    // Parmater keys, parameters with defaults are optional
+    static const std::string PARAM_INPUT_ROWS;        ///< no. of rows of input map
+    static const std::string PARAM_INPUT_COLS;        ///< no. of columns of input map
+    static const std::string PARAM_NB_CHANNELS;       ///< no. of afferents per element of input map
+    static const std::string PARAM_PATCH_ROWS;        ///< no. of rows of a receptive field
+    static const std::string PARAM_PATCH_COLS;        ///< no. of columns of a receptive field
+    static const std::string PARAM_STRIDE;            ///< step between neighbouring receptive fields in both directions
+    static const std::string PARAM_NB_OUTPUT_NODES;   ///< no. of neurons per position, see LayerZ::PARAM_NB_OUTPUT_NODES
+
+    static const int DEFAULT_NB_CHANNELS;             ///< = 1;
+    static const int DEFAULT_STRIDE;                  ///< = 1;
+
+    ~LayerZConv();
+
+    LayerZConv();
+
+    void Clear();
+
+    /**
+     * @brief Reset layer
+     * Parameters besides geometry are passed on to the weight bank, e.g. LayerZ::PARAM_WTA_FREQ
+     * @param config
+     * @throws ExceptionValueError if receptive fields do not fit into the input map
+     */
+    void Reset(const elm::LayerConfig &config);
+
+    /**
+     * @brief Change parameters of the weight bank, keeping what it learned, see LayerZ::Reconfigure()
+     * Positions start over with empty spiking histories.
+     * @param config with parameters to change
+     * @throws ExceptionValueError on a change to the geometry of input map or receptive fields
+     */
+    void Reconfigure(const elm::LayerConfig &config);
+
+    virtual void InputNames(const elm::LayerInputNames& in_names);
+
+    virtual void OutputNames(const elm::LayerOutputNames& out_names);
+
+    /**
+     * @brief Let neurons at all positions compete on their receptive fields
+     * @param signal with input spikes
+     * @throws ExceptionBadDims on mismatching no. of input elements
+     */
+    void Activate(const elm::Signal &signal);
+
+    /**
+     * @brief Apply STDP of all positions to the shared weights, see LayerZ::Learn(const std::vector<LayerZStream>&)
+     * Takes effect on the next Activate()
+     */
+    void Learn();
+
+    void Learn(const cv::Mat1f& features, const cv::Mat1f &labels);
+
+    void Response(elm::Signal &signal);
+
+    /**
+     * @brief get no. of receptive field positions
+     */
+    int NbPositions() const;
+
+    /**
+     * @brief get size of output map
+     * @return no. of positions along columns (width) and rows (height)
+     */
+    cv::Size OutputSize() const;
+
+    /**
+     * @brief get shared weights
+     * Involves deep copy
+     * @return weights excluding bias, one row per neuron, patch elements in row-major order, channels consecutive
+     */
+    cv::Mat1f Weights() const;
+
+    /**
+     * @brief get shared bias terms
+     * @return row vector with bias per neuron
+     */
+    cv::Mat1f Bias() const;
+
+    /**
+     * @brief get state of a single position
+     * @param index of position, row-major
+     * @return reference to position's stream
+     */
+    const LayerZStream& Position(int i) const;
+
+protected:
+    class ParallelActivate;
+    friend class ParallelActivate;
+
+    /**
+     * @brief Copy receptive field of a position from the input map, let the position's neurons compete
+     * Positions are independent of each other and may run concurrently
+     * @param index of position, row-major
+     * @param input map, one row per row of the map, channels consecutive
+     */
+    void ActivatePosition(int i, const cv::Mat1f &in);
+
+    /**
+     * @brief Publish bank's weights for activating all positions
+     */
+    void ShareWeights();
+
+    /**
+     * @brief (Re-)create state of all positions with the bank's geometry and WTA timing
+     * Positions keep their random number generators
+     */
+    void CreatePositions();
+
+    /** Output slots of arena_
+     */
+    enum ArenaSlot {
+        SLOT_SPIKES = 0
+    };
+
+    std::string name_input_spikes_;     ///< name of input spikes in signal object
+    std::string name_output_spikes_;    ///< destination of output spikes in signal object
+
+    int input_rows_;                    ///< no. of rows of input map
+    int input_cols_;                    ///< no. of columns of input map
+    int nb_channels_;                   ///< no. of afferents per input element
+    int patch_rows_;                    ///< no. of rows of a receptive field
+    int patch_cols_;                    ///< no. of columns of a receptive field
+    int stride_;                        ///< step between receptive fields
+    cv::Size output_size_;              ///< no. of positions along columns and rows
+
+    LayerZ bank_;                                   ///< neurons sharing their weights across positions
+    WeightsPublisher::SnapshotPtr weights_;         ///< bank's weights as of the most recent learning step
+    std::vector<LayerZStream> positions_;           ///< WTA circuit and spiking history per position
+    std::vector<cv::RNG> rngs_;                     ///< random number generator per position
+
+    cv::Mat1f patches_;                 ///< receptive field per position, one row each
+    cv::Mat1f spikes_out_;              ///< output spikes from most recent stimuli
+    TickArena arena_;                   ///< output buffers
+};
+
+#endif // SEM_LAYERS_LAYERZCONV_H_
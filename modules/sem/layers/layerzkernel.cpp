@@ -0,0 +1,141 @@
+#include "sem/layers/layerzkernel.h"
+
+#include <map>
+#include <utility>
+
+#include <boost/assign/list_of.hpp>
+
+#include "sem/neuron/zneuron.h"
+
+using boost::assign::map_list_of;
+using std::shared_ptr;
+using cv::Mat1b;
+using cv::Mat1f;
+
+namespace {
+
+typedef shared_ptr<base_LayerZKernel> (*LayerZKernelCreateFn)();
+typedef std::map<std::pair<int, int>, LayerZKernelCreateFn> LayerZKernelRegistry;
+
+template <int NB_AFFERENTS, int LEN_HISTORY>
+shared_ptr<base_LayerZKernel> CreateLayerZKernel()
+{
+    return shared_ptr<base_LayerZKernel>(new LayerZKernel<NB_AFFERENTS, LEN_HISTORY>());
+}
+
+} // annonymous namespace
+
+/** Macro for creating individual registry pair items, keyed on (no. of afferents, history length)
+ */
+#define LAYERZ_KERNEL_REGISTRY_PAIR(NB_AFFERENTS, LEN_HISTORY) (std::make_pair(NB_AFFERENTS, LEN_HISTORY), &CreateLayerZKernel<NB_AFFERENTS, LEN_HISTORY>)
+
+/** Production geometries: MNIST (28x28) and its on/off population code (2x28x28)
+ */
+LayerZKernelRegistry g_layerZKernelRegistry = map_list_of
+        LAYERZ_KERNEL_REGISTRY_PAIR( 784, 5 )
+        LAYERZ_KERNEL_REGISTRY_PAIR( 784, 10 )
+        LAYERZ_KERNEL_REGISTRY_PAIR( 1568, 5 )
+        LAYERZ_KERNEL_REGISTRY_PAIR( 1568, 10 )
+        ; ///< <-- add new geometry to registry here
+
+base_LayerZKernel::~base_LayerZKernel()
+{
+}
+
+base_LayerZKernel::base_LayerZKernel()
+{
+}
+
+const float* base_LayerZKernel::WeightsAll(const shared_ptr<base_Learner> &z)
+{
+    return std::static_pointer_cast<ZNeuron>(z)->WeightsAll().ptr<float>(0);
+}
+
+GenericLayerZKernel::GenericLayerZKernel(int nb_afferents, int len_history)
+    : base_LayerZKernel(),
+      nb_afferents_(nb_afferents),
+      len_history_(len_history)
+{
+}
+
+int GenericLayerZKernel::NbAfferents() const
+{
+    return nb_afferents_;
+}
+
+int GenericLayerZKernel::LenHistory() const
+{
+    return len_history_;
+}
+
+bool GenericLayerZKernel::IsSpecialized() const
+{
+    return false;
+}
+
+void GenericLayerZKernel::Potentials(const Mat1f &spikes_in, const VecLPtr &z, Mat1f &u)
+{
+    const int nb_outputs = static_cast<int>(z.size());
+    if(u.rows != 1 || u.cols != nb_outputs) {
+
+        u = Mat1f(1, nb_outputs);
+    }
+
+    Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+
+    for(int r=0; r<nb_outputs; r++) {
+
+        const float *w = WeightsAll(z[r]);
+        u(r) = w[0] + SIMDKernels::MaskedSum(w+1, x, nb_afferents_);
+    }
+}
+
+void GenericLayerZKernel::PushSkipped(const Mat1f &spikes_in, int nb_ticks)
+{
+    const int nb_keep = len_history_-1;
+    if(nb_keep < 1 || nb_ticks < 1) {
+
+        return;
+    }
+
+    Mat1b in = spikes_in.reshape(1, 1) != 0; // caller may reuse its buffer
+    for(int t=0; t<std::min(nb_ticks, nb_keep); t++) {
+
+        skipped_.push_back(in);
+    }
+    while(static_cast<int>(skipped_.size()) > nb_keep) {
+
+        skipped_.pop_front();
+    }
+}
+
+int GenericLayerZKernel::NbSkipped() const
+{
+    return static_cast<int>(skipped_.size());
+}
+
+Mat1b GenericLayerZKernel::Skipped(int t) const
+{
+    return skipped_[t];
+}
+
+void GenericLayerZKernel::ClearSkipped()
+{
+    skipped_.clear();
+}
+
+bool LayerZKernelFactory::IsRegistered(int nb_afferents, int len_history)
+{
+    return g_layerZKernelRegistry.find(std::make_pair(nb_afferents, len_history)) != g_layerZKernelRegistry.end();
+}
+
+shared_ptr<base_LayerZKernel> LayerZKernelFactory::CreateShared(int nb_afferents, int len_history, bool is_specialized)
+{
+    LayerZKernelRegistry::const_iterator itr = g_layerZKernelRegistry.find(std::make_pair(nb_afferents, len_history));
+    if(is_specialized && itr != g_layerZKernelRegistry.end()) {
+
+        return itr->second();
+    }
+    return shared_ptr<base_LayerZKernel>(new GenericLayerZKernel(nb_afferents, len_history));
+}
@@ -0,0 +1,278 @@
+#ifndef SEM_LAYERS_LAYERZKERNEL_H_
+#define SEM_LAYERS_LAYERZKERNEL_H_
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/neuron/base_learner.h"
+#include "sem/neuron/simdkernels.h"
+
+/**
+ * @brief Interface of LayerZ's per-tick kernels
+ *
+ * Computes membrane potentials of all neurons in one pass
+ * and keeps the input of skipped ticks still within the spiking history (see LayerZ::Skip()).
+ * Obtain instances through LayerZKernelFactory.
+ */
+class base_LayerZKernel
+{
+public:
+    typedef std::vector<std::shared_ptr<base_Learner> > VecLPtr; ///< vector of ZNeuron pointers
+
+    virtual ~base_LayerZKernel();
+
+    virtual int NbAfferents() const = 0;
+
+    virtual int LenHistory() const = 0;
+
+    /**
+     * @brief whether kernel is specialized for a fixed geometry
+     */
+    virtual bool IsSpecialized() const = 0;
+
+    /**
+     * @brief Compute membrane potentials of all neurons, u = bias + sum of weights of spiking afferents
+     * Does not touch the neurons' spiking histories
+     * @param input spikes, spiking if greater than zero
+     * @param ZNeuron instances
+     * @param[out] membrane potential per neuron, allocated unless matching
+     */
+    virtual void Potentials(const cv::Mat1f &spikes_in, const VecLPtr &z, cv::Mat1f &u) = 0;
+
+    /**
+     * @brief Record input of skipped ticks, only the most recent LenHistory()-1 are kept
+     * @param input spikes held over skipped ticks
+     * @param no. of ticks
+     */
+    virtual void PushSkipped(const cv::Mat1f &spikes_in, int nb_ticks) = 0;
+
+    /**
+     * @brief get no. of skipped inputs kept
+     */
+    virtual int NbSkipped() const = 0;
+
+    /**
+     * @brief get input of a skipped tick
+     * No deep copy, valid until the next call to PushSkipped() or ClearSkipped()
+     * @param index, oldest first
+     * @return spike mask, non-zero for spiking afferent
+     */
+    virtual cv::Mat1b Skipped(int t) const = 0;
+
+    virtual void ClearSkipped() = 0;
+
+protected:
+    base_LayerZKernel();
+
+    /**
+     * @brief get weights of a neuron
+     * @return pointer to bias followed by weights of all afferents
+     */
+    static const float* WeightsAll(const std::shared_ptr<base_Learner> &z);
+};
+
+/**
+ * @brief Kernel for any geometry, bounds known at runtime only
+ */
+class GenericLayerZKernel : public base_LayerZKernel
+{
+public:
+    GenericLayerZKernel(int nb_afferents, int len_history);
+
+    int NbAfferents() const;
+
+    int LenHistory() const;
+
+    bool IsSpecialized() const;
+
+    void Potentials(const cv::Mat1f &spikes_in, const VecLPtr &z, cv::Mat1f &u);
+
+    void PushSkipped(const cv::Mat1f &spikes_in, int nb_ticks);
+
+    int NbSkipped() const;
+
+    cv::Mat1b Skipped(int t) const;
+
+    void ClearSkipped();
+
+protected:
+    int nb_afferents_;                  ///< no. of afferents
+    int len_history_;                   ///< length of spiking history
+    std::deque<cv::Mat1b> skipped_;     ///< input of most recent skipped ticks
+};
+
+/**
+ * @brief Kernel specialized for a fixed no. of afferents and history length
+ *
+ * All buffers are statically sized, loops over afferents have compile-time bounds.
+ * Potentials gather the weights of spiking afferents for sparse input,
+ * and fall back to SIMDKernels::MaskedSum() over all afferents for dense input.
+ * Register new geometries in LayerZKernelFactory.
+ */
+template <int NB_AFFERENTS, int LEN_HISTORY>
+class LayerZKernel : public base_LayerZKernel
+{
+public:
+    LayerZKernel()
+        : base_LayerZKernel(),
+          first_(0),
+          nb_skipped_(0)
+    {
+    }
+
+    int NbAfferents() const
+    {
+        return NB_AFFERENTS;
+    }
+
+    int LenHistory() const
+    {
+        return LEN_HISTORY;
+    }
+
+    bool IsSpecialized() const
+    {
+        return true;
+    }
+
+    void Potentials(const cv::Mat1f &spikes_in, const VecLPtr &z, cv::Mat1f &u);
+
+    void PushSkipped(const cv::Mat1f &spikes_in, int nb_ticks);
+
+    int NbSkipped() const
+    {
+        return nb_skipped_;
+    }
+
+    cv::Mat1b Skipped(int t) const
+    {
+        return cv::Mat1b(1, NB_AFFERENTS, const_cast<uchar*>(skipped_[(first_+t)%NB_SLOTS]));
+    }
+
+    void ClearSkipped()
+    {
+        first_ = 0;
+        nb_skipped_ = 0;
+    }
+
+protected:
+    static const int NB_SLOTS = (LEN_HISTORY > 1)? LEN_HISTORY-1 : 1;  ///< capacity of skipped input ring
+    static const int MAX_GATHER = NB_AFFERENTS/8;                       ///< max. no. of spiking afferents to gather weights for
+
+    int active_[NB_AFFERENTS];                  ///< weight index of each spiking afferent, offset by bias
+    uchar skipped_[NB_SLOTS][NB_AFFERENTS];     ///< ring of skipped input spike masks
+    int first_;                                 ///< slot of oldest skipped input
+    int nb_skipped_;                            ///< no. of skipped inputs kept
+};
+
+template <int NB_AFFERENTS, int LEN_HISTORY>
+void LayerZKernel<NB_AFFERENTS, LEN_HISTORY>::Potentials(const cv::Mat1f &spikes_in, const VecLPtr &z, cv::Mat1f &u)
+{
+    const int nb_outputs = static_cast<int>(z.size());
+    if(u.rows != 1 || u.cols != nb_outputs) {
+
+        u = cv::Mat1f(1, nb_outputs);
+    }
+
+    cv::Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+
+    // branch-free compaction of spiking afferents
+    int nb_active = 0;
+    for(int j=0; j<NB_AFFERENTS; j++) {
+
+        active_[nb_active] = j+1;
+        nb_active += static_cast<int>(x[j] > 0.f);
+    }
+
+    float *pu = u.ptr<float>(0);
+    for(int r=0; r<nb_outputs; r++) {
+
+        const float *w = WeightsAll(z[r]);
+        float s = 0.f;
+        if(nb_active <= MAX_GATHER) {
+
+            for(int k=0; k<nb_active; k++) {
+
+                s += w[active_[k]];
+            }
+        }
+        else {
+
+            s = SIMDKernels::MaskedSum(w+1, x, NB_AFFERENTS);
+        }
+        pu[r] = w[0] + s;
+    }
+}
+
+template <int NB_AFFERENTS, int LEN_HISTORY>
+void LayerZKernel<NB_AFFERENTS, LEN_HISTORY>::PushSkipped(const cv::Mat1f &spikes_in, int nb_ticks)
+{
+    if(LEN_HISTORY < 2 || nb_ticks < 1) {
+
+        return;
+    }
+
+    cv::Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+
+    for(int t=0; t<std::min(nb_ticks, NB_SLOTS); t++) {
+
+        int slot;
+        if(nb_skipped_ < NB_SLOTS) {
+
+            slot = (first_+nb_skipped_++)%NB_SLOTS;
+        }
+        else {
+
+            // overwrite oldest
+            slot = first_;
+            first_ = (first_+1)%NB_SLOTS;
+        }
+
+        if(t == 0) {
+
+            for(int j=0; j<NB_AFFERENTS; j++) {
+
+                skipped_[slot][j] = (x[j] != 0.f)? 255 : 0;
+            }
+        }
+        else {
+
+            std::memcpy(skipped_[slot], skipped_[(slot+NB_SLOTS-1)%NB_SLOTS], NB_AFFERENTS);
+        }
+    }
+}
+
+/**
+ * @brief Create kernels for a layer's geometry
+ *
+ * Whenever a new geometry is to be specialized,
+ * add it to the initialization of g_layerZKernelRegistry in layerzkernel.cpp.
+ */
+class LayerZKernelFactory
+{
+public:
+    /**
+     * @brief whether a specialized kernel is registered for a geometry
+     * @param no. of afferents
+     * @param history length
+     */
+    static bool IsRegistered(int nb_afferents, int len_history);
+
+    /**
+     * @brief Create kernel for a geometry
+     * @param no. of afferents
+     * @param history length
+     * @param use specialized kernel if registered, generic kernel otherwise
+     * @return pointer to new kernel instance
+     */
+    static std::shared_ptr<base_LayerZKernel> CreateShared(int nb_afferents, int len_history, bool is_specialized=true);
+};
+
+#endif // SEM_LAYERS_LAYERZKERNEL_H_
@@ -0,0 +1,363 @@
+#include "sem/layers/layerzstack.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/layerionames.h"
+#include "elm/core/signal.h"
+
+using std::shared_ptr;
+using cv::Mat1f;
+using namespace elm;
+
+// I/O keys
+const std::string LayerZStack::KEY_INPUT_SPIKES     = LayerZ::KEY_INPUT_SPIKES;
+const std::string LayerZStack::KEY_OUTPUT_SPIKES    = LayerZ::KEY_OUTPUT_SPIKES;
+
+// Parameter keys
+const std::string LayerZStack::PARAM_NB_AFFERENTS   = LayerZ::PARAM_NB_AFFERENTS;
+const std::string LayerZStack::PARAM_STAGES         = "stages";
+const std::string LayerZStack::PARAM_PIPELINED      = "pipelined";
+
+// defaults
+const bool LayerZStack::DEFAULT_PIPELINED = true;
+
+namespace {
+
+const std::string NAME_STAGE_IN     = "in";     ///< input spikes within a stage's own signal
+const std::string NAME_STAGE_OUT    = "out";    ///< output spikes within a stage's own signal
+
+} // annonymous namespace
+
+LayerZStack::~LayerZStack()
+{
+    StopWorkers();
+}
+
+LayerZStack::LayerZStack()
+    : base_LearningLayer(),
+      is_pipelined_(DEFAULT_PIPELINED),
+      task_(TASK_ACTIVATE),
+      generation_(0),
+      nb_busy_(0)
+{
+}
+
+void LayerZStack::Clear()
+{
+    for(size_t k=0; k<stages_.size(); k++) {
+
+        stages_[k]->z->Clear();
+        stages_[k]->spikes_in.setTo(0.f);
+    }
+}
+
+void LayerZStack::Reset(const LayerConfig &config)
+{
+    StopWorkers();
+
+    PTree params = config.Params();
+    int nb_afferents = params.get<int>(PARAM_NB_AFFERENTS);
+
+    boost::optional<PTree&> stages_params = params.get_child_optional(PARAM_STAGES);
+    if(!stages_params || stages_params->empty()) {
+
+        ELM_THROW_VALUE_ERROR("Expecting parameters for at least one stage");
+    }
+
+    is_pipelined_ = params.get<bool>(PARAM_PIPELINED, DEFAULT_PIPELINED);
+
+    stages_.clear();
+    for(PTree::const_iterator itr=stages_params->begin(); itr != stages_params->end(); ++itr) {
+
+        PTree p = StageParams(params, itr->second);
+        p.put(LayerZ::PARAM_NB_AFFERENTS, nb_afferents);
+
+        LayerConfig cfg;
+        cfg.Params(p);
+        cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_STAGE_IN);
+        cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_STAGE_OUT);
+
+        shared_ptr<StageState> s(new StageState);
+        s->z.reset(new LayerZ);
+        s->z->Reset(cfg);
+        s->z->Bind(s->bound);
+        s->z->IONames(cfg);
+
+        // input slot refers to the hand-off buffer, written in place
+        s->spikes_in = Mat1f::zeros(1, nb_afferents);
+        s->in = s->bound.Bind(NAME_STAGE_IN);
+        s->in->Set(s->spikes_in);
+
+        s->rng = cv::RNG(static_cast<uint64>(cv::theRNG()()));
+        stages_.push_back(s);
+
+        nb_afferents = s->z->Spikes().cols;
+    }
+
+    StartWorkers();
+}
+
+void LayerZStack::Reconfigure(const LayerConfig &config)
+{
+    if(stages_.empty()) {
+
+        ELM_THROW_VALUE_ERROR("Nothing to reconfigure before a Reset");
+    }
+
+    PTree params = config.Params();
+    boost::optional<PTree&> stages_params = params.get_child_optional(PARAM_STAGES);
+
+    // validate everything before changing anything
+    if(params.get<int>(PARAM_NB_AFFERENTS, stages_[0]->spikes_in.cols) != stages_[0]->spikes_in.cols) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change no. of afferents without a Reset");
+    }
+
+    if(stages_params && static_cast<int>(stages_params->size()) != NbStages()) {
+
+        ELM_THROW_VALUE_ERROR("Cannot change no. of stages without a Reset");
+    }
+
+    std::vector<PTree> p(stages_.size(), StageParams(params, PTree()));
+    if(stages_params) {
+
+        int k=0;
+        for(PTree::const_iterator itr=stages_params->begin(); itr != stages_params->end(); ++itr) {
+
+            p[k++] = StageParams(params, itr->second);
+        }
+    }
+
+    for(int k=0; k<NbStages()-1; k++) {
+
+        const int nb_outputs = stages_[k]->z->Spikes().cols;
+        if(p[k].get<int>(LayerZ::PARAM_NB_OUTPUT_NODES, nb_outputs) != nb_outputs ||
+                p[k].get<bool>(LayerZ::PARAM_PRUNE, false)) {
+
+            ELM_THROW_VALUE_ERROR("Only the last stage may change its no. of outputs");
+        }
+    }
+
+    // workers idle in between ticks
+    for(int k=0; k<NbStages(); k++) {
+
+        p[k].erase(LayerZ::PARAM_NB_AFFERENTS);
+
+        LayerConfig cfg;
+        cfg.Params(p[k]);
+        stages_[k]->z->Reconfigure(cfg);
+    }
+
+    const bool is_pipelined = params.get<bool>(PARAM_PIPELINED, is_pipelined_);
+    if(is_pipelined != is_pipelined_) {
+
+        StopWorkers();
+        is_pipelined_ = is_pipelined;
+        StartWorkers();
+    }
+}
+
+void LayerZStack::InputNames(const LayerInputNames &in_names)
+{
+    name_input_spikes_ = in_names.Input(KEY_INPUT_SPIKES);
+}
+
+void LayerZStack::OutputNames(const LayerOutputNames &out_names)
+{
+    name_output_spikes_ = out_names.Output(KEY_OUTPUT_SPIKES);
+}
+
+void LayerZStack::Activate(const Signal &signal)
+{
+    // hand off most recent output downstream, last stage first
+    for(int k=NbStages()-1; k>0; k--) {
+
+        stages_[k-1]->z->Spikes().copyTo(stages_[k]->spikes_in); // same dims, in place
+    }
+    stages_[0]->in->Set(signal.MostRecentMat1f(name_input_spikes_));
+
+    Run(TASK_ACTIVATE);
+}
+
+void LayerZStack::Learn()
+{
+    Run(TASK_LEARN);
+}
+
+void LayerZStack::Learn(const cv::Mat1f &features, const cv::Mat1f &labels)
+{
+    for(int r=0; r<features.rows; r++) {
+
+        Signal s;
+        s.Append(name_input_spikes_, features.row(r));
+        Activate(s);
+        Learn();
+    }
+}
+
+void LayerZStack::Response(Signal &signal)
+{
+    signal.Append(name_output_spikes_, stages_.back()->z->Spikes());
+}
+
+int LayerZStack::NbStages() const
+{
+    return static_cast<int>(stages_.size());
+}
+
+int LayerZStack::Latency() const
+{
+    return NbStages()-1;
+}
+
+shared_ptr<LayerZ> LayerZStack::Stage(int k) const
+{
+    return stages_[k]->z;
+}
+
+bool LayerZStack::IsPipelined() const
+{
+    return is_pipelined_;
+}
+
+void LayerZStack::Run(Task task)
+{
+    if(workers_.empty()) {
+
+        for(int k=0; k<NbStages(); k++) {
+
+            RunStage(k, task);
+        }
+    }
+    else {
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = task;
+            nb_busy_ = static_cast<int>(workers_.size());
+            generation_++;
+        }
+        cv_task_.notify_all();
+
+        RunStage(0, task); // first stage on the caller's thread
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_done_.wait(lock, [this] { return nb_busy_ == 0; });
+    }
+
+    std::exception_ptr e;
+    for(size_t k=0; k<stages_.size(); k++) {
+
+        if(stages_[k]->error && !e) {
+
+            e = stages_[k]->error;
+        }
+        stages_[k]->error = std::exception_ptr();
+    }
+
+    if(e) {
+
+        std::rethrow_exception(e);
+    }
+}
+
+void LayerZStack::RunStage(int k, Task task)
+{
+    StageState &s = *stages_[k];
+
+    cv::RNG &rng = cv::theRNG();
+    const cv::RNG caller_rng = rng;
+    rng = s.rng;
+
+    try {
+
+        if(task == TASK_ACTIVATE) {
+
+            s.z->Activate(s.bound);
+        }
+        else if(task == TASK_LEARN) {
+
+            s.z->Learn();
+        }
+    }
+    catch(...) {
+
+        s.error = std::current_exception();
+    }
+
+    s.rng = rng;
+    rng = caller_rng;
+}
+
+void LayerZStack::StartWorkers()
+{
+    if(!is_pipelined_) {
+
+        return;
+    }
+
+    for(int k=1; k<NbStages(); k++) {
+
+        workers_.push_back(std::thread(&LayerZStack::WorkerLoop, this, k, generation_));
+    }
+}
+
+void LayerZStack::StopWorkers()
+{
+    if(workers_.empty()) {
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = TASK_STOP;
+        generation_++;
+    }
+    cv_task_.notify_all();
+
+    for(size_t i=0; i<workers_.size(); i++) {
+
+        workers_[i].join();
+    }
+    workers_.clear();
+}
+
+void LayerZStack::WorkerLoop(int k, unsigned long long generation)
+{
+    for(;;) {
+
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_task_.wait(lock, [this, generation] { return generation_ != generation; });
+            generation = generation_;
+            task = task_;
+        }
+
+        if(task == TASK_STOP) {
+
+            return;
+        }
+
+        RunStage(k, task);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(--nb_busy_ == 0) {
+
+            cv_done_.notify_one();
+        }
+    }
+}
+
+PTree LayerZStack::StageParams(const PTree &params, const PTree &stage_params)
+{
+    PTree p = params;
+    p.erase(PARAM_STAGES);
+    p.erase(PARAM_PIPELINED);
+
+    for(PTree::const_iterator itr=stage_params.begin(); itr != stage_params.end(); ++itr) {
+
+        p.put_child(itr->first, itr->second);
+    }
+    return p;
+}
@@ -0,0 +1,178 @@
+#ifndef SEM_LAYERS_LAYERZSTACK_H_
+#define SEM_LAYERS_LAYERZSTACK_H_
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "elm/core/layerconfig.h"   // OptS member definition
+#include "elm/layers/layers_interim/base_LearningLayer.h"
+#include "sem/layers/boundsignal.h"
+#include "sem/layers/layer_z.h"
+
+/**
+ * @brief Hierarchy of Z layers, each stage's output spikes feeding the next stage's input spikes
+ *
+ * Stages are pipelined: on every tick, stage k processes what stage k-1 put out on the previous tick,
+ * such that all stages activate and learn concurrently, one thread per stage.
+ * The last stage's output lags the input by Latency() ticks, stages further down see silence until then.
+ *
+ * Each stage draws from its own random number generator, seeded on Reset(),
+ * such that outcomes do not depend on which thread runs a stage. Pipelined and serial execution yield the same spikes.
+ *
+ * Stages are configured through a child of the parameters with one child per stage,
+ * each holding the LayerZ parameters of that stage. Stage parameters default to those at the top level,
+ * the no. of afferents of all but the first stage follows from the previous stage's no. of outputs.
+ */
+class LayerZStack : public elm::base_LearningLayer
+{
+public:
+    // I/O keys
+    static const std::string KEY_INPUT_SPIKES;        ///< key to input spikes of first stage
+    static const std::string KEY_OUTPUT_SPIKES;       ///< key to output spikes of last stage
+
+    // Parmater keys, parameters with defaults are optional
+    static const std::string PARAM_NB_AFFERENTS;      ///< no. of afferent inputs to first stage
+    static const std::string PARAM_STAGES;            ///< child with LayerZ parameters per stage, in order, at least one
+    static const std::string PARAM_PIPELINED;         ///< run stages concurrently on their own threads
+
+    static const bool DEFAULT_PIPELINED;              ///< = true;
+
+    ~LayerZStack();
+
+    LayerZStack();
+
+    void Clear();
+
+    void Reset(const elm::LayerConfig &config);
+
+    /**
+     * @brief Change parameters of live stages, see LayerZ::Reconfigure()
+     * Top-level parameters apply to all stages, followed by per-stage parameters if given.
+     * Only the last stage may change its no. of outputs.
+     * @param config with parameters to change
+     * @throws ExceptionValueError on a different no. of stages or a change to the hierarchy's geometry
+     */
+    void Reconfigure(const elm::LayerConfig &config);
+
+    virtual void InputNames(const elm::LayerInputNames& in_names);
+
+    virtual void OutputNames(const elm::LayerOutputNames& out_names);
+
+    /**
+     * @brief Advance all stages by one tick
+     * Hands each stage's most recent output spikes to the next stage, then activates all stages
+     */
+    void Activate(const elm::Signal &signal);
+
+    /**
+     * @brief Apply STDP in all stages for learning from their most recent input
+     */
+    void Learn();
+
+    void Learn(const cv::Mat1f& features, const cv::Mat1f &labels);
+
+    void Response(elm::Signal &signal);
+
+    /**
+     * @brief get no. of stages
+     */
+    int NbStages() const;
+
+    /**
+     * @brief get no. of ticks the last stage's output lags the input
+     * @return no. of stages-1
+     */
+    int Latency() const;
+
+    /**
+     * @brief get stage, e.g. for inspecting its weights
+     * Not while Activate() or Learn() are running
+     * @param index of stage, 0 for the first
+     * @return pointer to stage
+     */
+    std::shared_ptr<LayerZ> Stage(int k) const;
+
+    bool IsPipelined() const;
+
+protected:
+    /**
+     * @brief Stage of the hierarchy with its input and random state
+     */
+    struct StageState
+    {
+        std::shared_ptr<LayerZ> z;      ///< layer
+        BoundSignal bound;              ///< layer's I/O
+        BoundSignal::Slot *in;          ///< input spikes slot, refers to spikes_in
+        cv::Mat1f spikes_in;            ///< input spikes, handed over from previous stage
+        cv::RNG rng;                    ///< stage's own random number generator
+        std::exception_ptr error;       ///< error of most recent task, if any
+    };
+
+    enum Task {
+        TASK_ACTIVATE = 0,
+        TASK_LEARN,
+        TASK_STOP
+    };
+
+    /**
+     * @brief Run task on all stages and wait for it to complete
+     * @param task
+     * @throws first error raised by any stage
+     */
+    void Run(Task task);
+
+    /**
+     * @brief Run task on a single stage with the stage's random number generator
+     * Errors are kept for rethrowing on the calling thread
+     * @param index of stage
+     * @param task
+     */
+    void RunStage(int k, Task task);
+
+    /**
+     * @brief Start one worker thread per stage but the first, which runs on the caller's thread
+     * Only when pipelined
+     */
+    void StartWorkers();
+
+    /**
+     * @brief Stop and join worker threads
+     */
+    void StopWorkers();
+
+    /**
+     * @brief Worker thread's loop, running tasks on a single stage
+     * @param index of stage
+     * @param no. of tasks handed out before the worker started
+     */
+    void WorkerLoop(int k, unsigned long long generation);
+
+    /**
+     * @brief Compose parameters of a single stage
+     * @param top-level parameters
+     * @param stage parameters, override top-level
+     * @return LayerZ parameters
+     */
+    static elm::PTree StageParams(const elm::PTree &params, const elm::PTree &stage_params);
+
+    std::string name_input_spikes_;         ///< name of input spikes in signal object
+    std::string name_output_spikes_;        ///< destination of output spikes in signal object
+
+    std::vector<std::shared_ptr<StageState> > stages_;  ///< stages in order
+    bool is_pipelined_;                     ///< pipelined execution flag
+
+    std::vector<std::thread> workers_;      ///< worker threads, one per stage but the first
+    std::mutex mutex_;                      ///< guards task hand-off between caller and workers
+    std::condition_variable cv_task_;       ///< signals workers a new task
+    std::condition_variable cv_done_;       ///< signals caller that all workers completed
+    Task task_;                             ///< most recent task
+    unsigned long long generation_;         ///< no. of tasks handed out, workers run each one once
+    int nb_busy_;                           ///< no. of workers yet to complete the most recent task
+};
+
+#endif // SEM_LAYERS_LAYERZSTACK_H_
@@ -0,0 +1,77 @@
+#include "sem/layers/layerzstream.h"
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+LayerZStream::LayerZStream(int nb_afferents, int nb_outputs, int len_history, float wta_f, float delta_t, int nb_columns)
+    : nb_afferents_(nb_afferents),
+      history_(nb_afferents, len_history),
+      u_(Mat1f::zeros(1, nb_outputs)),
+      spikes_out_(Mat1f::zeros(1, nb_outputs))
+{
+    if(nb_columns < 1 || nb_outputs % nb_columns != 0) {
+
+        ELM_THROW_VALUE_ERROR("No. of outputs must be a multiple of the no. of columns");
+    }
+
+    // each column draws its own spike times
+    for(int c=0; c<nb_columns; c++) {
+
+        wta_.push_back(WTAPoisson(wta_f, delta_t));
+    }
+    distr_ = Mat1f(1, nb_outputs);
+}
+
+void LayerZStream::Activate(const WeightsSnapshot &params, const Mat1f &spikes_in)
+{
+    if(params.NbAfferents() != nb_afferents_ || params.NbOutputs() != NbOutputs()) {
+
+        ELM_THROW_BAD_DIMS("Weights do not match the stream's no. of afferents and outputs");
+    }
+
+    params.Potentials(spikes_in, u_); // checks input dims
+
+    const int column_size = NbOutputs()/static_cast<int>(wta_.size());
+    for(int c=0; c<static_cast<int>(wta_.size()); c++) {
+
+        // in place, column headers match
+        Mat1f distr_column = distr_.colRange(c*column_size, (c+1)*column_size);
+        Mat1f spikes_column = spikes_out_.colRange(c*column_size, (c+1)*column_size);
+        wta_[c].Compete(u_.colRange(c*column_size, (c+1)*column_size), distr_column, spikes_column);
+    }
+
+    cv::compare(spikes_in.reshape(1, 1), 0.f, is_spiking_, CMP_NE);
+    history_.Advance();
+    history_.Update(is_spiking_);
+}
+
+const Mat1f& LayerZStream::MembranePotentials() const
+{
+    return u_;
+}
+
+const Mat1f& LayerZStream::Spikes() const
+{
+    return spikes_out_;
+}
+
+Mat LayerZStream::RecentAfferents() const
+{
+    return history_.Recent();
+}
+
+void LayerZStream::Clear()
+{
+    history_.Reset();
+}
+
+int LayerZStream::NbAfferents() const
+{
+    return nb_afferents_;
+}
+
+int LayerZStream::NbOutputs() const
+{
+    return u_.cols;
+}
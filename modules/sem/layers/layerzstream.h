@@ -0,0 +1,85 @@
+#ifndef SEM_LAYERS_LAYERZSTREAM_H_
+#define SEM_LAYERS_LAYERZSTREAM_H_
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/neuron/spikinghistory.h"
+#include "sem/layers/weightssnapshot.h"
+#include "sem/neuron/wtapoisson.h"
+
+/**
+ * @brief State of a single input stream through a layer of Z neurons
+ *
+ * Everything a stream needs besides the layer's weights: the afferents' spiking history,
+ * the timing of the WTA circuit of each column, membrane potentials and output spikes of the most recent tick.
+ * Its size is proportional to the history, the weights live in a WeightsSnapshot shared by all streams.
+ * Unlike LayerZ, which keeps a history per neuron, all neurons of a stream share one history of their afferents.
+ *
+ * Streams are independent of each other, each one may run on its own thread
+ * against the same snapshot. A single stream is not thread-safe.
+ * Create through LayerZ::CreateStream(), learn from one through LayerZ::Learn(const LayerZStream&).
+ */
+class LayerZStream
+{
+public:
+    /**
+     * @brief Create stream state
+     * @param no. of afferents
+     * @param no. of output neurons
+     * @param spiking history length
+     * @param WTA's spiking frequency [Hz]
+     * @param spike time resolution [milliseconds]
+     * @param no. of WTA columns, each competing among an equal group of consecutive neurons, see LayerZ::NbColumns()
+     */
+    LayerZStream(int nb_afferents, int nb_outputs, int len_history, float wta_f, float delta_t, int nb_columns=1);
+
+    /**
+     * @brief Compute membrane potentials and let neurons compete on a stimulus
+     * @param weights shared by all streams
+     * @param input spikes, non-zero for spiking afferent
+     * @throws ExceptionBadDims if input or weights do not match the stream's geometry
+     */
+    void Activate(const WeightsSnapshot &params, const cv::Mat1f &spikes_in);
+
+    /**
+     * @brief get membrane potentials of most recent tick
+     * No deep copy, overwritten on next Activate()
+     */
+    const cv::Mat1f& MembranePotentials() const;
+
+    /**
+     * @brief get output spikes of most recent tick
+     * No deep copy, overwritten on next Activate()
+     * @return 255 for the winner of each column, 0 otherwise
+     */
+    const cv::Mat1f& Spikes() const;
+
+    /**
+     * @brief get afferents that spiked within the history
+     * @return 8-bit mask, non-zero for afferent spiking recently
+     */
+    cv::Mat RecentAfferents() const;
+
+    /**
+     * @brief Clear spiking history, keep WTA timing
+     */
+    void Clear();
+
+    int NbAfferents() const;
+
+    int NbOutputs() const;
+
+protected:
+    int nb_afferents_;              ///< no. of afferents
+    SpikingHistory history_;        ///< spiking history of afferents, shared by all neurons
+    std::vector<WTAPoisson> wta_;   ///< winner-take-all timing of this stream, one per column
+
+    cv::Mat1f u_;                   ///< membrane potential per neuron from most recent stimulus
+    cv::Mat1f spikes_out_;          ///< output spikes of most recent tick
+    cv::Mat1f distr_;               ///< scratch buffer for the state distribution
+    cv::Mat1b is_spiking_;          ///< scratch buffer for the input spike mask
+};
+
+#endif // SEM_LAYERS_LAYERZSTREAM_H_
@@ -0,0 +1,202 @@
+#include "sem/layers/layerzsweep.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/layerconfig.h"
+
+using std::shared_ptr;
+using cv::Mat1f;
+using namespace elm;
+
+namespace {
+
+const std::string NAME_INSTANCE_IN     = "in";     ///< input spikes within an instance's own signal
+const std::string NAME_INSTANCE_OUT    = "out";    ///< output spikes within an instance's own signal
+
+} // annonymous namespace
+
+/**
+ * @brief Present a stimulus to a range of instances
+ */
+class LayerZSweep::ParallelPresent : public cv::ParallelLoopBody
+{
+public:
+    /**
+     * @brief body of parallel loop
+     * @param sweep
+     * @param encoded stimulus
+     * @param label
+     */
+    ParallelPresent(LayerZSweep *sweep, const Mat1f &raster, int label)
+        : sweep_(sweep),
+          raster_(raster),
+          label_(label)
+    {
+    }
+
+    virtual void operator()(const cv::Range &range) const
+    {
+        for(int i=range.start; i<range.end; i++) {
+
+            sweep_->PresentInstance(i, raster_, label_);
+        }
+    }
+
+protected:
+    LayerZSweep *sweep_;    ///< sweep owning the instances
+    Mat1f raster_;          ///< encoded stimulus, shared by all instances
+    int label_;             ///< ground-truth label
+};
+
+std::vector<PTree> LayerZSweep::Grid(const PTree &base, const std::vector<Axis> &axes)
+{
+    std::vector<PTree> grid(1, base);
+    for(size_t a=0; a<axes.size(); a++) {
+
+        const Axis &axis = axes[a];
+        if(axis.second.empty()) {
+
+            ELM_THROW_VALUE_ERROR("Expecting at least one value for " + axis.first);
+        }
+
+        std::vector<PTree> expanded;
+        expanded.reserve(grid.size()*axis.second.size());
+        for(size_t g=0; g<grid.size(); g++) {
+
+            for(size_t v=0; v<axis.second.size(); v++) {
+
+                PTree p = grid[g];
+                p.put(axis.first, axis.second[v]);
+                expanded.push_back(p);
+            }
+        }
+        grid.swap(expanded);
+    }
+    return grid;
+}
+
+LayerZSweep::LayerZSweep()
+    : nb_labels_(0)
+{
+}
+
+void LayerZSweep::Reset(const std::vector<PTree> &configs,
+                        int nb_labels,
+                        const PresentationController &presentation)
+{
+    if(configs.empty()) {
+
+        ELM_THROW_VALUE_ERROR("Expecting at least one configuration to sweep over");
+    }
+
+    instances_.clear();
+    nb_labels_ = nb_labels;
+    for(size_t i=0; i<configs.size(); i++) {
+
+        LayerConfig cfg;
+        cfg.Params(configs[i]);
+        cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_INSTANCE_IN);
+        cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_INSTANCE_OUT);
+
+        shared_ptr<Instance> s(new Instance);
+        s->params = configs[i];
+        s->z.reset(new LayerZ);
+        s->z->Reset(cfg);
+        s->z->Bind(s->bound);
+        s->z->IONames(cfg);
+        s->in = s->bound.Bind(NAME_INSTANCE_IN);
+
+        s->eval.Reset(static_cast<int>(s->z->Bias().total()), nb_labels);
+        s->presentation = presentation;
+        s->rng = cv::RNG(static_cast<uint64>(cv::theRNG()()));
+        instances_.push_back(s);
+    }
+}
+
+void LayerZSweep::Present(const Mat1f &raster, int label)
+{
+    if(raster.empty()) {
+
+        ELM_THROW_BAD_DIMS("Expecting at least one tick of input spikes");
+    }
+
+    if(label < 0 || label >= nb_labels_) {
+
+        ELM_THROW_BAD_DIMS("Label out of range.");
+    }
+
+    cv::parallel_for_(cv::Range(0, NbInstances()), ParallelPresent(this, raster, label));
+
+    std::exception_ptr e;
+    for(size_t i=0; i<instances_.size(); i++) {
+
+        if(instances_[i]->error && !e) {
+
+            e = instances_[i]->error;
+        }
+        instances_[i]->error = std::exception_ptr();
+    }
+
+    if(e) {
+
+        std::rethrow_exception(e);
+    }
+}
+
+void LayerZSweep::PresentInstance(int i, const Mat1f &raster, int label)
+{
+    Instance &s = *instances_[i];
+
+    cv::RNG &rng = cv::theRNG();
+    const cv::RNG caller_rng = rng;
+    rng = s.rng;
+
+    try {
+
+        s.presentation.Start();
+        bool is_done = false;
+        for(int t=0; t<raster.rows && !is_done; t++) {
+
+            s.in->Set(raster.row(t));
+            s.z->Activate(s.bound);
+            s.z->Learn();
+
+            const Mat1f spikes = s.z->Spikes();
+            s.eval.Update(spikes, label);
+            is_done = s.presentation.Tick(spikes,
+                                          s.presentation.NeedsStateDistr()? s.z->StateDistr() : Mat1f());
+        }
+        s.z->Clear(); // clear before moving on to the next stimulus
+    }
+    catch(...) {
+
+        s.error = std::current_exception();
+    }
+
+    s.rng = rng;
+    rng = caller_rng;
+}
+
+int LayerZSweep::NbInstances() const
+{
+    return static_cast<int>(instances_.size());
+}
+
+const PTree& LayerZSweep::Params(int i) const
+{
+    return instances_[i]->params;
+}
+
+const OnlineClusterEval& LayerZSweep::Evaluation(int i) const
+{
+    return instances_[i]->eval;
+}
+
+const PresentationController& LayerZSweep::Presentation(int i) const
+{
+    return instances_[i]->presentation;
+}
+
+shared_ptr<LayerZ> LayerZSweep::Layer(int i) const
+{
+    return instances_[i]->z;
+}
@@ -0,0 +1,124 @@
+#ifndef SEM_LAYERS_LAYERZSWEEP_H_
+#define SEM_LAYERS_LAYERZSWEEP_H_
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/typedefs_fwd.h"
+#include "sem/eval/onlineclustereval.h"
+#include "sem/layers/boundsignal.h"
+#include "sem/layers/layer_z.h"
+#include "sem/layers/presentationcontroller.h"
+
+/**
+ * @brief Evaluate a grid of LayerZ configurations in a single pass over the data
+ *
+ * Each stimulus is encoded once by the caller into a raster of input spikes, one row per tick.
+ * The same raster is presented to every instance, instances run in parallel (cv::parallel_for_),
+ * each with its own layer, presentation controller, online evaluation and random number generator.
+ * Outcomes do not depend on the no. of threads.
+ *
+ * Instances only differ in their LayerZ parameters, e.g. those of a Grid().
+ */
+class LayerZSweep
+{
+public:
+    typedef std::pair<std::string, std::vector<std::string> > Axis; ///< parameter key and values to sweep over
+
+    /**
+     * @brief Cartesian product of parameter values
+     * @param parameters shared by all configurations
+     * @param axes to sweep over, the last one varying fastest
+     * @return one set of parameters per grid point
+     */
+    static std::vector<elm::PTree> Grid(const elm::PTree &base, const std::vector<Axis> &axes);
+
+    LayerZSweep();
+
+    /**
+     * @brief Create one instance per configuration
+     * Instances seed their random number generator from cv::theRNG()
+     * @param LayerZ parameters per instance, without I/O names
+     * @param no. of ground-truth labels
+     * @param presentation length, applies to all instances
+     * @throws ExceptionValueError for an empty grid, as well as errors of LayerZ::Reset()
+     */
+    void Reset(const std::vector<elm::PTree> &configs,
+               int nb_labels,
+               const PresentationController &presentation=PresentationController());
+
+    /**
+     * @brief Present a stimulus to all instances, learning while presented
+     * Each instance consumes rows of the raster until its presentation ends, or runs out of rows
+     * @param encoded stimulus, one row of input spikes per tick
+     * @param ground-truth label of the stimulus
+     * @throws ExceptionBadDims for an empty raster or a label out of range
+     * @throws first error raised by any instance
+     */
+    void Present(const cv::Mat1f &raster, int label);
+
+    int NbInstances() const;
+
+    /**
+     * @brief get parameters of an instance
+     * @param index of instance
+     */
+    const elm::PTree& Params(int i) const;
+
+    /**
+     * @brief get online evaluation of an instance
+     * @param index of instance
+     */
+    const OnlineClusterEval& Evaluation(int i) const;
+
+    /**
+     * @brief get presentation statistics of an instance
+     * @param index of instance
+     */
+    const PresentationController& Presentation(int i) const;
+
+    /**
+     * @brief get layer of an instance, e.g. for inspecting its weights
+     * Not while Present() is running
+     * @param index of instance
+     */
+    std::shared_ptr<LayerZ> Layer(int i) const;
+
+protected:
+    /**
+     * @brief Single configuration with its own state
+     */
+    struct Instance
+    {
+        elm::PTree params;                      ///< LayerZ parameters
+        std::shared_ptr<LayerZ> z;              ///< layer
+        BoundSignal bound;                      ///< layer's I/O
+        BoundSignal::Slot *in;                  ///< input spikes slot
+        OnlineClusterEval eval;                 ///< winner-vs-label evaluation
+        PresentationController presentation;    ///< presentation length
+        cv::RNG rng;                            ///< instance's own random number generator
+        std::exception_ptr error;               ///< error of most recent presentation, if any
+    };
+
+    class ParallelPresent;
+    friend class ParallelPresent;
+
+    /**
+     * @brief Present stimulus to a single instance with the instance's random number generator
+     * Errors are kept for rethrowing on the calling thread
+     * @param index of instance
+     * @param encoded stimulus
+     * @param label
+     */
+    void PresentInstance(int i, const cv::Mat1f &raster, int label);
+
+    std::vector<std::shared_ptr<Instance> > instances_;  ///< one per configuration
+    int nb_labels_;                                     ///< no. of ground-truth labels
+};
+
+#endif // SEM_LAYERS_LAYERZSWEEP_H_
@@ -0,0 +1,135 @@
+#include "sem/layers/presentationcontroller.h"
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+const int PresentationController::DEFAULT_MAX_TICKS = 20;
+
+PresentationController::PresentationController()
+    : max_ticks_(DEFAULT_MAX_TICKS),
+      min_ticks_(1),
+      nb_spikes_stop_(0),
+      confidence_stop_(0.f),
+      nb_ticks_(0),
+      nb_spikes_(0),
+      confidence_(0.f),
+      reason_(STOP_NONE),
+      total_ticks_(0),
+      nb_presentations_(0)
+{
+}
+
+PresentationController::PresentationController(int max_ticks, int nb_spikes, float confidence, int min_ticks)
+    : max_ticks_(max_ticks),
+      min_ticks_(min_ticks),
+      nb_spikes_stop_(nb_spikes),
+      confidence_stop_(confidence),
+      nb_ticks_(0),
+      nb_spikes_(0),
+      confidence_(0.f),
+      reason_(STOP_NONE),
+      total_ticks_(0),
+      nb_presentations_(0)
+{
+    if(max_ticks < 1) {
+
+        ELM_THROW_VALUE_ERROR("Max. no. of ticks must be > 0");
+    }
+
+    if(min_ticks < 1 || min_ticks > max_ticks) {
+
+        ELM_THROW_VALUE_ERROR("Min. no. of ticks must be in [1, max. no. of ticks]");
+    }
+
+    if(nb_spikes < 0) {
+
+        ELM_THROW_VALUE_ERROR("No. of WTA spikes must be >= 0");
+    }
+
+    if(confidence < 0.f || confidence > 1.f) {
+
+        ELM_THROW_VALUE_ERROR("Confidence must be in [0, 1]");
+    }
+}
+
+void PresentationController::Start()
+{
+    nb_ticks_ = 0;
+    nb_spikes_ = 0;
+    confidence_ = 0.f;
+    reason_ = STOP_NONE;
+    nb_presentations_++;
+}
+
+bool PresentationController::Tick(const Mat1f &spikes, const Mat1f &state_distr)
+{
+    nb_ticks_++;
+    total_ticks_++;
+    nb_spikes_ += countNonZero(spikes);
+
+    if(confidence_stop_ > 0.f && !state_distr.empty()) {
+
+        double max_p;
+        minMaxIdx(state_distr, 0, &max_p);
+        confidence_ = static_cast<float>(max_p);
+    }
+
+    if(nb_ticks_ >= max_ticks_) {
+
+        reason_ = STOP_MAX_TICKS;
+    }
+    else if(nb_ticks_ >= min_ticks_) {
+
+        if(nb_spikes_stop_ > 0 && nb_spikes_ >= nb_spikes_stop_) {
+
+            reason_ = STOP_SPIKES;
+        }
+        else if(confidence_stop_ > 0.f && confidence_ >= confidence_stop_) {
+
+            reason_ = STOP_CONFIDENCE;
+        }
+    }
+
+    return IsDone();
+}
+
+bool PresentationController::NeedsStateDistr() const
+{
+    return confidence_stop_ > 0.f;
+}
+
+bool PresentationController::IsDone() const
+{
+    return reason_ != STOP_NONE;
+}
+
+PresentationController::StopReason PresentationController::Reason() const
+{
+    return reason_;
+}
+
+int PresentationController::NbTicks() const
+{
+    return nb_ticks_;
+}
+
+int PresentationController::NbSpikes() const
+{
+    return nb_spikes_;
+}
+
+float PresentationController::Confidence() const
+{
+    return confidence_;
+}
+
+unsigned long long PresentationController::TotalTicks() const
+{
+    return total_ticks_;
+}
+
+unsigned long long PresentationController::NbPresentations() const
+{
+    return nb_presentations_;
+}
@@ -0,0 +1,108 @@
+#ifndef SEM_LAYERS_PRESENTATIONCONTROLLER_H_
+#define SEM_LAYERS_PRESENTATIONCONTROLLER_H_
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Decide how long to present a stimulus from WTA activity
+ *
+ * A presentation ends after a given no. of WTA spikes,
+ * or once the softmax posterior over neurons is confident enough,
+ * or when reaching a max. no. of ticks, whichever comes first.
+ * Easy stimuli end early, hard ones run up to the cap.
+ *
+ * @see LayerZ::Spikes(), LayerZ::StateDistr()
+ */
+class PresentationController
+{
+public:
+    /** Reason for ending a presentation
+     */
+    enum StopReason {
+        STOP_NONE = 0,      ///< presentation still running
+        STOP_SPIKES,        ///< reached no. of WTA spikes
+        STOP_CONFIDENCE,    ///< posterior confident enough
+        STOP_MAX_TICKS      ///< reached max. no. of ticks
+    };
+
+    static const int DEFAULT_MAX_TICKS;     ///< = 20, same as a fixed length presentation
+
+    /**
+     * @brief Construct controller for fixed length presentations of DEFAULT_MAX_TICKS
+     */
+    PresentationController();
+
+    /**
+     * @brief Construct controller
+     * @param max. no. of ticks per presentation
+     * @param no. of WTA spikes to end a presentation, 0 to disable
+     * @param min. max. posterior probability to end a presentation, 0 to disable
+     * @param min. no. of ticks per presentation
+     * @throws ExceptionValueError on invalid parameters
+     */
+    PresentationController(int max_ticks, int nb_spikes, float confidence, int min_ticks=1);
+
+    /**
+     * @brief Start presenting a new stimulus
+     */
+    void Start();
+
+    /**
+     * @brief Record a simulation tick of the current presentation
+     * @param WTA output spikes, non-zero for spiking neuron
+     * @param softmax posterior over neurons, may be empty when confidence criterion is disabled
+     * @return true when the presentation should end
+     */
+    bool Tick(const cv::Mat1f &spikes, const cv::Mat1f &state_distr=cv::Mat1f());
+
+    /**
+     * @brief Whether the confidence criterion is enabled
+     * Lets callers skip computing the posterior otherwise
+     */
+    bool NeedsStateDistr() const;
+
+    bool IsDone() const;
+
+    StopReason Reason() const;
+
+    /**
+     * @brief get no. of ticks of current presentation
+     */
+    int NbTicks() const;
+
+    /**
+     * @brief get no. of WTA spikes during current presentation
+     */
+    int NbSpikes() const;
+
+    /**
+     * @brief get max. posterior probability of most recent tick
+     */
+    float Confidence() const;
+
+    /**
+     * @brief get no. of ticks over all presentations so far
+     */
+    unsigned long long TotalTicks() const;
+
+    /**
+     * @brief get no. of started presentations
+     */
+    unsigned long long NbPresentations() const;
+
+protected:
+    int max_ticks_;                 ///< max. no. of ticks per presentation
+    int min_ticks_;                 ///< min. no. of ticks per presentation
+    int nb_spikes_stop_;            ///< no. of WTA spikes to end a presentation, 0 for disabled
+    float confidence_stop_;         ///< posterior confidence to end a presentation, 0 for disabled
+
+    int nb_ticks_;                  ///< ticks of current presentation
+    int nb_spikes_;                 ///< WTA spikes of current presentation
+    float confidence_;              ///< max. posterior of most recent tick
+    StopReason reason_;             ///< reason for ending current presentation
+
+    unsigned long long total_ticks_;        ///< ticks over all presentations
+    unsigned long long nb_presentations_;   ///< no. of presentations
+};
+
+#endif // SEM_LAYERS_PRESENTATIONCONTROLLER_H_
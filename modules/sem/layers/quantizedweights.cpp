@@ -0,0 +1,226 @@
+#include "sem/layers/quantizedweights.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+const int QuantizedWeights::DEPTH_8 = 8;
+const int QuantizedWeights::DEPTH_16 = 16;
+
+QuantizedWeights::QuantizedWeights()
+    : depth_(DEPTH_8),
+      offset_(0.f),
+      scale_(0.f)
+{
+}
+
+QuantizedWeights::QuantizedWeights(const Mat1f &weights, const Mat1f &bias, int depth)
+    : depth_(depth),
+      offset_(0.f),
+      scale_(0.f)
+{
+    if(depth != DEPTH_8 && depth != DEPTH_16) {
+
+        ELM_THROW_VALUE_ERROR("Quantization depth must be 8 or 16 bits");
+    }
+
+    if(bias.total() != static_cast<size_t>(weights.rows)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one bias term per row of weights");
+    }
+
+    // calibrate grid to range of weights
+    double w_min = 0., w_max = 0.;
+    if(!weights.empty()) {
+
+        minMaxIdx(weights, &w_min, &w_max);
+    }
+    const double q_max = static_cast<double>((1 << depth)-1);
+
+    offset_ = static_cast<float>(w_min);
+    scale_ = (w_max > w_min)? static_cast<float>((w_max-w_min)/q_max) : 1.f;
+
+    // saturate_cast rounds to nearest
+    weights.convertTo(q_, (depth == DEPTH_8)? CV_8U : CV_16U, 1./scale_, -w_min/scale_);
+
+    bias_ = bias.reshape(1, 1).clone();
+}
+
+template <typename T>
+unsigned long long QuantizedWeights::Accumulate(const T *q, const int *active, int nb_active)
+{
+    unsigned long long sum = 0;
+    for(int i=0; i<nb_active; i++) {
+
+        sum += q[active[i]];
+    }
+    return sum;
+}
+
+void QuantizedWeights::Potentials(const Mat1f &spikes_in, Mat1f &u) const
+{
+    if(spikes_in.total() != static_cast<size_t>(q_.cols)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one input spike per afferent");
+    }
+
+    // gather spiking afferents once for all neurons
+    Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+    std::vector<int> active;
+    active.reserve(q_.cols);
+    for(int i=0; i<q_.cols; i++) {
+
+        if(x[i] != 0.f) {
+
+            active.push_back(i);
+        }
+    }
+    const int nb_active = static_cast<int>(active.size());
+    const int *idx = active.empty()? 0 : &active[0];
+
+    if(u.rows != 1 || u.cols != q_.rows) {
+
+        u = Mat1f(1, q_.rows);
+    }
+    const float *b = bias_.ptr<float>(0);
+    for(int r=0; r<q_.rows; r++) {
+
+        unsigned long long sum = (depth_ == DEPTH_8)?
+                    Accumulate(q_.ptr<uchar>(r), idx, nb_active) :
+                    Accumulate(q_.ptr<ushort>(r), idx, nb_active);
+
+        u(r) = static_cast<float>(b[r] +
+                                  static_cast<double>(nb_active)*offset_ +
+                                  static_cast<double>(sum)*scale_);
+    }
+}
+
+QuantizationReport QuantizedWeights::Compare(const Mat1f &weights, const Mat1f &bias, const Mat1f &samples) const
+{
+    QuantizationReport report;
+    for(int s=0; s<samples.rows; s++) {
+
+        Compare(weights, bias, samples.row(s), report);
+    }
+    return report;
+}
+
+void QuantizedWeights::Compare(const Mat1f &weights, const Mat1f &bias, const Mat1f &spikes_in, QuantizationReport &report) const
+{
+    if(weights.rows != q_.rows || weights.cols != q_.cols) {
+
+        ELM_THROW_BAD_DIMS("Float weights do not match quantized weights");
+    }
+
+    Mat1f u_q;
+    Potentials(spikes_in, u_q);
+
+    // float reference, u = bias + weights of spiking afferents
+    Mat1f x = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *p = x.ptr<float>(0);
+    std::vector<int> spiking;
+    for(int i=0; i<static_cast<int>(x.total()); i++) {
+
+        if(p[i] != 0.f) {
+
+            spiking.push_back(i);
+        }
+    }
+
+    double sum_abs_error = 0.;
+    float max_abs_error = 0.f;
+    int winner_q = -1, winner_f = -1;
+    float max_u_q = 0.f, max_u_f = 0.f;
+    const float *u_q_ptr = u_q.ptr<float>(0);
+    for(int r=0; r<q_.rows; r++) {
+
+        const float *w = weights.ptr<float>(r);
+        float u_f = bias(r);
+        for(size_t k=0; k<spiking.size(); k++) {
+
+            u_f += w[spiking[k]];
+        }
+
+        const float abs_error = std::abs(u_q_ptr[r]-u_f);
+        max_abs_error = std::max(max_abs_error, abs_error);
+        sum_abs_error += abs_error;
+
+        if(r == 0 || u_q_ptr[r] > max_u_q) {
+
+            max_u_q = u_q_ptr[r];
+            winner_q = r;
+        }
+        if(r == 0 || u_f > max_u_f) {
+
+            max_u_f = u_f;
+            winner_f = r;
+        }
+    }
+
+    // running means over samples
+    const int n = ++report.nb_samples;
+    report.max_abs_error = std::max(report.max_abs_error, max_abs_error);
+    if(q_.rows > 0) {
+
+        const float mean_abs_error = static_cast<float>(sum_abs_error/q_.rows);
+        report.mean_abs_error += (mean_abs_error-report.mean_abs_error)/n;
+        report.winner_agreement += (static_cast<float>(winner_q == winner_f)-report.winner_agreement)/n;
+    }
+}
+
+Mat1f QuantizedWeights::Dequantize() const
+{
+    Mat1f weights;
+    q_.convertTo(weights, CV_32F, scale_, offset_);
+    return weights;
+}
+
+bool QuantizedWeights::empty() const
+{
+    return q_.empty();
+}
+
+int QuantizedWeights::Depth() const
+{
+    return depth_;
+}
+
+int QuantizedWeights::NbAfferents() const
+{
+    return q_.cols;
+}
+
+int QuantizedWeights::NbOutputs() const
+{
+    return q_.rows;
+}
+
+Mat QuantizedWeights::Data() const
+{
+    return q_;
+}
+
+float QuantizedWeights::Offset() const
+{
+    return offset_;
+}
+
+float QuantizedWeights::Scale() const
+{
+    return scale_;
+}
+
+Mat1f QuantizedWeights::Bias() const
+{
+    return bias_;
+}
+
+size_t QuantizedWeights::NbBytes() const
+{
+    return q_.total()*q_.elemSize();
+}
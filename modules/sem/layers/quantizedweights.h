@@ -0,0 +1,134 @@
+#ifndef SEM_LAYERS_QUANTIZEDWEIGHTS_H_
+#define SEM_LAYERS_QUANTIZEDWEIGHTS_H_
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Report comparing quantized against float membrane potentials
+ */
+struct QuantizationReport
+{
+    QuantizationReport()
+        : nb_samples(0),
+          max_abs_error(0.f),
+          mean_abs_error(0.f),
+          winner_agreement(0.f)
+    {}
+
+    int nb_samples;             ///< no. of input samples compared
+    float max_abs_error;        ///< max. absolute error of membrane potentials
+    float mean_abs_error;       ///< mean absolute error of membrane potentials
+    float winner_agreement;     ///< fraction of samples with the same neuron of max. potential
+};
+
+/**
+ * @brief Integer weight storage of a layer of Z neurons for inference
+ *
+ * Weights are log probabilities in a narrow, bounded range (clamped at -5, see ZNeuron).
+ * They are stored as unsigned integers on a uniform grid calibrated to the range of the weights:
+ * w ~ offset + scale * q, q in [0, 2^depth-1].
+ * Membrane potentials then accumulate integers over spiking afferents,
+ * u = bias + nb_spiking * offset + scale * sum(q), converting to float once per neuron.
+ * Bias terms remain float.
+ *
+ * 8-bit weights take a quarter of the memory of float weights,
+ * such that large layers fit into cache.
+ */
+class QuantizedWeights
+{
+public:
+    static const int DEPTH_8;   ///< = 8, 8-bit weights
+    static const int DEPTH_16;  ///< = 16, 16-bit weights
+
+    QuantizedWeights();
+
+    /**
+     * @brief Quantize weights
+     * @param weights, one row per neuron, one column per afferent, log scale
+     * @param bias with one element per neuron, log scale
+     * @param depth in bits, DEPTH_8 or DEPTH_16
+     * @throws ExceptionValueError on unsupported depth
+     * @throws ExceptionBadDims on mismatching bias
+     */
+    QuantizedWeights(const cv::Mat1f &weights, const cv::Mat1f &bias, int depth);
+
+    /**
+     * @brief Compute membrane potentials with integer accumulation
+     * @param input spikes, non-zero for spiking afferent
+     * @param[out] membrane potential per neuron
+     * @throws ExceptionBadDims on mismatching no. of afferents
+     */
+    void Potentials(const cv::Mat1f &spikes_in, cv::Mat1f &u) const;
+
+    /**
+     * @brief Compare against float potentials
+     * @param float weights the quantization was calibrated on
+     * @param float bias
+     * @param input spikes, one sample per row
+     * @return accuracy report
+     */
+    QuantizationReport Compare(const cv::Mat1f &weights, const cv::Mat1f &bias, const cv::Mat1f &samples) const;
+
+    /**
+     * @brief Compare a single input sample against float potentials, adding to a report
+     * Samples can be generated and compared one at a time, without holding all of them in memory.
+     * The float reference only sums weights of spiking afferents.
+     * @param float weights the quantization was calibrated on
+     * @param float bias
+     * @param input spikes of a single sample
+     * @param[in,out] report covering all samples compared into it so far
+     * @throws ExceptionBadDims on mismatching weights or no. of afferents
+     */
+    void Compare(const cv::Mat1f &weights, const cv::Mat1f &bias, const cv::Mat1f &spikes_in, QuantizationReport &report) const;
+
+    /**
+     * @brief Reconstruct float weights
+     * @return weights on the quantization grid, one row per neuron
+     */
+    cv::Mat1f Dequantize() const;
+
+    bool empty() const;
+
+    int Depth() const;
+
+    int NbAfferents() const;
+
+    int NbOutputs() const;
+
+    /**
+     * @brief get integer weights
+     * No deep copy, one row per neuron, CV_8U or CV_16U
+     */
+    cv::Mat Data() const;
+
+    float Offset() const;
+
+    float Scale() const;
+
+    cv::Mat1f Bias() const;
+
+    /**
+     * @brief get size of weight storage
+     * @return no. of bytes, excluding bias
+     */
+    size_t NbBytes() const;
+
+protected:
+    /**
+     * @brief Accumulate integer weights of spiking afferents
+     * @param row of integer weights
+     * @param indices of spiking afferents
+     * @param no. of spiking afferents
+     * @return sum of integer weights
+     */
+    template <typename T>
+    static unsigned long long Accumulate(const T *q, const int *active, int nb_active);
+
+    int depth_;             ///< no. of bits per weight
+    cv::Mat q_;             ///< integer weights, one row per neuron
+    float offset_;          ///< weight value of q=0
+    float scale_;           ///< weight step per integer step
+    cv::Mat1f bias_;        ///< float bias per neuron
+};
+
+#endif // SEM_LAYERS_QUANTIZEDWEIGHTS_H_
@@ -0,0 +1,195 @@
+#include "sem/layers/sparseweights.h"
+
+#include <algorithm>
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+const float SparseWeights::DEFAULT_THRESHOLD = -5.f;
+
+SparseWeights::SparseWeights()
+    : nb_outputs_(0),
+      nb_afferents_(0),
+      threshold_(DEFAULT_THRESHOLD),
+      col_ptr_(1, 0)
+{
+}
+
+SparseWeights::SparseWeights(const Mat1f &weights, const Mat1f &bias, float threshold)
+    : nb_outputs_(weights.rows),
+      nb_afferents_(weights.cols),
+      threshold_(threshold)
+{
+    if(bias.total() != static_cast<size_t>(weights.rows)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one bias term per row of weights");
+    }
+
+    // floor per neuron from dropped weights, count kept synapses per afferent
+    floor_ = Mat1f::zeros(1, nb_outputs_);
+    col_ptr_.assign(nb_afferents_+1, 0);
+    for(int r=0; r<nb_outputs_; r++) {
+
+        const float *w = weights.ptr<float>(r);
+        double sum_dropped = 0.;
+        int nb_dropped = 0;
+        for(int c=0; c<nb_afferents_; c++) {
+
+            if(w[c] <= threshold_) {
+
+                sum_dropped += w[c];
+                nb_dropped++;
+            }
+            else {
+
+                col_ptr_[c+1]++;
+            }
+        }
+
+        if(nb_dropped > 0) {
+
+            floor_(r) = static_cast<float>(sum_dropped/nb_dropped);
+        }
+    }
+
+    for(int c=0; c<nb_afferents_; c++) {
+
+        col_ptr_[c+1] += col_ptr_[c];
+    }
+
+    // fill columns, rows in ascending order within each column
+    row_idx_.resize(col_ptr_[nb_afferents_]);
+    values_.resize(col_ptr_[nb_afferents_]);
+    std::vector<int> next(col_ptr_.begin(), col_ptr_.end()-1);
+    for(int r=0; r<nb_outputs_; r++) {
+
+        const float *w = weights.ptr<float>(r);
+        const float f = floor_(r);
+        for(int c=0; c<nb_afferents_; c++) {
+
+            if(w[c] > threshold_) {
+
+                int k = next[c]++;
+                row_idx_[k] = r;
+                values_[k] = w[c]-f;
+            }
+        }
+    }
+
+    Bias(bias);
+}
+
+void SparseWeights::Potentials(const Mat1f &spikes_in, Mat1f &u) const
+{
+    if(spikes_in.total() != static_cast<size_t>(nb_afferents_)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one input spike per afferent");
+    }
+
+    if(u.rows != 1 || u.cols != nb_outputs_) {
+
+        u = Mat1f(1, nb_outputs_);
+    }
+    float *pu = u.ptr<float>(0);
+
+    Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+
+    // only visit kept synapses of spiking afferents
+    int nb_active = 0;
+    std::fill(pu, pu+nb_outputs_, 0.f);
+    for(int c=0; c<nb_afferents_; c++) {
+
+        if(x[c] != 0.f) {
+
+            nb_active++;
+            for(int k=col_ptr_[c]; k<col_ptr_[c+1]; k++) {
+
+                pu[row_idx_[k]] += values_[k];
+            }
+        }
+    }
+
+    const float *b = bias_.ptr<float>(0);
+    const float *f = floor_.ptr<float>(0);
+    for(int r=0; r<nb_outputs_; r++) {
+
+        pu[r] += b[r] + nb_active*f[r];
+    }
+}
+
+void SparseWeights::Bias(const Mat1f &bias)
+{
+    if(bias.total() != static_cast<size_t>(nb_outputs_)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one bias term per neuron");
+    }
+    bias.reshape(1, 1).copyTo(bias_);
+}
+
+Mat1f SparseWeights::Bias() const
+{
+    return bias_;
+}
+
+Mat1f SparseWeights::Floor() const
+{
+    return floor_;
+}
+
+Mat1f SparseWeights::Dense() const
+{
+    Mat1f weights(nb_outputs_, nb_afferents_);
+    for(int r=0; r<nb_outputs_; r++) {
+
+        weights.row(r).setTo(floor_(r));
+    }
+
+    for(int c=0; c<nb_afferents_; c++) {
+
+        for(int k=col_ptr_[c]; k<col_ptr_[c+1]; k++) {
+
+            weights(row_idx_[k], c) += values_[k];
+        }
+    }
+    return weights;
+}
+
+bool SparseWeights::empty() const
+{
+    return nb_outputs_ == 0 || nb_afferents_ == 0;
+}
+
+int SparseWeights::NbAfferents() const
+{
+    return nb_afferents_;
+}
+
+int SparseWeights::NbOutputs() const
+{
+    return nb_outputs_;
+}
+
+float SparseWeights::Threshold() const
+{
+    return threshold_;
+}
+
+int SparseWeights::NbNonZero() const
+{
+    return static_cast<int>(values_.size());
+}
+
+float SparseWeights::Density() const
+{
+    return empty()? 0.f : NbNonZero()/(static_cast<float>(nb_outputs_)*nb_afferents_);
+}
+
+size_t SparseWeights::NbBytes() const
+{
+    return col_ptr_.size()*sizeof(int) +
+            row_idx_.size()*sizeof(int) +
+            values_.size()*sizeof(float) +
+            floor_.total()*sizeof(float);
+}
@@ -0,0 +1,100 @@
+#ifndef SEM_LAYERS_SPARSEWEIGHTS_H_
+#define SEM_LAYERS_SPARSEWEIGHTS_H_
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Pruned sparse weight storage of a layer of Z neurons
+ *
+ * Synapses at or below a threshold, typically those saturated at the weight clamp (see ZNeuron),
+ * are dropped. Their mass folds into a per-neuron floor, the mean of the dropped weights.
+ * Kept synapses are stored relative to that floor in compressed sparse columns,
+ * one column per afferent, such that membrane potentials only visit kept synapses of spiking afferents:
+ * u = bias + nb_spiking * floor + sum(w - floor) over kept synapses of spiking afferents.
+ * Exact when all dropped weights of a neuron are equal, e.g. all at the clamp.
+ */
+class SparseWeights
+{
+public:
+    static const float DEFAULT_THRESHOLD;   ///< = -5.f, drop saturated synapses only
+
+    SparseWeights();
+
+    /**
+     * @brief Build sparse weights
+     * @param weights, one row per neuron, one column per afferent, log scale
+     * @param bias with one element per neuron, log scale
+     * @param drop synapses with weights at or below this threshold
+     * @throws ExceptionBadDims on mismatching bias
+     */
+    SparseWeights(const cv::Mat1f &weights, const cv::Mat1f &bias, float threshold=DEFAULT_THRESHOLD);
+
+    /**
+     * @brief Compute membrane potentials
+     * @param input spikes, non-zero for spiking afferent
+     * @param[out] membrane potential per neuron
+     * @throws ExceptionBadDims on mismatching no. of afferents
+     */
+    void Potentials(const cv::Mat1f &spikes_in, cv::Mat1f &u) const;
+
+    /**
+     * @brief Refresh bias terms without rebuilding
+     * Bias terms change on every tick during learning, unlike most weights
+     * @param bias with one element per neuron
+     */
+    void Bias(const cv::Mat1f &bias);
+
+    cv::Mat1f Bias() const;
+
+    /**
+     * @brief get per-neuron floor dropped synapses fold into
+     * @return row vector with one element per neuron
+     */
+    cv::Mat1f Floor() const;
+
+    /**
+     * @brief Reconstruct dense weights, dropped synapses at their neuron's floor
+     * @return weights, one row per neuron
+     */
+    cv::Mat1f Dense() const;
+
+    bool empty() const;
+
+    int NbAfferents() const;
+
+    int NbOutputs() const;
+
+    float Threshold() const;
+
+    /**
+     * @brief get no. of kept synapses
+     */
+    int NbNonZero() const;
+
+    /**
+     * @brief get fraction of kept synapses
+     */
+    float Density() const;
+
+    /**
+     * @brief get size of sparse storage
+     * @return no. of bytes, excluding bias
+     */
+    size_t NbBytes() const;
+
+protected:
+    int nb_outputs_;                ///< no. of neurons
+    int nb_afferents_;              ///< no. of afferents
+    float threshold_;               ///< weights at or below are dropped
+
+    std::vector<int> col_ptr_;      ///< start of each afferent's synapses, nb_afferents+1 elements
+    std::vector<int> row_idx_;      ///< neuron of each kept synapse
+    std::vector<float> values_;     ///< weight of each kept synapse relative to its neuron's floor
+
+    cv::Mat1f floor_;               ///< per-neuron mean of dropped weights, 0 if none dropped
+    cv::Mat1f bias_;                ///< bias per neuron
+};
+
+#endif // SEM_LAYERS_SPARSEWEIGHTS_H_
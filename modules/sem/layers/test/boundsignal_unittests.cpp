@@ -0,0 +1,149 @@
+#include "sem/layers/boundsignal.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/signal.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+class BoundSignalTest : public testing::Test
+{
+protected:
+    BoundSignal to_;    ///< test object
+};
+
+TEST_F(BoundSignalTest, Bind)
+{
+    EXPECT_EQ(0, to_.NbSlots());
+
+    BoundSignal::Slot *a = to_.Bind("a");
+    ASSERT_TRUE(a != 0);
+    EXPECT_EQ("a", a->Name());
+    EXPECT_FALSE(a->IsSet());
+    EXPECT_FALSE(to_.Exists("a"));
+
+    EXPECT_EQ(a, to_.Bind("a")) << "Expecting same slot for same name.";
+    EXPECT_EQ(1, to_.NbSlots());
+
+    BoundSignal::Slot *b = to_.Bind("b");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(2, to_.NbSlots());
+}
+
+/**
+ * @brief Slots keep their address while more get bound
+ */
+TEST_F(BoundSignalTest, Bind_StableAddress)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+    a->Set(Mat1f::ones(1, 3));
+
+    for(int i=0; i<1000; i++) {
+
+        std::stringstream s;
+        s << "x" << i;
+        to_.Bind(s.str());
+    }
+
+    EXPECT_EQ(a, to_.Bind("a"));
+    EXPECT_MAT_EQ(Mat1f::ones(1, 3), a->Get());
+}
+
+TEST_F(BoundSignalTest, Set)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+    EXPECT_THROW(a->Get(), ExceptionKeyError);
+
+    Mat1f x(1, 3, 2.f);
+    a->Set(x);
+    EXPECT_TRUE(a->IsSet());
+    EXPECT_TRUE(to_.Exists("a"));
+    EXPECT_EQ(x.data, a->Get().data) << "Expecting no deep copy.";
+}
+
+/**
+ * @brief Writing copies into the slot's own buffer, reused while dims match
+ */
+TEST_F(BoundSignalTest, Write)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+
+    Mat1f x(1, 3, 2.f);
+    a->Write(x);
+    EXPECT_NE(x.data, a->Get().data) << "Expecting deep copy.";
+    EXPECT_MAT_EQ(x, a->Get());
+
+    const uchar *data = a->Get().data;
+    Mat1f y(1, 3, 5.f);
+    a->Write(y);
+    EXPECT_EQ(data, a->Get().data) << "Expecting buffer reused.";
+    EXPECT_MAT_EQ(y, a->Get());
+
+    Mat1f z(1, 4, 1.f);
+    a->Write(z);
+    EXPECT_MAT_EQ(z, a->Get());
+}
+
+/**
+ * @brief Writing never touches a feature passed to Set()
+ */
+TEST_F(BoundSignalTest, Write_AfterSet)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+
+    Mat1f x(1, 3, 2.f);
+    a->Set(x);
+    a->Write(Mat1f(1, 3, 5.f));
+
+    EXPECT_MAT_EQ(Mat1f(1, 3, 2.f), x);
+    EXPECT_MAT_EQ(Mat1f(1, 3, 5.f), a->Get());
+}
+
+TEST_F(BoundSignalTest, Clear)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+    a->Write(Mat1f(1, 3, 2.f));
+    const uchar *data = a->Get().data;
+
+    to_.Clear();
+    EXPECT_FALSE(a->IsSet());
+    EXPECT_FALSE(to_.Exists("a"));
+    EXPECT_EQ(1, to_.NbSlots()) << "Expecting slots to remain bound.";
+
+    a->Write(Mat1f(1, 3, 5.f));
+    EXPECT_EQ(data, a->Get().data) << "Expecting buffer kept.";
+}
+
+TEST_F(BoundSignalTest, Import)
+{
+    BoundSignal::Slot *a = to_.Bind("a");
+    BoundSignal::Slot *b = to_.Bind("b");
+
+    Signal signal;
+    signal.Append("a", Mat1f(1, 3, 2.f));
+    signal.Append("c", Mat1f(1, 3, 4.f));
+
+    to_.Import(signal);
+    EXPECT_MAT_EQ(Mat1f(1, 3, 2.f), a->Get());
+    EXPECT_FALSE(b->IsSet());
+    EXPECT_FALSE(to_.Exists("c")) << "Expecting unbound features to be ignored.";
+}
+
+TEST_F(BoundSignalTest, Export)
+{
+    to_.Bind("a")->Write(Mat1f(1, 3, 2.f));
+    to_.Bind("b");
+
+    Signal signal;
+    to_.Export(signal);
+
+    ASSERT_TRUE(signal.Exists("a"));
+    EXPECT_MAT_EQ(Mat1f(1, 3, 2.f), signal.MostRecentMat1f("a"));
+    EXPECT_FALSE(signal.Exists("b"));
+}
+
+} // annonymous namespace
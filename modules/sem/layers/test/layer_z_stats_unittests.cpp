@@ -0,0 +1,132 @@
+#include "sem/layers/layer_z_stats.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+class LayerZStatsTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        nb_outputs_ = 5;
+        to_ = LayerZStats();
+        to_.Reset(nb_outputs_);
+        to_.Enable(true);
+    }
+
+    LayerZStats to_;    ///< test object
+    int nb_outputs_;
+};
+
+TEST_F(LayerZStatsTest, DisabledByDefault)
+{
+    LayerZStats to;
+    EXPECT_FALSE(to.IsEnabled());
+
+    to.Reset(nb_outputs_);
+    to.Tick(10, 1);
+    to.Spike(0);
+    to.Toc(LayerZStats::PHASE_ACTIVATE, to.Tic());
+
+    EXPECT_EQ(0ULL, to.NbTicks());
+    EXPECT_EQ(0ULL, to.NbSpikes());
+    EXPECT_EQ(0ULL, to.Count(LayerZStats::PHASE_ACTIVATE));
+    EXPECT_EQ(0, countNonZero(to.Winners()));
+}
+
+TEST_F(LayerZStatsTest, Empty)
+{
+    EXPECT_EQ(0ULL, to_.NbTicks());
+    EXPECT_FLOAT_EQ(0.f, to_.SpikeRate());
+    EXPECT_FLOAT_EQ(0.f, to_.MeanActiveAfferents());
+    EXPECT_FLOAT_EQ(0.f, to_.ArenaGrowthsPerTick());
+    EXPECT_MAT_DIMS_EQ(to_.Winners(), Size2i(nb_outputs_, 1));
+}
+
+TEST_F(LayerZStatsTest, Ticks)
+{
+    to_.Tick(10, 2);
+    to_.Tick(20, 0);
+
+    EXPECT_EQ(2ULL, to_.NbTicks());
+    EXPECT_FLOAT_EQ(15.f, to_.MeanActiveAfferents());
+    EXPECT_FLOAT_EQ(1.f, to_.ArenaGrowthsPerTick());
+}
+
+TEST_F(LayerZStatsTest, Spikes)
+{
+    for(int i=0; i<4; i++) {
+
+        to_.Tick(0, 0);
+    }
+    to_.Spike(1);
+    to_.Spike(1);
+    to_.Spike(3);
+
+    EXPECT_EQ(3ULL, to_.NbSpikes());
+    EXPECT_FLOAT_EQ(0.75f, to_.SpikeRate());
+
+    Mat1i winners = to_.Winners();
+    EXPECT_EQ(0, winners(0));
+    EXPECT_EQ(2, winners(1));
+    EXPECT_EQ(1, winners(3));
+
+    EXPECT_THROW(to_.Spike(-1), ExceptionBadDims);
+    EXPECT_THROW(to_.Spike(nb_outputs_), ExceptionBadDims);
+}
+
+TEST_F(LayerZStatsTest, Timing)
+{
+    for(int i=0; i<LayerZStats::NB_PHASES; i++) {
+
+        LayerZStats::Phase phase = static_cast<LayerZStats::Phase>(i);
+        EXPECT_EQ(0ULL, to_.Count(phase));
+
+        to_.Toc(phase, to_.Tic());
+        to_.Toc(phase, to_.Tic());
+
+        EXPECT_EQ(2ULL, to_.Count(phase));
+        EXPECT_GE(to_.Seconds(phase), 0.);
+        EXPECT_FALSE(LayerZStats::PhaseName(phase).empty());
+    }
+}
+
+TEST_F(LayerZStatsTest, Reset)
+{
+    to_.Tick(10, 2);
+    to_.Spike(0);
+    to_.Toc(LayerZStats::PHASE_LEARN, to_.Tic());
+
+    to_.Reset(nb_outputs_+1);
+
+    EXPECT_TRUE(to_.IsEnabled()) << "Reset should not affect recording flag.";
+    EXPECT_EQ(0ULL, to_.NbTicks());
+    EXPECT_EQ(0ULL, to_.NbSpikes());
+    EXPECT_EQ(0ULL, to_.Count(LayerZStats::PHASE_LEARN));
+    EXPECT_MAT_DIMS_EQ(to_.Winners(), Size2i(nb_outputs_+1, 1));
+}
+
+TEST_F(LayerZStatsTest, ToMat)
+{
+    to_.Tick(10, 2);
+    to_.Spike(2);
+    to_.Toc(LayerZStats::PHASE_COMPETE, to_.Tic());
+
+    Mat1f m = to_.ToMat();
+    EXPECT_MAT_DIMS_EQ(m, Size2i(LayerZStats::NB_COLS_SUMMARY+2*LayerZStats::NB_PHASES, 1));
+
+    EXPECT_FLOAT_EQ(1.f, m(LayerZStats::COL_NB_TICKS));
+    EXPECT_FLOAT_EQ(1.f, m(LayerZStats::COL_NB_SPIKES));
+    EXPECT_FLOAT_EQ(1.f, m(LayerZStats::COL_SPIKE_RATE));
+    EXPECT_FLOAT_EQ(10.f, m(LayerZStats::COL_MEAN_ACTIVE_AFFERENTS));
+    EXPECT_FLOAT_EQ(2.f, m(LayerZStats::COL_ARENA_GROWTHS_PER_TICK));
+    EXPECT_FLOAT_EQ(1.f, m(LayerZStats::NB_COLS_SUMMARY+2*LayerZStats::PHASE_COMPETE));
+    EXPECT_FLOAT_EQ(0.f, m(LayerZStats::NB_COLS_SUMMARY+2*LayerZStats::PHASE_LEARN));
+}
+
+} // annonymous namespace
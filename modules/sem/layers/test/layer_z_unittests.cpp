@@ -10,6 +10,10 @@
  */
 #include "sem/layers/layer_z.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 #include "elm/core/exception.h"
 #include "elm/core/boost/ptree_utils.h"
 #include "elm/core/cv/mat_utils_inl.h"
@@ -29,6 +33,9 @@ const string NAME_OUTPUT_SPIKES  = "out";       ///< no. of output spikes/size o
 const string NAME_OUTPUT_MEM_POT = "mem_pot";   ///< membrane potential
 const string NAME_OUTPUT_WEIGHTS = "weights";   ///< neuron weights
 const string NAME_OUTPUT_BIAS    = "bias";         ///< neuron weights
+const string NAME_OUTPUT_STATS   = "stats";     ///< hot path stats
+const string NAME_OUTPUT_STATE_DISTR = "p";     ///< softmax posterior
+const string NAME_OUTPUT_WEIGHTS_DELTA = "w_delta"; ///< rows of weights changed since last response
 
 /**
  * @brief mixin for testing layer Z, the main, SEM learning algorithm
@@ -121,7 +128,9 @@ INSTANTIATE_TEST_CASE_P(TestWithParams,
                                         TParamPairSF(LayerZ::PARAM_NB_AFFERENTS, 0),
                                         TParamPairSF(LayerZ::PARAM_NB_AFFERENTS, -3),
                                         TParamPairSF(LayerZ::PARAM_WTA_FREQ, -0.001f),
-                                        TParamPairSF(LayerZ::PARAM_WTA_FREQ, -1.f)));
+                                        TParamPairSF(LayerZ::PARAM_WTA_FREQ, -1.f),
+                                        TParamPairSF(LayerZ::PARAM_CHANGE_SMOOTHING, 0.f),
+                                        TParamPairSF(LayerZ::PARAM_CHANGE_SMOOTHING, 1.1f)));
 
 TEST_P(LayerZParamsTest, InvalidParams)
 {
@@ -277,6 +286,215 @@ TEST_F(LayerZTest, Stimulus)
     }
 }
 
+/**
+ * @brief Test instrumentation is disabled unless requested
+ */
+TEST_F(LayerZTest, StatsDisabled)
+{
+    EXPECT_FALSE(to_.Stats().IsEnabled());
+
+    to_.Activate(signal_);
+    to_.Learn();
+    to_.Response(signal_);
+
+    EXPECT_EQ(0ULL, to_.Stats().NbTicks());
+    EXPECT_EQ(0ULL, to_.Stats().Count(LayerZStats::PHASE_ACTIVATE));
+    EXPECT_FALSE(signal_.Exists(NAME_OUTPUT_STATS));
+}
+
+/**
+ * @brief Test recording of hot path stats
+ */
+TEST_F(LayerZTest, Stats)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_STATS, true);
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    config_.Output(LayerZ::KEY_OUTPUT_STATS, NAME_OUTPUT_STATS);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    EXPECT_TRUE(to_.Stats().IsEnabled());
+
+    const int N=10;
+    const int nb_active = countNonZero(signal_.MostRecentMat1f(NAME_INPUT_SPIKES));
+    for(int i=0; i<N; i++) {
+
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+    }
+
+    const LayerZStats &stats = to_.Stats();
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.NbTicks());
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.NbSpikes());
+    EXPECT_FLOAT_EQ(1.f, stats.SpikeRate());
+    EXPECT_FLOAT_EQ(static_cast<float>(nb_active), stats.MeanActiveAfferents());
+    EXPECT_EQ(N, static_cast<int>(sum(stats.Winners())(0)));
+
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_ACTIVATE));
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_PREDICT));
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_COMPETE));
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_LEARN));
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_UPDATE)) << "Expecting 1 STDP update per WTA spike";
+    EXPECT_EQ(static_cast<unsigned long long>(N), stats.Count(LayerZStats::PHASE_RESPONSE));
+
+    ASSERT_TRUE(signal_.Exists(NAME_OUTPUT_STATS));
+    Mat1f stats_mat = signal_.MostRecentMat1f(NAME_OUTPUT_STATS);
+    EXPECT_FLOAT_EQ(static_cast<float>(N), stats_mat(LayerZStats::COL_NB_TICKS));
+
+    to_.ResetStats();
+    EXPECT_EQ(0ULL, to_.Stats().NbTicks());
+    EXPECT_TRUE(to_.Stats().IsEnabled());
+
+    to_.EnableStats(false);
+    to_.Activate(signal_);
+    EXPECT_EQ(0ULL, to_.Stats().NbTicks());
+}
+
+/**
+ * @brief Ticks stop growing the arena once outputs are dropped between ticks
+ */
+TEST_F(LayerZTest, Arena_SteadyState)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_STATS, true);
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    Mat1f spikes_in = signal_.MostRecentMat1f(NAME_INPUT_SPIKES);
+
+    const int NB_WARMUP=3;
+    const int N=50;
+    for(int i=0; i<NB_WARMUP+N; i++) {
+
+        if(i == NB_WARMUP) {
+
+            to_.Arena().Seal();
+            to_.ResetStats();
+        }
+
+        signal_.Clear();
+        signal_.Append(NAME_INPUT_SPIKES, spikes_in);
+
+        unsigned long long nb_growths = to_.Arena().NbGrowthsTotal();
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+
+        if(i >= NB_WARMUP) {
+
+            EXPECT_EQ(nb_growths, to_.Arena().NbGrowthsTotal()) << "Arena grew in steady state, tick " << i;
+        }
+    }
+    EXPECT_FLOAT_EQ(0.f, to_.Stats().ArenaGrowthsPerTick());
+}
+
+/**
+ * @brief Outputs still referenced elsewhere are never overwritten
+ */
+TEST_F(LayerZTest, Arena_OutputsKept)
+{
+    Mat1f u0, u0_values;
+
+    const int N=10;
+    for(int i=0; i<N; i++) {
+
+        Mat1f r(1, nb_afferents_);
+        randu(r, 0.f, 1.f);
+        Mat1f spikes_in = Mat1f::zeros(1, nb_afferents_);
+        spikes_in.setTo(1.f, r < 0.5f); // different input, different potentials
+        signal_.Append(NAME_INPUT_SPIKES, spikes_in);
+
+        to_.Activate(signal_);
+        to_.Response(signal_);
+
+        if(i == 0) {
+
+            u0 = signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT);
+            u0_values = u0.clone();
+        }
+    }
+
+    EXPECT_MAT_EQ(u0_values, u0);
+    EXPECT_GT(to_.Arena().NbGrowthsTotal(), 0ULL);
+}
+
+TEST_F(LayerZTest, WeightChangeRate)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    params.put(LayerZ::PARAM_CHANGE_SMOOTHING, 0.5f);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    const int nb_output_nodes = config_.Params().get<int>(LayerZ::PARAM_NB_OUTPUT_NODES);
+    Mat1f rates = to_.WeightChangeRates();
+    EXPECT_MAT_DIMS_EQ(rates, Size2i(nb_output_nodes, 1));
+    EXPECT_EQ(0, countNonZero(rates));
+    EXPECT_FLOAT_EQ(0.f, to_.WeightChangeRate());
+
+    to_.Activate(signal_);
+    to_.Learn();
+    to_.Response(signal_);
+
+    rates = to_.WeightChangeRates();
+    Mat1f spikes = signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES);
+    for(int i=0; i<nb_output_nodes; i++) {
+
+        EXPECT_GT(rates(i), 0.f);
+        if(spikes(i) != 0.f) {
+
+            EXPECT_GT(rates(i), to_.WeightChangeRate()) << "Expecting winner to move most.";
+        }
+    }
+    EXPECT_FLOAT_EQ(static_cast<float>(mean(rates)(0)), to_.WeightChangeRate());
+}
+
+TEST_F(LayerZTest, AdaptiveRate)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    params.put(LayerZ::PARAM_ADAPTIVE_RATE, true);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    for(int i=0; i<10; i++) {
+
+        EXPECT_NO_THROW(to_.Activate(signal_));
+        EXPECT_NO_THROW(to_.Learn());
+    }
+    EXPECT_GT(to_.WeightChangeRate(), 0.f);
+}
+
+TEST_F(LayerZTest, StateDistr)
+{
+    config_.Output(LayerZ::KEY_OUTPUT_STATE_DISTR, NAME_OUTPUT_STATE_DISTR);
+    to_.IONames(config_);
+
+    to_.Activate(signal_);
+    to_.Response(signal_);
+
+    const int nb_output_nodes = config_.Params().get<int>(LayerZ::PARAM_NB_OUTPUT_NODES);
+    Mat1f p = to_.StateDistr();
+    EXPECT_MAT_DIMS_EQ(p, Size2i(nb_output_nodes, 1));
+    EXPECT_NEAR(1., sum(p)(0), 1e-5);
+
+    ASSERT_TRUE(signal_.Exists(NAME_OUTPUT_STATE_DISTR));
+    EXPECT_MAT_EQ(p, signal_.MostRecentMat1f(NAME_OUTPUT_STATE_DISTR));
+
+    EXPECT_MAT_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES), to_.Spikes());
+}
+
 TEST_F(LayerZTest, Activate)
 {
     Mat1f spikes(1, nb_afferents_);
@@ -288,6 +506,37 @@ TEST_F(LayerZTest, Activate)
     EXPECT_TRUE(signal_.Exists(NAME_OUTPUT_SPIKES));
 }
 
+/**
+ * @brief Bound I/O requires binding to the same signal and known names
+ */
+TEST_F(LayerZTest, Bind)
+{
+    BoundSignal bound;
+    EXPECT_FALSE(to_.IsBound());
+    EXPECT_THROW(to_.Activate(bound), ExceptionValueError);
+
+    LayerZ to;
+    to.Reset(config_);
+    to.Bind(bound);
+    EXPECT_FALSE(to.IsBound()) << "I/O names not known yet";
+
+    to.IONames(config_);
+    EXPECT_TRUE(to.IsBound());
+    EXPECT_EQ(3, bound.NbSlots()) << "Expecting slots for input spikes, output spikes and membrane potential";
+
+    EXPECT_THROW(to.Activate(bound), ExceptionKeyError) << "Input spikes not set";
+
+    BoundSignal other;
+    EXPECT_THROW(to.Activate(other), ExceptionValueError);
+    EXPECT_THROW(to.Response(other), ExceptionValueError);
+
+    bound.Bind(NAME_INPUT_SPIKES)->Set(signal_.MostRecentMat1f(NAME_INPUT_SPIKES));
+    to.Activate(bound);
+    to.Response(bound);
+    EXPECT_TRUE(bound.Exists(NAME_OUTPUT_SPIKES));
+    EXPECT_MAT_EQ(to.Spikes(), bound.Bind(NAME_OUTPUT_SPIKES)->Get());
+}
+
 /**
  * @brief class for covering layer z neuron learning, weights and bias
  */
@@ -306,6 +555,76 @@ protected:
     }
 };
 
+/**
+ * @brief Bound I/O yields the same outputs as string-keyed I/O
+ */
+TEST_F(LayerZLearnTest, Bind_SameAsSignal)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 100.f);
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+
+    const int N=100;
+    FakeEvidence stimuli(nb_afferents_);
+    vector<Mat1f> spikes_in;
+    for(int i=0; i<N; i++) {
+
+        spikes_in.push_back(static_cast<Mat1f>(stimuli.next(i%2)));
+    }
+
+    // string-keyed
+    theRNG() = RNG(2010);
+    to_.Reset(config_);
+    vector<Mat1f> spikes, u, weights, bias;
+    for(int i=0; i<N; i++) {
+
+        signal_.Clear();
+        signal_.Append(NAME_INPUT_SPIKES, spikes_in[i]);
+        to_.Activate(signal_);
+        to_.Learn();
+        to_.Response(signal_);
+
+        spikes.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES).clone());
+        u.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT).clone());
+        weights.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS).clone());
+        bias.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_BIAS).clone());
+    }
+
+    // bound
+    theRNG() = RNG(2010);
+    LayerZ to;
+    to.Reset(config_);
+    BoundSignal bound;
+    to.Bind(bound);
+    to.IONames(config_);
+    ASSERT_TRUE(to.IsBound());
+
+    BoundSignal::Slot *in = bound.Bind(NAME_INPUT_SPIKES);
+    BoundSignal::Slot *out = bound.Bind(NAME_OUTPUT_SPIKES);
+    BoundSignal::Slot *mem_pot = bound.Bind(NAME_OUTPUT_MEM_POT);
+    BoundSignal::Slot *w = bound.Bind(NAME_OUTPUT_WEIGHTS);
+    BoundSignal::Slot *w0 = bound.Bind(NAME_OUTPUT_BIAS);
+    for(int i=0; i<N; i++) {
+
+        bound.Clear();
+        in->Set(spikes_in[i]);
+        to.Activate(bound);
+        to.Learn();
+        to.Response(bound);
+
+        EXPECT_MAT_EQ(spikes[i], out->Get()) << "tick " << i;
+        EXPECT_MAT_EQ(u[i], mem_pot->Get()) << "tick " << i;
+        EXPECT_MAT_EQ(weights[i], w->Get()) << "tick " << i;
+        EXPECT_MAT_EQ(bias[i], w0->Get()) << "tick " << i;
+    }
+
+    // bridge to string-keyed consumers
+    Signal signal;
+    bound.Export(signal);
+    EXPECT_MAT_EQ(spikes[N-1], signal.MostRecentMat1f(NAME_OUTPUT_SPIKES));
+}
+
 /**
  * @brief test adding request to optional output of neuron weights
  */
@@ -436,38 +755,75 @@ TEST_F(LayerZLearnTest, WeightsNotCopied)
 {
     to_.Activate(signal_);
     to_.Response(signal_);
-    Mat1f w0;
 
-    // get from signal
+    // exported weights are a view on the layer's own storage
+    // Given that the weights are probably going to be used for evaluations and visualizations rather than
+    // downstream computation, consumers are expected to not modify them
     Mat1f w1 = signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS);
-    w1.copyTo(w0); // back up, deep-copy
+    EXPECT_EQ(to_.WeightsView().data, w1.data) << "Expecting no deep copy.";
+    EXPECT_MAT_EQ(to_.Weights(), w1);
+    EXPECT_NE(to_.Weights().data, w1.data) << "Weights() must remain a deep copy.";
 
-    // get form signal one more time
-    // any modification on w2 will reflect on w1, because we're only copying
-    // the matrix header inside this signal object
+    // responding again hands out the same storage
+    to_.Response(signal_);
     Mat1f w2 = signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS);
+    EXPECT_EQ(w1.data, w2.data);
+
+    // bias is not recopied while unchanged
+    Mat1f b1 = signal_.MostRecentMat1f(NAME_OUTPUT_BIAS);
+    to_.Response(signal_);
+    EXPECT_EQ(b1.data, signal_.MostRecentMat1f(NAME_OUTPUT_BIAS).data);
+}
+
+/**
+ * @brief Only rows of neurons that spiked since a version are exported as delta
+ */
+TEST_F(LayerZLearnTest, WeightsDelta)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    config_.Output(LayerZ::KEY_OUTPUT_WEIGHTS_DELTA, NAME_OUTPUT_WEIGHTS_DELTA);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    // nothing learned yet, initial weights were never exported as delta
+    to_.Response(signal_);
+    ASSERT_TRUE(signal_.Exists(NAME_OUTPUT_WEIGHTS_DELTA));
+    EXPECT_MAT_DIMS_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS_DELTA), Size(nb_afferents_+1, to_.Spikes().cols));
+
+    const unsigned long long v0 = to_.WeightsVersion();
+    EXPECT_EQ(0, to_.WeightsDelta(v0).rows);
 
-    // update signal with layer response and get it a third time
-    // any modification on w3 will reflect on w2 and w1, because we're effectivly
-    // only copying the header of the matrix that lives inside the header
-    // This means we're referencing the same memory block as the layer, a save on memory,
-    // however, we need to be careful not to interfere with this sturucture.
-    // Given that the weights, are probably going to be used for evaluations and visualizations rather than
-    // downstream computation, this is acceptable
+    signal_.Clear();
     to_.Response(signal_);
-    Mat1f w3 = signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS);
+    EXPECT_FALSE(signal_.Exists(NAME_OUTPUT_WEIGHTS_DELTA)) << "Nothing changed since last delta.";
 
-    // add increments to the different weight copies
-    w1 += 1.f;
-    w2 += 2.f;
-    w3 += 3.f;
+    FakeEvidence stimuli(nb_afferents_);
+    signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(0)));
+    to_.Activate(signal_);
+    to_.Learn();
+
+    Mat1f spikes = to_.Spikes();
+    ASSERT_GT(countNonZero(spikes), 0) << "WTA never spiked";
+    EXPECT_GT(to_.WeightsVersion(), v0);
+
+    Mat1f delta = to_.WeightsDelta(v0);
+    ASSERT_EQ(countNonZero(spikes), delta.rows);
+
+    Mat1f weights = to_.Weights();
+    for(int r=0; r<delta.rows; r++) {
 
-    // check which objects are just references of each other
-    // we have to use the NEAR asssertion with low tolerance due to float precision errors
-    EXPECT_MAT_NEAR(w0+3.f, w1, 1e-5);
-    EXPECT_MAT_NEAR(w0+3.f, w2, 1e-5);
-    EXPECT_MAT_NEAR(w1, w2, 1e-7) << "w1 and w2 point to the same underlying data";
-    EXPECT_MAT_NEAR(w0+3.f, w3, 1e-5);
+        int i = static_cast<int>(delta(r, 0));
+        EXPECT_NE(0.f, spikes(i)) << "Row of non-spiking neuron in delta.";
+        EXPECT_MAT_EQ(weights.row(i), delta(Range(r, r+1), Range(1, delta.cols)));
+    }
+
+    signal_.Clear();
+    to_.Response(signal_);
+    ASSERT_TRUE(signal_.Exists(NAME_OUTPUT_WEIGHTS_DELTA));
+    EXPECT_MAT_EQ(delta, signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS_DELTA));
 }
 
 /**
@@ -582,3 +938,866 @@ TEST_F(LayerZLearnTest, Learn)
     // sanity check that we performed the assertions.
     ASSERT_TRUE(checked) << "Assertions were not performed, the WTA circuits never spiked.";
 }
+
+TEST_F(LayerZLearnTest, Snapshot_Disabled)
+{
+    to_.Learn();
+    EXPECT_TRUE(to_.Snapshot().get() == 0) << "Publishing disabled by default.";
+
+    to_.Publish();
+    ASSERT_TRUE(to_.Snapshot().get() != 0);
+    EXPECT_MAT_EQ(to_.Weights(), to_.Snapshot()->Weights());
+    EXPECT_MAT_EQ(to_.Bias(), to_.Snapshot()->Bias());
+}
+
+/**
+ * @brief Snapshots are published at the configured cadence and never change while held
+ */
+TEST_F(LayerZLearnTest, Snapshot_Cadence)
+{
+    const int PUBLISH_EVERY=3;
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    params.put(LayerZ::PARAM_PUBLISH_EVERY, PUBLISH_EVERY);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    WeightsPublisher::SnapshotPtr initial = to_.Snapshot();
+    ASSERT_TRUE(initial.get() != 0) << "Expecting initial weights published on Reset.";
+    const Mat1f w_initial = to_.Weights();
+    EXPECT_MAT_EQ(w_initial, initial->Weights());
+
+    FakeEvidence stimuli(nb_afferents_);
+    for(int i=1; i<=3*PUBLISH_EVERY; i++) {
+
+        signal_.Clear();
+        signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(i%2)));
+        to_.Activate(signal_);
+        to_.Learn();
+
+        WeightsPublisher::SnapshotPtr s = to_.Snapshot();
+        if(i % PUBLISH_EVERY == 0) {
+
+            EXPECT_MAT_EQ(to_.Weights(), s->Weights()) << "Expecting publish after learning step " << i;
+            EXPECT_MAT_EQ(to_.Bias(), s->Bias());
+            EXPECT_EQ(to_.WeightsVersion(), s->Version());
+        }
+        else {
+
+            EXPECT_FALSE(Equal(to_.Bias(), s->Bias())) << "Expecting snapshot to lag behind learning step " << i;
+        }
+    }
+
+    EXPECT_FALSE(Equal(to_.Weights(), w_initial)) << "WTA never spiked";
+    EXPECT_MAT_EQ(w_initial, initial->Weights()) << "Held snapshot changed.";
+}
+
+TEST_F(LayerZLearnTest, CreateStream)
+{
+    LayerZStream stream = to_.CreateStream();
+    EXPECT_EQ(nb_afferents_, stream.NbAfferents());
+    EXPECT_EQ(to_.Spikes().cols, stream.NbOutputs());
+}
+
+/**
+ * @brief Learning from another stream applies STDP with that stream's history and spikes only
+ */
+TEST_F(LayerZLearnTest, Learn_Stream)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+    to_.Publish();
+
+    LayerZStream stream = to_.CreateStream();
+    FakeEvidence stimuli(nb_afferents_); // afferents alternate in spiking
+    stream.Activate(*to_.Snapshot(), static_cast<Mat1f>(stimuli.next(0)));
+
+    int winner;
+    ASSERT_TRUE(elm::find_first_of(stream.Spikes() > 0, static_cast<uchar>(255), winner)) << "WTA never spiked";
+
+    const Mat1f weights_prev = to_.Weights();
+    const Mat1f bias_prev = to_.Bias();
+    const unsigned long long version_prev = to_.WeightsVersion();
+    to_.Learn(stream);
+
+    Mat1f weights = to_.Weights();
+    Mat1f bias = to_.Bias();
+    for(int i=0; i<weights.cols; i+=2) {
+
+        EXPECT_GT(weights_prev(winner, i+1), weights(winner, i+1)) << "Weight for non-spiking input potentiating.";
+        EXPECT_LT(weights_prev(winner, i), weights(winner, i)) << "Weight for spiking input decaying.";
+    }
+    EXPECT_LT(bias_prev(winner), bias(winner)) << "Bias not increasing for spiking neuron.";
+
+    for(int r=0; r<weights.rows; r++) {
+
+        if(r != winner) {
+
+            EXPECT_MAT_EQ(weights_prev.row(r), weights.row(r)) << "Weights of non-spiking neuron changed.";
+            EXPECT_GT(bias_prev(r), bias(r)) << "Bias not decaying for non-spiking neuron.";
+        }
+    }
+
+    EXPECT_GT(to_.WeightsVersion(), version_prev);
+    EXPECT_EQ(1, to_.WeightsDelta(version_prev).rows);
+}
+
+TEST_F(LayerZLearnTest, Learn_Stream_Invalid)
+{
+    LayerZStream stream(nb_afferents_+1, to_.Spikes().cols, 5, 1.f, 1.f);
+    EXPECT_THROW(to_.Learn(stream), ExceptionBadDims);
+
+    LayerZStream stream2(nb_afferents_, to_.Spikes().cols+1, 5, 1.f, 1.f);
+    EXPECT_THROW(to_.Learn(stream2), ExceptionBadDims);
+}
+
+/**
+ * @brief Inference on a snapshot yields the layer's membrane potentials at the time of publishing
+ */
+TEST_F(LayerZLearnTest, Snapshot_Potentials)
+{
+    to_.Publish();
+    WeightsPublisher::SnapshotPtr s = to_.Snapshot();
+
+    FakeEvidence stimuli(nb_afferents_);
+    Mat1f spikes_in = static_cast<Mat1f>(stimuli.next(0));
+    signal_.Clear();
+    signal_.Append(NAME_INPUT_SPIKES, spikes_in);
+    to_.Activate(signal_);
+    to_.Response(signal_);
+
+    Mat1f u;
+    s->Potentials(spikes_in, u);
+    EXPECT_MAT_NEAR(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT), u, 1e-5);
+}
+
+/**
+ * @brief class for comparing event-driven against tick-by-tick simulation
+ */
+class LayerZEventDrivenTest : public LayerZLearnTest
+{
+protected:
+    static const int NB_TICKS = 300;
+    static const int CLEAR_EVERY = 50;  ///< ticks per stimulus
+
+    virtual void SetUp()
+    {
+        LayerZLearnTest::SetUp();
+
+        PTree params = config_.Params();
+        params.put(LayerZ::PARAM_WTA_FREQ, 50.f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+        config_.Params(params);
+
+        ZNeuron::ExactSilentUpdates(true); // bit-exact with ticking
+    }
+
+    virtual void TearDown()
+    {
+        ZNeuron::ExactSilentUpdates(false);
+    }
+
+    /**
+     * @brief Simulate from the same initial state and random draws
+     * @param event-driven flag
+     * @param skip over ticks in bulk, input held constant
+     * @param output spikes per tick
+     */
+    void Simulate(bool is_event_driven, bool is_bulk, Mat1f &spikes)
+    {
+        PTree params = config_.Params();
+        params.put(LayerZ::PARAM_EVENT_DRIVEN, is_event_driven);
+        config_.Params(params);
+
+        theRNG() = RNG(2010);
+        to_.Reset(config_);
+        to_.IONames(config_);
+
+        FakeEvidence stimuli(nb_afferents_);
+        Mat1f spikes_in = static_cast<Mat1f>(stimuli.next(0));
+
+        spikes = Mat1f::zeros(NB_TICKS, to_.Spikes().cols);
+        int t=0;
+        while(t < NB_TICKS) {
+
+            signal_.Clear();
+            signal_.Append(NAME_INPUT_SPIKES, spikes_in);
+
+            // don't skip past clearing the history
+            const int nb_skip = is_bulk? std::min(to_.TicksToNextEvent(), CLEAR_EVERY-t%CLEAR_EVERY) : 0;
+            if(nb_skip > 0) {
+
+                to_.Skip(signal_, nb_skip);
+                t += nb_skip;
+            }
+            else {
+
+                // no Response() on every tick, such that deferred updates pile up
+                to_.Activate(signal_);
+                to_.Learn();
+                to_.Spikes().copyTo(spikes.row(t++));
+            }
+
+            if(t % CLEAR_EVERY == 0) {
+
+                to_.Clear();
+            }
+        }
+        to_.Response(signal_);
+    }
+};
+
+TEST_F(LayerZEventDrivenTest, SameAsTicking)
+{
+    Mat1f spikes_ticking;
+    Simulate(false, false, spikes_ticking);
+    const Mat1f weights = signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS).clone();
+    const Mat1f bias = signal_.MostRecentMat1f(NAME_OUTPUT_BIAS).clone();
+    ASSERT_GT(countNonZero(spikes_ticking), 0) << "WTA never spiked";
+
+    Mat1f spikes_event_driven;
+    Simulate(true, false, spikes_event_driven);
+
+    EXPECT_MAT_EQ(spikes_ticking, spikes_event_driven);
+    EXPECT_MAT_EQ(weights, signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS));
+    EXPECT_MAT_EQ(bias, signal_.MostRecentMat1f(NAME_OUTPUT_BIAS));
+}
+
+TEST_F(LayerZEventDrivenTest, Skip)
+{
+    Mat1f spikes_ticking;
+    Simulate(false, false, spikes_ticking);
+    const Mat1f weights = signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS).clone();
+    const Mat1f bias = signal_.MostRecentMat1f(NAME_OUTPUT_BIAS).clone();
+
+    Mat1f spikes_skipped;
+    Simulate(false, true, spikes_skipped);
+
+    EXPECT_MAT_EQ(spikes_ticking, spikes_skipped);
+    EXPECT_MAT_EQ(weights, signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS));
+    EXPECT_MAT_EQ(bias, signal_.MostRecentMat1f(NAME_OUTPUT_BIAS));
+}
+
+TEST_F(LayerZEventDrivenTest, SkipOverSpike)
+{
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    int nb_ticks = to_.TicksToNextEvent();
+    EXPECT_THROW(to_.Skip(signal_, nb_ticks+1), ExceptionValueError);
+    EXPECT_NO_THROW(to_.Skip(signal_, nb_ticks));
+    EXPECT_EQ(0, to_.TicksToNextEvent());
+
+    to_.Activate(signal_);
+    to_.Response(signal_);
+    EXPECT_EQ(1, countNonZero(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES)));
+}
+
+/**
+ * @brief Inference alone does not learn, neither on skipped nor on spike ticks
+ */
+TEST_F(LayerZEventDrivenTest, ActivateWithoutLearn)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_EVENT_DRIVEN, true);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+
+    const Mat1f bias = to_.Bias().clone();
+    const Mat1f weights = to_.Weights().clone();
+
+    int nb_spikes = 0;
+    for(int t=0; t<NB_TICKS; t++) {
+
+        to_.Activate(signal_);
+        to_.Response(signal_);
+        nb_spikes += countNonZero(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES));
+    }
+    ASSERT_GT(nb_spikes, 0) << "WTA never spiked";
+
+    to_.Flush();
+    EXPECT_MAT_EQ(bias, to_.Bias());
+    EXPECT_MAT_EQ(weights, to_.Weights());
+}
+
+/**
+ * @brief class for covering reconfiguration of a live layer
+ */
+class LayerZReconfigureTest : public LayerZLearnTest
+{
+protected:
+    virtual void SetUp()
+    {
+        LayerZLearnTest::SetUp();
+
+        PTree params = config_.Params();
+        params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+        params.put(LayerZ::PARAM_SEED_GROWTH, true);
+        config_.Params(params);
+        to_.Reset(config_);
+        to_.IONames(config_);
+    }
+
+    /**
+     * @brief Let layer learn from alternating stimuli
+     * @param no. of ticks
+     */
+    void Run(int nb_ticks)
+    {
+        FakeEvidence stimuli(nb_afferents_);
+        for(int t=0; t<nb_ticks; t++) {
+
+            signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(0)));
+            to_.Activate(signal_);
+            to_.Learn();
+        }
+    }
+
+    /**
+     * @brief Reconfigure with a single parameter
+     */
+    template <typename T>
+    void Reconfigure(const string &key, const T &value)
+    {
+        PTree params;
+        params.put(key, value);
+        LayerConfig cfg;
+        cfg.Params(params);
+        to_.Reconfigure(cfg);
+    }
+
+    Mat1f Weights()
+    {
+        to_.Response(signal_);
+        return signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS).clone();
+    }
+};
+
+TEST_F(LayerZReconfigureTest, NoChange)
+{
+    Run(20);
+    const Mat1f w = Weights();
+
+    EXPECT_NO_THROW(to_.Reconfigure(LayerConfig()));
+    EXPECT_MAT_EQ(w, Weights());
+    EXPECT_MAT_EQ(Mat1i::zeros(1, w.rows), to_.NbWins()) << "Win counts not starting over";
+}
+
+TEST_F(LayerZReconfigureTest, Invalid)
+{
+    Run(5);
+    const Mat1f w = Weights();
+
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_NB_AFFERENTS, nb_afferents_+1), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_NB_OUTPUT_NODES, 0), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_LEN_HISTORY, 0), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_WTA_FREQ, -1.f), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_DELTA_T, 0.f), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_CHANGE_SMOOTHING, 0.f), ExceptionValueError);
+
+    EXPECT_MAT_EQ(w, Weights()) << "Failed reconfiguration modified layer";
+}
+
+TEST_F(LayerZReconfigureTest, Grow)
+{
+    Run(20);
+    const Mat1f w = Weights();
+
+    Reconfigure(LayerZ::PARAM_NB_OUTPUT_NODES, w.rows+5);
+
+    Mat1f w_grown = Weights();
+    ASSERT_EQ(w.rows+5, w_grown.rows);
+    EXPECT_MAT_EQ(w, w_grown.rowRange(0, w.rows)) << "Existing neurons changed";
+
+    // new neurons seeded from inputs
+    const float w_on = std::log(1.f-ZNeuron::SEED_NOISE);
+    const float w_off = std::log(ZNeuron::SEED_NOISE);
+    for(int r=w.rows; r<w_grown.rows; r++) {
+
+        for(int c=0; c<w_grown.cols; c++) {
+
+            float v = w_grown(r, c);
+            EXPECT_TRUE(v == w_on || v == w_off) << "Expecting seeded weight";
+        }
+    }
+
+    to_.Activate(signal_);
+    to_.Response(signal_);
+    EXPECT_MAT_DIMS_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES), Size2i(w_grown.rows, 1));
+    EXPECT_MAT_DIMS_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_BIAS), Size2i(w_grown.rows, 1));
+    EXPECT_MAT_DIMS_EQ(to_.StateDistr(), Size2i(w_grown.rows, 1));
+}
+
+/**
+ * @brief Without tracking seed candidates, new neurons start out random
+ */
+TEST_F(LayerZReconfigureTest, Grow_Unseeded)
+{
+    Reconfigure(LayerZ::PARAM_SEED_GROWTH, false);
+    Run(20);
+    const Mat1f w = Weights();
+
+    Reconfigure(LayerZ::PARAM_NB_OUTPUT_NODES, w.rows+5);
+
+    Mat1f w_grown = Weights();
+    ASSERT_EQ(w.rows+5, w_grown.rows);
+    EXPECT_MAT_EQ(w, w_grown.rowRange(0, w.rows)) << "Existing neurons changed";
+
+    const float w_on = std::log(1.f-ZNeuron::SEED_NOISE);
+    const float w_off = std::log(ZNeuron::SEED_NOISE);
+    int nb_seeded = 0;
+    for(int r=w.rows; r<w_grown.rows; r++) {
+
+        for(int c=0; c<w_grown.cols; c++) {
+
+            float v = w_grown(r, c);
+            nb_seeded += (v == w_on || v == w_off)? 1 : 0;
+        }
+    }
+    EXPECT_EQ(0, nb_seeded) << "Expecting random weights";
+}
+
+TEST_F(LayerZReconfigureTest, Shrink)
+{
+    Run(100);
+    const Mat1f w = Weights();
+    const Mat1i nb_wins = to_.NbWins();
+    ASSERT_EQ(100, static_cast<int>(sum(nb_wins)(0)));
+
+    const int nb_kept = 3;
+    Reconfigure(LayerZ::PARAM_NB_OUTPUT_NODES, nb_kept);
+
+    Mat1f w_shrunk = Weights();
+    ASSERT_EQ(nb_kept, w_shrunk.rows);
+
+    // kept neurons won at least as often as any removed one
+    std::vector<int> sorted_wins(nb_wins.begin(), nb_wins.end());
+    std::sort(sorted_wins.begin(), sorted_wins.end(), std::greater<int>());
+    int r=0;
+    int min_kept = sorted_wins[0];
+    for(int i=0; i<w.rows; i++) {
+
+        if(r < nb_kept && Equal(w.row(i), w_shrunk.row(r))) {
+
+            min_kept = std::min(min_kept, nb_wins(i));
+            r++;
+        }
+    }
+    EXPECT_EQ(nb_kept, r) << "Kept neurons changed or reordered";
+    EXPECT_GE(min_kept, sorted_wins[nb_kept]);
+}
+
+TEST_F(LayerZReconfigureTest, Prune)
+{
+    // nobody won yet, nothing to prune
+    Reconfigure(LayerZ::PARAM_PRUNE, true);
+    const Mat1f w = Weights();
+    EXPECT_EQ(10, w.rows);
+
+    Run(3);
+    const Mat1i nb_wins = to_.NbWins();
+    const int nb_winners = countNonZero(nb_wins);
+    ASSERT_LT(nb_winners, w.rows);
+
+    Mat1f w_learned = Weights();
+
+    Reconfigure(LayerZ::PARAM_PRUNE, true);
+
+    // winners first, dead neurons replaced by seeded ones
+    Mat1f w_pruned = Weights();
+    ASSERT_EQ(w.rows, w_pruned.rows);
+    int r=0;
+    for(int i=0; i<w.rows; i++) {
+
+        if(nb_wins(i) > 0) {
+
+            EXPECT_MAT_EQ(w_learned.row(i), w_pruned.row(r++));
+        }
+    }
+    EXPECT_EQ(nb_winners, r);
+}
+
+/**
+ * @brief Pruning and growing back to the same no. of outputs still clears per-neuron state
+ */
+TEST_F(LayerZReconfigureTest, Prune_SameNbOutputs)
+{
+    to_.EnableStats(true);
+    Run(3);
+    ASSERT_LT(countNonZero(to_.NbWins()), 10);
+    ASSERT_GT(to_.Stats().NbSpikes(), 0ULL);
+
+    Reconfigure(LayerZ::PARAM_PRUNE, true);
+    ASSERT_EQ(10, Weights().rows);
+
+    EXPECT_EQ(0ULL, to_.Stats().NbSpikes()) << "Statistics refer to neurons before pruning";
+    EXPECT_MAT_EQ(Mat1i::zeros(1, 10), to_.Stats().Winners());
+    EXPECT_MAT_EQ(Mat1i::zeros(1, 10), to_.NbWins());
+
+    to_.Response(signal_);
+    EXPECT_EQ(0, countNonZero(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES))) << "Spikes refer to neurons before pruning";
+}
+
+TEST_F(LayerZReconfigureTest, Timing)
+{
+    Run(5);
+    const Mat1f w = Weights();
+
+    PTree params;
+    params.put(LayerZ::PARAM_LEN_HISTORY, 10);
+    params.put(LayerZ::PARAM_WTA_FREQ, 0.f);
+    params.put(LayerZ::PARAM_DELTA_T, 2.f);
+    LayerConfig cfg;
+    cfg.Params(params);
+    to_.Reconfigure(cfg);
+
+    EXPECT_MAT_EQ(w, Weights());
+
+    // no more spikes
+    for(int t=0; t<10; t++) {
+
+        to_.Activate(signal_);
+        to_.Learn();
+        EXPECT_EQ(0, countNonZero(to_.Spikes()));
+    }
+    EXPECT_MAT_EQ(w, Weights());
+}
+
+TEST_F(LayerZLearnTest, WeightsAndBias)
+{
+    to_.Response(signal_);
+
+    EXPECT_MAT_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_WEIGHTS), to_.Weights());
+    EXPECT_MAT_EQ(signal_.MostRecentMat1f(NAME_OUTPUT_BIAS), to_.Bias());
+}
+
+TEST_F(LayerZLearnTest, Restore)
+{
+    Mat1f weights_all = to_.WeightsAll();
+    EXPECT_MAT_EQ(to_.Bias(), weights_all.col(0).t());
+    EXPECT_MAT_EQ(to_.Weights(), weights_all.colRange(1, weights_all.cols));
+
+    weights_all -= 1.f;
+    const unsigned long long version_prev = to_.WeightsVersion();
+    to_.Restore(weights_all);
+
+    EXPECT_MAT_EQ(weights_all, to_.WeightsAll());
+    EXPECT_GT(to_.WeightsVersion(), version_prev);
+    EXPECT_EQ(weights_all.rows, to_.WeightsDelta(version_prev).rows) << "Expecting all rows changed.";
+
+    // neurons keep learning on restored weights
+    FakeEvidence stimuli(nb_afferents_);
+    signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(0)));
+    to_.Activate(signal_);
+    to_.Learn();
+    EXPECT_FALSE(Equal(weights_all, to_.WeightsAll()));
+
+    EXPECT_THROW(to_.Restore(Mat1f::zeros(weights_all.rows+1, weights_all.cols)), ExceptionBadDims);
+    EXPECT_THROW(to_.Restore(Mat1f::zeros(weights_all.rows, weights_all.cols-1)), ExceptionBadDims);
+}
+
+TEST_F(LayerZLearnTest, Quantize)
+{
+    QuantizedWeights q = to_.Quantize(QuantizedWeights::DEPTH_8);
+    EXPECT_EQ(to_.Weights().rows, q.NbOutputs());
+    EXPECT_EQ(nb_afferents_, q.NbAfferents());
+    EXPECT_MAT_NEAR(to_.Weights(), q.Dequantize(), 0.5f*q.Scale()+1e-5f);
+
+    to_.Activate(signal_);
+    to_.Response(signal_);
+
+    Mat1f u;
+    q.Potentials(signal_.MostRecentMat1f(NAME_INPUT_SPIKES), u);
+    EXPECT_MAT_NEAR(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT), u, 0.5f*q.Scale()*nb_afferents_+1e-5f);
+}
+
+TEST_F(LayerZLearnTest, Sparsify)
+{
+    SparseWeights sparse = to_.Sparsify();
+    EXPECT_EQ(to_.Weights().rows, sparse.NbOutputs());
+    EXPECT_EQ(nb_afferents_, sparse.NbAfferents());
+    EXPECT_MAT_NEAR(to_.Weights(), sparse.Dense(), 1e-5f);
+
+    to_.Activate(signal_);
+    to_.Response(signal_);
+
+    Mat1f u;
+    sparse.Potentials(signal_.MostRecentMat1f(NAME_INPUT_SPIKES), u);
+    EXPECT_MAT_NEAR(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT), u, 1e-4f);
+}
+
+/**
+ * @brief Potentials from sparse weights match dense ones
+ */
+TEST_F(LayerZLearnTest, SparsePotentials)
+{
+    Mat1f u_dense;
+    for(int sparse=0; sparse<2; sparse++) {
+
+        FakeEvidence stimuli(nb_afferents_);
+
+        PTree params = config_.Params();
+        params.put(LayerZ::PARAM_SPARSE, sparse > 0);
+        params.put(LayerZ::PARAM_SPARSE_REBUILD, 3);
+        config_.Params(params);
+
+        theRNG() = RNG(2010);
+        to_.Reset(config_);
+        to_.IONames(config_);
+
+        Mat1f u;
+        for(int t=0; t<10; t++) {
+
+            signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(0)));
+            to_.Activate(signal_);
+            to_.Response(signal_);
+            u.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT));
+        }
+
+        if(sparse > 0) {
+
+            EXPECT_MAT_NEAR(u_dense, u, 1e-4f);
+        }
+        else {
+
+            u_dense = u;
+        }
+    }
+}
+
+TEST_F(LayerZTest, IsSpecialized)
+{
+    EXPECT_FALSE(to_.IsSpecialized()) << "No kernel registered for this geometry.";
+
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_AFFERENTS, 784);
+    params.put(LayerZ::PARAM_LEN_HISTORY, 5);
+    config_.Params(params);
+    to_.Reset(config_);
+    EXPECT_TRUE(to_.IsSpecialized());
+
+    LayerConfig cfg;
+    PTree changes;
+    changes.put(LayerZ::PARAM_SPECIALIZED, false);
+    cfg.Params(changes);
+    to_.Reconfigure(cfg);
+    EXPECT_FALSE(to_.IsSpecialized());
+
+    changes.put(LayerZ::PARAM_SPECIALIZED, true);
+    changes.put(LayerZ::PARAM_LEN_HISTORY, 3);
+    cfg.Params(changes);
+    to_.Reconfigure(cfg);
+    EXPECT_FALSE(to_.IsSpecialized()) << "No kernel registered for new history length.";
+}
+
+/**
+ * @brief Same potentials and spikes from specialized and generic kernels, event-driven
+ */
+TEST_F(LayerZLearnTest, SpecializedPotentials)
+{
+    const int nb_afferents = 784;
+    Mat1f u_generic, spikes_generic;
+    for(int specialized=0; specialized<2; specialized++) {
+
+        FakeEvidence stimuli(nb_afferents);
+
+        PTree params = config_.Params();
+        params.put(LayerZ::PARAM_NB_AFFERENTS, nb_afferents);
+        params.put(LayerZ::PARAM_LEN_HISTORY, 5);
+        params.put(LayerZ::PARAM_WTA_FREQ, 200.f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+        params.put(LayerZ::PARAM_EVENT_DRIVEN, true);
+        params.put(LayerZ::PARAM_SPECIALIZED, specialized > 0);
+        config_.Params(params);
+
+        theRNG() = RNG(2010);
+        to_.Reset(config_);
+        to_.IONames(config_);
+        ASSERT_EQ(specialized > 0, to_.IsSpecialized());
+
+        Mat1f u, spikes;
+        for(int t=0; t<50; t++) {
+
+            signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(0)));
+            to_.Activate(signal_);
+            to_.Response(signal_);
+            to_.Learn();
+            u.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_MEM_POT));
+            spikes.push_back(signal_.MostRecentMat1f(NAME_OUTPUT_SPIKES));
+        }
+
+        if(specialized > 0) {
+
+            EXPECT_MAT_NEAR(u_generic, u, 1e-3f);
+            EXPECT_MAT_EQ(spikes_generic, spikes);
+        }
+        else {
+
+            u_generic = u;
+            spikes_generic = spikes;
+        }
+    }
+}
+
+TEST_F(LayerZTest, InvalidSparseRebuild)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_SPARSE_REBUILD, 0);
+    config_.Params(params);
+    EXPECT_THROW(to_.Reset(config_), ExceptionValueError);
+}
+
+TEST_F(LayerZTest, InvalidPublishEvery)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_PUBLISH_EVERY, -1);
+    config_.Params(params);
+    EXPECT_THROW(to_.Reset(config_), ExceptionValueError);
+}
+
+TEST_F(LayerZTest, InvalidNbColumns)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_COLUMNS, 0);
+    config_.Params(params);
+    EXPECT_THROW(to_.Reset(config_), ExceptionValueError);
+
+    params.put(LayerZ::PARAM_NB_COLUMNS, 3);
+    config_.Params(params);
+    EXPECT_THROW(to_.Reset(config_), ExceptionValueError) << "10 outputs not divisible into 3 columns";
+}
+
+/**
+ * @brief Each column's WTA circuit picks its own winner among its own neurons
+ */
+TEST_F(LayerZLearnTest, Columns)
+{
+    const int NB_COLUMNS=5;
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_COLUMNS, NB_COLUMNS);
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+    EXPECT_EQ(NB_COLUMNS, to_.NbColumns());
+
+    const int column_size = to_.Spikes().cols/NB_COLUMNS;
+
+    FakeEvidence stimuli(nb_afferents_);
+    for(int t=0; t<10; t++) {
+
+        const Mat1f weights_prev = to_.Weights();
+
+        signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(t%2)));
+        to_.Activate(signal_);
+
+        Mat1f spikes = to_.Spikes().clone();
+        Mat1f distr = to_.StateDistr();
+        EXPECT_MAT_DIMS_EQ(distr, spikes.size());
+        for(int c=0; c<NB_COLUMNS; c++) {
+
+            EXPECT_EQ(1, countNonZero(spikes.colRange(c*column_size, (c+1)*column_size))) << "Expecting one winner in column " << c;
+            EXPECT_NEAR(1., sum(distr.colRange(c*column_size, (c+1)*column_size))(0), 1e-5) << "Expecting posterior per column " << c;
+        }
+
+        to_.Learn();
+
+        // only winners change their weights
+        const Mat1f weights = to_.Weights();
+        for(int i=0; i<spikes.cols; i++) {
+
+            EXPECT_EQ(spikes(i) != 0.f, !Equal(weights_prev.row(i), weights.row(i))) << "neuron " << i;
+        }
+    }
+}
+
+/**
+ * @brief Profiling columns times their parallel learning without changing the outcome
+ */
+TEST_F(LayerZLearnTest, Columns_Stats)
+{
+    const int N=10;
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_COLUMNS, 5);
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f); // spike on every tick
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+
+    Mat1f weights[2];
+    for(int stats=0; stats<2; stats++) {
+
+        params.put(LayerZ::PARAM_STATS, stats > 0);
+        config_.Params(params);
+        theRNG() = RNG(2010);
+        to_.Reset(config_);
+        to_.IONames(config_);
+
+        FakeEvidence stimuli(nb_afferents_);
+        for(int t=0; t<N; t++) {
+
+            signal_.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(t%2)));
+            to_.Activate(signal_);
+            to_.Learn();
+        }
+        weights[stats] = to_.Weights();
+    }
+
+    EXPECT_MAT_EQ(weights[0], weights[1]);
+    EXPECT_EQ(static_cast<unsigned long long>(N), to_.Stats().Count(LayerZStats::PHASE_LEARN));
+    EXPECT_EQ(0ULL, to_.Stats().Count(LayerZStats::PHASE_UPDATE)) << "Expecting parallel learning, not the single column path";
+}
+
+TEST_F(LayerZLearnTest, Columns_Stream)
+{
+    const int NB_COLUMNS=2;
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_COLUMNS, NB_COLUMNS);
+    params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+    params.put(LayerZ::PARAM_DELTA_T, 1.f);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+    to_.Publish();
+
+    LayerZStream stream = to_.CreateStream();
+    FakeEvidence stimuli(nb_afferents_);
+    stream.Activate(*to_.Snapshot(), static_cast<Mat1f>(stimuli.next(0)));
+
+    const int column_size = stream.NbOutputs()/NB_COLUMNS;
+    for(int c=0; c<NB_COLUMNS; c++) {
+
+        EXPECT_EQ(1, countNonZero(stream.Spikes().colRange(c*column_size, (c+1)*column_size))) << "column " << c;
+    }
+
+    const unsigned long long version_prev = to_.WeightsVersion();
+    to_.Learn(stream);
+    EXPECT_EQ(NB_COLUMNS, to_.WeightsDelta(version_prev).rows);
+}
+
+TEST_F(LayerZReconfigureTest, Columns)
+{
+    PTree params = config_.Params();
+    params.put(LayerZ::PARAM_NB_COLUMNS, 2);
+    config_.Params(params);
+    to_.Reset(config_);
+    to_.IONames(config_);
+    Run(5);
+    const Mat1f w = Weights();
+
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_NB_COLUMNS, 5), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_NB_OUTPUT_NODES, 12), ExceptionValueError);
+    EXPECT_THROW(Reconfigure(LayerZ::PARAM_PRUNE, true), ExceptionValueError);
+    EXPECT_MAT_EQ(w, Weights()) << "Failed reconfiguration modified layer";
+
+    EXPECT_NO_THROW(Reconfigure(LayerZ::PARAM_WTA_FREQ, 200.f));
+    EXPECT_EQ(2, to_.NbColumns());
+    EXPECT_NO_THROW(Run(5));
+}
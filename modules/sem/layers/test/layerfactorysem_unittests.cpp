@@ -26,6 +26,14 @@ TEST_F(LayerFactorySEMStaticTest, CreateLayerPtrShared)
         shared_ptr<base_Layer> ptr = LayerFactorySEM::CreateShared("LayerZ");
         EXPECT_TRUE(bool(ptr));
     }
+    {
+        shared_ptr<base_Layer> ptr = LayerFactorySEM::CreateShared("LayerZStack");
+        EXPECT_TRUE(bool(ptr));
+    }
+    {
+        shared_ptr<base_Layer> ptr = LayerFactorySEM::CreateShared("LayerZConv");
+        EXPECT_TRUE(bool(ptr));
+    }
     {
         shared_ptr<base_Layer> ptr = LayerFactorySEM::CreateShared("WeightedSum");
         EXPECT_TRUE(bool(ptr));
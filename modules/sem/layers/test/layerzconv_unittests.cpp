@@ -0,0 +1,377 @@
+#include "sem/layers/layerzconv.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "elm/ts/ts.h"
+#include "sem/neuron/zneuron.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string NAME_INPUT_SPIKES   = "in";
+const string NAME_OUTPUT_SPIKES  = "out";
+
+const int INPUT_ROWS = 6;
+const int INPUT_COLS = 8;
+const int NB_CHANNELS = 2;
+const int PATCH_ROWS = 3;
+const int PATCH_COLS = 4;
+const int STRIDE = 2;
+const int NB_OUTPUTS = 5;
+
+class LayerZConvTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        config_ = Config(INPUT_ROWS, INPUT_COLS);
+        to_.Reset(config_);
+        to_.IONames(config_);
+    }
+
+    /**
+     * @brief Configure layer spiking on every tick
+     * @param no. of input rows
+     * @param no. of input columns
+     */
+    static LayerConfig Config(int input_rows, int input_cols)
+    {
+        PTree params;
+        params.put(LayerZConv::PARAM_INPUT_ROWS, input_rows);
+        params.put(LayerZConv::PARAM_INPUT_COLS, input_cols);
+        params.put(LayerZConv::PARAM_NB_CHANNELS, NB_CHANNELS);
+        params.put(LayerZConv::PARAM_PATCH_ROWS, PATCH_ROWS);
+        params.put(LayerZConv::PARAM_PATCH_COLS, PATCH_COLS);
+        params.put(LayerZConv::PARAM_STRIDE, STRIDE);
+        params.put(LayerZConv::PARAM_NB_OUTPUT_NODES, NB_OUTPUTS);
+        params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+
+        LayerConfig config;
+        config.Params(params);
+        config.Input(LayerZConv::KEY_INPUT_SPIKES, NAME_INPUT_SPIKES);
+        config.Output(LayerZConv::KEY_OUTPUT_SPIKES, NAME_OUTPUT_SPIKES);
+        return config;
+    }
+
+    /**
+     * @brief Generate random input spikes
+     * @param no. of input rows
+     * @param no. of input columns
+     * @return input map, channels consecutive
+     */
+    static Mat1f Stimulus(int input_rows, int input_cols)
+    {
+        Mat1f spikes(input_rows, input_cols*NB_CHANNELS);
+        randu(spikes, 0.f, 1.f);
+        return static_cast<Mat1f>(spikes > 0.5f)/255.f;
+    }
+
+    LayerZConv to_;         ///< test object
+    LayerConfig config_;    ///< default configuration
+};
+
+TEST_F(LayerZConvTest, Reset)
+{
+    EXPECT_EQ(3, to_.OutputSize().width);
+    EXPECT_EQ(2, to_.OutputSize().height);
+    EXPECT_EQ(6, to_.NbPositions());
+    EXPECT_MAT_DIMS_EQ(to_.Weights(), Size(PATCH_ROWS*PATCH_COLS*NB_CHANNELS, NB_OUTPUTS));
+    EXPECT_MAT_DIMS_EQ(to_.Bias(), Size(NB_OUTPUTS, 1));
+}
+
+TEST_F(LayerZConvTest, Reset_Invalid)
+{
+    {
+        LayerConfig config = Config(INPUT_ROWS, PATCH_COLS-1);
+        LayerZConv to;
+        EXPECT_THROW(to.Reset(config), ExceptionValueError);
+    }
+    {
+        LayerConfig config = Config(INPUT_ROWS, INPUT_COLS);
+        PTree params = config.Params();
+        params.put(LayerZConv::PARAM_STRIDE, 0);
+        config.Params(params);
+
+        LayerZConv to;
+        EXPECT_THROW(to.Reset(config), ExceptionValueError);
+    }
+}
+
+/**
+ * @brief Weights are shared, their size does not depend on the input map
+ */
+TEST_F(LayerZConvTest, WeightsIndependentOfInputSize)
+{
+    LayerZConv to;
+    to.Reset(Config(INPUT_ROWS*10, INPUT_COLS*10));
+
+    EXPECT_GT(to.NbPositions(), to_.NbPositions());
+    EXPECT_MAT_DIMS_EQ(to.Weights(), to_.Weights().size());
+}
+
+TEST_F(LayerZConvTest, Response)
+{
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Stimulus(INPUT_ROWS, INPUT_COLS));
+    to_.Activate(signal);
+    to_.Response(signal);
+
+    Mat1f spikes = signal.MostRecentMat1f(NAME_OUTPUT_SPIKES);
+    EXPECT_MAT_DIMS_EQ(spikes, Size(to_.NbPositions()*NB_OUTPUTS, 1));
+
+    for(int i=0; i<to_.NbPositions(); i++) {
+
+        EXPECT_EQ(1, countNonZero(spikes.colRange(i*NB_OUTPUTS, (i+1)*NB_OUTPUTS))) << "Expecting exactly one winner per position " << i;
+        EXPECT_MAT_EQ(to_.Position(i).Spikes(), spikes.colRange(i*NB_OUTPUTS, (i+1)*NB_OUTPUTS));
+    }
+}
+
+/**
+ * @brief Each position computes potentials from its own receptive field through the shared weights
+ */
+TEST_F(LayerZConvTest, ReceptiveFields)
+{
+    Mat1f in = Stimulus(INPUT_ROWS, INPUT_COLS);
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, in.reshape(1, 1)); // any shape with matching no. of elements
+    to_.Activate(signal);
+
+    Mat1f weights_all;
+    hconcat(to_.Bias().t(), to_.Weights(), weights_all);
+    WeightsSnapshot w(weights_all, 1);
+
+    for(int r=0; r<to_.OutputSize().height; r++) {
+
+        for(int c=0; c<to_.OutputSize().width; c++) {
+
+            Mat1f patch = in(Rect(c*STRIDE*NB_CHANNELS, r*STRIDE, PATCH_COLS*NB_CHANNELS, PATCH_ROWS)).clone();
+
+            Mat1f u;
+            w.Potentials(patch.reshape(1, 1), u);
+            EXPECT_MAT_NEAR(u, to_.Position(r*to_.OutputSize().width+c).MembranePotentials(), 1e-5)
+                    << "position (" << r << ", " << c << ")";
+        }
+    }
+}
+
+TEST_F(LayerZConvTest, Learn)
+{
+    Mat1f weights0 = to_.Weights();
+    Mat1f bias0 = to_.Bias();
+
+    for(int t=0; t<5; t++) {
+
+        Signal signal;
+        signal.Append(NAME_INPUT_SPIKES, Stimulus(INPUT_ROWS, INPUT_COLS));
+        to_.Activate(signal);
+        to_.Learn();
+    }
+
+    EXPECT_GT(norm(weights0, to_.Weights(), NORM_L1), 0.);
+    EXPECT_GT(norm(bias0, to_.Bias(), NORM_L1), 0.);
+
+    // learned weights take effect on next tick
+    Mat1f in = Stimulus(INPUT_ROWS, INPUT_COLS);
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, in);
+    to_.Activate(signal);
+
+    Mat1f weights_all;
+    hconcat(to_.Bias().t(), to_.Weights(), weights_all);
+    Mat1f u;
+    WeightsSnapshot(weights_all, 1).Potentials(in(Rect(0, 0, PATCH_COLS*NB_CHANNELS, PATCH_ROWS)).clone().reshape(1, 1), u);
+    EXPECT_MAT_NEAR(u, to_.Position(0).MembranePotentials(), 1e-5);
+}
+
+/**
+ * @brief A single position learns like a plain LayerZ learning from the same stream
+ */
+TEST_F(LayerZConvTest, Learn_SinglePosition)
+{
+    LayerConfig config = Config(PATCH_ROWS, PATCH_COLS);
+
+    theRNG() = RNG(2010);
+    LayerZConv to;
+    to.Reset(config);
+    to.IONames(config);
+    ASSERT_EQ(1, to.NbPositions());
+
+    PTree params = config.Params();
+    params.put(LayerZ::PARAM_NB_AFFERENTS, PATCH_ROWS*PATCH_COLS*NB_CHANNELS);
+    LayerConfig config_z;
+    config_z.Params(params);
+
+    theRNG() = RNG(2010);
+    LayerZ z;
+    z.Reset(config_z);
+    EXPECT_MAT_EQ(z.Weights(), to.Weights());
+
+    for(int t=0; t<20; t++) {
+
+        Signal signal;
+        signal.Append(NAME_INPUT_SPIKES, Stimulus(PATCH_ROWS, PATCH_COLS));
+        to.Activate(signal);
+        z.Learn(to.Position(0));
+        to.Learn();
+    }
+
+    EXPECT_MAT_EQ(z.Weights(), to.Weights());
+    EXPECT_MAT_EQ(z.Bias(), to.Bias());
+}
+
+/**
+ * @brief Each neuron updates its bias once per tick, no matter how many positions it won at
+ */
+TEST_F(LayerZConvTest, Learn_BiasIndependentOfNbPositions)
+{
+    LayerConfig config_single = Config(PATCH_ROWS, PATCH_COLS);
+
+    theRNG() = RNG(2010);
+    LayerZConv single;
+    single.Reset(config_single);
+    single.IONames(config_single);
+
+    theRNG() = RNG(2010);
+    LayerZConv to;
+    to.Reset(config_);
+    to.IONames(config_);
+    EXPECT_MAT_EQ(single.Bias(), to.Bias());
+
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Stimulus(PATCH_ROWS, PATCH_COLS));
+    single.Activate(signal);
+    single.Response(signal);
+    Mat1f spikes_single = signal.MostRecentMat1f(NAME_OUTPUT_SPIKES).clone();
+
+    signal.Clear();
+    signal.Append(NAME_INPUT_SPIKES, Stimulus(INPUT_ROWS, INPUT_COLS));
+    to.Activate(signal);
+    to.Response(signal);
+    Mat1f spikes = signal.MostRecentMat1f(NAME_OUTPUT_SPIKES).reshape(1, to.NbPositions());
+
+    single.Learn();
+    to.Learn();
+
+    // more positions than neurons, at least one neuron won at several positions
+    ASSERT_GT(to.NbPositions(), NB_OUTPUTS);
+
+    int nb_compared = 0;
+    for(int i=0; i<NB_OUTPUTS; i++) {
+
+        // same step as a single position with the same outcome
+        const int nb_wins = countNonZero(spikes.col(i));
+        if((nb_wins > 0) == (spikes_single(i) != 0.f)) {
+
+            EXPECT_FLOAT_EQ(single.Bias()(i), to.Bias()(i)) << "neuron " << i << " won at " << nb_wins << " positions";
+            nb_compared++;
+        }
+    }
+    EXPECT_GT(nb_compared, 0);
+}
+
+/**
+ * @brief Weights stay within log probabilities with neurons winning at many positions with all afferents spiking
+ */
+TEST_F(LayerZConvTest, Learn_ManyPositions_WithinLimits)
+{
+    const int ROWS = 40;
+    const int COLS = 40;
+    LayerConfig config = Config(ROWS, COLS);
+
+    theRNG() = RNG(2010);
+    LayerZConv to;
+    to.Reset(config);
+    to.IONames(config);
+    ASSERT_GT(to.NbPositions(), 100*NB_OUTPUTS);
+
+    for(int t=0; t<10; t++) {
+
+        Signal signal;
+        signal.Append(NAME_INPUT_SPIKES, Mat1f::ones(ROWS, COLS*NB_CHANNELS));
+        to.Activate(signal);
+        to.Learn();
+
+        double min_weight, max_weight;
+        minMaxLoc(to.Weights(), &min_weight, &max_weight);
+        EXPECT_LE(max_weight, 0.) << "tick " << t;
+        EXPECT_GE(min_weight, -ZNeuron::WEIGHT_LIMIT) << "tick " << t;
+    }
+}
+
+/**
+ * @brief Outcome does not depend on the no. of threads activating positions
+ */
+TEST_F(LayerZConvTest, SameAcrossThreads)
+{
+    const int N=20;
+    const int nb_threads = getNumThreads();
+    vector<Mat1f> stimuli;
+    for(int t=0; t<N; t++) {
+
+        stimuli.push_back(Stimulus(INPUT_ROWS, INPUT_COLS));
+    }
+
+    Mat1f spikes[2];
+    Mat1f weights[2];
+    for(int k=0; k<2; k++) {
+
+        setNumThreads((k == 0)? 1 : nb_threads);
+
+        theRNG() = RNG(2010);
+        LayerZConv to;
+        to.Reset(config_);
+        to.IONames(config_);
+
+        for(int t=0; t<N; t++) {
+
+            Signal signal;
+            signal.Append(NAME_INPUT_SPIKES, stimuli[t]);
+            to.Activate(signal);
+            to.Learn();
+            to.Response(signal);
+            spikes[k].push_back(signal.MostRecentMat1f(NAME_OUTPUT_SPIKES).clone());
+        }
+        weights[k] = to.Weights();
+    }
+    setNumThreads(nb_threads);
+
+    EXPECT_MAT_EQ(spikes[0], spikes[1]);
+    EXPECT_MAT_EQ(weights[0], weights[1]);
+}
+
+TEST_F(LayerZConvTest, Reconfigure)
+{
+    Mat1f weights0 = to_.Weights();
+
+    PTree params;
+    params.put(LayerZConv::PARAM_NB_OUTPUT_NODES, NB_OUTPUTS+2);
+    LayerConfig config;
+    config.Params(params);
+    to_.Reconfigure(config);
+
+    EXPECT_MAT_EQ(weights0, to_.Weights().rowRange(0, NB_OUTPUTS));
+
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Stimulus(INPUT_ROWS, INPUT_COLS));
+    to_.Activate(signal);
+    to_.Response(signal);
+    EXPECT_MAT_DIMS_EQ(signal.MostRecentMat1f(NAME_OUTPUT_SPIKES), Size(to_.NbPositions()*(NB_OUTPUTS+2), 1));
+
+    params.put(LayerZConv::PARAM_STRIDE, STRIDE+1);
+    config.Params(params);
+    EXPECT_THROW(to_.Reconfigure(config), ExceptionValueError);
+}
+
+TEST_F(LayerZConvTest, Activate_Invalid)
+{
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Mat1f::zeros(INPUT_ROWS, INPUT_COLS));
+    EXPECT_THROW(to_.Activate(signal), ExceptionBadDims);
+}
+
+} // annonymous namespace
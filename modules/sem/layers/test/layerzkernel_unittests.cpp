@@ -0,0 +1,173 @@
+#include "sem/layers/layerzkernel.h"
+
+#include "sem/neuron/zneuron.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+const int NB_AFFERENTS = 784;   ///< registered geometry
+const int LEN_HISTORY = 5;
+const int NB_OUTPUTS = 10;
+
+class LayerZKernelTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        z_.clear();
+        for(int i=0; i<NB_OUTPUTS; i++) {
+
+            shared_ptr<ZNeuron> p(new ZNeuron);
+            p->Init(NB_AFFERENTS, LEN_HISTORY);
+            p->Seed(RandomSpikes(0.3f)); // spread out weights
+            z_.push_back(p);
+        }
+    }
+
+    /**
+     * @brief Generate random binary spikes
+     * @param fraction of afferents spiking
+     */
+    static Mat1f RandomSpikes(float density)
+    {
+        Mat1f r(1, NB_AFFERENTS);
+        randu(r, 0.f, 1.f);
+        Mat1f spikes = Mat1f::zeros(1, NB_AFFERENTS);
+        spikes.setTo(1.f, r < density);
+        return spikes;
+    }
+
+    /**
+     * @brief Reference potentials, one Predict() per neuron
+     */
+    Mat1f Predict(const Mat1f &spikes_in)
+    {
+        Mat1f u(1, NB_OUTPUTS);
+        for(int i=0; i<NB_OUTPUTS; i++) {
+
+            u(i) = z_[i]->Predict(spikes_in).at<float>(0);
+        }
+        return u;
+    }
+
+    base_LayerZKernel::VecLPtr z_;  ///< neurons
+};
+
+TEST_F(LayerZKernelTest, Registry)
+{
+    EXPECT_TRUE(LayerZKernelFactory::IsRegistered(NB_AFFERENTS, LEN_HISTORY));
+    EXPECT_TRUE(LayerZKernelFactory::IsRegistered(1568, 10));
+    EXPECT_FALSE(LayerZKernelFactory::IsRegistered(NB_AFFERENTS, 3));
+    EXPECT_FALSE(LayerZKernelFactory::IsRegistered(50, LEN_HISTORY));
+
+    shared_ptr<base_LayerZKernel> k = LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY);
+    EXPECT_TRUE(k->IsSpecialized());
+    EXPECT_EQ(NB_AFFERENTS, k->NbAfferents());
+    EXPECT_EQ(LEN_HISTORY, k->LenHistory());
+
+    k = LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY, false);
+    EXPECT_FALSE(k->IsSpecialized()) << "Expecting generic kernel when specialization disabled.";
+
+    k = LayerZKernelFactory::CreateShared(50, 3);
+    EXPECT_FALSE(k->IsSpecialized()) << "Expecting generic kernel for unregistered geometry.";
+    EXPECT_EQ(50, k->NbAfferents());
+    EXPECT_EQ(3, k->LenHistory());
+}
+
+/**
+ * @brief Specialized and generic potentials match Predict(), for sparse (gathered) and dense input
+ */
+TEST_F(LayerZKernelTest, Potentials)
+{
+    shared_ptr<base_LayerZKernel> specialized = LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY);
+    shared_ptr<base_LayerZKernel> generic = LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY, false);
+
+    const float DENSITY[] = {0.f, 0.02f, 0.1f, 0.5f, 1.f};
+    for(int d=0; d<5; d++) {
+
+        Mat1f spikes_in = RandomSpikes(DENSITY[d]);
+        Mat1f u_expected = Predict(spikes_in);
+
+        Mat1f u;
+        specialized->Potentials(spikes_in, z_, u);
+        EXPECT_MAT_DIMS_EQ(u, Size2i(NB_OUTPUTS, 1));
+        EXPECT_MAT_NEAR(u_expected, u, 1e-2f) << "density=" << DENSITY[d];
+
+        generic->Potentials(spikes_in, z_, u);
+        EXPECT_MAT_NEAR(u_expected, u, 1e-2f) << "density=" << DENSITY[d];
+    }
+}
+
+TEST_F(LayerZKernelTest, Potentials_NoAlloc)
+{
+    shared_ptr<base_LayerZKernel> to = LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY);
+
+    Mat1f u(1, NB_OUTPUTS);
+    const uchar *data = u.data;
+    to->Potentials(RandomSpikes(0.1f), z_, u);
+    EXPECT_EQ(data, u.data) << "Expecting output written in place.";
+}
+
+/**
+ * @brief Both kernels keep the same most recent skipped inputs, oldest first
+ */
+TEST_F(LayerZKernelTest, Skipped)
+{
+    shared_ptr<base_LayerZKernel> kernels[2] = {LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY),
+                                                LayerZKernelFactory::CreateShared(NB_AFFERENTS, LEN_HISTORY, false)};
+
+    for(int k=0; k<2; k++) {
+
+        shared_ptr<base_LayerZKernel> to = kernels[k];
+        EXPECT_EQ(0, to->NbSkipped());
+
+        Mat1f a = RandomSpikes(0.1f);
+        Mat1f b = RandomSpikes(0.1f);
+        Mat1f c = RandomSpikes(0.1f);
+        Mat1b mask_a = a != 0.f;
+        Mat1b mask_b = b != 0.f;
+        Mat1b mask_c = c != 0.f;
+
+        to->PushSkipped(a, 1);
+        EXPECT_EQ(1, to->NbSkipped());
+        EXPECT_MAT_EQ(mask_a, to->Skipped(0));
+
+        to->PushSkipped(b, 2);
+        to->PushSkipped(c, 1);
+        ASSERT_EQ(LEN_HISTORY-1, to->NbSkipped());
+        EXPECT_MAT_EQ(mask_a, to->Skipped(0));
+        EXPECT_MAT_EQ(mask_b, to->Skipped(1));
+        EXPECT_MAT_EQ(mask_b, to->Skipped(2));
+        EXPECT_MAT_EQ(mask_c, to->Skipped(3));
+
+        // more ticks than slots, oldest dropped
+        to->PushSkipped(a, 2);
+        ASSERT_EQ(LEN_HISTORY-1, to->NbSkipped());
+        EXPECT_MAT_EQ(mask_b, to->Skipped(0));
+        EXPECT_MAT_EQ(mask_c, to->Skipped(1));
+        EXPECT_MAT_EQ(mask_a, to->Skipped(2));
+        EXPECT_MAT_EQ(mask_a, to->Skipped(3));
+
+        to->PushSkipped(c, 100);
+        ASSERT_EQ(LEN_HISTORY-1, to->NbSkipped());
+        for(int t=0; t<LEN_HISTORY-1; t++) {
+
+            EXPECT_MAT_EQ(mask_c, to->Skipped(t));
+        }
+
+        to->ClearSkipped();
+        EXPECT_EQ(0, to->NbSkipped());
+    }
+}
+
+TEST_F(LayerZKernelTest, Skipped_NoHistory)
+{
+    shared_ptr<base_LayerZKernel> to = LayerZKernelFactory::CreateShared(10, 1);
+    to->PushSkipped(Mat1f::ones(1, 10), 5);
+    EXPECT_EQ(0, to->NbSkipped()) << "Expecting nothing kept without history beyond the current tick.";
+}
+
+} // annonymous namespace
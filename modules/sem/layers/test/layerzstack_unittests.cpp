@@ -0,0 +1,219 @@
+#include "sem/layers/layerzstack.h"
+
+#include "elm/core/exception.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "elm/ts/ts.h"
+#include "elm/ts/fakeevidence.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string NAME_INPUT_SPIKES   = "in";
+const string NAME_OUTPUT_SPIKES  = "out";
+
+const int NB_AFFERENTS = 20;
+
+class LayerZStackTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        nb_outputs_.clear();
+        nb_outputs_.push_back(10);
+        nb_outputs_.push_back(8);
+        nb_outputs_.push_back(4);
+
+        config_ = Config(nb_outputs_, true);
+        to_.Reset(config_);
+        to_.IONames(config_);
+    }
+
+    /**
+     * @brief Configure stack with one stage per no. of outputs
+     * @param no. of outputs per stage
+     * @param pipelined flag
+     */
+    static LayerConfig Config(const vector<int> &nb_outputs, bool is_pipelined)
+    {
+        PTree params;
+        params.put(LayerZStack::PARAM_NB_AFFERENTS, NB_AFFERENTS);
+        params.put(LayerZStack::PARAM_PIPELINED, is_pipelined);
+        params.put(LayerZ::PARAM_WTA_FREQ, 200.f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+
+        PTree stages;
+        for(size_t k=0; k<nb_outputs.size(); k++) {
+
+            PTree stage;
+            stage.put(LayerZ::PARAM_NB_OUTPUT_NODES, nb_outputs[k]);
+            stages.push_back(make_pair("", stage));
+        }
+        params.add_child(LayerZStack::PARAM_STAGES, stages);
+
+        LayerConfig config;
+        config.Params(params);
+        config.Input(LayerZStack::KEY_INPUT_SPIKES, NAME_INPUT_SPIKES);
+        config.Output(LayerZStack::KEY_OUTPUT_SPIKES, NAME_OUTPUT_SPIKES);
+        return config;
+    }
+
+    /**
+     * @brief Run stack over stimuli, optionally learning
+     * @param stack
+     * @param no. of ticks
+     * @param learning flag
+     * @return output spikes, one row per tick
+     */
+    static Mat1f Simulate(LayerZStack &to, int nb_ticks, bool is_learning)
+    {
+        FakeEvidence stimuli(NB_AFFERENTS);
+        Mat1f spikes;
+        for(int t=0; t<nb_ticks; t++) {
+
+            Signal signal;
+            signal.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(t%2)));
+            to.Activate(signal);
+            if(is_learning) {
+
+                to.Learn();
+            }
+            to.Response(signal);
+            spikes.push_back(signal.MostRecentMat1f(NAME_OUTPUT_SPIKES).clone());
+        }
+        return spikes;
+    }
+
+    LayerZStack to_;            ///< test object
+    LayerConfig config_;        ///< default configuration
+    vector<int> nb_outputs_;    ///< no. of outputs per stage
+};
+
+TEST_F(LayerZStackTest, Reset)
+{
+    EXPECT_EQ(3, to_.NbStages());
+    EXPECT_EQ(2, to_.Latency());
+    EXPECT_TRUE(to_.IsPipelined());
+
+    for(int k=0; k<to_.NbStages(); k++) {
+
+        EXPECT_EQ(nb_outputs_[k], to_.Stage(k)->Spikes().cols);
+        EXPECT_EQ((k == 0)? NB_AFFERENTS : nb_outputs_[k-1], to_.Stage(k)->Weights().cols) << "stage " << k;
+    }
+}
+
+TEST_F(LayerZStackTest, Reset_NoStages)
+{
+    PTree params;
+    params.put(LayerZStack::PARAM_NB_AFFERENTS, NB_AFFERENTS);
+    LayerConfig config;
+    config.Params(params);
+
+    LayerZStack to;
+    EXPECT_THROW(to.Reset(config), ExceptionValueError);
+}
+
+TEST_F(LayerZStackTest, Response)
+{
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Mat1f::ones(1, NB_AFFERENTS));
+    to_.Activate(signal);
+    to_.Response(signal);
+
+    ASSERT_TRUE(signal.Exists(NAME_OUTPUT_SPIKES));
+    EXPECT_MAT_DIMS_EQ(signal.MostRecentMat1f(NAME_OUTPUT_SPIKES), Size(nb_outputs_.back(), 1));
+}
+
+/**
+ * @brief Each stage processes the previous stage's output of the previous tick
+ */
+TEST_F(LayerZStackTest, HandOff)
+{
+    FakeEvidence stimuli(NB_AFFERENTS);
+    Mat1f spikes_prev = Mat1f::zeros(1, nb_outputs_[0]); // silence before first tick
+
+    to_.Stage(1)->Publish();
+    WeightsPublisher::SnapshotPtr w = to_.Stage(1)->Snapshot();
+
+    for(int t=0; t<10; t++) {
+
+        Signal signal;
+        signal.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(t%2)));
+        to_.Activate(signal);
+
+        Mat1f u, distr;
+        w->Potentials(spikes_prev, u);
+        double u_max;
+        cv::minMaxIdx(u, 0, &u_max);
+        cv::exp(u-static_cast<float>(u_max), distr);
+        distr /= sum(distr)(0);
+
+        EXPECT_MAT_NEAR(distr, to_.Stage(1)->StateDistr(), 1e-5) << "tick " << t;
+
+        spikes_prev = to_.Stage(0)->Spikes().clone();
+    }
+}
+
+/**
+ * @brief Pipelined execution yields the same outcome as running stages one after the other
+ */
+TEST_F(LayerZStackTest, SameAsSerial)
+{
+    const int N=100;
+
+    theRNG() = RNG(2010);
+    to_.Reset(Config(nb_outputs_, true));
+    to_.IONames(config_);
+    Mat1f spikes_pipelined = Simulate(to_, N, true);
+    ASSERT_GT(countNonZero(spikes_pipelined), 0) << "Last stage never spiked";
+
+    theRNG() = RNG(2010);
+    LayerZStack serial;
+    serial.Reset(Config(nb_outputs_, false));
+    serial.IONames(config_);
+    EXPECT_FALSE(serial.IsPipelined());
+    Mat1f spikes_serial = Simulate(serial, N, true);
+
+    EXPECT_MAT_EQ(spikes_serial, spikes_pipelined);
+    for(int k=0; k<to_.NbStages(); k++) {
+
+        EXPECT_MAT_EQ(serial.Stage(k)->Weights(), to_.Stage(k)->Weights()) << "stage " << k;
+        EXPECT_MAT_EQ(serial.Stage(k)->Bias(), to_.Stage(k)->Bias()) << "stage " << k;
+    }
+}
+
+/**
+ * @brief Errors raised within a stage reach the caller
+ */
+TEST_F(LayerZStackTest, Activate_Invalid)
+{
+    Signal signal;
+    signal.Append(NAME_INPUT_SPIKES, Mat1f::ones(1, NB_AFFERENTS+1));
+    EXPECT_THROW(to_.Activate(signal), ExceptionBadDims);
+
+    // still usable
+    signal.Append(NAME_INPUT_SPIKES, Mat1f::ones(1, NB_AFFERENTS));
+    EXPECT_NO_THROW(to_.Activate(signal));
+}
+
+TEST_F(LayerZStackTest, Reconfigure)
+{
+    vector<int> nb_outputs = nb_outputs_;
+    nb_outputs.back() = 6;
+    to_.Reconfigure(Config(nb_outputs, false));
+
+    EXPECT_EQ(6, to_.Stage(2)->Spikes().cols);
+    EXPECT_FALSE(to_.IsPipelined());
+    EXPECT_NO_THROW(Simulate(to_, 5, true));
+
+    nb_outputs[1] = 3;
+    EXPECT_THROW(to_.Reconfigure(Config(nb_outputs, false)), ExceptionValueError);
+
+    nb_outputs.pop_back();
+    EXPECT_THROW(to_.Reconfigure(Config(nb_outputs, false)), ExceptionValueError);
+}
+
+} // annonymous namespace
@@ -0,0 +1,126 @@
+#include "sem/layers/layerzstream.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+#include "elm/ts/fakeevidence.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_AFFERENTS = 20;
+const int NB_OUTPUTS = 5;
+const int LEN_HISTORY = 3;
+
+class LayerZStreamTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        Mat1f weights_all(NB_OUTPUTS, NB_AFFERENTS+1);
+        randn(weights_all, 0.f, 1.f);
+        params_ = WeightsSnapshot(weights_all, 1);
+    }
+
+    /**
+     * @brief Create stream spiking on every tick
+     */
+    static LayerZStream CreateStream()
+    {
+        return LayerZStream(NB_AFFERENTS, NB_OUTPUTS, LEN_HISTORY, 1e5f, 1.f);
+    }
+
+    WeightsSnapshot params_;    ///< weights shared by streams
+};
+
+TEST_F(LayerZStreamTest, Initial)
+{
+    LayerZStream to = CreateStream();
+    EXPECT_EQ(NB_AFFERENTS, to.NbAfferents());
+    EXPECT_EQ(NB_OUTPUTS, to.NbOutputs());
+    EXPECT_MAT_EQ(Mat1f::zeros(1, NB_OUTPUTS), to.MembranePotentials());
+    EXPECT_MAT_EQ(Mat1f::zeros(1, NB_OUTPUTS), to.Spikes());
+    EXPECT_EQ(0, countNonZero(to.RecentAfferents()));
+}
+
+TEST_F(LayerZStreamTest, Activate)
+{
+    LayerZStream to = CreateStream();
+
+    FakeEvidence stimuli(NB_AFFERENTS);
+    Mat1f spikes_in = static_cast<Mat1f>(stimuli.next(0));
+    to.Activate(params_, spikes_in);
+
+    Mat1f u;
+    params_.Potentials(spikes_in, u);
+    EXPECT_MAT_EQ(u, to.MembranePotentials());
+
+    EXPECT_EQ(1, countNonZero(to.Spikes())) << "Expecting exactly one winner.";
+    EXPECT_EQ(countNonZero(spikes_in), countNonZero(to.RecentAfferents()));
+}
+
+/**
+ * @brief Streams through the same weights do not see each other's input
+ */
+TEST_F(LayerZStreamTest, Independent)
+{
+    LayerZStream a = CreateStream();
+    LayerZStream b = CreateStream();
+
+    FakeEvidence stimuli(NB_AFFERENTS);
+    Mat1f spikes_a = static_cast<Mat1f>(stimuli.next(0));
+    Mat1f spikes_b = static_cast<Mat1f>(stimuli.next(1));
+
+    a.Activate(params_, spikes_a);
+    b.Activate(params_, spikes_b);
+
+    Mat1f u_a;
+    params_.Potentials(spikes_a, u_a);
+    EXPECT_MAT_EQ(u_a, a.MembranePotentials());
+
+    Mat is_recent_a = a.RecentAfferents() != 0;
+    Mat is_spiking_a = spikes_a != 0.f;
+    EXPECT_MAT_EQ(is_spiking_a, is_recent_a);
+}
+
+/**
+ * @brief Spikes remain in the history for its length
+ */
+TEST_F(LayerZStreamTest, History)
+{
+    LayerZStream to = CreateStream();
+
+    Mat1f spikes_in = Mat1f::zeros(1, NB_AFFERENTS);
+    spikes_in(3) = 1.f;
+    to.Activate(params_, spikes_in);
+
+    for(int t=1; t<LEN_HISTORY; t++) {
+
+        to.Activate(params_, Mat1f::zeros(1, NB_AFFERENTS));
+        EXPECT_EQ(1, countNonZero(to.RecentAfferents())) << "tick " << t;
+    }
+
+    to.Activate(params_, Mat1f::zeros(1, NB_AFFERENTS));
+    EXPECT_EQ(0, countNonZero(to.RecentAfferents()));
+
+    to.Activate(params_, spikes_in);
+    to.Clear();
+    EXPECT_EQ(0, countNonZero(to.RecentAfferents()));
+}
+
+TEST_F(LayerZStreamTest, Activate_Invalid)
+{
+    LayerZStream to = CreateStream();
+    EXPECT_THROW(to.Activate(params_, Mat1f::zeros(1, NB_AFFERENTS+1)), ExceptionBadDims);
+    EXPECT_THROW(to.Activate(WeightsSnapshot(Mat1f::zeros(NB_OUTPUTS+1, NB_AFFERENTS+1), 1), Mat1f::zeros(1, NB_AFFERENTS)), ExceptionBadDims);
+}
+
+TEST_F(LayerZStreamTest, Columns_Invalid)
+{
+    EXPECT_THROW(LayerZStream(NB_AFFERENTS, NB_OUTPUTS, LEN_HISTORY, 1e5f, 1.f, 0), ExceptionValueError);
+    EXPECT_THROW(LayerZStream(NB_AFFERENTS, NB_OUTPUTS, LEN_HISTORY, 1e5f, 1.f, 2), ExceptionValueError);
+}
+
+} // annonymous namespace
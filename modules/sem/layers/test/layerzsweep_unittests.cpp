@@ -0,0 +1,206 @@
+#include "sem/layers/layerzsweep.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+#include "elm/ts/fakeevidence.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_AFFERENTS = 20;
+const int NB_LABELS = 4;
+const int NB_TICKS = 10;
+
+class LayerZSweepTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        configs_ = LayerZSweep::Grid(BaseParams(), Axes());
+        to_.Reset(configs_, NB_LABELS);
+    }
+
+    static PTree BaseParams()
+    {
+        PTree params;
+        params.put(LayerZ::PARAM_NB_AFFERENTS, NB_AFFERENTS);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+        return params;
+    }
+
+    static vector<LayerZSweep::Axis> Axes()
+    {
+        vector<LayerZSweep::Axis> axes;
+
+        vector<string> wta_f;
+        wta_f.push_back("200");
+        wta_f.push_back("1000");
+        axes.push_back(make_pair(LayerZ::PARAM_WTA_FREQ, wta_f));
+
+        vector<string> nb_outputs;
+        nb_outputs.push_back("4");
+        nb_outputs.push_back("6");
+        nb_outputs.push_back("8");
+        axes.push_back(make_pair(LayerZ::PARAM_NB_OUTPUT_NODES, nb_outputs));
+
+        return axes;
+    }
+
+    /**
+     * @brief Encode stimulus into a raster, same spikes on every tick
+     * @param label
+     * @return one row of input spikes per tick
+     */
+    static Mat1f Raster(int label)
+    {
+        FakeEvidence stimuli(NB_AFFERENTS);
+        Mat1f spikes_in = stimuli.next(label);
+
+        Mat1f raster(NB_TICKS, NB_AFFERENTS);
+        for(int t=0; t<NB_TICKS; t++) {
+
+            spikes_in.reshape(1, 1).copyTo(raster.row(t));
+        }
+        return raster;
+    }
+
+    LayerZSweep to_;            ///< test object
+    vector<PTree> configs_;     ///< default grid
+};
+
+TEST_F(LayerZSweepTest, Grid)
+{
+    ASSERT_EQ(size_t(6), configs_.size());
+
+    // last axis varies fastest
+    const float WTA_F[] = {200.f, 200.f, 200.f, 1000.f, 1000.f, 1000.f};
+    const int NB_OUTPUTS[] = {4, 6, 8, 4, 6, 8};
+    for(size_t i=0; i<configs_.size(); i++) {
+
+        EXPECT_FLOAT_EQ(WTA_F[i], configs_[i].get<float>(LayerZ::PARAM_WTA_FREQ));
+        EXPECT_EQ(NB_OUTPUTS[i], configs_[i].get<int>(LayerZ::PARAM_NB_OUTPUT_NODES));
+        EXPECT_EQ(NB_AFFERENTS, configs_[i].get<int>(LayerZ::PARAM_NB_AFFERENTS)) << "Expecting base parameters in every configuration";
+    }
+
+    EXPECT_EQ(size_t(1), LayerZSweep::Grid(BaseParams(), vector<LayerZSweep::Axis>()).size());
+}
+
+TEST_F(LayerZSweepTest, Grid_Invalid)
+{
+    vector<LayerZSweep::Axis> axes = Axes();
+    axes.push_back(make_pair(LayerZ::PARAM_LEN_HISTORY, vector<string>()));
+    EXPECT_THROW(LayerZSweep::Grid(BaseParams(), axes), ExceptionValueError);
+}
+
+TEST_F(LayerZSweepTest, Reset)
+{
+    ASSERT_EQ(static_cast<int>(configs_.size()), to_.NbInstances());
+
+    for(int i=0; i<to_.NbInstances(); i++) {
+
+        const int nb_outputs = configs_[i].get<int>(LayerZ::PARAM_NB_OUTPUT_NODES);
+        EXPECT_EQ(nb_outputs, to_.Params(i).get<int>(LayerZ::PARAM_NB_OUTPUT_NODES));
+        EXPECT_MAT_DIMS_EQ(to_.Layer(i)->Weights(), Size(NB_AFFERENTS, nb_outputs));
+        EXPECT_MAT_DIMS_EQ(to_.Evaluation(i).Confusion(), Size(NB_LABELS, nb_outputs));
+    }
+
+    LayerZSweep to;
+    EXPECT_THROW(to.Reset(vector<PTree>(), NB_LABELS), ExceptionValueError);
+}
+
+/**
+ * @brief Every instance learns from the same raster and keeps its own metrics
+ */
+TEST_F(LayerZSweepTest, Present)
+{
+    vector<Mat1f> weights0;
+    for(int i=0; i<to_.NbInstances(); i++) {
+
+        weights0.push_back(to_.Layer(i)->Weights());
+    }
+
+    for(int s=0; s<20; s++) {
+
+        to_.Present(Raster(s % NB_LABELS), s % NB_LABELS);
+    }
+
+    for(int i=0; i<to_.NbInstances(); i++) {
+
+        EXPECT_EQ(20ULL, to_.Presentation(i).NbPresentations());
+        EXPECT_EQ(20ULL*NB_TICKS, to_.Presentation(i).TotalTicks()) << "Expecting fixed length presentations by default";
+        EXPECT_GT(to_.Evaluation(i).NbSamples(), 0ULL);
+        EXPECT_GT(norm(weights0[i], to_.Layer(i)->Weights(), NORM_L1), 0.);
+    }
+
+    // higher WTA rate, more WTA spikes
+    EXPECT_GT(to_.Evaluation(3).NbSamples(), to_.Evaluation(0).NbSamples());
+}
+
+/**
+ * @brief Presentation ends early on WTA activity or when running out of ticks
+ */
+TEST_F(LayerZSweepTest, Present_Length)
+{
+    LayerZSweep to;
+    to.Reset(configs_, NB_LABELS, PresentationController(2*NB_TICKS, 1, 0.f));
+
+    for(int s=0; s<10; s++) {
+
+        to.Present(Raster(s % NB_LABELS), s % NB_LABELS);
+    }
+
+    for(int i=0; i<to.NbInstances(); i++) {
+
+        EXPECT_LE(to.Presentation(i).TotalTicks(), 10ULL*NB_TICKS);
+        EXPECT_LE(to.Evaluation(i).NbSamples(), 10ULL);
+    }
+}
+
+TEST_F(LayerZSweepTest, Present_Invalid)
+{
+    EXPECT_THROW(to_.Present(Mat1f(), 0), ExceptionBadDims);
+    EXPECT_THROW(to_.Present(Mat1f::zeros(NB_TICKS, NB_AFFERENTS+1), 0), ExceptionBadDims);
+    EXPECT_THROW(to_.Present(Raster(0), NB_LABELS), ExceptionBadDims) << "label out of range";
+}
+
+/**
+ * @brief Outcome does not depend on the no. of threads running instances
+ */
+TEST_F(LayerZSweepTest, SameAcrossThreads)
+{
+    const int nb_threads = getNumThreads();
+
+    vector<Mat1f> weights[2];
+    vector<Mat1i> confusion[2];
+    for(int k=0; k<2; k++) {
+
+        setNumThreads((k == 0)? 1 : nb_threads);
+
+        theRNG() = RNG(2010);
+        LayerZSweep to;
+        to.Reset(configs_, NB_LABELS);
+
+        for(int s=0; s<20; s++) {
+
+            to.Present(Raster(s % NB_LABELS), s % NB_LABELS);
+        }
+
+        for(int i=0; i<to.NbInstances(); i++) {
+
+            weights[k].push_back(to.Layer(i)->Weights());
+            confusion[k].push_back(to.Evaluation(i).Confusion());
+        }
+    }
+    setNumThreads(nb_threads);
+
+    for(size_t i=0; i<weights[0].size(); i++) {
+
+        EXPECT_MAT_EQ(weights[0][i], weights[1][i]) << "instance " << i;
+        EXPECT_MAT_EQ(confusion[0][i], confusion[1][i]) << "instance " << i;
+    }
+}
+
+} // annonymous namespace
@@ -0,0 +1,113 @@
+#include "sem/layers/presentationcontroller.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_OUTPUTS = 5;
+
+TEST(PresentationControllerTest, InvalidParams)
+{
+    EXPECT_THROW(PresentationController(0, 0, 0.f), ExceptionValueError);
+    EXPECT_THROW(PresentationController(10, -1, 0.f), ExceptionValueError);
+    EXPECT_THROW(PresentationController(10, 0, -0.1f), ExceptionValueError);
+    EXPECT_THROW(PresentationController(10, 0, 1.1f), ExceptionValueError);
+    EXPECT_THROW(PresentationController(10, 0, 0.f, 0), ExceptionValueError);
+    EXPECT_THROW(PresentationController(10, 0, 0.f, 11), ExceptionValueError);
+}
+
+TEST(PresentationControllerTest, FixedLength)
+{
+    PresentationController to;
+    EXPECT_FALSE(to.NeedsStateDistr());
+
+    const Mat1f spikes = Mat1f::ones(1, NB_OUTPUTS);
+    for(int p=0; p<3; p++) {
+
+        to.Start();
+        int t = 0;
+        while(!to.Tick(spikes)) {
+
+            t++;
+        }
+        EXPECT_EQ(PresentationController::DEFAULT_MAX_TICKS, t+1);
+        EXPECT_EQ(PresentationController::STOP_MAX_TICKS, to.Reason());
+    }
+
+    EXPECT_EQ(3ULL, to.NbPresentations());
+    EXPECT_EQ(static_cast<unsigned long long>(3*PresentationController::DEFAULT_MAX_TICKS), to.TotalTicks());
+}
+
+TEST(PresentationControllerTest, StopOnSpikes)
+{
+    PresentationController to(20, 3, 0.f);
+    to.Start();
+
+    Mat1f spikes = Mat1f::zeros(1, NB_OUTPUTS);
+    EXPECT_FALSE(to.Tick(spikes));
+
+    spikes(2) = 1.f;
+    EXPECT_FALSE(to.Tick(spikes));
+    EXPECT_FALSE(to.Tick(spikes));
+    EXPECT_EQ(2, to.NbSpikes());
+    EXPECT_TRUE(to.Tick(spikes));
+    EXPECT_EQ(PresentationController::STOP_SPIKES, to.Reason());
+    EXPECT_EQ(4, to.NbTicks());
+
+    // next presentation starts over
+    to.Start();
+    EXPECT_FALSE(to.IsDone());
+    EXPECT_EQ(0, to.NbTicks());
+    EXPECT_EQ(0, to.NbSpikes());
+    EXPECT_EQ(4ULL, to.TotalTicks());
+}
+
+TEST(PresentationControllerTest, StopOnConfidence)
+{
+    PresentationController to(20, 0, 0.8f);
+    EXPECT_TRUE(to.NeedsStateDistr());
+    to.Start();
+
+    const Mat1f spikes = Mat1f::zeros(1, NB_OUTPUTS);
+    Mat1f p(1, NB_OUTPUTS, 1.f/NB_OUTPUTS);
+    EXPECT_FALSE(to.Tick(spikes, p));
+    EXPECT_FLOAT_EQ(1.f/NB_OUTPUTS, to.Confidence());
+
+    p = 0.05f;
+    p(3) = 0.8f;
+    EXPECT_TRUE(to.Tick(spikes, p));
+    EXPECT_EQ(PresentationController::STOP_CONFIDENCE, to.Reason());
+    EXPECT_FLOAT_EQ(0.8f, to.Confidence());
+}
+
+TEST(PresentationControllerTest, MinTicks)
+{
+    PresentationController to(20, 1, 0.f, 5);
+    to.Start();
+
+    const Mat1f spikes = Mat1f::ones(1, NB_OUTPUTS);
+    for(int t=0; t<4; t++) {
+
+        EXPECT_FALSE(to.Tick(spikes));
+    }
+    EXPECT_TRUE(to.Tick(spikes));
+    EXPECT_EQ(PresentationController::STOP_SPIKES, to.Reason());
+}
+
+TEST(PresentationControllerTest, MaxTicksFirst)
+{
+    PresentationController to(2, 10, 0.99f);
+    to.Start();
+
+    const Mat1f spikes = Mat1f::zeros(1, NB_OUTPUTS);
+    const Mat1f p(1, NB_OUTPUTS, 1.f/NB_OUTPUTS);
+    EXPECT_FALSE(to.Tick(spikes, p));
+    EXPECT_TRUE(to.Tick(spikes, p));
+    EXPECT_EQ(PresentationController::STOP_MAX_TICKS, to.Reason());
+}
+
+} // annonymous namespace
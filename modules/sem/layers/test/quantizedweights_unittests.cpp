@@ -0,0 +1,170 @@
+#include "sem/layers/quantizedweights.h"
+
+#include <algorithm>
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_OUTPUTS = 20;
+const int NB_AFFERENTS = 100;
+
+class QuantizedWeightsTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        // log probabilities within the clamped range
+        weights_ = Mat1f(NB_OUTPUTS, NB_AFFERENTS);
+        randu(weights_, -5.f, 0.f);
+
+        bias_ = Mat1f(1, NB_OUTPUTS);
+        randu(bias_, -3.f, 0.f);
+
+        samples_ = Mat1f(50, NB_AFFERENTS);
+        randu(samples_, 0.f, 1.f);
+        samples_ = samples_ < 0.2f;
+        samples_ /= 255.f;
+    }
+
+    Mat1f weights_;
+    Mat1f bias_;
+    Mat1f samples_;     ///< input spikes, one sample per row
+};
+
+TEST_F(QuantizedWeightsTest, Empty)
+{
+    EXPECT_TRUE(QuantizedWeights().empty());
+    EXPECT_FALSE(QuantizedWeights(weights_, bias_, QuantizedWeights::DEPTH_8).empty());
+}
+
+TEST_F(QuantizedWeightsTest, Invalid)
+{
+    EXPECT_THROW(QuantizedWeights(weights_, bias_, 4), ExceptionValueError);
+    EXPECT_THROW(QuantizedWeights(weights_, bias_, 32), ExceptionValueError);
+    EXPECT_THROW(QuantizedWeights(weights_, bias_.colRange(0, NB_OUTPUTS-1), QuantizedWeights::DEPTH_8), ExceptionBadDims);
+
+    QuantizedWeights to(weights_, bias_, QuantizedWeights::DEPTH_8);
+    Mat1f u;
+    EXPECT_THROW(to.Potentials(Mat1f::zeros(1, NB_AFFERENTS+1), u), ExceptionBadDims);
+}
+
+TEST_F(QuantizedWeightsTest, Dims)
+{
+    QuantizedWeights to8(weights_, bias_, QuantizedWeights::DEPTH_8);
+    EXPECT_EQ(NB_OUTPUTS, to8.NbOutputs());
+    EXPECT_EQ(NB_AFFERENTS, to8.NbAfferents());
+    EXPECT_EQ(CV_8U, to8.Data().type());
+    EXPECT_EQ(static_cast<size_t>(NB_OUTPUTS*NB_AFFERENTS), to8.NbBytes());
+
+    QuantizedWeights to16(weights_, bias_, QuantizedWeights::DEPTH_16);
+    EXPECT_EQ(CV_16U, to16.Data().type());
+    EXPECT_EQ(static_cast<size_t>(2*NB_OUTPUTS*NB_AFFERENTS), to16.NbBytes());
+}
+
+/**
+ * @brief Reconstruction error within half a quantization step
+ */
+TEST_F(QuantizedWeightsTest, Dequantize)
+{
+    const int DEPTHS[] = {QuantizedWeights::DEPTH_8, QuantizedWeights::DEPTH_16};
+    for(int d=0; d<2; d++) {
+
+        QuantizedWeights to(weights_, bias_, DEPTHS[d]);
+        Mat1f w = to.Dequantize();
+        EXPECT_MAT_DIMS_EQ(w, weights_);
+        EXPECT_MAT_NEAR(w, weights_, 0.5f*to.Scale()+1e-5f);
+    }
+}
+
+/**
+ * @brief Integer accumulation matches summing dequantized weights
+ */
+TEST_F(QuantizedWeightsTest, Potentials)
+{
+    QuantizedWeights to(weights_, bias_, QuantizedWeights::DEPTH_8);
+    const Mat1f w = to.Dequantize();
+
+    Mat1f u;
+    for(int s=0; s<samples_.rows; s++) {
+
+        to.Potentials(samples_.row(s), u);
+        EXPECT_MAT_DIMS_EQ(u, Size2i(NB_OUTPUTS, 1));
+
+        Mat1f u_expected = samples_.row(s) * w.t() + bias_;
+        EXPECT_MAT_NEAR(u_expected, u, 1e-3f);
+    }
+}
+
+TEST_F(QuantizedWeightsTest, Potentials_NoSpikes)
+{
+    QuantizedWeights to(weights_, bias_, QuantizedWeights::DEPTH_16);
+    Mat1f u;
+    to.Potentials(Mat1f::zeros(1, NB_AFFERENTS), u);
+    EXPECT_MAT_NEAR(bias_, u, 1e-7f);
+}
+
+/**
+ * @brief 16-bit weights are more accurate than 8-bit, both agree on winners mostly
+ */
+TEST_F(QuantizedWeightsTest, Compare)
+{
+    QuantizationReport r8 = QuantizedWeights(weights_, bias_, QuantizedWeights::DEPTH_8).Compare(weights_, bias_, samples_);
+    QuantizationReport r16 = QuantizedWeights(weights_, bias_, QuantizedWeights::DEPTH_16).Compare(weights_, bias_, samples_);
+
+    EXPECT_EQ(samples_.rows, r8.nb_samples);
+    EXPECT_LE(r8.mean_abs_error, r8.max_abs_error);
+    EXPECT_LT(r16.max_abs_error, r8.max_abs_error);
+    EXPECT_LT(r16.mean_abs_error, r8.mean_abs_error);
+
+    // error of a sum over spiking afferents grows with no. of spiking afferents
+    const float scale = 5.f/255.f;
+    EXPECT_LT(r8.max_abs_error, 0.5f*scale*NB_AFFERENTS);
+
+    EXPECT_GT(r8.winner_agreement, 0.9f);
+    EXPECT_FLOAT_EQ(1.f, r16.winner_agreement);
+}
+
+/**
+ * @brief Comparing one sample at a time against the dense float reference
+ */
+TEST_F(QuantizedWeightsTest, Compare_PerSample)
+{
+    QuantizedWeights to(weights_, bias_, QuantizedWeights::DEPTH_8);
+
+    QuantizationReport report;
+    double max_abs_error = 0.;
+    for(int s=0; s<samples_.rows; s++) {
+
+        to.Compare(weights_, bias_, samples_.row(s), report);
+
+        Mat1f u_q;
+        to.Potentials(samples_.row(s), u_q);
+        Mat1f x = samples_.row(s) != 0;
+        x /= 255.f;
+        Mat1f u_f = x * weights_.t() + bias_.reshape(1, 1);
+
+        double max_err;
+        minMaxIdx(abs(u_q-u_f), 0, &max_err);
+        max_abs_error = std::max(max_abs_error, max_err);
+    }
+
+    EXPECT_EQ(samples_.rows, report.nb_samples);
+    EXPECT_NEAR(max_abs_error, report.max_abs_error, 1e-5);
+    EXPECT_LE(report.mean_abs_error, report.max_abs_error);
+
+    EXPECT_THROW(to.Compare(weights_.colRange(1, NB_AFFERENTS), bias_, samples_.row(0), report), ExceptionBadDims);
+}
+
+TEST_F(QuantizedWeightsTest, ConstantWeights)
+{
+    Mat1f w(NB_OUTPUTS, NB_AFFERENTS, -1.f);
+    QuantizedWeights to(w, bias_, QuantizedWeights::DEPTH_8);
+    EXPECT_MAT_EQ(w, to.Dequantize());
+}
+
+} // annonymous namespace
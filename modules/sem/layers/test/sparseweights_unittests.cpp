@@ -0,0 +1,150 @@
+#include "sem/layers/sparseweights.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int NB_OUTPUTS = 20;
+const int NB_AFFERENTS = 100;
+const float WEIGHT_LIMIT = 5.f;
+
+class SparseWeightsTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        // half the synapses saturated at the clamp
+        weights_ = Mat1f(NB_OUTPUTS, NB_AFFERENTS);
+        randu(weights_, -4.f, 0.f);
+        Mat1f r(NB_OUTPUTS, NB_AFFERENTS);
+        randu(r, 0.f, 1.f);
+        weights_.setTo(-WEIGHT_LIMIT, r < 0.5f);
+
+        bias_ = Mat1f(1, NB_OUTPUTS);
+        randu(bias_, -3.f, 0.f);
+
+        samples_ = Mat1f(50, NB_AFFERENTS);
+        randu(samples_, 0.f, 1.f);
+        samples_ = samples_ < 0.2f;
+        samples_ /= 255.f;
+    }
+
+    Mat1f weights_;
+    Mat1f bias_;
+    Mat1f samples_;     ///< input spikes, one sample per row
+};
+
+TEST_F(SparseWeightsTest, Empty)
+{
+    SparseWeights to;
+    EXPECT_TRUE(to.empty());
+    EXPECT_EQ(0, to.NbNonZero());
+    EXPECT_FLOAT_EQ(0.f, to.Density());
+
+    EXPECT_FALSE(SparseWeights(weights_, bias_).empty());
+}
+
+TEST_F(SparseWeightsTest, Invalid)
+{
+    EXPECT_THROW(SparseWeights(weights_, bias_.colRange(0, NB_OUTPUTS-1)), ExceptionBadDims);
+
+    SparseWeights to(weights_, bias_);
+    Mat1f u;
+    EXPECT_THROW(to.Potentials(Mat1f::zeros(1, NB_AFFERENTS+1), u), ExceptionBadDims);
+    EXPECT_THROW(to.Bias(Mat1f::zeros(1, NB_OUTPUTS+1)), ExceptionBadDims);
+}
+
+/**
+ * @brief Only saturated synapses dropped, folding into a floor at the clamp
+ */
+TEST_F(SparseWeightsTest, Saturated)
+{
+    SparseWeights to(weights_, bias_);
+    EXPECT_EQ(NB_OUTPUTS, to.NbOutputs());
+    EXPECT_EQ(NB_AFFERENTS, to.NbAfferents());
+    EXPECT_EQ(countNonZero(weights_ > -WEIGHT_LIMIT), to.NbNonZero());
+    EXPECT_LT(to.Density(), 0.75f);
+    EXPECT_LT(to.NbBytes(), weights_.total()*sizeof(float));
+
+    Mat1f f = to.Floor();
+    for(int r=0; r<NB_OUTPUTS; r++) {
+
+        EXPECT_FLOAT_EQ(-WEIGHT_LIMIT, f(r));
+    }
+
+    EXPECT_MAT_NEAR(weights_, to.Dense(), 1e-5f);
+}
+
+/**
+ * @brief Exact potentials when all dropped synapses sit at the clamp
+ */
+TEST_F(SparseWeightsTest, Potentials)
+{
+    SparseWeights to(weights_, bias_);
+
+    Mat1f u;
+    for(int s=0; s<samples_.rows; s++) {
+
+        to.Potentials(samples_.row(s), u);
+        EXPECT_MAT_DIMS_EQ(u, Size2i(NB_OUTPUTS, 1));
+
+        Mat1f u_expected = samples_.row(s) * weights_.t() + bias_;
+        EXPECT_MAT_NEAR(u_expected, u, 1e-4f);
+    }
+}
+
+TEST_F(SparseWeightsTest, Potentials_NoSpikes)
+{
+    SparseWeights to(weights_, bias_);
+    Mat1f u;
+    to.Potentials(Mat1f::zeros(1, NB_AFFERENTS), u);
+    EXPECT_MAT_NEAR(bias_, u, 1e-7f);
+}
+
+/**
+ * @brief Dropping synapses above the clamp, error bounded by spread of dropped weights
+ */
+TEST_F(SparseWeightsTest, Threshold)
+{
+    const float threshold = -3.f;
+    SparseWeights to(weights_, bias_, threshold);
+    EXPECT_FLOAT_EQ(threshold, to.Threshold());
+    EXPECT_EQ(countNonZero(weights_ > threshold), to.NbNonZero());
+
+    Mat1f f = to.Floor();
+    for(int r=0; r<NB_OUTPUTS; r++) {
+
+        EXPECT_GE(f(r), -WEIGHT_LIMIT);
+        EXPECT_LE(f(r), threshold);
+    }
+
+    Mat1f u;
+    for(int s=0; s<samples_.rows; s++) {
+
+        to.Potentials(samples_.row(s), u);
+        Mat1f u_expected = samples_.row(s) * weights_.t() + bias_;
+
+        const float nb_active = static_cast<float>(countNonZero(samples_.row(s)));
+        EXPECT_MAT_NEAR(u_expected, u, (threshold+WEIGHT_LIMIT)*nb_active+1e-4f);
+    }
+}
+
+TEST_F(SparseWeightsTest, Bias)
+{
+    SparseWeights to(weights_, bias_);
+
+    Mat1f u0, u1;
+    to.Potentials(samples_.row(0), u0);
+
+    to.Bias(bias_+1.f);
+    EXPECT_MAT_NEAR(bias_+1.f, to.Bias(), 1e-7f);
+
+    to.Potentials(samples_.row(0), u1);
+    EXPECT_MAT_NEAR(u0+1.f, u1, 1e-5f);
+}
+
+} // annonymous namespace
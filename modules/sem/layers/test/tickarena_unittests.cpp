@@ -0,0 +1,188 @@
+#include "sem/layers/tickarena.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+class TickArenaTest : public testing::Test
+{
+protected:
+    TickArena to_;  ///< test object
+};
+
+TEST_F(TickArenaTest, Initial)
+{
+    EXPECT_EQ(0, to_.NbGrowths());
+    EXPECT_EQ(0ULL, to_.NbGrowthsTotal());
+    EXPECT_FALSE(to_.IsSealed());
+    EXPECT_EQ(0, to_.EndTick());
+}
+
+TEST_F(TickArenaTest, Scratch)
+{
+    Mat a = to_.Scratch(1, 10, CV_32FC1);
+    Mat b = to_.Scratch(3, 7, CV_8UC1);
+
+    EXPECT_MAT_DIMS_EQ(a, Size(10, 1));
+    EXPECT_MAT_TYPE(a, CV_32F);
+    EXPECT_MAT_DIMS_EQ(b, Size(7, 3));
+    EXPECT_MAT_TYPE(b, CV_8U);
+    EXPECT_TRUE(a.isContinuous());
+    EXPECT_TRUE(b.isContinuous());
+
+    EXPECT_EQ(0u, reinterpret_cast<size_t>(a.data) % TickArena::ALIGNMENT);
+    EXPECT_EQ(0u, reinterpret_cast<size_t>(b.data) % TickArena::ALIGNMENT);
+
+    // no overlap within a tick
+    a.setTo(1.f);
+    b.setTo(2);
+    EXPECT_EQ(10, countNonZero(a == 1.f));
+    EXPECT_EQ(21, countNonZero(b == 2));
+}
+
+/**
+ * @brief Same requests tick after tick stop growing the arena
+ */
+TEST_F(TickArenaTest, Scratch_SteadyState)
+{
+    const int N=10;
+    for(int i=0; i<N; i++) {
+
+        to_.Scratch(1, 100, CV_32FC1);
+        to_.Scratch(1, 1000, CV_8UC1);
+        to_.Scratch(1, 100, CV_32FC1);
+
+        int nb_growths = to_.EndTick();
+        if(i > 1) {
+
+            EXPECT_EQ(0, nb_growths) << "Arena grew in tick " << i;
+        }
+    }
+}
+
+/**
+ * @brief Outgrowing the scratch block keeps earlier buffers of the tick valid
+ */
+TEST_F(TickArenaTest, Scratch_Grow)
+{
+    Mat1f a = to_.Scratch(1, 4, CV_32FC1);
+    a.setTo(3.f);
+
+    Mat1f b = to_.Scratch(1, 10000, CV_32FC1);
+    b.setTo(0.f);
+
+    EXPECT_EQ(4, countNonZero(a == 3.f));
+    EXPECT_EQ(2, to_.NbGrowths());
+}
+
+TEST_F(TickArenaTest, Scratch_Invalid)
+{
+    EXPECT_THROW(to_.Scratch(-1, 1, CV_32FC1), ExceptionValueError);
+    EXPECT_THROW(to_.Scratch(1, -1, CV_32FC1), ExceptionValueError);
+}
+
+TEST_F(TickArenaTest, Output)
+{
+    Mat a = to_.Output(0, 1, 10, CV_32FC1);
+    EXPECT_MAT_DIMS_EQ(a, Size(10, 1));
+    EXPECT_MAT_TYPE(a, CV_32F);
+    EXPECT_EQ(1, to_.NbGrowths());
+
+    const uchar *data = a.data;
+    a.release();
+
+    Mat b = to_.Output(0, 1, 10, CV_32FC1);
+    EXPECT_EQ(data, b.data) << "Expecting released buffer to be reused.";
+    EXPECT_EQ(1, to_.NbGrowths());
+
+    Mat c = to_.Output(1, 1, 10, CV_32FC1);
+    EXPECT_NE(b.data, c.data) << "Slots must not share buffers.";
+    EXPECT_EQ(2, to_.EndTick());
+}
+
+/**
+ * @brief Buffers referenced outside the arena are never handed out again
+ */
+TEST_F(TickArenaTest, Output_Shared)
+{
+    vector<Mat> kept;
+    for(int i=0; i<2*TickArena::MAX_OUTPUT_BUFFERS; i++) {
+
+        Mat m = to_.Output(0, 1, 5, CV_32FC1);
+        m.setTo(static_cast<float>(i));
+        kept.push_back(m);
+    }
+    EXPECT_EQ(2*TickArena::MAX_OUTPUT_BUFFERS, to_.NbGrowths());
+
+    for(size_t i=0; i<kept.size(); i++) {
+
+        EXPECT_EQ(5, countNonZero(kept[i] == static_cast<float>(i))) << "Overwritten buffer " << i;
+    }
+
+    kept.clear();
+    to_.EndTick();
+
+    to_.Output(0, 1, 5, CV_32FC1);
+    EXPECT_EQ(0, to_.NbGrowths()) << "Expecting buffer released by all others to be reused.";
+}
+
+TEST_F(TickArenaTest, Output_Dims)
+{
+    Mat a = to_.Output(0, 1, 10, CV_32FC1);
+    a.release();
+
+    Mat b = to_.Output(0, 1, 11, CV_32FC1);
+    EXPECT_MAT_DIMS_EQ(b, Size(11, 1));
+    b.release();
+
+    Mat c = to_.Output(0, 1, 10, CV_8UC1);
+    EXPECT_MAT_TYPE(c, CV_8U);
+    EXPECT_EQ(3, to_.NbGrowths());
+}
+
+TEST_F(TickArenaTest, Output_Invalid)
+{
+    EXPECT_THROW(to_.Output(-1, 1, 1, CV_32FC1), ExceptionValueError);
+}
+
+TEST_F(TickArenaTest, EndTick)
+{
+    to_.Scratch(1, 10, CV_32FC1);
+    to_.Output(0, 1, 10, CV_32FC1);
+    EXPECT_EQ(2, to_.NbGrowths());
+
+    EXPECT_EQ(2, to_.EndTick());
+    EXPECT_EQ(0, to_.NbGrowths());
+    EXPECT_EQ(2ULL, to_.NbGrowthsTotal());
+}
+
+TEST_F(TickArenaTest, Seal)
+{
+    to_.Seal();
+    EXPECT_TRUE(to_.IsSealed());
+
+    to_.Seal(false);
+    EXPECT_FALSE(to_.IsSealed());
+}
+
+TEST_F(TickArenaTest, Clear)
+{
+    Mat a = to_.Output(0, 1, 10, CV_32FC1);
+    a.setTo(1.f);
+    to_.EndTick();
+
+    to_.Clear();
+    EXPECT_EQ(0ULL, to_.NbGrowthsTotal());
+    EXPECT_EQ(10, countNonZero(a == 1.f)) << "Buffer referenced elsewhere released.";
+
+    a.release();
+    to_.Output(0, 1, 10, CV_32FC1);
+    EXPECT_EQ(1, to_.NbGrowths());
+}
+
+} // annonymous namespace
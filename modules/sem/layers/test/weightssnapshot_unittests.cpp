@@ -0,0 +1,158 @@
+#include "sem/layers/weightssnapshot.h"
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+class WeightsSnapshotTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        weights_all_ = Mat1f(4, 7);
+        randn(weights_all_, 0.f, 1.f);
+    }
+
+    Mat1f weights_all_;     ///< one row per neuron, bias first
+};
+
+TEST_F(WeightsSnapshotTest, Empty)
+{
+    WeightsSnapshot to;
+    EXPECT_TRUE(to.empty());
+    EXPECT_EQ(0, to.NbOutputs());
+    EXPECT_EQ(0, to.NbAfferents());
+    EXPECT_EQ(0ULL, to.Version());
+}
+
+TEST_F(WeightsSnapshotTest, Dims)
+{
+    WeightsSnapshot to(weights_all_, 3);
+    EXPECT_FALSE(to.empty());
+    EXPECT_EQ(4, to.NbOutputs());
+    EXPECT_EQ(6, to.NbAfferents());
+    EXPECT_EQ(3ULL, to.Version());
+
+    EXPECT_MAT_EQ(weights_all_.colRange(1, 7), to.Weights());
+    EXPECT_MAT_EQ(weights_all_.col(0).t(), to.Bias());
+}
+
+/**
+ * @brief Snapshot remains the same when the source changes
+ */
+TEST_F(WeightsSnapshotTest, DeepCopy)
+{
+    WeightsSnapshot to(weights_all_, 1);
+    Mat1f expected = weights_all_.colRange(1, 7).clone();
+
+    weights_all_ += 1.f;
+    EXPECT_MAT_EQ(expected, to.Weights());
+}
+
+TEST_F(WeightsSnapshotTest, Potentials)
+{
+    WeightsSnapshot to(weights_all_, 1);
+
+    Mat1f spikes_in = Mat1f::zeros(1, 6);
+    spikes_in(1) = spikes_in(4) = 1.f;
+
+    Mat1f u;
+    to.Potentials(spikes_in, u);
+    EXPECT_MAT_DIMS_EQ(u, Size(4, 1));
+
+    for(int r=0; r<4; r++) {
+
+        EXPECT_FLOAT_EQ(weights_all_(r, 0)+weights_all_(r, 2)+weights_all_(r, 5), u(r));
+    }
+
+    EXPECT_THROW(to.Potentials(Mat1f::zeros(1, 5), u), ExceptionBadDims);
+}
+
+class WeightsPublisherTest : public WeightsSnapshotTest
+{
+protected:
+    WeightsPublisher to_;   ///< test object
+};
+
+TEST_F(WeightsPublisherTest, Initial)
+{
+    EXPECT_TRUE(to_.Acquire().get() == 0);
+    EXPECT_EQ(0ULL, to_.NbPublished());
+    EXPECT_EQ(0ULL, to_.NbAllocs());
+}
+
+TEST_F(WeightsPublisherTest, Publish)
+{
+    to_.Publish(weights_all_, 1);
+    WeightsPublisher::SnapshotPtr s = to_.Acquire();
+    ASSERT_TRUE(s.get() != 0);
+    EXPECT_EQ(1ULL, s->Version());
+    EXPECT_MAT_EQ(weights_all_.colRange(1, 7), s->Weights());
+    EXPECT_EQ(1ULL, to_.NbPublished());
+}
+
+/**
+ * @brief Snapshots held by readers never change
+ */
+TEST_F(WeightsPublisherTest, Held)
+{
+    vector<WeightsPublisher::SnapshotPtr> held;
+    for(int i=0; i<5; i++) {
+
+        to_.Publish(Mat1f(4, 7, static_cast<float>(i)), i);
+        held.push_back(to_.Acquire());
+    }
+
+    for(size_t i=0; i<held.size(); i++) {
+
+        EXPECT_EQ(static_cast<unsigned long long>(i), held[i]->Version());
+        EXPECT_MAT_EQ(Mat1f(4, 6, static_cast<float>(i)), held[i]->Weights());
+    }
+    EXPECT_EQ(5ULL, to_.NbAllocs()) << "Expecting new buffer while readers hold the others.";
+}
+
+/**
+ * @brief Without readers holding on to snapshots, two buffers alternate
+ */
+TEST_F(WeightsPublisherTest, DoubleBuffered)
+{
+    const int N=10;
+    for(int i=0; i<N; i++) {
+
+        to_.Publish(weights_all_+static_cast<float>(i), i);
+
+        WeightsPublisher::SnapshotPtr s = to_.Acquire();
+        EXPECT_EQ(static_cast<unsigned long long>(i), s->Version());
+        EXPECT_MAT_NEAR(weights_all_.colRange(1, 7)+static_cast<float>(i), s->Weights(), 1e-5);
+    }
+    EXPECT_EQ(2ULL, to_.NbAllocs());
+    EXPECT_EQ(static_cast<unsigned long long>(N), to_.NbPublished());
+}
+
+TEST_F(WeightsPublisherTest, Dims)
+{
+    to_.Publish(weights_all_, 1);
+    to_.Publish(weights_all_, 2);
+    to_.Publish(Mat1f::ones(2, 7), 3);
+
+    EXPECT_EQ(2, to_.Acquire()->NbOutputs());
+    EXPECT_EQ(3ULL, to_.NbAllocs());
+}
+
+TEST_F(WeightsPublisherTest, Clear)
+{
+    to_.Publish(weights_all_, 1);
+    WeightsPublisher::SnapshotPtr s = to_.Acquire();
+
+    to_.Clear();
+    EXPECT_TRUE(to_.Acquire().get() == 0);
+    EXPECT_EQ(0ULL, to_.NbPublished());
+    EXPECT_MAT_EQ(weights_all_.colRange(1, 7), s->Weights()) << "Expecting held snapshot kept.";
+}
+
+} // annonymous namespace
@@ -0,0 +1,132 @@
+#include "sem/layers/tickarena.h"
+
+#include <algorithm>
+
+#include "elm/core/exception.h"
+
+using namespace cv;
+
+const int TickArena::MAX_OUTPUT_BUFFERS = 3;
+const size_t TickArena::ALIGNMENT = 64;
+
+TickArena::TickArena()
+    : offset_(0),
+      nb_growths_(0),
+      nb_growths_total_(0),
+      is_sealed_(false)
+{
+}
+
+Mat TickArena::Scratch(int rows, int cols, int type)
+{
+    if(rows < 0 || cols < 0) {
+
+        ELM_THROW_VALUE_ERROR("Scratch dimensions must be >= 0");
+    }
+
+    const size_t nb_bytes = static_cast<size_t>(rows)*static_cast<size_t>(cols)*CV_ELEM_SIZE(type);
+    const size_t nb_aligned = (nb_bytes+ALIGNMENT-1)/ALIGNMENT*ALIGNMENT;
+
+    if(block_.empty() || offset_+nb_aligned+ALIGNMENT > block_.total()) {
+
+        // outgrown, headers into the current block stay valid until the end of the tick
+        if(!block_.empty()) {
+
+            retired_.push_back(block_);
+        }
+        size_t capacity = std::max(2*block_.total(), nb_aligned+ALIGNMENT);
+        block_ = Mat1b(1, static_cast<int>(capacity));
+        offset_ = 0;
+        nb_growths_++;
+        nb_growths_total_++;
+    }
+
+    uchar *data = alignPtr(block_.data, static_cast<int>(ALIGNMENT))+offset_;
+    offset_ += nb_aligned;
+
+    return Mat(rows, cols, type, data);
+}
+
+Mat TickArena::Output(int slot, int rows, int cols, int type)
+{
+    if(slot < 0) {
+
+        ELM_THROW_VALUE_ERROR("Output slot must be >= 0");
+    }
+
+    if(slot >= static_cast<int>(outputs_.size())) {
+
+        outputs_.resize(slot+1);
+    }
+    std::vector<Mat> &buffers = outputs_[slot];
+
+    for(size_t i=0; i<buffers.size(); i++) {
+
+        const Mat &b = buffers[i];
+        if(b.rows == rows && b.cols == cols && b.type() == type && !IsShared(b)) {
+
+            return b;
+        }
+    }
+
+    if(static_cast<int>(buffers.size()) >= MAX_OUTPUT_BUFFERS) {
+
+        // drop least recently allocated, whoever still references it keeps it alive
+        buffers.erase(buffers.begin());
+    }
+    buffers.push_back(Mat(rows, cols, type));
+    nb_growths_++;
+    nb_growths_total_++;
+
+    return buffers.back();
+}
+
+int TickArena::EndTick()
+{
+    CV_DbgAssert(!is_sealed_ || nb_growths_ == 0);
+
+    const int nb_growths = nb_growths_;
+    retired_.clear();
+    offset_ = 0;
+    nb_growths_ = 0;
+    return nb_growths;
+}
+
+int TickArena::NbGrowths() const
+{
+    return nb_growths_;
+}
+
+unsigned long long TickArena::NbGrowthsTotal() const
+{
+    return nb_growths_total_;
+}
+
+void TickArena::Seal(bool enable)
+{
+    is_sealed_ = enable;
+}
+
+bool TickArena::IsSealed() const
+{
+    return is_sealed_;
+}
+
+void TickArena::Clear()
+{
+    block_.release();
+    retired_.clear();
+    offset_ = 0;
+    outputs_.clear();
+    nb_growths_ = 0;
+    nb_growths_total_ = 0;
+}
+
+bool TickArena::IsShared(const Mat &m)
+{
+#if CV_MAJOR_VERSION < 3
+    return m.refcount != 0 && *m.refcount > 1;
+#else
+    return m.u != 0 && m.u->refcount > 1;
+#endif
+}
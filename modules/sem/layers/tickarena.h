@@ -0,0 +1,104 @@
+#ifndef SEM_LAYERS_TICKARENA_H_
+#define SEM_LAYERS_TICKARENA_H_
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Per-layer pool of the matrices a simulation tick needs
+ *
+ * Two kinds of buffers:
+ * Scratch buffers live until the end of the tick. They are bump allocated from a single block
+ * that grows to the largest tick seen so far.
+ * Output buffers leave the layer, e.g. appended to a signal. Each slot keeps a few buffers around
+ * and only hands out one nobody else references anymore, such that headers held outside are never overwritten.
+ *
+ * Once the layer's geometry settles and callers drop outputs between ticks (e.g. Signal::Clear()),
+ * the arena stops growing. Growths, i.e. new scratch blocks and output buffers, are counted to verify this,
+ * after Seal() they fail a debug assertion.
+ *
+ * Scope: only the arena's own buffers are counted. A sealed arena does not imply a tick free of heap allocations,
+ * LayerZ still allocates outside of it, e.g. refreshing the bias of sparse weights, StateDistr(),
+ * flattening stats and keeping seed candidates.
+ */
+class TickArena
+{
+public:
+    static const int MAX_OUTPUT_BUFFERS;    ///< = 3, max. no. of buffers kept per output slot
+    static const size_t ALIGNMENT;          ///< = 64 bytes, alignment of scratch buffers
+
+    TickArena();
+
+    /**
+     * @brief get scratch buffer
+     * No deep copy, valid until EndTick(), contents undefined
+     * @param rows
+     * @param cols
+     * @param type, e.g. CV_32FC1
+     * @return continuous matrix
+     */
+    cv::Mat Scratch(int rows, int cols, int type);
+
+    /**
+     * @brief get output buffer not referenced outside the arena
+     * Contents undefined, remains valid for as long as the caller holds on to it.
+     * Release previous headers of the same slot first to allow reusing their buffer.
+     * @param slot index, e.g. one per output of the layer
+     * @param rows
+     * @param cols
+     * @param type, e.g. CV_32FC1
+     * @return continuous matrix
+     */
+    cv::Mat Output(int slot, int rows, int cols, int type);
+
+    /**
+     * @brief Rewind scratch buffers at the end of a tick
+     * @return no. of arena growths during this tick
+     */
+    int EndTick();
+
+    /**
+     * @brief get no. of arena growths since last EndTick()
+     */
+    int NbGrowths() const;
+
+    /**
+     * @brief get no. of arena growths since construction or last Clear()
+     */
+    unsigned long long NbGrowthsTotal() const;
+
+    /**
+     * @brief Declare steady state reached, any further arena growth is a bug
+     * Growths still succeed and are counted, debug builds fail an assertion in EndTick().
+     * Allocations outside the arena are not covered.
+     * @param enable
+     */
+    void Seal(bool enable=true);
+
+    bool IsSealed() const;
+
+    /**
+     * @brief Release all buffers and reset counters
+     * Buffers still referenced elsewhere remain valid.
+     */
+    void Clear();
+
+protected:
+    /**
+     * @brief whether a buffer is referenced outside the arena
+     */
+    static bool IsShared(const cv::Mat &m);
+
+    cv::Mat1b block_;                   ///< scratch memory of current tick
+    std::vector<cv::Mat1b> retired_;    ///< blocks outgrown during current tick, kept alive until EndTick()
+    size_t offset_;                     ///< bytes of scratch memory handed out during current tick
+
+    std::vector<std::vector<cv::Mat> > outputs_;    ///< buffers per output slot, most recently allocated last
+
+    int nb_growths_;                    ///< no. of arena growths during current tick
+    unsigned long long nb_growths_total_;///< no. of arena growths in total
+    bool is_sealed_;                    ///< steady state flag
+};
+
+#endif // SEM_LAYERS_TICKARENA_H_
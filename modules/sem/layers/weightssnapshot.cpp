@@ -0,0 +1,140 @@
+#include "sem/layers/weightssnapshot.h"
+
+#include <atomic>
+
+#include "elm/core/exception.h"
+#include "sem/neuron/simdkernels.h"
+
+using std::shared_ptr;
+using namespace cv;
+
+WeightsSnapshot::WeightsSnapshot()
+    : version_(0)
+{
+}
+
+WeightsSnapshot::WeightsSnapshot(const Mat1f &weights_all, unsigned long long version)
+    : version_(0)
+{
+    Assign(weights_all, version);
+}
+
+void WeightsSnapshot::Assign(const Mat1f &weights_all, unsigned long long version)
+{
+    weights_all.copyTo(weights_all_); // continuous, reallocated only on new dims
+    version_ = version;
+}
+
+void WeightsSnapshot::Potentials(const Mat1f &spikes_in, Mat1f &u) const
+{
+    const int nb_afferents = NbAfferents();
+    if(spikes_in.total() != static_cast<size_t>(nb_afferents)) {
+
+        ELM_THROW_BAD_DIMS("Expecting one input spike per afferent");
+    }
+
+    const int nb_outputs = NbOutputs();
+    if(u.rows != 1 || u.cols != nb_outputs) {
+
+        u = Mat1f(1, nb_outputs);
+    }
+
+    Mat1f in = spikes_in.isContinuous()? spikes_in : spikes_in.clone();
+    const float *x = in.ptr<float>(0);
+
+    for(int r=0; r<nb_outputs; r++) {
+
+        const float *w = weights_all_.ptr<float>(r);
+        u(r) = w[0] + SIMDKernels::MaskedSum(w+1, x, nb_afferents);
+    }
+}
+
+Mat1f WeightsSnapshot::Weights() const
+{
+    if(weights_all_.empty()) {
+
+        return Mat1f();
+    }
+    return weights_all_.colRange(1, weights_all_.cols);
+}
+
+Mat1f WeightsSnapshot::Bias() const
+{
+    Mat1f bias(1, weights_all_.rows);
+    for(int r=0; r<weights_all_.rows; r++) {
+
+        bias(r) = weights_all_(r, 0);
+    }
+    return bias;
+}
+
+unsigned long long WeightsSnapshot::Version() const
+{
+    return version_;
+}
+
+bool WeightsSnapshot::empty() const
+{
+    return weights_all_.empty();
+}
+
+int WeightsSnapshot::NbAfferents() const
+{
+    return weights_all_.empty()? 0 : weights_all_.cols-1;
+}
+
+int WeightsSnapshot::NbOutputs() const
+{
+    return weights_all_.rows;
+}
+
+WeightsPublisher::WeightsPublisher()
+    : nb_published_(0),
+      nb_allocs_(0)
+{
+}
+
+void WeightsPublisher::Publish(const Mat1f &weights_all, unsigned long long version)
+{
+    // readers who loaded the back buffer while it was still published may hold on to it
+    if(back_ && back_.use_count() == 1 &&
+            back_->NbOutputs() == weights_all.rows &&
+            back_->NbAfferents() == weights_all.cols-1) {
+
+        // readers released it, make sure their reads happen before our writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+        back_->Assign(weights_all, version);
+    }
+    else {
+
+        back_.reset(new WeightsSnapshot(weights_all, version));
+        nb_allocs_++;
+    }
+
+    SnapshotPtr prev = std::atomic_exchange(&front_, SnapshotPtr(back_));
+    back_ = std::const_pointer_cast<WeightsSnapshot>(prev);
+    nb_published_++;
+}
+
+WeightsPublisher::SnapshotPtr WeightsPublisher::Acquire() const
+{
+    return std::atomic_load(&front_);
+}
+
+unsigned long long WeightsPublisher::NbPublished() const
+{
+    return nb_published_;
+}
+
+unsigned long long WeightsPublisher::NbAllocs() const
+{
+    return nb_allocs_;
+}
+
+void WeightsPublisher::Clear()
+{
+    std::atomic_store(&front_, SnapshotPtr());
+    back_.reset();
+    nb_published_ = 0;
+    nb_allocs_ = 0;
+}
@@ -0,0 +1,126 @@
+#ifndef SEM_LAYERS_WEIGHTSSNAPSHOT_H_
+#define SEM_LAYERS_WEIGHTSSNAPSHOT_H_
+
+#include <memory>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Immutable copy of the weights and bias of a layer of Z neurons for inference
+ *
+ * Computes the same membrane potentials as the layer did at the time the copy was taken,
+ * unaffected by further learning. Safe to share between threads as long as nobody writes to it.
+ * @see WeightsPublisher
+ */
+class WeightsSnapshot
+{
+public:
+    WeightsSnapshot();
+
+    /**
+     * @brief Take snapshot
+     * Involves deep copy
+     * @param weights of all neurons, one row per neuron, bias first, log scale
+     * @param version of weights, e.g. LayerZ::WeightsVersion()
+     */
+    WeightsSnapshot(const cv::Mat1f &weights_all, unsigned long long version);
+
+    /**
+     * @brief Overwrite with new weights, reusing storage while dimensions remain the same
+     * Only while nobody else reads from this snapshot
+     * @param weights of all neurons, one row per neuron, bias first
+     * @param version of weights
+     */
+    void Assign(const cv::Mat1f &weights_all, unsigned long long version);
+
+    /**
+     * @brief Compute membrane potentials
+     * @param input spikes, non-zero for spiking afferent
+     * @param[out] membrane potential per neuron
+     * @throws ExceptionBadDims on mismatching no. of afferents
+     */
+    void Potentials(const cv::Mat1f &spikes_in, cv::Mat1f &u) const;
+
+    /**
+     * @brief get weights
+     * No deep copy, do not write to it
+     * @return weights excluding bias, one row per neuron
+     */
+    cv::Mat1f Weights() const;
+
+    /**
+     * @brief get bias terms
+     * @return row vector with bias per neuron
+     */
+    cv::Mat1f Bias() const;
+
+    unsigned long long Version() const;
+
+    bool empty() const;
+
+    int NbAfferents() const;
+
+    int NbOutputs() const;
+
+protected:
+    cv::Mat1f weights_all_;         ///< one row per neuron, bias first
+    unsigned long long version_;    ///< version of weights at the time of the snapshot
+};
+
+/**
+ * @brief Publish weight snapshots of a learning layer to concurrent readers
+ *
+ * Read-copy-update with two buffers: the learner copies its weights into a back buffer
+ * and swaps it with the published front buffer in a single atomic pointer exchange.
+ * Readers atomically load the front buffer and keep it alive for as long as they hold it,
+ * such that a snapshot is only reclaimed once its last reader drops it.
+ * The back buffer is reused while no reader holds on to it, allocated anew otherwise.
+ *
+ * Publish() from the learner's thread only, Acquire() from any thread.
+ */
+class WeightsPublisher
+{
+public:
+    typedef std::shared_ptr<const WeightsSnapshot> SnapshotPtr;
+
+    WeightsPublisher();
+
+    /**
+     * @brief Publish snapshot of weights
+     * Involves deep copy into the back buffer, never waits for readers
+     * @param weights of all neurons, one row per neuron, bias first
+     * @param version of weights
+     */
+    void Publish(const cv::Mat1f &weights_all, unsigned long long version);
+
+    /**
+     * @brief get most recently published snapshot
+     * Safe to call concurrently with Publish(), the snapshot remains valid while held
+     * @return snapshot, null if nothing published yet
+     */
+    SnapshotPtr Acquire() const;
+
+    /**
+     * @brief get no. of snapshots published since construction or Clear()
+     */
+    unsigned long long NbPublished() const;
+
+    /**
+     * @brief get no. of times publishing had to allocate a new back buffer
+     */
+    unsigned long long NbAllocs() const;
+
+    /**
+     * @brief Unpublish, readers keep snapshots they hold
+     * Learner's thread only
+     */
+    void Clear();
+
+protected:
+    SnapshotPtr front_;                         ///< published snapshot, only accessed through atomic operations
+    std::shared_ptr<WeightsSnapshot> back_;     ///< snapshot to overwrite on next publish, null if none
+    unsigned long long nb_published_;           ///< no. of snapshots published
+    unsigned long long nb_allocs_;              ///< no. of back buffers allocated
+};
+
+#endif // SEM_LAYERS_WEIGHTSSNAPSHOT_H_
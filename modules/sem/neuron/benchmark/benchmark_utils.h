@@ -0,0 +1,158 @@
+/** @file Utilities for benchmarking SEM kernels
+ *
+ * Benchmarks are written as gtest value-parameterized tests.
+ * Each measurement is reported as test properties, such that running
+ * the benchmark binary with --gtest_output=xml:<file> yields machine-readable results.
+ */
+#ifndef SEM_NEURON_BENCHMARK_BENCHMARK_UTILS_H_
+#define SEM_NEURON_BENCHMARK_BENCHMARK_UTILS_H_
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/ts/ts.h"
+
+/**
+ * @brief Geometry of a benchmark run
+ */
+struct BenchmarkGeometry
+{
+    BenchmarkGeometry(int nb_afferents, int nb_outputs, int len_history, float density)
+        : nb_afferents(nb_afferents),
+          nb_outputs(nb_outputs),
+          len_history(len_history),
+          density(density)
+    {}
+
+    int nb_afferents;   ///< no. of afferent inputs
+    int nb_outputs;     ///< no. of output neurons
+    int len_history;    ///< length of spiking history
+    float density;      ///< fraction of afferents spiking per tick
+};
+
+inline std::ostream& operator<<(std::ostream &os, const BenchmarkGeometry &g)
+{
+    return os << "afferents=" << g.nb_afferents
+              << " outputs=" << g.nb_outputs
+              << " history=" << g.len_history
+              << " density=" << g.density;
+}
+
+/**
+ * @brief Cartesian product of geometry values
+ * @return list of geometries to sweep over
+ */
+inline std::vector<BenchmarkGeometry> SweepGeometry(const std::vector<int> &nb_afferents,
+                                                    const std::vector<int> &nb_outputs,
+                                                    const std::vector<int> &len_history,
+                                                    const std::vector<float> &density)
+{
+    std::vector<BenchmarkGeometry> sweep;
+    for(size_t a=0; a<nb_afferents.size(); a++) {
+        for(size_t o=0; o<nb_outputs.size(); o++) {
+            for(size_t h=0; h<len_history.size(); h++) {
+                for(size_t d=0; d<density.size(); d++) {
+
+                    sweep.push_back(BenchmarkGeometry(nb_afferents[a], nb_outputs[o], len_history[h], density[d]));
+                }
+            }
+        }
+    }
+    return sweep;
+}
+
+/**
+ * @brief Generate random binary spikes
+ * @param no. of afferents
+ * @param fraction of afferents spiking
+ * @return row vector of 0/1 spikes
+ */
+inline cv::Mat1f RandomSpikes(int nb_afferents, float density)
+{
+    cv::Mat1f r(1, nb_afferents);
+    cv::randu(r, 0.f, 1.f);
+
+    cv::Mat1f spikes;
+    cv::Mat(r < density).convertTo(spikes, CV_32F, 1./255.);
+    return spikes;
+}
+
+/**
+ * @brief Min. duration of a single measurement
+ * Can be overriden through the SEM_BENCHMARK_MIN_SEC environment variable
+ * @return duration [seconds]
+ */
+inline double BenchmarkMinSeconds()
+{
+    const char *value = std::getenv("SEM_BENCHMARK_MIN_SEC");
+    return (value != 0)? std::atof(value) : 0.2;
+}
+
+/**
+ * @brief Time repeated calls to a kernel
+ *
+ * Calls the kernel once for warm up, then repeatedly until
+ * the min. duration and min. no. of iterations are both reached.
+ *
+ * @param kernel callable without arguments
+ * @param[out] no. of timed iterations
+ * @return mean time per call [nanoseconds]
+ */
+template <class TKernel>
+double TimeKernel(TKernel kernel, int &nb_iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int MIN_ITERATIONS = 3;
+    const double MIN_SECONDS = BenchmarkMinSeconds();
+
+    kernel(); // warm up
+
+    nb_iterations = 0;
+    double elapsed_sec = 0.;
+    Clock::time_point t0 = Clock::now();
+    while(nb_iterations < MIN_ITERATIONS || elapsed_sec < MIN_SECONDS) {
+
+        kernel();
+        nb_iterations++;
+        elapsed_sec = std::chrono::duration<double>(Clock::now()-t0).count();
+    }
+
+    return elapsed_sec*1e9/nb_iterations;
+}
+
+/**
+ * @brief Report measurement of current benchmark as test properties and to stdout
+ * @param kernel name
+ * @param geometry
+ * @param no. of timed iterations
+ * @param mean time per call [nanoseconds]
+ */
+inline void RecordBenchmark(const std::string &kernel,
+                            const BenchmarkGeometry &g,
+                            int nb_iterations,
+                            double ns_per_op)
+{
+    std::stringstream s;
+    s << ns_per_op;
+
+    testing::Test::RecordProperty("kernel", kernel);
+    testing::Test::RecordProperty("nb_afferents", g.nb_afferents);
+    testing::Test::RecordProperty("nb_outputs", g.nb_outputs);
+    testing::Test::RecordProperty("len_history", g.len_history);
+    testing::Test::RecordProperty("density_permille", static_cast<int>(g.density*1000.f+0.5f));
+    testing::Test::RecordProperty("iterations", nb_iterations);
+    testing::Test::RecordProperty("ns_per_op", s.str());
+
+    std::cout << "[ BENCHMARK] " << kernel << " " << g
+              << " iterations=" << nb_iterations
+              << " ns_per_op=" << s.str() << std::endl;
+}
+
+#endif // SEM_NEURON_BENCHMARK_BENCHMARK_UTILS_H_
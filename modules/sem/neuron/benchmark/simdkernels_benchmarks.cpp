@@ -0,0 +1,112 @@
+/** @file Benchmark SIMD kernels per instruction set against the scalar reference
+ *
+ * Every supported instruction set is timed in turn,
+ * results are recorded under the kernel name suffixed by the instruction set.
+ */
+#include "sem/neuron/simdkernels.h"
+
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+/**
+ * @brief class for benchmarking kernels over different geometries and instruction sets
+ */
+class SIMDKernelsBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+
+        weights_ = Mat1f(1, g.nb_afferents);
+        randu(weights_, -5.f, 0.f);
+        drift_ = Mat1f::zeros(1, g.nb_afferents);
+        spikes_in_ = RandomSpikes(g.nb_afferents, g.density);
+        is_spiked_ = spikes_in_ > 0.f;
+
+        u_ = Mat1f(1, g.nb_outputs);
+        randu(u_, -10.f, 0.f);
+        p_ = Mat1f(1, g.nb_outputs);
+    }
+
+    virtual void TearDown()
+    {
+        SIMDKernels::Select(SIMDKernels::Detect());
+    }
+
+    /**
+     * @brief Time a kernel under every supported instruction set
+     * @param kernel name
+     * @param kernel
+     */
+    template <class TKernel>
+    void TimeISAs(const string &kernel, TKernel f)
+    {
+        for(int i=SIMDKernels::SCALAR; i<SIMDKernels::NB_ISA; i++) {
+
+            SIMDKernels::ISA isa = static_cast<SIMDKernels::ISA>(i);
+            if(SIMDKernels::IsSupported(isa)) {
+
+                SIMDKernels::Select(isa);
+
+                int nb_iterations;
+                double ns = TimeKernel(f, nb_iterations);
+                RecordBenchmark(kernel + "_" + SIMDKernels::Name(isa), GetParam(), nb_iterations, ns);
+            }
+        }
+    }
+
+    Mat1f weights_;     ///< weights of a single neuron
+    Mat1f drift_;       ///< smoothed weight changes
+    Mat1f spikes_in_;   ///< input spikes
+    Mat1b is_spiked_;   ///< input spikes as 8-bit mask
+    Mat1f u_;           ///< membrane potentials, one per output
+    Mat1f p_;           ///< softmax of potentials
+};
+
+TEST_P(SIMDKernelsBenchmark, MaskedSum)
+{
+    const int n = weights_.cols;
+    TimeISAs("SIMDKernels::MaskedSum", [this, n]() {
+
+        SIMDKernels::MaskedSum(weights_.ptr<float>(0), spikes_in_.ptr<float>(0), n);
+    });
+}
+
+/**
+ * @brief STDP with weights drifting towards the clamp, as during a long run
+ */
+TEST_P(SIMDKernelsBenchmark, STDP)
+{
+    const int n = weights_.cols;
+    TimeISAs("SIMDKernels::STDP", [this, n]() {
+
+        SIMDKernels::STDP(weights_.ptr<float>(0), drift_.ptr<float>(0), is_spiked_.ptr<uchar>(0), n,
+                          0.01f, -5.f, 0.999f, 0.001f);
+    });
+}
+
+TEST_P(SIMDKernelsBenchmark, SoftMax)
+{
+    const int n = u_.cols;
+    TimeISAs("SIMDKernels::SoftMax", [this, n]() {
+
+        SIMDKernels::SoftMax(u_.ptr<float>(0), p_.ptr<float>(0), n);
+    });
+}
+
+const int AFFERENTS[] = {784, 10000, 100000};
+const int OUTPUTS[] = {10, 100, 1000};
+
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        SIMDKernelsBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+3),
+                                                        vector<int>(OUTPUTS, OUTPUTS+3),
+                                                        vector<int>(1, 1),
+                                                        vector<float>(1, 0.1f))));
+
+} // annonymous namespace
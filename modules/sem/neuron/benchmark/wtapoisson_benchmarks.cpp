@@ -0,0 +1,84 @@
+/** @file Benchmark WTA circuit kernels
+ */
+#include "sem/neuron/wtapoisson.h"
+
+#include "sem/neuron/zneuron.h"
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+/**
+ * @brief class for benchmarking WTA competition over different no. of learners
+ */
+class WTAPoissonBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    WTAPoissonBenchmark()
+        : to_(0.f, 0.f)
+    {
+    }
+
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+
+        Mat1f evidence = RandomSpikes(g.nb_afferents, g.density);
+        learners_.clear();
+        for(int i=0; i<g.nb_outputs; i++) {
+
+            shared_ptr<ZNeuron> p(new ZNeuron);
+            p->Init(g.nb_afferents, g.len_history);
+            p->Predict(evidence);
+            learners_.push_back(p);
+        }
+    }
+
+    WTAPoisson to_;                                 ///< test object
+    vector<shared_ptr<base_Learner> > learners_;    ///< vector of spiking learners
+};
+
+/**
+ * @brief Competition with WTA spiking on every tick (soft-max and sampling)
+ */
+TEST_P(WTAPoissonBenchmark, Compete_Fire)
+{
+    to_ = WTAPoisson(1e5f, 1.f);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Compete(learners_); }, nb_iterations);
+    RecordBenchmark("WTAPoisson::Compete_Fire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Competition during refractory period
+ */
+TEST_P(WTAPoissonBenchmark, Compete_NoFire)
+{
+    to_ = WTAPoisson(0.f, 1.f);
+
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Compete(learners_); }, nb_iterations);
+    RecordBenchmark("WTAPoisson::Compete_NoFire", GetParam(), nb_iterations, ns);
+}
+
+TEST_P(WTAPoissonBenchmark, LearnerStateDistr)
+{
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.LearnerStateDistr(learners_); }, nb_iterations);
+    RecordBenchmark("WTAPoisson::LearnerStateDistr", GetParam(), nb_iterations, ns);
+}
+
+const int OUTPUTS[] = {10, 100, 1000, 10000};
+
+// afferent count is irrelevant to competition, keep it small for fast setup
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        WTAPoissonBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(1, 16),
+                                                        vector<int>(OUTPUTS, OUTPUTS+4),
+                                                        vector<int>(1, 1),
+                                                        vector<float>(1, 0.5f))));
+
+} // annonymous namespace
@@ -0,0 +1,91 @@
+/** @file Benchmark ZNeuron kernels
+ */
+#include "sem/neuron/zneuron.h"
+
+#include "sem/neuron/benchmark/benchmark_utils.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+
+/**
+ * @brief class for benchmarking a single neuron over different geometries
+ */
+class ZNeuronBenchmark : public testing::TestWithParam<BenchmarkGeometry>
+{
+protected:
+    virtual void SetUp()
+    {
+        BenchmarkGeometry g = GetParam();
+        to_ = ZNeuron();
+        to_.Init(g.nb_afferents, g.len_history);
+        evidence_ = RandomSpikes(g.nb_afferents, g.density);
+    }
+
+    ZNeuron to_;        ///< test object
+    Mat1f evidence_;    ///< input spikes
+};
+
+TEST_P(ZNeuronBenchmark, Predict)
+{
+    int nb_iterations;
+    double ns = TimeKernel([this]() { to_.Predict(evidence_); }, nb_iterations);
+    RecordBenchmark("ZNeuron::Predict", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Learn for a spiking neuron, STDP update of all weights
+ */
+TEST_P(ZNeuronBenchmark, Learn_Fire)
+{
+    const Mat1i target = Mat1i::ones(1, 1);
+    to_.Predict(evidence_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this, &target]() { to_.Learn(target); }, nb_iterations);
+    RecordBenchmark("ZNeuron::Learn_Fire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief Learn for a silent neuron, update of bias only
+ */
+TEST_P(ZNeuronBenchmark, Learn_NoFire)
+{
+    const Mat1i target = Mat1i::zeros(1, 1);
+    to_.Predict(evidence_);
+
+    int nb_iterations;
+    double ns = TimeKernel([this, &target]() { to_.Learn(target); }, nb_iterations);
+    RecordBenchmark("ZNeuron::Learn_NoFire", GetParam(), nb_iterations, ns);
+}
+
+/**
+ * @brief A full tick of a spiking neuron
+ */
+TEST_P(ZNeuronBenchmark, PredictLearn_Fire)
+{
+    const Mat1i target = Mat1i::ones(1, 1);
+
+    int nb_iterations;
+    double ns = TimeKernel([this, &target]() {
+
+        to_.Predict(evidence_);
+        to_.Learn(target);
+
+    }, nb_iterations);
+    RecordBenchmark("ZNeuron::PredictLearn_Fire", GetParam(), nb_iterations, ns);
+}
+
+const int AFFERENTS[] = {784, 1568, 10000, 100000};
+const int HISTORY[] = {1, 5, 10};
+const float DENSITY[] = {0.01f, 0.1f, 0.5f};
+
+INSTANTIATE_TEST_CASE_P(Sweep,
+                        ZNeuronBenchmark,
+                        testing::ValuesIn(SweepGeometry(vector<int>(AFFERENTS, AFFERENTS+4),
+                                                        vector<int>(1, 1),
+                                                        vector<int>(HISTORY, HISTORY+3),
+                                                        vector<float>(DENSITY, DENSITY+3))));
+
+} // annonymous namespace
@@ -0,0 +1,669 @@
+#include "sem/neuron/simdkernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "elm/core/exception.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEM_SIMD_X86 1
+#include <immintrin.h>
+// intrinsics headers trip false positives when inlined into target-specific functions
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#else
+#define SEM_SIMD_X86 0
+#endif
+
+namespace {
+
+/**
+ * @brief STDP update of a single weight, shared by reference and vector tails
+ * @return absolute drift
+ */
+inline float STDPOne(float &w, float &drift, unsigned char is_spiked,
+                     float eta, float w_min, float keep, float smoothing)
+{
+    const float w_old = w;
+    const float exp_w = std::exp(w_old);
+
+    // limit factor exp(-max(w, log(eta))) scales down updates of large weights
+    const float delta = (exp_w > eta)? eta/exp_w : 1.f;
+
+    float w_new = w_old + (is_spiked? delta*(1.f-exp_w) : -delta*exp_w);
+    w_new = std::max(w_new, w_min);
+    w = w_new;
+
+    drift = keep*drift + smoothing*(w_new-w_old);
+    return std::abs(drift);
+}
+
+#if SEM_SIMD_X86
+
+// Cephes single precision exp, exp(x) = 2^n exp(r) with |r| <= ln(2)/2
+const float EXP_HI = 88.3762626647949f;
+const float EXP_LO = -88.3762626647949f;
+const float LOG2E = 1.44269504088896341f;
+const float LN2_HI = 0.693359375f;
+const float LN2_LO = -2.12194440e-4f;
+const float EXP_P0 = 1.9875691500e-4f;
+const float EXP_P1 = 1.3981999507e-3f;
+const float EXP_P2 = 8.3334519073e-3f;
+const float EXP_P3 = 4.1665795894e-2f;
+const float EXP_P4 = 1.6666665459e-1f;
+const float EXP_P5 = 5.0000001201e-1f;
+
+// SSE4.1
+
+__attribute__((target("sse4.1")))
+inline __m128 Exp_SSE4(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_LO)), _mm_set1_ps(EXP_HI));
+
+    __m128 fx = _mm_floor_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E)), _mm_set1_ps(0.5f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_HI)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_LO)));
+
+    __m128 y = _mm_set1_ps(EXP_P0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(EXP_P1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(EXP_P2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(EXP_P3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(EXP_P4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(EXP_P5));
+    y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), _mm_add_ps(x, _mm_set1_ps(1.f)));
+
+    __m128i n = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127));
+    return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+}
+
+__attribute__((target("sse4.1")))
+inline float HSum_SSE4(__m128 v)
+{
+    v = _mm_hadd_ps(v, v);
+    v = _mm_hadd_ps(v, v);
+    return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("sse4.1")))
+inline float HMax_SSE4(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("sse4.1")))
+float MaskedSum_SSE4(const float *w, const float *x, int n)
+{
+    const __m128 zero = _mm_setzero_ps();
+    __m128 acc = zero;
+    int i=0;
+    for(; i+4<=n; i+=4) {
+
+        __m128 mask = _mm_cmpgt_ps(_mm_loadu_ps(x+i), zero);
+        acc = _mm_add_ps(acc, _mm_and_ps(mask, _mm_loadu_ps(w+i)));
+    }
+
+    float s = HSum_SSE4(acc);
+    for(; i<n; i++) {
+
+        if(x[i] > 0.f) {
+
+            s += w[i];
+        }
+    }
+    return s;
+}
+
+__attribute__((target("sse4.1")))
+double STDP_SSE4(float *w, float *drift, const unsigned char *is_spiked, int n,
+                 float eta, float w_min, float keep, float smoothing)
+{
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 v_eta = _mm_set1_ps(eta);
+    const __m128 v_min = _mm_set1_ps(w_min);
+    const __m128 v_keep = _mm_set1_ps(keep);
+    const __m128 v_smoothing = _mm_set1_ps(smoothing);
+    const __m128 sign = _mm_set1_ps(-0.f);
+    const __m128i zero_i = _mm_setzero_si128();
+
+    __m128d acc = _mm_setzero_pd();
+    int i=0;
+    for(; i+4<=n; i+=4) {
+
+        const __m128 w_old = _mm_loadu_ps(w+i);
+        const __m128 e = Exp_SSE4(w_old);
+        const __m128 delta = _mm_blendv_ps(one, _mm_div_ps(v_eta, e), _mm_cmpgt_ps(e, v_eta));
+
+        int s;
+        std::memcpy(&s, is_spiked+i, sizeof(s));
+        const __m128 spiked = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(s)), zero_i));
+
+        const __m128 dw = _mm_blendv_ps(_mm_xor_ps(_mm_mul_ps(delta, e), sign),
+                                        _mm_mul_ps(delta, _mm_sub_ps(one, e)),
+                                        spiked);
+        const __m128 w_new = _mm_max_ps(_mm_add_ps(w_old, dw), v_min);
+        _mm_storeu_ps(w+i, w_new);
+
+        const __m128 d = _mm_add_ps(_mm_mul_ps(v_keep, _mm_loadu_ps(drift+i)),
+                                    _mm_mul_ps(v_smoothing, _mm_sub_ps(w_new, w_old)));
+        _mm_storeu_ps(drift+i, d);
+
+        const __m128 abs_d = _mm_andnot_ps(sign, d);
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(abs_d));
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(abs_d, abs_d)));
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    double sum_abs = lanes[0]+lanes[1];
+    for(; i<n; i++) {
+
+        sum_abs += STDPOne(w[i], drift[i], is_spiked[i], eta, w_min, keep, smoothing);
+    }
+    return sum_abs;
+}
+
+__attribute__((target("sse4.1")))
+void SoftMax_SSE4(const float *u, float *p, int n)
+{
+    __m128 v_max = _mm_set1_ps(u[0]);
+    int i=0;
+    for(; i+4<=n; i+=4) {
+
+        v_max = _mm_max_ps(v_max, _mm_loadu_ps(u+i));
+    }
+    float m = HMax_SSE4(v_max);
+    for(; i<n; i++) {
+
+        m = std::max(m, u[i]);
+    }
+
+    const __m128 shift = _mm_set1_ps(m);
+    __m128 acc = _mm_setzero_ps();
+    for(i=0; i+4<=n; i+=4) {
+
+        __m128 e = Exp_SSE4(_mm_sub_ps(_mm_loadu_ps(u+i), shift));
+        _mm_storeu_ps(p+i, e);
+        acc = _mm_add_ps(acc, e);
+    }
+    float s = HSum_SSE4(acc);
+    for(; i<n; i++) {
+
+        p[i] = std::exp(u[i]-m);
+        s += p[i];
+    }
+
+    const __m128 scale = _mm_set1_ps(1.f/s);
+    for(i=0; i+4<=n; i+=4) {
+
+        _mm_storeu_ps(p+i, _mm_mul_ps(_mm_loadu_ps(p+i), scale));
+    }
+    for(; i<n; i++) {
+
+        p[i] *= 1.f/s;
+    }
+}
+
+// AVX2
+
+__attribute__((target("avx2,fma")))
+inline __m256 Exp_AVX2(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO)), _mm256_set1_ps(EXP_HI));
+
+    __m256 fx = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(LOG2E), _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(LN2_HI), x);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(LN2_LO), x);
+
+    __m256 y = _mm256_set1_ps(EXP_P0);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(EXP_P1));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(EXP_P2));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(EXP_P3));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(EXP_P4));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(EXP_P5));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.f)));
+
+    __m256i n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127));
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+__attribute__((target("avx2,fma")))
+inline float HSum_AVX2(__m256 v)
+{
+    return HSum_SSE4(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+inline float HMax_AVX2(__m256 v)
+{
+    return HMax_SSE4(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+float MaskedSum_AVX2(const float *w, const float *x, int n)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 acc = zero;
+    int i=0;
+    for(; i+8<=n; i+=8) {
+
+        __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(x+i), zero, _CMP_GT_OQ);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(mask, _mm256_loadu_ps(w+i)));
+    }
+
+    float s = HSum_AVX2(acc);
+    for(; i<n; i++) {
+
+        if(x[i] > 0.f) {
+
+            s += w[i];
+        }
+    }
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+double STDP_AVX2(float *w, float *drift, const unsigned char *is_spiked, int n,
+                 float eta, float w_min, float keep, float smoothing)
+{
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 v_eta = _mm256_set1_ps(eta);
+    const __m256 v_min = _mm256_set1_ps(w_min);
+    const __m256 v_keep = _mm256_set1_ps(keep);
+    const __m256 v_smoothing = _mm256_set1_ps(smoothing);
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    const __m256i zero_i = _mm256_setzero_si256();
+
+    __m256d acc = _mm256_setzero_pd();
+    int i=0;
+    for(; i+8<=n; i+=8) {
+
+        const __m256 w_old = _mm256_loadu_ps(w+i);
+        const __m256 e = Exp_AVX2(w_old);
+        const __m256 delta = _mm256_blendv_ps(one, _mm256_div_ps(v_eta, e), _mm256_cmp_ps(e, v_eta, _CMP_GT_OQ));
+
+        const __m256i s = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(is_spiked+i)));
+        const __m256 spiked = _mm256_castsi256_ps(_mm256_cmpgt_epi32(s, zero_i));
+
+        const __m256 dw = _mm256_blendv_ps(_mm256_xor_ps(_mm256_mul_ps(delta, e), sign),
+                                           _mm256_mul_ps(delta, _mm256_sub_ps(one, e)),
+                                           spiked);
+        const __m256 w_new = _mm256_max_ps(_mm256_add_ps(w_old, dw), v_min);
+        _mm256_storeu_ps(w+i, w_new);
+
+        const __m256 d = _mm256_fmadd_ps(v_keep, _mm256_loadu_ps(drift+i),
+                                         _mm256_mul_ps(v_smoothing, _mm256_sub_ps(w_new, w_old)));
+        _mm256_storeu_ps(drift+i, d);
+
+        const __m256 abs_d = _mm256_andnot_ps(sign, d);
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(abs_d)));
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(abs_d, 1)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double sum_abs = lanes[0]+lanes[1]+lanes[2]+lanes[3];
+    for(; i<n; i++) {
+
+        sum_abs += STDPOne(w[i], drift[i], is_spiked[i], eta, w_min, keep, smoothing);
+    }
+    return sum_abs;
+}
+
+__attribute__((target("avx2,fma")))
+void SoftMax_AVX2(const float *u, float *p, int n)
+{
+    __m256 v_max = _mm256_set1_ps(u[0]);
+    int i=0;
+    for(; i+8<=n; i+=8) {
+
+        v_max = _mm256_max_ps(v_max, _mm256_loadu_ps(u+i));
+    }
+    float m = HMax_AVX2(v_max);
+    for(; i<n; i++) {
+
+        m = std::max(m, u[i]);
+    }
+
+    const __m256 shift = _mm256_set1_ps(m);
+    __m256 acc = _mm256_setzero_ps();
+    for(i=0; i+8<=n; i+=8) {
+
+        __m256 e = Exp_AVX2(_mm256_sub_ps(_mm256_loadu_ps(u+i), shift));
+        _mm256_storeu_ps(p+i, e);
+        acc = _mm256_add_ps(acc, e);
+    }
+    float s = HSum_AVX2(acc);
+    for(; i<n; i++) {
+
+        p[i] = std::exp(u[i]-m);
+        s += p[i];
+    }
+
+    const __m256 scale = _mm256_set1_ps(1.f/s);
+    for(i=0; i+8<=n; i+=8) {
+
+        _mm256_storeu_ps(p+i, _mm256_mul_ps(_mm256_loadu_ps(p+i), scale));
+    }
+    for(; i<n; i++) {
+
+        p[i] *= 1.f/s;
+    }
+}
+
+// AVX-512
+
+__attribute__((target("avx512f")))
+inline __m512 Exp_AVX512(__m512 x)
+{
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(EXP_LO)), _mm512_set1_ps(EXP_HI));
+
+    __m512 fx = _mm512_roundscale_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(LOG2E), _mm512_set1_ps(0.5f)),
+                                     _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(LN2_HI), x);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(LN2_LO), x);
+
+    __m512 y = _mm512_set1_ps(EXP_P0);
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(EXP_P1));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(EXP_P2));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(EXP_P3));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(EXP_P4));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(EXP_P5));
+    y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, _mm512_set1_ps(1.f)));
+
+    __m512i n = _mm512_add_epi32(_mm512_cvttps_epi32(fx), _mm512_set1_epi32(127));
+    return _mm512_mul_ps(y, _mm512_castsi512_ps(_mm512_slli_epi32(n, 23)));
+}
+
+__attribute__((target("avx512f")))
+inline __m512 Abs_AVX512(__m512 v)
+{
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+}
+
+__attribute__((target("avx512f")))
+float MaskedSum_AVX512(const float *w, const float *x, int n)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 acc = zero;
+    int i=0;
+    for(; i+16<=n; i+=16) {
+
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(x+i), zero, _CMP_GT_OQ);
+        acc = _mm512_mask_add_ps(acc, mask, acc, _mm512_loadu_ps(w+i));
+    }
+
+    float s = _mm512_reduce_add_ps(acc);
+    for(; i<n; i++) {
+
+        if(x[i] > 0.f) {
+
+            s += w[i];
+        }
+    }
+    return s;
+}
+
+__attribute__((target("avx512f")))
+double STDP_AVX512(float *w, float *drift, const unsigned char *is_spiked, int n,
+                   float eta, float w_min, float keep, float smoothing)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.f);
+    const __m512 v_eta = _mm512_set1_ps(eta);
+    const __m512 v_min = _mm512_set1_ps(w_min);
+    const __m512 v_keep = _mm512_set1_ps(keep);
+    const __m512 v_smoothing = _mm512_set1_ps(smoothing);
+
+    __m512d acc = _mm512_setzero_pd();
+    int i=0;
+    for(; i+16<=n; i+=16) {
+
+        const __m512 w_old = _mm512_loadu_ps(w+i);
+        const __m512 e = Exp_AVX512(w_old);
+        const __m512 delta = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(e, v_eta, _CMP_GT_OQ),
+                                                  one, _mm512_div_ps(v_eta, e));
+
+        const __m512i s = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(is_spiked+i)));
+        const __mmask16 spiked = _mm512_test_epi32_mask(s, s);
+
+        const __m512 dw = _mm512_mask_blend_ps(spiked,
+                                               _mm512_sub_ps(zero, _mm512_mul_ps(delta, e)),
+                                               _mm512_mul_ps(delta, _mm512_sub_ps(one, e)));
+        const __m512 w_new = _mm512_max_ps(_mm512_add_ps(w_old, dw), v_min);
+        _mm512_storeu_ps(w+i, w_new);
+
+        const __m512 d = _mm512_fmadd_ps(v_keep, _mm512_loadu_ps(drift+i),
+                                         _mm512_mul_ps(v_smoothing, _mm512_sub_ps(w_new, w_old)));
+        _mm512_storeu_ps(drift+i, d);
+
+        const __m512 abs_d = Abs_AVX512(d);
+        acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm512_castps512_ps256(abs_d)));
+        acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(abs_d), 1))));
+    }
+
+    double sum_abs = _mm512_reduce_add_pd(acc);
+    for(; i<n; i++) {
+
+        sum_abs += STDPOne(w[i], drift[i], is_spiked[i], eta, w_min, keep, smoothing);
+    }
+    return sum_abs;
+}
+
+__attribute__((target("avx512f")))
+void SoftMax_AVX512(const float *u, float *p, int n)
+{
+    __m512 v_max = _mm512_set1_ps(u[0]);
+    int i=0;
+    for(; i+16<=n; i+=16) {
+
+        v_max = _mm512_max_ps(v_max, _mm512_loadu_ps(u+i));
+    }
+    float m = _mm512_reduce_max_ps(v_max);
+    for(; i<n; i++) {
+
+        m = std::max(m, u[i]);
+    }
+
+    const __m512 shift = _mm512_set1_ps(m);
+    __m512 acc = _mm512_setzero_ps();
+    for(i=0; i+16<=n; i+=16) {
+
+        __m512 e = Exp_AVX512(_mm512_sub_ps(_mm512_loadu_ps(u+i), shift));
+        _mm512_storeu_ps(p+i, e);
+        acc = _mm512_add_ps(acc, e);
+    }
+    float s = _mm512_reduce_add_ps(acc);
+    for(; i<n; i++) {
+
+        p[i] = std::exp(u[i]-m);
+        s += p[i];
+    }
+
+    const __m512 scale = _mm512_set1_ps(1.f/s);
+    for(i=0; i+16<=n; i+=16) {
+
+        _mm512_storeu_ps(p+i, _mm512_mul_ps(_mm512_loadu_ps(p+i), scale));
+    }
+    for(; i<n; i++) {
+
+        p[i] *= 1.f/s;
+    }
+}
+
+#endif // SEM_SIMD_X86
+
+/**
+ * @brief Kernels of one instruction set
+ */
+struct KernelTable
+{
+    SIMDKernels::ISA isa;
+    float (*masked_sum)(const float*, const float*, int);
+    double (*stdp)(float*, float*, const unsigned char*, int, float, float, float, float);
+    void (*soft_max)(const float*, float*, int);
+};
+
+KernelTable Table(SIMDKernels::ISA isa)
+{
+    KernelTable t;
+    t.isa = isa;
+    switch(isa) {
+
+#if SEM_SIMD_X86
+    case SIMDKernels::SSE4:
+        t.masked_sum = MaskedSum_SSE4;
+        t.stdp = STDP_SSE4;
+        t.soft_max = SoftMax_SSE4;
+        break;
+    case SIMDKernels::AVX2:
+        t.masked_sum = MaskedSum_AVX2;
+        t.stdp = STDP_AVX2;
+        t.soft_max = SoftMax_AVX2;
+        break;
+    case SIMDKernels::AVX512:
+        t.masked_sum = MaskedSum_AVX512;
+        t.stdp = STDP_AVX512;
+        t.soft_max = SoftMax_AVX512;
+        break;
+#endif // SEM_SIMD_X86
+    default:
+        t.isa = SIMDKernels::SCALAR;
+        t.masked_sum = SIMDKernels::MaskedSumScalar;
+        t.stdp = SIMDKernels::STDPScalar;
+        t.soft_max = SIMDKernels::SoftMaxScalar;
+        break;
+    }
+    return t;
+}
+
+/**
+ * @brief get kernels in use, detected on first call
+ */
+KernelTable& ActiveTable()
+{
+    static KernelTable table = Table(SIMDKernels::Detect());
+    return table;
+}
+
+} // annonymous namespace
+
+bool SIMDKernels::IsSupported(ISA isa)
+{
+    switch(isa) {
+
+    case SCALAR:
+        return true;
+#if SEM_SIMD_X86
+    case SSE4:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.1");
+    case AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case AVX512:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+#endif // SEM_SIMD_X86
+    default:
+        return false;
+    }
+}
+
+SIMDKernels::ISA SIMDKernels::Detect()
+{
+    for(int isa=NB_ISA-1; isa>SCALAR; isa--) {
+
+        if(IsSupported(static_cast<ISA>(isa))) {
+
+            return static_cast<ISA>(isa);
+        }
+    }
+    return SCALAR;
+}
+
+SIMDKernels::ISA SIMDKernels::Active()
+{
+    return ActiveTable().isa;
+}
+
+void SIMDKernels::Select(ISA isa)
+{
+    if(!IsSupported(isa)) {
+
+        ELM_THROW_VALUE_ERROR("Instruction set not supported: " + Name(isa));
+    }
+    ActiveTable() = Table(isa);
+}
+
+std::string SIMDKernels::Name(ISA isa)
+{
+    switch(isa) {
+
+    case SCALAR:    return "scalar";
+    case SSE4:      return "sse4";
+    case AVX2:      return "avx2";
+    case AVX512:    return "avx512";
+    default:        return "unknown";
+    }
+}
+
+float SIMDKernels::MaskedSum(const float *w, const float *x, int n)
+{
+    return ActiveTable().masked_sum(w, x, n);
+}
+
+double SIMDKernels::STDP(float *w, float *drift, const unsigned char *is_spiked, int n,
+                         float eta, float w_min, float keep, float smoothing)
+{
+    return ActiveTable().stdp(w, drift, is_spiked, n, eta, w_min, keep, smoothing);
+}
+
+void SIMDKernels::SoftMax(const float *u, float *p, int n)
+{
+    ActiveTable().soft_max(u, p, n);
+}
+
+float SIMDKernels::MaskedSumScalar(const float *w, const float *x, int n)
+{
+    double s = 0.;
+    for(int i=0; i<n; i++) {
+
+        if(x[i] > 0.f) {
+
+            s += w[i];
+        }
+    }
+    return static_cast<float>(s);
+}
+
+double SIMDKernels::STDPScalar(float *w, float *drift, const unsigned char *is_spiked, int n,
+                               float eta, float w_min, float keep, float smoothing)
+{
+    double sum_abs = 0.;
+    for(int i=0; i<n; i++) {
+
+        sum_abs += STDPOne(w[i], drift[i], is_spiked[i], eta, w_min, keep, smoothing);
+    }
+    return sum_abs;
+}
+
+void SIMDKernels::SoftMaxScalar(const float *u, float *p, int n)
+{
+    const float m = *std::max_element(u, u+n);
+
+    double s = 0.;
+    for(int i=0; i<n; i++) {
+
+        p[i] = std::exp(u[i]-m);
+        s += p[i];
+    }
+
+    const float scale = static_cast<float>(1./s);
+    for(int i=0; i<n; i++) {
+
+        p[i] *= scale;
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef SEM_NEURON_SIMDKERNELS_H_
+#define SEM_NEURON_SIMDKERNELS_H_
+
+#include <string>
+
+/**
+ * @brief Hand-vectorized kernels for the inner loops of SEM neurons
+ *
+ * Every kernel comes in a scalar reference and SSE4.1, AVX2 and AVX-512 variants,
+ * all compiled into the same binary. The widest variant supported by the CPU
+ * is selected on first use, such that one build runs at full speed on any x86 machine.
+ * Other architectures and compilers fall back to the scalar reference.
+ *
+ * Variants differ from the reference by rounding only (accumulation order, polynomial exp).
+ */
+class SIMDKernels
+{
+public:
+    /**
+     * @brief Instruction sets kernels are available for, ordered by vector width
+     */
+    enum ISA {
+        SCALAR=0,   ///< portable reference
+        SSE4,       ///< SSE4.1, 4 floats per vector
+        AVX2,       ///< AVX2 and FMA, 8 floats per vector
+        AVX512,     ///< AVX-512F, 16 floats per vector
+        NB_ISA
+    };
+
+    /**
+     * @brief Detect widest instruction set supported by this CPU and build
+     */
+    static ISA Detect();
+
+    static bool IsSupported(ISA isa);
+
+    /**
+     * @brief get instruction set of kernels currently in use
+     */
+    static ISA Active();
+
+    /**
+     * @brief Switch kernels to a different instruction set, e.g. for testing against the reference
+     * Not thread-safe, select before running any layers.
+     * @param isa
+     * @throws ExceptionValueError if not supported
+     */
+    static void Select(ISA isa);
+
+    static std::string Name(ISA isa);
+
+    /**
+     * @brief Sum weights of spiking inputs
+     * @param weights
+     * @param inputs, spiking if greater than zero
+     * @param no. of elements
+     * @return sum of w[i] over x[i] > 0
+     */
+    static float MaskedSum(const float *w, const float *x, int n);
+
+    /**
+     * @brief STDP update of weights under a constant learning rate, see ZNeuron
+     *
+     * w += spiked? delta*(1-exp(w)) : -delta*exp(w) with delta = min(1, eta*exp(-w)),
+     * clamped at w_min, followed by drift = keep*drift + smoothing*(change in w).
+     *
+     * @param[in,out] weights
+     * @param[in,out] smoothed weight changes
+     * @param non-zero for afferents that spiked recently
+     * @param no. of weights
+     * @param learning rate
+     * @param lower limit of weights
+     * @param decay of drift
+     * @param smoothing factor of drift
+     * @return sum of absolute drift
+     */
+    static double STDP(float *w, float *drift, const unsigned char *is_spiked, int n,
+                       float eta, float w_min, float keep, float smoothing);
+
+    /**
+     * @brief Softmax, shifted by the max. for numerical stability
+     * @param input, at least one element
+     * @param[out] output distribution, may alias input
+     * @param no. of elements
+     */
+    static void SoftMax(const float *u, float *p, int n);
+
+    /** Scalar references */
+    static float MaskedSumScalar(const float *w, const float *x, int n);
+
+    static double STDPScalar(float *w, float *drift, const unsigned char *is_spiked, int n,
+                             float eta, float w_min, float keep, float smoothing);
+
+    static void SoftMaxScalar(const float *u, float *p, int n);
+};
+
+#endif // SEM_NEURON_SIMDKERNELS_H_
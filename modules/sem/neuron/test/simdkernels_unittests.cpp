@@ -0,0 +1,196 @@
+#include "sem/neuron/simdkernels.h"
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/exception.h"
+#include "elm/ts/ts.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int SIZES[] = {1, 3, 7, 15, 16, 17, 33, 100, 1001}; ///< exercise vector bodies and tails
+const int NB_SIZES = static_cast<int>(sizeof(SIZES)/sizeof(SIZES[0]));
+
+/**
+ * @brief Compare every supported instruction set against the scalar reference
+ */
+class SIMDKernelsTest : public testing::TestWithParam<int>
+{
+protected:
+    virtual void SetUp()
+    {
+        isa_ = static_cast<SIMDKernels::ISA>(GetParam());
+        if(SIMDKernels::IsSupported(isa_)) {
+
+            SIMDKernels::Select(isa_);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        SIMDKernels::Select(SIMDKernels::Detect());
+    }
+
+    /**
+     * @brief Generate random row vector
+     */
+    static Mat1f Random(int n, float low, float high)
+    {
+        Mat1f m(1, n);
+        randu(m, low, high);
+        return m;
+    }
+
+    SIMDKernels::ISA isa_;
+};
+
+TEST_P(SIMDKernelsTest, MaskedSum)
+{
+    if(!SIMDKernels::IsSupported(isa_)) {
+
+        return;
+    }
+
+    for(int k=0; k<NB_SIZES; k++) {
+
+        const int n = SIZES[k];
+        Mat1f w = Random(n, -5.f, 0.f);
+        Mat1f x = Random(n, -1.f, 1.f); // negative inputs do not count as spiking
+
+        float expected = SIMDKernels::MaskedSumScalar(w.ptr<float>(0), x.ptr<float>(0), n);
+        float actual = SIMDKernels::MaskedSum(w.ptr<float>(0), x.ptr<float>(0), n);
+        EXPECT_NEAR(expected, actual, 1e-6f*n) << "n=" << n;
+
+        Mat1f w_spiking = w.clone();
+        w_spiking.setTo(0.f, x <= 0.f);
+        EXPECT_NEAR(sum(w_spiking)(0), actual, 1e-6f*n) << "n=" << n;
+    }
+}
+
+TEST_P(SIMDKernelsTest, STDP)
+{
+    if(!SIMDKernels::IsSupported(isa_)) {
+
+        return;
+    }
+
+    const float ETA = 0.01f;
+    const float W_MIN = -5.f;
+    const float SMOOTHING = 0.001f;
+
+    for(int k=0; k<NB_SIZES; k++) {
+
+        const int n = SIZES[k];
+        Mat1f w = Random(n, -6.f, 1.f); // span clamp and limit factor
+        Mat1f drift = Random(n, -0.01f, 0.01f);
+        Mat1b is_spiked = Random(n, 0.f, 1.f) > 0.5f;
+
+        Mat1f w_expected = w.clone();
+        Mat1f drift_expected = drift.clone();
+        double expected = SIMDKernels::STDPScalar(w_expected.ptr<float>(0), drift_expected.ptr<float>(0),
+                                                  is_spiked.ptr<uchar>(0), n,
+                                                  ETA, W_MIN, 1.f-SMOOTHING, SMOOTHING);
+
+        double actual = SIMDKernels::STDP(w.ptr<float>(0), drift.ptr<float>(0),
+                                          is_spiked.ptr<uchar>(0), n,
+                                          ETA, W_MIN, 1.f-SMOOTHING, SMOOTHING);
+
+        EXPECT_NEAR(expected, actual, 1e-5*expected) << "n=" << n;
+        EXPECT_MAT_NEAR(w_expected, w, 1e-6f);
+        EXPECT_MAT_NEAR(drift_expected, drift, 1e-8f);
+
+        double min_w;
+        minMaxLoc(w, &min_w);
+        EXPECT_GE(min_w, W_MIN);
+    }
+}
+
+TEST_P(SIMDKernelsTest, SoftMax)
+{
+    if(!SIMDKernels::IsSupported(isa_)) {
+
+        return;
+    }
+
+    for(int k=0; k<NB_SIZES; k++) {
+
+        const int n = SIZES[k];
+        Mat1f u = Random(n, -50.f, 50.f);
+
+        Mat1f expected(1, n), actual(1, n);
+        SIMDKernels::SoftMaxScalar(u.ptr<float>(0), expected.ptr<float>(0), n);
+        SIMDKernels::SoftMax(u.ptr<float>(0), actual.ptr<float>(0), n);
+
+        EXPECT_MAT_NEAR(expected, actual, 1e-6f);
+        EXPECT_NEAR(1., sum(actual)(0), 1e-5) << "n=" << n;
+
+        double min_p;
+        minMaxLoc(actual, &min_p);
+        EXPECT_GE(min_p, 0.);
+
+        // in place
+        SIMDKernels::SoftMax(u.ptr<float>(0), u.ptr<float>(0), n);
+        EXPECT_MAT_NEAR(expected, u, 1e-6f);
+    }
+}
+
+/**
+ * @brief Shift by the max. keeps large potentials from overflowing
+ */
+TEST_P(SIMDKernelsTest, SoftMax_Large)
+{
+    if(!SIMDKernels::IsSupported(isa_)) {
+
+        return;
+    }
+
+    const int n = 33;
+    Mat1f u = Random(n, 500.f, 600.f);
+    Mat1f p(1, n);
+    SIMDKernels::SoftMax(u.ptr<float>(0), p.ptr<float>(0), n);
+
+    EXPECT_TRUE(checkRange(p));
+    EXPECT_NEAR(1., sum(p)(0), 1e-5);
+}
+
+INSTANTIATE_TEST_CASE_P(ISA,
+                        SIMDKernelsTest,
+                        testing::Range(static_cast<int>(SIMDKernels::SCALAR),
+                                       static_cast<int>(SIMDKernels::NB_ISA)));
+
+TEST(SIMDKernelsDispatchTest, Detect)
+{
+    SIMDKernels::ISA isa = SIMDKernels::Detect();
+    EXPECT_TRUE(SIMDKernels::IsSupported(isa));
+    EXPECT_TRUE(SIMDKernels::IsSupported(SIMDKernels::SCALAR));
+    EXPECT_EQ(isa, SIMDKernels::Active()) << "Expecting widest supported kernels by default.";
+
+    for(int i=isa+1; i<SIMDKernels::NB_ISA; i++) {
+
+        EXPECT_FALSE(SIMDKernels::IsSupported(static_cast<SIMDKernels::ISA>(i)));
+    }
+}
+
+TEST(SIMDKernelsDispatchTest, Select)
+{
+    SIMDKernels::Select(SIMDKernels::SCALAR);
+    EXPECT_EQ(SIMDKernels::SCALAR, SIMDKernels::Active());
+
+    EXPECT_THROW(SIMDKernels::Select(SIMDKernels::NB_ISA), ExceptionValueError);
+    EXPECT_EQ(SIMDKernels::SCALAR, SIMDKernels::Active()) << "Failed selection changed kernels.";
+
+    SIMDKernels::Select(SIMDKernels::Detect());
+    EXPECT_EQ(SIMDKernels::Detect(), SIMDKernels::Active());
+}
+
+TEST(SIMDKernelsDispatchTest, Name)
+{
+    EXPECT_EQ("scalar", SIMDKernels::Name(SIMDKernels::SCALAR));
+    EXPECT_EQ("avx2", SIMDKernels::Name(SIMDKernels::AVX2));
+    EXPECT_EQ("unknown", SIMDKernels::Name(SIMDKernels::NB_ISA));
+}
+
+} // annonymous namespace
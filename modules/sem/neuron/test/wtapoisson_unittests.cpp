@@ -127,10 +127,88 @@ TEST_F(WTAPoissonTest, LearnerStateDistr)
     EXPECT_MAT_EQ(Mat1i(1, 2, max_idx1), Mat1i(1, 2, max_idx2));
 }
 
+/**
+ * @brief Competing on potentials draws the same winners as competing on learners
+ */
+TEST_F(WTAPoissonTest, Compete_Potentials)
+{
+    const int N=100;
+    int nb_learners = static_cast<int>(learners_.size());
+
+    Mat1f u(1, nb_learners);
+    for(int i=0; i<nb_learners; i++) {
+
+        u(i) = learners_[i]->State().at<float>(0);
+    }
+
+    theRNG() = RNG(456);
+    WTAPoisson a(50.f, delta_t_msec_);
+    vector<Mat1f> expected;
+    for(int i=0; i<N; i++) {
+
+        Mat1f outcome = a.Compete(learners_);
+        expected.push_back(outcome);
+    }
+
+    theRNG() = RNG(456);
+    WTAPoisson b(50.f, delta_t_msec_);
+    Mat1f distr(1, nb_learners), spikes(1, nb_learners);
+    const uchar *spikes_data = spikes.data;
+    for(int i=0; i<N; i++) {
+
+        b.Compete(u, distr, spikes);
+        EXPECT_MAT_EQ(expected[i], spikes);
+        EXPECT_EQ(spikes_data, spikes.data) << "Reallocated preallocated spikes.";
+    }
+}
+
 TEST_F(WTAPoissonTest, NoLearners)
 {
     EXPECT_THROW(to_.LearnerStateDistr(vector<shared_ptr<base_Learner> >()), ExceptionBadDims);
 }
 
+/**
+ * @brief Skipping the refractory period lands on the next spike
+ */
+TEST_F(WTAPoissonTest, TicksToNextSpike)
+{
+    for(int i=0; i<20; i++) {
+
+        WTAPoisson to(50.f, delta_t_msec_);
+
+        int nb_ticks = to.TicksToNextSpike();
+        EXPECT_GE(nb_ticks, 0);
+
+        to.Skip(nb_ticks);
+        EXPECT_EQ(0, to.TicksToNextSpike());
+        EXPECT_EQ(1, countNonZero(to.Compete(learners_)));
+    }
+}
+
+/**
+ * @brief Skipping is equivalent to competing without a spike
+ */
+TEST_F(WTAPoissonTest, TicksToNextSpike_Compete)
+{
+    WTAPoisson to(50.f, delta_t_msec_);
+
+    int nb_ticks = to.TicksToNextSpike();
+    for(int t=0; t<nb_ticks; t++) {
+
+        EXPECT_EQ(0, countNonZero(to.Compete(learners_))) << "Spiking in refractory period";
+        EXPECT_EQ(nb_ticks-t-1, to.TicksToNextSpike());
+    }
+    EXPECT_EQ(1, countNonZero(to.Compete(learners_)));
+}
 
+TEST_F(WTAPoissonTest, TicksToNextSpike_NeverFire)
+{
+    WTAPoisson to(0.f, 1.f);
+    EXPECT_EQ(WTAPoisson::NEVER, to.TicksToNextSpike());
 
+    to.Skip(1000);
+    EXPECT_EQ(WTAPoisson::NEVER, to.TicksToNextSpike()) << "Expecting no spike, ever";
+
+    WTAPoisson no_resolution(1e5, 0.f);
+    EXPECT_EQ(WTAPoisson::NEVER, no_resolution.TicksToNextSpike());
+}
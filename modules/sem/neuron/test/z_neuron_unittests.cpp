@@ -1,11 +1,16 @@
 #include "sem/neuron/zneuron.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
+#include "elm/core/exception.h"
 #include "elm/ts/ts.h"
 #include "elm/ts/fakeevidence.h"
 
 using namespace cv;
+using namespace elm;
 
 namespace {
 
@@ -95,6 +100,32 @@ TEST_F(ZNeuronTest, PredictStateless)
     }
 }
 
+/**
+ * @brief Invalid evidence leaves the neuron's state alone
+ */
+TEST_F(ZNeuronTest, Predict_Invalid)
+{
+    ZNeuron a, b;
+    theRNG() = RNG(2010);
+    a.Init(nb_features_, 3);
+    theRNG() = RNG(2010);
+    b.Init(nb_features_, 3);
+
+    FakeEvidence f(nb_features_);
+    Mat evidence = f.next(0) > 0;
+    a.Predict(evidence);
+    b.Predict(evidence);
+
+    EXPECT_THROW(a.Predict(Mat1f::ones(1, nb_features_+1)), ExceptionBadDims);
+    EXPECT_MAT_EQ(a.State(), b.State());
+
+    // spiking history unchanged
+    a.Learn(Mat1i::ones(1, 1));
+    b.Learn(Mat1i::ones(1, 1));
+    EXPECT_MAT_EQ(a.Weights(), b.Weights());
+    EXPECT_MAT_EQ(a.Bias(), b.Bias());
+}
+
 TEST_F(ZNeuronTest, WeightsCopied)
 {
     Mat1f w = to_.Weights();
@@ -158,10 +189,348 @@ TEST_F(ZNeuronTest, Learn)
     }
 }
 
+TEST_F(ZNeuronTest, WeightChangeRate)
+{
+    EXPECT_FLOAT_EQ(0.f, to_.WeightChangeRate());
+    EXPECT_THROW(to_.ChangeSmoothing(0.f), ExceptionValueError);
+    EXPECT_THROW(to_.ChangeSmoothing(1.1f), ExceptionValueError);
+
+    to_.ChangeSmoothing(1.f); // only most recent update
+
+    Mat1f weights_prev = to_.Weights().clone();
+    float bias_prev = to_.Bias()(0);
+
+    to_.Predict( Mat1i::ones(1, nb_features_) > 0 );
+    to_.Learn( Mat1i::ones(1, 1) );
+
+    float change = static_cast<float>(norm(weights_prev, to_.Weights(), NORM_L1)) + std::abs(bias_prev-to_.Bias()(0));
+    EXPECT_NEAR(change/(nb_features_+1), to_.WeightChangeRate(), 1e-6f);
+
+    const float rate_fire = to_.WeightChangeRate();
+
+    to_.Predict( Mat1i::ones(1, nb_features_) > 0 );
+    to_.Learn( Mat1i::zeros(1, 1) );
+    EXPECT_GT(to_.WeightChangeRate(), 0.f) << "Bias still decaying";
+    EXPECT_LT(to_.WeightChangeRate(), rate_fire) << "Only bias changing";
+}
+
+/**
+ * @brief Compare a single STDP update with constant learning rate against its closed form
+ */
+TEST_F(ZNeuronTest, Learn_ConstantRate)
+{
+    const float ETA = ZNeuron::DEFAULT_LEARNING_RATE;
+
+    Mat1f eta = to_.LearningRates();
+    EXPECT_MAT_DIMS_EQ(eta, Size2i(nb_features_+1, 1));
+    for(int i=0; i<eta.cols; i++) {
+
+        EXPECT_FLOAT_EQ(ETA, eta(i));
+    }
+
+    FakeEvidence f(nb_features_);
+    Mat1f evidence = f.next(0);
+
+    const Mat1f weights_prev = to_.Weights().clone();
+    const float bias_prev = to_.Bias()(0);
+
+    to_.Predict( evidence > 0 );
+    to_.Learn( Mat1i::ones(1, 1) );
+
+    Mat1f weights = to_.Weights();
+    for(int i=0; i<nb_features_; i++) {
+
+        double w = weights_prev(i);
+        double d = ETA*std::exp(-std::max(w, std::log(static_cast<double>(ETA))));
+        double expected = w + ((evidence(i) > 0)? d*(1.-std::exp(w)) : -d*std::exp(w));
+        EXPECT_NEAR(std::max(expected, -5.), weights(i), 1e-5);
+    }
+
+    double b = bias_prev;
+    double d = ETA*std::exp(-std::max(b, std::log(static_cast<double>(ETA))));
+    EXPECT_NEAR(b + d*(1.-std::exp(b)), to_.Bias()(0), 1e-5);
+}
+
+TEST_F(ZNeuronTest, Learn_AdaptiveRate)
+{
+    to_.AdaptiveLearningRate(true);
+
+    Mat1f eta = to_.LearningRates();
+    for(int i=0; i<eta.cols; i++) {
+
+        EXPECT_FLOAT_EQ(ZNeuron::DEFAULT_LEARNING_RATE, eta(i)) << "Expecting adaptive rates to start at default.";
+    }
+
+    Mat1f weights_prev = to_.Weights().clone();
+    FakeEvidence f(nb_features_);
+
+    for(int i=0; i<50; i++) {
+
+        to_.Predict( f.next(0) > 0 );
+        to_.Learn( Mat1i::ones(1, 1) );
+
+        for(int j=0; j<weights_prev.cols; j+=2) {
+
+            EXPECT_GT(weights_prev(j+1), to_.Weights()(j+1)) << "Weight for non-spiking input potentiating.";
+            EXPECT_LT(weights_prev(j), to_.Weights()(j)) << "Weight for spiking input decaying.";
+        }
+        weights_prev = to_.Weights().clone();
+    }
+
+    eta = to_.LearningRates();
+    EXPECT_FALSE( Equal(Mat1f(eta.size(), ZNeuron::DEFAULT_LEARNING_RATE), eta) ) << "Learning rates not adapting.";
+    for(int i=0; i<eta.cols; i++) {
+
+        EXPECT_GE(eta(i), ZNeuron::MIN_LEARNING_RATE);
+        EXPECT_LE(eta(i), ZNeuron::MAX_LEARNING_RATE);
+    }
+
+    to_.AdaptiveLearningRate(false);
+    eta = to_.LearningRates();
+    for(int i=0; i<eta.cols; i++) {
+
+        EXPECT_FLOAT_EQ(ZNeuron::DEFAULT_LEARNING_RATE, eta(i));
+    }
+}
+
 /**
  * @brief Test clearing of state/history
  * TODO: Write a better test for this. May need exposing learning rates.
  */
+/**
+ * @brief Bulk bias updates match as many Learn() calls without a spike
+ */
+TEST_F(ZNeuronTest, LearnSilent)
+{
+    const int N=30;
+    ZNeuron::ExactSilentUpdates(true);
+    for(int adaptive=0; adaptive<2; adaptive++) {
+
+        theRNG() = RNG(123);
+        ZNeuron a;
+        a.AdaptiveLearningRate(adaptive > 0);
+        a.Init(nb_features_, 3);
+
+        theRNG() = RNG(123);
+        ZNeuron b;
+        b.AdaptiveLearningRate(adaptive > 0);
+        b.Init(nb_features_, 3);
+
+        for(int i=0; i<N; i++) {
+
+            a.Learn(Mat1i::zeros(1, 1));
+        }
+        b.LearnSilent(N);
+
+        EXPECT_MAT_EQ(a.Bias(), b.Bias());
+        EXPECT_MAT_EQ(a.Weights(), b.Weights());
+        EXPECT_MAT_EQ(a.LearningRates(), b.LearningRates());
+        EXPECT_FLOAT_EQ(a.WeightChangeRate(), b.WeightChangeRate());
+    }
+    ZNeuron::ExactSilentUpdates(false);
+}
+
+/**
+ * @brief Closed form of bulk bias updates is close to as many Learn() calls without a spike,
+ * from a bias decaying linearly, through the transition, into saturation
+ */
+TEST_F(ZNeuronTest, LearnSilent_ClosedForm)
+{
+    EXPECT_FALSE(ZNeuron::IsExactSilentUpdates());
+
+    const int N[] = {1, 10, 200, 2000};
+    for(size_t i=0; i<sizeof(N)/sizeof(int); i++) {
+
+        theRNG() = RNG(123);
+        ZNeuron a;
+        a.Init(nb_features_, 3);
+        a.Attach(Mat1f(1, nb_features_+1, -0.5f));
+
+        theRNG() = RNG(123);
+        ZNeuron b;
+        b.Init(nb_features_, 3);
+        b.Attach(Mat1f(1, nb_features_+1, -0.5f));
+
+        for(int t=0; t<N[i]; t++) {
+
+            a.Learn(Mat1i::zeros(1, 1));
+        }
+        b.LearnSilent(N[i]);
+
+        EXPECT_NEAR(a.Bias()(0), b.Bias()(0), 1e-3) << "after " << N[i] << " ticks";
+        EXPECT_MAT_EQ(a.Weights(), b.Weights());
+        EXPECT_NEAR(a.WeightChangeRate(), b.WeightChangeRate(), 1e-5) << "after " << N[i] << " ticks";
+    }
+}
+
+/**
+ * @brief Bulk bias updates over a very long silence saturate the bias
+ */
+TEST_F(ZNeuronTest, LearnSilent_Long)
+{
+    ZNeuron to;
+    to.Init(nb_features_, 3);
+
+    to.LearnSilent(std::numeric_limits<int>::max()/2);
+
+    EXPECT_FLOAT_EQ(-ZNeuron::WEIGHT_LIMIT, to.Bias()(0));
+    EXPECT_LT(to.WeightChangeRate(), ZNeuron::DEFAULT_LEARNING_RATE);
+}
+
+/**
+ * @brief Observing input updates spiking history like Predict()
+ */
+TEST_F(ZNeuronTest, Observe)
+{
+    theRNG() = RNG(123);
+    ZNeuron a;
+    a.Init(nb_features_, 3);
+
+    theRNG() = RNG(123);
+    ZNeuron b;
+    b.Init(nb_features_, 3);
+
+    FakeEvidence fake_evidence(nb_features_);
+    Mat evidence = fake_evidence.next(0) > 0;
+    a.Predict(evidence);
+    b.Observe(evidence);
+
+    a.Learn(Mat1i::ones(1, 1));
+    b.Learn(Mat1i::ones(1, 1));
+
+    EXPECT_MAT_EQ(a.Weights(), b.Weights());
+    EXPECT_MAT_EQ(a.Bias(), b.Bias());
+}
+
+/**
+ * @brief Observing a precomputed spike mask is equivalent to observing input
+ */
+TEST_F(ZNeuronTest, ObserveSpiking)
+{
+    theRNG() = RNG(123);
+    ZNeuron a;
+    a.Init(nb_features_, 3);
+
+    theRNG() = RNG(123);
+    ZNeuron b;
+    b.Init(nb_features_, 3);
+
+    FakeEvidence fake_evidence(nb_features_);
+    Mat1f evidence;
+    Mat(fake_evidence.next(0) > 0).convertTo(evidence, CV_32F);
+    a.Observe(evidence, -1.f);
+    b.ObserveSpiking(evidence != 0.f, -1.f);
+
+    EXPECT_FLOAT_EQ(a.State().at<float>(0), b.State().at<float>(0));
+
+    a.Learn(Mat1i::ones(1, 1));
+    b.Learn(Mat1i::ones(1, 1));
+
+    EXPECT_MAT_EQ(a.Weights(), b.Weights());
+    EXPECT_MAT_EQ(a.Bias(), b.Bias());
+}
+
+/**
+ * @brief Learning from a history kept elsewhere is equivalent to learning from the neuron's own
+ */
+TEST_F(ZNeuronTest, Learn_ExternalHistory)
+{
+    theRNG() = RNG(123);
+    ZNeuron a;
+    a.Init(nb_features_, 3);
+
+    theRNG() = RNG(123);
+    ZNeuron b;
+    b.Init(nb_features_, 3);
+
+    FakeEvidence fake_evidence(nb_features_);
+    Mat evidence = fake_evidence.next(0) > 0;
+    a.Observe(evidence);
+
+    Mat1b has_spiked_recently(1, nb_features_+1);
+    has_spiked_recently(0) = 1;
+    evidence.copyTo(has_spiked_recently.colRange(1, nb_features_+1));
+
+    a.Learn(Mat1i::ones(1, 1));
+    b.Learn(Mat1i::ones(1, 1), has_spiked_recently);
+
+    EXPECT_MAT_EQ(a.Weights(), b.Weights());
+    EXPECT_MAT_EQ(a.Bias(), b.Bias());
+
+    a.Learn(Mat1i::zeros(1, 1));
+    b.Learn(Mat1i::zeros(1, 1), has_spiked_recently);
+
+    EXPECT_MAT_EQ(a.Weights(), b.Weights());
+    EXPECT_MAT_EQ(a.Bias(), b.Bias());
+
+    EXPECT_THROW(b.Learn(Mat1i::ones(1, 1), Mat1b::ones(1, nb_features_)), ExceptionBadDims);
+}
+
+/**
+ * @brief Attached neurons keep their weights and learn in external storage
+ */
+TEST_F(ZNeuronTest, Attach)
+{
+    Mat1f storage = Mat1f::zeros(3, nb_features_+1);
+    Mat1f weights_all = to_.WeightsAll().clone();
+
+    to_.Attach(storage.row(1));
+    EXPECT_MAT_EQ(weights_all, storage.row(1));
+    EXPECT_EQ(storage.row(1).data, to_.WeightsAll().data);
+    EXPECT_EQ(0, countNonZero(storage.row(0)));
+    EXPECT_EQ(0, countNonZero(storage.row(2)));
+
+    to_.Predict(Mat1f::ones(1, nb_features_));
+    to_.Learn(Mat1i::ones(1, 1));
+    EXPECT_MAT_EQ(to_.WeightsAll(), storage.row(1));
+    EXPECT_GT(countNonZero(storage.row(1) != weights_all), 0) << "Expecting learning in place.";
+
+    EXPECT_THROW(to_.Attach(Mat1f(1, nb_features_)), ExceptionBadDims);
+    EXPECT_THROW(to_.Attach(storage.col(0)), ExceptionBadDims);
+}
+
+TEST_F(ZNeuronTest, Seed)
+{
+    const float bias = to_.Bias()(0);
+
+    Mat1f evidence = Mat1f::zeros(1, nb_features_);
+    for(int i=0; i<nb_features_; i+=3) {
+
+        evidence(i) = 1.f;
+    }
+    to_.Seed(evidence);
+
+    Mat1f w = to_.Weights();
+    for(int i=0; i<nb_features_; i++) {
+
+        EXPECT_FLOAT_EQ(std::log(evidence(i) > 0.f? 1.f-ZNeuron::SEED_NOISE : ZNeuron::SEED_NOISE), w(i));
+    }
+    EXPECT_FLOAT_EQ(bias, to_.Bias()(0)) << "Seed changed bias";
+    EXPECT_FLOAT_EQ(0.f, to_.WeightChangeRate());
+
+    // seeded neuron prefers its pattern
+    float u_seed = to_.Predict(evidence).at<float>(0);
+    float u_other = to_.Predict(1.f-evidence).at<float>(0);
+    EXPECT_GT(u_seed, u_other);
+
+    EXPECT_THROW(to_.Seed(Mat1f::zeros(1, nb_features_+1)), ExceptionBadDims);
+}
+
+TEST_F(ZNeuronTest, LenHistory)
+{
+    const Mat1f w = to_.Weights().clone();
+    const Mat1f b = to_.Bias().clone();
+
+    to_.LenHistory(10);
+
+    EXPECT_MAT_EQ(w, to_.Weights());
+    EXPECT_MAT_EQ(b, to_.Bias());
+
+    to_.Predict(Mat1f::ones(1, nb_features_));
+    EXPECT_NO_THROW(to_.Learn(Mat1i::ones(1, 1)));
+    EXPECT_FALSE(Equal(w, to_.Weights()));
+}
+
 TEST_F(ZNeuronTest, Clear)
 {
     EXPECT_NO_THROW(to_.Clear());
@@ -1,22 +1,54 @@
 #include "sem/neuron/wtapoisson.h"
 
+#include <cmath>
+#include <limits>
+
 #include "elm/core/exception.h"
 #include "elm/core/sampler.h"
+#include "sem/neuron/simdkernels.h"
 
 using namespace std;
 using namespace cv;
 using namespace elm;
 
+const int WTAPoisson::NEVER = numeric_limits<int>::max();
+
 WTAPoisson::WTAPoisson(float max_frequency, float delta_t_msec)
     : base_WTA(delta_t_msec),
-      lambda_(max_frequency)
+      lambda_(max_frequency),
+      ticks_to_spike_(NEVER)
 {
     NextSpikeTime();
 }
 
 void WTAPoisson::NextSpikeTime()
 {
-    next_spike_time_sec_ = elm::randexp(lambda_);
+    const double t = static_cast<double>(elm::randexp(lambda_));
+    const double dt = static_cast<double>(delta_t_sec_);
+
+    // spike on the first tick with less than a tick's time left: after floor(t/dt) ticks
+    double n = floor(t/dt); // inf or nan for zero frequency or time resolution
+    if(n < static_cast<double>(NEVER)) {
+
+        // single correction for rounding of the division at tick boundaries
+        if(n > 0. && n*dt > t) {
+
+            n -= 1.;
+        }
+        else if((n+1.)*dt <= t) {
+
+            n += 1.;
+        }
+    }
+    ticks_to_spike_ = (n >= 0. && n < static_cast<double>(NEVER))? static_cast<int>(n) : NEVER;
+}
+
+void WTAPoisson::Tick()
+{
+    if(ticks_to_spike_ != NEVER) {
+
+        ticks_to_spike_--;
+    }
 }
 
 Mat WTAPoisson::Compete(vector<shared_ptr<base_Learner> > &learners)
@@ -25,26 +57,57 @@ Mat WTAPoisson::Compete(vector<shared_ptr<base_Learner> > &learners)
     Mat1i winners = Mat1i::zeros(1, static_cast<int>(learners.size()));
 
     // time to spike or still in refractory period
-    if(next_spike_time_sec_ < delta_t_sec_) { // time to spike
+    if(ticks_to_spike_ == 0) { // time to spike
 
         // Distribution of learner states
         Mat1f soft_max = LearnerStateDistr(learners);
 
-        Sampler1D sampler;
-        sampler.pdf(soft_max);
-
-        winners(sampler.Sample()) = 1;
+        winners(SampleWinner(soft_max.ptr<float>(0), soft_max.cols)) = 1;
 
         NextSpikeTime();
     }
     else { // refractory period
 
-        next_spike_time_sec_ -= delta_t_sec_;
+        Tick();
     }
 
     return winners > 0;
 }
 
+void WTAPoisson::Compete(const Mat1f &u, Mat1f &distr, Mat1f &spikes)
+{
+    const int nb_learners = static_cast<int>(u.total());
+    if(spikes.rows != 1 || spikes.cols != nb_learners) {
+
+        spikes = Mat1f(1, nb_learners);
+    }
+    spikes.setTo(0.f);
+
+    if(ticks_to_spike_ == 0) { // time to spike
+
+        if(nb_learners < 1) {
+
+            ELM_THROW_BAD_DIMS("Learner vector is empty.");
+        }
+
+        if(distr.rows != 1 || distr.cols != nb_learners) {
+
+            distr = Mat1f(1, nb_learners);
+        }
+
+        Mat1f x = u.isContinuous()? u : u.clone();
+        SIMDKernels::SoftMax(x.ptr<float>(0), distr.ptr<float>(0), nb_learners);
+
+        spikes(SampleWinner(distr.ptr<float>(0), nb_learners)) = 255.f;
+
+        NextSpikeTime();
+    }
+    else { // refractory period
+
+        Tick();
+    }
+}
+
 Mat WTAPoisson::LearnerStateDistr(const vector<shared_ptr<base_Learner> > &learners) const
 {
     int nb_learners = static_cast<int>(learners.size());
@@ -60,16 +123,37 @@ Mat WTAPoisson::LearnerStateDistr(const vector<shared_ptr<base_Learner> > &learn
         u(i) = learners[i]->State().at<float>(0);
     }
 
-    // normalize learner state distribution
-    Mat mean, s;
-    meanStdDev(u, mean, s);
+    // normalize learner state distribution, in place
+    SIMDKernels::SoftMax(u.ptr<float>(0), u.ptr<float>(0), nb_learners);
 
-    u -= static_cast<float>(mean.at<double>(0));
-    Mat1f soft_max;
-    exp(u, soft_max);
-    soft_max /= sum(soft_max)(0);
+    return u;
+}
 
-    return soft_max;
+int WTAPoisson::SampleWinner(const float *distr, int n)
+{
+    const float r = static_cast<float>(theRNG()); // uniform in [0, 1)
+
+    float cdf = 0.f;
+    for(int i=0; i<n-1; i++) {
+
+        cdf += distr[i];
+        if(r < cdf) {
+
+            return i;
+        }
+    }
+    return n-1; // rest of the mass, including rounding
+}
+
+int WTAPoisson::TicksToNextSpike() const
+{
+    return ticks_to_spike_;
 }
 
+void WTAPoisson::Skip(int nb_ticks)
+{
+    if(ticks_to_spike_ != NEVER) {
 
+        ticks_to_spike_ -= min(max(nb_ticks, 0), ticks_to_spike_);
+    }
+}
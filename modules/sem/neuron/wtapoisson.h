@@ -19,6 +19,15 @@ public:
 
     virtual cv::Mat Compete(std::vector<std::shared_ptr<base_Learner> > &learners);
 
+    /**
+     * @brief Compete on membrane potentials computed elsewhere, without allocating
+     * Same outcome as Compete() on learners in these states, the state distribution is only computed when spiking.
+     * @param membrane potential per learner
+     * @param scratch buffer for the state distribution, allocated unless matching
+     * @param[out] spikes, 255 for the winner as in Compete()'s mask, 0 otherwise, allocated unless matching
+     */
+    void Compete(const cv::Mat1f &u, cv::Mat1f &distr, cv::Mat1f &spikes);
+
     /**
      * @brief Compute distribution for learner states
      * @param learners
@@ -27,15 +36,47 @@ public:
      */
     cv::Mat LearnerStateDistr(const std::vector<std::shared_ptr<base_Learner> > &learners) const;
 
+    /**
+     * @brief get no. of ticks left in the refractory period
+     *
+     * Compete() is guaranteed not to spike for this many calls, then spikes on the next.
+     * The refractory period is converted into whole ticks once per spike time drawn,
+     * such that skipping and ticking stay in lockstep.
+     *
+     * @return no. of ticks until next spike, 0 when spiking on next Compete() call, NEVER if not spiking at all
+     */
+    int TicksToNextSpike() const;
+
+    /**
+     * @brief Advance time through the refractory period without competing
+     * Equivalent to as many calls to Compete() without a spike
+     * @param no. of ticks to skip, at most TicksToNextSpike()
+     */
+    void Skip(int nb_ticks);
+
+    static const int NEVER;             ///< = std::numeric_limits<int>::max(), no. of ticks to a spike that never comes
+
 protected:
     /**
-     * @brief Compute next spike time for inhibiting neuron
-     * @return next spike time in milliseconds
+     * @brief Draw next spike time for inhibiting neuron, in whole ticks
      */
     void NextSpikeTime();
 
+    /**
+     * @brief Advance by a single tick without a spike
+     */
+    void Tick();
+
+    /**
+     * @brief Draw winner from state distribution, by inverse transform sampling
+     * @param state distribution
+     * @param no. of learners
+     * @return index of winner
+     */
+    static int SampleWinner(const float *distr, int n);
+
     float lambda_;  ///< Lambda variable for Poisson Rate
-    float next_spike_time_sec_; ///< timestamp for next spike event in seconds
+    int ticks_to_spike_;    ///< no. of ticks left in the refractory period, NEVER if not spiking at all
 };
 
 #endif // SEM_NEURON_WTAPOISSON_H_
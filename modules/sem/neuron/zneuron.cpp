@@ -1,16 +1,33 @@
 #include "sem/neuron/zneuron.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "elm/core/exception.h"
+#include "sem/neuron/simdkernels.h"
 
 using namespace cv;
 
+const float ZNeuron::DEFAULT_CHANGE_SMOOTHING = 0.001f;
+const float ZNeuron::DEFAULT_LEARNING_RATE = 0.01f;
+const float ZNeuron::MIN_LEARNING_RATE = 1e-4f;
+const float ZNeuron::MAX_LEARNING_RATE = 0.5f;
+const float ZNeuron::SEED_NOISE = 0.1f;
+const float ZNeuron::WEIGHT_LIMIT = 5.f;
+
+bool ZNeuron::is_exact_silent_ = false;
+
 ZNeuron::ZNeuron()
     : base_Learner(),
       weights_all_(1, 1, 0.f),
       bias_(weights_all_.clone()),
       history_all_(1, 1),
       history_afferents_(1, 1),
-      history_self_(1, 1)
+      history_self_(1, 1),
+      is_adaptive_rate_(false),
+      change_smoothing_(DEFAULT_CHANGE_SMOOTHING),
+      drift_sum_abs_(0.),
+      nb_pending_(0)
 {
 }
 
@@ -25,57 +42,319 @@ void ZNeuron::Init(int nb_features, int len_history)
     weights_ = weights_all_.colRange(1, nb_features+1); // used for easier referencing of weights excluding bias term
     bias_    = weights_all_.col(0);
 
+    LenHistory(len_history);
+
+    if(is_adaptive_rate_) {
+
+        InitLearningRates();
+    }
+
+    drift_ = Mat1f::zeros(1, nb_features+1);
+    drift_sum_abs_ = 0.;
+    nb_pending_ = 0;
+}
+
+void ZNeuron::LenHistory(int len_history)
+{
+    const int nb_features = weights_.cols;
     history_all_ = SpikingHistory(nb_features+1, len_history);  // add 1 for self spiking
     history_afferents_ = history_all_.ColRange(1, nb_features+1);
     history_self_ = history_all_.ColRange(0, 1);
 }
 
+void ZNeuron::Seed(const Mat &evidence)
+{
+    if(evidence.total() != static_cast<size_t>(weights_.cols)) {
+
+        ELM_THROW_BAD_DIMS("Seed must have one element per afferent");
+    }
+
+    weights_.setTo(std::log(SEED_NOISE));
+    weights_.setTo(std::log(1.f-SEED_NOISE), evidence.reshape(1, 1) != 0);
+
+    if(is_adaptive_rate_) {
+
+        InitLearningRates();
+    }
+
+    drift_ = 0.f;
+    drift_sum_abs_ = 0.;
+    nb_pending_ = 0;
+}
+
+void ZNeuron::InitLearningRates()
+{
+    // start at the default rate: S - Q^2 = eta (exp(-Q)+1)
+    learning_rates_ = Mat1f(1, NB_RATE_STATES*static_cast<int>(weights_all_.total()));
+    const float *w = weights_all_.ptr<float>(0);
+    float *r = learning_rates_.ptr<float>(0);
+    for(int i=0; i<static_cast<int>(weights_all_.total()); i++, r+=NB_RATE_STATES) {
+
+        r[0] = DEFAULT_LEARNING_RATE;
+        r[1] = w[i];
+        r[2] = w[i]*w[i]+DEFAULT_LEARNING_RATE*(std::exp(-w[i])+1.f);
+    }
+}
+
 void ZNeuron::Learn(const Mat &target)
 {
     if(countNonZero(target) > 0) { // this neuron has fired recently
 
         history_self_.Update(Mat1b::ones(1, 1));
-        Update(weights_all_, history_all_.Recent());
+        Update(static_cast<int>(weights_all_.total()), history_all_.Recent());
     }
     else {
 
         history_self_.Reset();
-        Update(bias_, history_self_.Recent());
+        Update(1, history_self_.Recent()); // bias only
+    }
+}
+
+void ZNeuron::Learn(const Mat &target, const Mat &has_spiked_recently)
+{
+    if(has_spiked_recently.total() != weights_all_.total()) {
+
+        ELM_THROW_BAD_DIMS("Expecting one element of spiking history per weight, including bias");
+    }
+
+    if(countNonZero(target) > 0) {
+
+        Update(static_cast<int>(weights_all_.total()), has_spiked_recently);
+    }
+    else {
+
+        const Mat1b has_spiked_self = Mat1b::zeros(1, 1);
+        Update(1, has_spiked_self); // bias only
+    }
+}
+
+void ZNeuron::LearnSilent(int nb_ticks)
+{
+    if(nb_ticks < 1) {
+
+        return;
+    }
+
+    history_self_.Reset();
+
+    // bias only, the same arithmetic as Update() for a bias that did not spike
+    float &w = weights_all_(0);
+    float &drift = drift_(0);
+    float *rates = is_adaptive_rate_? learning_rates_.ptr<float>(0) : 0;
+    const float keep = 1.f-change_smoothing_;
+    const bool is_closed_form = !is_adaptive_rate_ && !is_exact_silent_;
+
+    int t = 0;
+    if(is_closed_form) {
+
+        // above log(eta), the limit factor turns every step into a constant decrement by eta
+        const float eta = DEFAULT_LEARNING_RATE;
+        const float log_eta = std::log(eta);
+        if(w > log_eta) {
+
+            const double nb_linear = std::ceil((static_cast<double>(w)-log_eta)/eta);
+            const int k = static_cast<int>(std::min(nb_linear, static_cast<double>(nb_ticks)));
+            const float keep_k = std::pow(keep, k);
+            w = std::max(w-static_cast<float>(k)*eta, -WEIGHT_LIMIT);
+            drift = keep_k*drift - eta*(1.f-keep_k); // geometric sum of change_smoothing_*(-eta)
+            t = k;
+        }
+    }
+
+    for(; t<nb_ticks; t++) {
+
+        if(is_closed_form && w <= -WEIGHT_LIMIT) {
+
+            // saturated, only the drift decays for the remaining ticks
+            drift *= std::pow(keep, nb_ticks-t);
+            break;
+        }
+
+        const float eta = is_adaptive_rate_? rates[0] : DEFAULT_LEARNING_RATE;
+        const float w_old = w;
+        const float exp_w = std::exp(w_old);
+        const float delta = (exp_w > eta)? eta/exp_w : 1.f;
+
+        w = std::max(w_old - delta*exp_w, -WEIGHT_LIMIT);
+
+        if(is_adaptive_rate_) {
+
+            TrackLearningRate(rates, w);
+        }
+
+        drift = keep*drift + change_smoothing_*(w-w_old);
+    }
+
+    nb_pending_ += nb_ticks; // defer decaying drift of the remaining weights
+}
+
+void ZNeuron::ExactSilentUpdates(bool enable)
+{
+    is_exact_silent_ = enable;
+}
+
+bool ZNeuron::IsExactSilentUpdates()
+{
+    return is_exact_silent_;
+}
+
+void ZNeuron::LearnPooled(const Mat1f &nb_spiked_recently)
+{
+    if(nb_spiked_recently.total() != weights_all_.total()) {
+
+        ELM_THROW_BAD_DIMS("Expecting one count of recent spiking per weight, including bias");
+    }
+
+    const float nb_spiked = nb_spiked_recently(0);
+    if(nb_spiked <= 1.f) {
+
+        // no more than one winning stream is the plain update
+        Learn(Mat1f(1, 1, nb_spiked), nb_spiked_recently != 0);
+    }
+    else {
+
+        UpdatePooled(nb_spiked_recently.isContinuous()? nb_spiked_recently : nb_spiked_recently.clone());
+    }
+}
+
+void ZNeuron::UpdatePooled(const Mat1f &nb_spiked_recently)
+{
+    const float *counts = nb_spiked_recently.ptr<float>(0);
+    const float nb_spiked = counts[0];
+
+    float *w = weights_all_.ptr<float>(0);
+    float *rates = is_adaptive_rate_? learning_rates_.ptr<float>(0) : 0;
+    float *drift = drift_.ptr<float>(0);
+
+    const float keep = 1.f-change_smoothing_;
+    const float keep_weights = std::pow(keep, nb_pending_+1);
+
+    double drift_sum_abs = 0.;
+    for(int i=0; i<static_cast<int>(weights_all_.total()); i++) {
+
+        const float eta = is_adaptive_rate_? rates[NB_RATE_STATES*i] : DEFAULT_LEARNING_RATE;
+        const float w_old = w[i];
+        const float exp_w = std::exp(w_old);
+        const float delta = (exp_w > eta)? eta/exp_w : 1.f;
+
+        // bias takes a single step towards having spiked,
+        // other weights the mean of their steps in all winning streams, no larger than a single stream's step
+        float w_new = (i == 0)? w_old + delta*(1.f-exp_w) : w_old + delta*(counts[i]/nb_spiked-exp_w);
+        w_new = std::max(w_new, -WEIGHT_LIMIT);
+        w[i] = w_new;
+
+        if(is_adaptive_rate_) {
+
+            TrackLearningRate(rates+NB_RATE_STATES*i, w_new);
+        }
+
+        if(i > 0) {
+
+            drift[i] = keep_weights*drift[i] + change_smoothing_*(w_new-w_old);
+            drift_sum_abs += std::abs(drift[i]);
+        }
+        else {
+
+            drift[i] = keep*drift[i] + change_smoothing_*(w_new-w_old);
+        }
     }
+
+    drift_sum_abs_ = drift_sum_abs;
+    nb_pending_ = 0;
 }
 
-void ZNeuron::Update(Mat &weights, const Mat &has_spiked_recently) const
+void ZNeuron::TrackLearningRate(float *rate_state, float w_new)
 {
-    const double WEIGHT_LIMIT = 5.0;
+    // track mean Q and second moment S of the weight, eta = (S-Q^2)/(exp(-Q)+1)
+    const float eta = rate_state[0];
+    float &q = rate_state[1];
+    float &s = rate_state[2];
+    q += eta*(w_new-q);
+    s += eta*(w_new*w_new-s);
+    rate_state[0] = std::min(std::max((s-q*q)/(std::exp(-q)+1.f), MIN_LEARNING_RATE), MAX_LEARNING_RATE);
+}
 
-    Mat1f weights_old = weights;      // this does not perform a deep copy
-    Mat1f _eta(weights.size(), 0.01f); // TODO: adaptive learing rate per weight
-    Mat1f _eta_log;
-    log(_eta, _eta_log);
-    Mat1f _limit_factor;
-    exp(-max(weights_old, _eta_log), _limit_factor);
+void ZNeuron::Update(int nb_weights, const Mat &has_spiked_recently)
+{
+    Mat1b spiked = has_spiked_recently; // no copy for 8-bit masks
+    if(!spiked.isContinuous()) {
+
+        spiked = spiked.clone();
+    }
+    const uchar *is_spiked = spiked.ptr<uchar>(0);
 
-    Mat1f _delta_w = _limit_factor.mul(_eta);
+    float *w = weights_all_.ptr<float>(0);
+    float *rates = is_adaptive_rate_? learning_rates_.ptr<float>(0) : 0;
+    float *drift = drift_.ptr<float>(0);
 
-    Mat1f _exp_w_old;
-    exp(weights_old, _exp_w_old);
+    // drift of weights other than the bias catches up on decay skipped while not firing
+    const float keep = 1.f-change_smoothing_;
+    const float keep_weights = std::pow(keep, nb_pending_+1);
 
-    // compute weight deltas according to afferent spiking
-    Mat1f _delta_w_cond = _delta_w.mul(_exp_w_old, -1.);
-    add(_delta_w_cond, _delta_w, _delta_w_cond, has_spiked_recently); // mask operation by recenlty spiking afferents
+    // the bias, and all weights under adaptive rates, are updated one at a time
+    const int nb_scalar = is_adaptive_rate_? nb_weights : std::min(nb_weights, 1);
 
-    // bh.w(2:(bh.dim+1),i) = old_w + delta .* C(i) .* limit_factor;
-    // bh.w(2:(bh.dim+1),i) = max(bh.w(2:(bh.dim+1),i), -bh.limit);
+    double drift_sum_abs = 0.;
+    for(int i=0; i<nb_scalar; i++) {
 
-    weights = weights_old + _delta_w_cond;
-    weights.setTo(-WEIGHT_LIMIT, weights < -WEIGHT_LIMIT);
+        const float eta = is_adaptive_rate_? rates[NB_RATE_STATES*i] : DEFAULT_LEARNING_RATE;
+        const float w_old = w[i];
+        const float exp_w = std::exp(w_old);
 
-    //m_arrLearningRate[wi].update(w);         // TODO: adaptive learning rate
+        // limit factor exp(-max(w, log(eta))) scales down updates of large weights
+        const float delta = (exp_w > eta)? eta/exp_w : 1.f;
+
+        // bh.w(2:(bh.dim+1),i) = old_w + delta .* C(i) .* limit_factor;
+        // bh.w(2:(bh.dim+1),i) = max(bh.w(2:(bh.dim+1),i), -bh.limit);
+        float w_new = w_old + (is_spiked[i]? delta*(1.f-exp_w) : -delta*exp_w);
+        w_new = std::max(w_new, -WEIGHT_LIMIT);
+        w[i] = w_new;
+
+        if(is_adaptive_rate_) {
+
+            TrackLearningRate(rates+NB_RATE_STATES*i, w_new);
+        }
+
+        // measure change after clamping, saturated weights do not count as moving
+        if(i > 0) {
+
+            drift[i] = keep_weights*drift[i] + change_smoothing_*(w_new-w_old);
+            drift_sum_abs += std::abs(drift[i]);
+        }
+        else {
+
+            drift[i] = keep*drift[i] + change_smoothing_*(w_new-w_old);
+        }
+    }
+
+    if(nb_scalar < nb_weights) {
+
+        // remaining weights under a constant rate, vectorized
+        drift_sum_abs += SIMDKernels::STDP(w+1, drift+1, is_spiked+1, nb_weights-1,
+                                           DEFAULT_LEARNING_RATE, -WEIGHT_LIMIT,
+                                           keep_weights, change_smoothing_);
+    }
+
+    if(nb_weights > 1) {
+
+        drift_sum_abs_ = drift_sum_abs;
+        nb_pending_ = 0;
+    }
+    else {
+
+        nb_pending_++; // defer decaying drift of the remaining weights
+    }
 }
 
 
 Mat ZNeuron::Predict(const Mat &evidence)
 {
+    // validate before touching any state
+    if(evidence.total() != static_cast<size_t>(weights_.cols)) {
+
+        ELM_THROW_BAD_DIMS("Evidence must have one element per afferent");
+    }
+
     u_ = weights_all_(0);  // membrane potential u
 
     history_afferents_.Advance();
@@ -84,14 +363,42 @@ Mat ZNeuron::Predict(const Mat &evidence)
     // u = bh.w' * [x];
 
     // Sum subset of weights with spiking evidence
-    Mat1f sub_weights = Mat1f::zeros(1, static_cast<int>(evidence.total()));
-    add(sub_weights, weights_, sub_weights, evidence > 0);
 
-    u_ += sum(sub_weights)(0);
+    Mat1f x;
+    if(evidence.type() == CV_32FC1 && evidence.isContinuous()) {
+
+        x = evidence; // no copy
+    }
+    else {
+
+        evidence.convertTo(x, CV_32F);
+        x = x.isContinuous()? x : x.clone();
+    }
+
+    u_ += SIMDKernels::MaskedSum(weights_.ptr<float>(0), x.ptr<float>(0), weights_.cols);
 
     return State();
 }
 
+void ZNeuron::Observe(const Mat &evidence)
+{
+    history_afferents_.Advance();
+    history_afferents_.Update(evidence != 0);
+}
+
+void ZNeuron::Observe(const Mat &evidence, float u)
+{
+    Observe(evidence);
+    u_ = u;
+}
+
+void ZNeuron::ObserveSpiking(const Mat &is_spiking, float u)
+{
+    history_afferents_.Advance();
+    history_afferents_.Update(is_spiking);
+    u_ = u;
+}
+
 Mat ZNeuron::State() const
 {
     return Mat(1, 1, CV_32FC1, u_);
@@ -107,8 +414,73 @@ Mat1f ZNeuron::Bias() const
     return bias_.clone();
 }
 
+const Mat1f& ZNeuron::WeightsAll() const
+{
+    return weights_all_;
+}
+
+void ZNeuron::Attach(const Mat1f &weights_all)
+{
+    if(weights_all.total() != weights_all_.total() || !weights_all.isContinuous()) {
+
+        ELM_THROW_BAD_DIMS("Storage must be continuous with one element per weight including bias");
+    }
+
+    Mat1f storage = weights_all.reshape(1, 1);
+    if(storage.data != weights_all_.data) {
+
+        weights_all_.copyTo(storage); // in place, sizes match
+    }
+
+    weights_all_ = storage;
+    weights_ = weights_all_.colRange(1, static_cast<int>(weights_all_.total()));
+    bias_    = weights_all_.col(0);
+}
+
 void ZNeuron::Clear()
 {
     history_all_.Reset();
 }
 
+void ZNeuron::ChangeSmoothing(float alpha)
+{
+    if(alpha <= 0.f || alpha > 1.f) {
+
+        ELM_THROW_VALUE_ERROR("Smoothing factor must be in (0, 1]");
+    }
+    change_smoothing_ = alpha;
+}
+
+void ZNeuron::AdaptiveLearningRate(bool enable)
+{
+    if(enable && !is_adaptive_rate_) {
+
+        InitLearningRates();
+    }
+    is_adaptive_rate_ = enable;
+}
+
+Mat1f ZNeuron::LearningRates() const
+{
+    Mat1f eta(1, static_cast<int>(weights_all_.total()));
+    if(!is_adaptive_rate_) {
+
+        eta = DEFAULT_LEARNING_RATE;
+        return eta;
+    }
+
+    const float *r = learning_rates_.ptr<float>(0);
+    for(int i=0; i<eta.cols; i++, r+=NB_RATE_STATES) {
+
+        eta(i) = r[0];
+    }
+    return eta;
+}
+
+float ZNeuron::WeightChangeRate() const
+{
+    double sum_abs = drift_sum_abs_*std::pow(1.f-change_smoothing_, nb_pending_);
+    sum_abs += std::abs(drift_(0));
+    return static_cast<float>(sum_abs/static_cast<double>(weights_all_.total()));
+}
+
@@ -10,6 +10,13 @@
 class ZNeuron : public base_Learner
 {
 public:
+    static const float DEFAULT_CHANGE_SMOOTHING;   ///< = 0.001f, smoothing factor of weight change rate per Learn() call
+    static const float DEFAULT_LEARNING_RATE;      ///< = 0.01f, constant learning rate and initial adaptive learning rate
+    static const float MIN_LEARNING_RATE;          ///< = 1e-4f, lower bound on adaptive learning rate
+    static const float MAX_LEARNING_RATE;          ///< = 0.5f, upper bound on adaptive learning rate
+    static const float SEED_NOISE;                 ///< = 0.1f, firing probability of afferents silent in a seed, see Seed()
+    static const float WEIGHT_LIMIT;               ///< = 5.f, weights are kept within [-WEIGHT_LIMIT, 0]
+
     ZNeuron();
 
     /**
@@ -23,8 +30,51 @@ public:
      */
     void Init(int nb_features, int len_history);
 
+    /**
+     * @brief Change length of spiking history
+     * Clears the history, keeps weights
+     * @param spiking input history length
+     */
+    void LenHistory(int len_history);
+
+    /**
+     * @brief Initialize weights around an input pattern
+     *
+     * Weights become log probabilities of afferents firing,
+     * 1-SEED_NOISE for afferents spiking in the pattern, SEED_NOISE otherwise.
+     * Keeps the bias.
+     *
+     * @param afferent spikes, non-zero for spiking afferent
+     */
+    void Seed(const cv::Mat &evidence);
+
     void Learn(const cv::Mat &target);
 
+    /**
+     * @brief Learn from a spiking history kept elsewhere, e.g. per input stream
+     * Same update as Learn(target), leaves the neuron's own spiking history untouched
+     * @param target, non-zero if this neuron spiked
+     * @param 8-bit mask of recent spiking, one element per weight including the bias term first,
+     * the bias element stands for this neuron's own spike
+     * @throws ExceptionBadDims on size mismatch
+     */
+    void Learn(const cv::Mat &target, const cv::Mat &has_spiked_recently);
+
+    /**
+     * @brief Learn from several streams at once, e.g. positions sharing this neuron's weights
+     *
+     * Steps of all streams in which this neuron spiked are taken from the current weights and averaged,
+     * such that the outcome depends neither on the order nor on the no. of streams
+     * and weights stay within the range of a single stream's update.
+     * The bias takes a single step, towards having spiked if the neuron spiked in any stream.
+     * Same update as Learn(target, has_spiked_recently) for a single stream.
+     *
+     * @param counts per weight including the bias term first, no. of streams in which this neuron and the afferent spiked recently,
+     * the bias element is the no. of streams in which this neuron spiked
+     * @throws ExceptionBadDims on size mismatch
+     */
+    void LearnPooled(const cv::Mat1f &nb_spiked_recently);
+
     /**
      * @brief Predict
      * @param evidence
@@ -32,6 +82,56 @@ public:
      */
     cv::Mat Predict(const cv::Mat &evidence);
 
+    /**
+     * @brief Record afferent spikes in history without computing the membrane potential
+     * Same effect on the spiking history as Predict()
+     * @param evidence
+     */
+    void Observe(const cv::Mat &evidence);
+
+    /**
+     * @brief Record afferent spikes with a membrane potential computed elsewhere
+     * Same effect as Predict(), e.g. with potentials from a sparse copy of the weights
+     * @param evidence
+     * @param membrane potential
+     */
+    void Observe(const cv::Mat &evidence, float u);
+
+    /**
+     * @brief Record afferent spikes given as a mask, with a membrane potential computed elsewhere
+     * Same effect as Observe(evidence, u) with mask evidence != 0,
+     * e.g. for a layer computing the mask once for all of its neurons
+     * @param 8-bit mask, non-zero for spiking afferent
+     * @param membrane potential
+     */
+    void ObserveSpiking(const cv::Mat &is_spiking, float u);
+
+    /**
+     * @brief Catch up on ticks without firing in bulk
+     *
+     * Same effect as that many calls to Learn() without a spike.
+     * Under a constant learning rate, the bias decays by a constant step while above log(eta)
+     * and stays put once clamped, both of which are computed in closed form.
+     * Only the few ticks in between are updated one at a time.
+     * The outcome is then equal up to rounding, see ExactSilentUpdates().
+     *
+     * @param no. of ticks
+     */
+    void LearnSilent(int nb_ticks);
+
+    /**
+     * @brief Let LearnSilent() update one tick at a time for results bit-exact with Learn(), e.g. for tests
+     * Applies to all neurons, like SIMDKernels::Select()
+     * @param enable, disabled by default
+     */
+    static void ExactSilentUpdates(bool enable);
+
+    /**
+     * @brief check if LearnSilent() updates one tick at a time
+     * @return true if enabled
+     */
+    static bool IsExactSilentUpdates();
+
     /**
      * @brief Z Neuron state State
      * @return membrane potential
@@ -51,21 +151,95 @@ public:
      */
     cv::Mat1f Bias() const;
 
+    /**
+     * @brief get read-only view of bias and weights
+     * No deep copy, valid until the next Init() or Attach()
+     * @return row vector with bias term first, log scale
+     */
+    const cv::Mat1f& WeightsAll() const;
+
+    /**
+     * @brief Move bias and weights into external storage, e.g. a row of a layer-wide matrix
+     * Copies current values, the neuron then learns in place until the next Init() or Attach()
+     * @param continuous row vector, bias term first followed by one element per afferent
+     * @throws ExceptionBadDims on size mismatch or non-continuous storage
+     */
+    void Attach(const cv::Mat1f &weights_all);
+
     /**
      * @brief Clear spiking history
+     * Does not reset weight change rate
      */
     void Clear();
 
+    /**
+     * @brief Enable or disable adaptive learning rate per weight
+     *
+     * Each weight tracks the running mean Q and second moment S of its values,
+     * and learns with rate eta = (S-Q^2)/(exp(-Q)+1), such that
+     * weights that settled slow down while weights still moving keep a large rate.
+     * Enabling restarts all rates at DEFAULT_LEARNING_RATE.
+     *
+     * @param enable, disabled by default
+     * @cite Nessler2010
+     */
+    void AdaptiveLearningRate(bool enable);
+
+    /**
+     * @brief get current learning rate per weight
+     * @return row vector of learning rates including bias term first
+     */
+    cv::Mat1f LearningRates() const;
+
+    /**
+     * @brief Set smoothing of weight change rate
+     * @param smoothing factor in (0, 1], weight of most recent Learn() call
+     */
+    void ChangeSmoothing(float alpha);
+
+    /**
+     * @brief get running magnitude of weight changes
+     *
+     * Each weight keeps an exponential moving average of its changes over Learn() calls.
+     * The rate is the mean magnitude of these averages, including the bias term.
+     * Fluctuations around an equilibrium average out, while sustained drift does not,
+     * such that the rate vanishes as learning converges.
+     *
+     * @return weight change rate, log scale per Learn() call
+     */
+    float WeightChangeRate() const;
+
 protected:
     /**
      * @brief Update of weights according to afferent spiking activity using STDP
      *
      * This implements the code learning algorithm from @cite Nessler2010
+     * Weights, their learning rates and weight change rates are updated in a single pass.
      *
-     * @param weights update in-place
-     * @param recent spiking history (binary mask)
+     * @param no. of leading weights to update, 1 for bias only
+     * @param recent spiking history (binary mask) of leading weights
+     */
+    void Update(int nb_weights, const cv::Mat &has_spiked_recently);
+
+    /**
+     * @brief Update of all weights from counts of recent spiking in several streams, see LearnPooled()
+     * @param continuous counts per weight including the bias term first
+     */
+    void UpdatePooled(const cv::Mat1f &nb_spiked_recently);
+
+    /**
+     * @brief Adapt learning rate of a single weight to its new value
+     * @param[in,out] learning rate state of the weight (eta, Q, S)
+     * @param new value of the weight
+     */
+    static void TrackLearningRate(float *rate_state, float w_new);
+
+    /**
+     * @brief (re-)initialize adaptive learning rate state from current weights
      */
-    void Update(cv::Mat &weights, const cv::Mat &has_spiked_recently) const;
+    void InitLearningRates();
+
+    static const int NB_RATE_STATES = 3;    ///< learning rate state per weight: eta, Q, S
 
     cv::Mat1f weights_all_;     ///< Neuron weights, including bias term, log scale
     cv::Mat1f bias_;            ///< bias term
@@ -76,6 +250,16 @@ protected:
     SpikingHistory history_self_;    ///< spiking input history, excluding bias
 
     float u_;                   ///< membrane potential
+
+    cv::Mat1f learning_rates_;  ///< adaptive learning rate state per weight including bias, interleaved (eta, Q, S)
+    bool is_adaptive_rate_;     ///< adaptive learning rate flag
+
+    float change_smoothing_;    ///< smoothing factor of weight change rate
+    cv::Mat1f drift_;           ///< running mean of changes per weight including bias, pending decay except for bias
+    double drift_sum_abs_;      ///< sum of absolute drift_ values excluding bias, pending decay
+    int nb_pending_;            ///< no. of Learn() calls since drift_ was last updated
+
+    static bool is_exact_silent_;   ///< LearnSilent() one tick at a time, see ExactSilentUpdates()
 };
 
 #endif // SEM_NEURON_ZNEURON_H_
@@ -0,0 +1,380 @@
+#include "sem/shm/sharedweights.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "elm/core/exception.h"
+#include "sem/layers/layer_z.h"
+#include "sem/neuron/zneuron.h"
+
+using cv::Mat1f;
+
+const int SharedWeights::FORMAT_VERSION = 1;
+
+/**
+ * @brief Segment's synchronization state, ahead of the checkpoint image
+ */
+struct SharedWeights::Control
+{
+    pthread_mutex_t mutex;              ///< process-shared, robust mutex guarding the checkpoint image
+    int is_writing;                     ///< non-zero while Add() modifies the weights
+    unsigned long long nb_interrupted;  ///< no. of Add() calls cut short by their process dying
+};
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'S', 'E', 'M', 'Z', 'W', 'G', 'T', '\0'};
+
+const size_t CONTROL_SIZE = 64; ///< bytes reserved for SharedWeights::Control, keeps the image cache line aligned
+
+bool IsValid(const WeightsCheckpointHeader &header)
+{
+    return std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+            header.format_version == SharedWeights::FORMAT_VERSION &&
+            header.nb_outputs > 0 &&
+            header.nb_afferents > 0;
+}
+
+} // annonymous namespace
+
+/**
+ * @brief Hold segment's mutex for the lifetime of this object
+ *
+ * Takes over the mutex of a holder that died,
+ * counting an Add() it did not complete, see NbInterrupted().
+ */
+class SharedWeights::SegmentLock
+{
+public:
+    explicit SegmentLock(Control *control)
+        : control_(control)
+    {
+        int ret = pthread_mutex_lock(&control_->mutex);
+        if(ret == EOWNERDEAD) {
+
+            if(control_->is_writing) {
+
+                // weights may hold part of the dead holder's changes
+                control_->nb_interrupted++;
+                control_->is_writing = 0;
+            }
+            pthread_mutex_consistent(&control_->mutex);
+        }
+        else if(ret != 0) {
+
+            ELM_THROW_VALUE_ERROR(std::string("Failed to lock shared weights: ") + strerror(ret));
+        }
+    }
+
+    ~SegmentLock()
+    {
+        pthread_mutex_unlock(&control_->mutex);
+    }
+
+protected:
+    Control *control_;  ///< control of locked segment
+};
+
+WeightsCheckpointHeader::WeightsCheckpointHeader()
+    : format_version(SharedWeights::FORMAT_VERSION),
+      nb_outputs(0),
+      nb_afferents(0),
+      reserved(0),
+      version(0)
+{
+    std::memcpy(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+}
+
+void WriteWeightsCheckpoint(const std::string &path, const Mat1f &weights_all, unsigned long long version)
+{
+    if(weights_all.empty() || weights_all.cols < 2) {
+
+        ELM_THROW_BAD_DIMS("Expecting bias and at least one weight per neuron");
+    }
+
+    WeightsCheckpointHeader header;
+    header.nb_outputs = weights_all.rows;
+    header.nb_afferents = weights_all.cols-1;
+    header.version = version;
+
+    // replace existing checkpoint only once complete
+    const std::string path_tmp = path + ".tmp";
+    {
+        std::ofstream out(path_tmp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!out.is_open()) {
+
+            ELM_THROW_FILEIO_ERROR("Failed to open file for writing: " + path_tmp);
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(int r=0; r<weights_all.rows; r++) {
+
+            out.write(reinterpret_cast<const char*>(weights_all.ptr<float>(r)), weights_all.cols*sizeof(float));
+        }
+
+        if(!out.good()) {
+
+            ELM_THROW_FILEIO_ERROR("Failed to write checkpoint: " + path_tmp);
+        }
+    }
+
+    if(std::rename(path_tmp.c_str(), path.c_str()) != 0) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to replace checkpoint: " + path);
+    }
+}
+
+unsigned long long ReadWeightsCheckpoint(const std::string &path, Mat1f &weights_all)
+{
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if(!in.is_open()) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open file for reading: " + path);
+    }
+
+    WeightsCheckpointHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if(!in.good() || !IsValid(header)) {
+
+        ELM_THROW_FILEIO_ERROR("Unrecognized weights checkpoint format: " + path);
+    }
+
+    weights_all = Mat1f(header.nb_outputs, header.nb_afferents+1);
+    in.read(reinterpret_cast<char*>(weights_all.ptr<float>(0)), weights_all.total()*sizeof(float));
+    if(!in.good()) {
+
+        ELM_THROW_FILEIO_ERROR("Truncated weights checkpoint: " + path);
+    }
+    return header.version;
+}
+
+SharedWeights::SharedWeights()
+    : addr_(0),
+      size_(0),
+      control_(0),
+      header_(0)
+{
+}
+
+SharedWeights::~SharedWeights()
+{
+    Detach();
+}
+
+void SharedWeights::Create(const std::string &name, const Mat1f &weights_all, unsigned long long version)
+{
+    if(weights_all.empty() || weights_all.cols < 2) {
+
+        ELM_THROW_BAD_DIMS("Expecting bias and at least one weight per neuron");
+    }
+
+    Detach();
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if(fd < 0) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to create shared memory segment " + name + ": " + strerror(errno));
+    }
+
+    const size_t size = SegmentSize(weights_all.rows, weights_all.cols-1);
+    if(ftruncate(fd, static_cast<off_t>(size)) != 0) {
+
+        const int err = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        ELM_THROW_FILEIO_ERROR("Failed to size shared memory segment " + name + ": " + strerror(err));
+    }
+
+    Map(fd, size);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&control_->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    control_->is_writing = 0;
+    control_->nb_interrupted = 0;
+
+    // header last, attaching fails on an incomplete segment
+    weights_ = Mat1f(weights_all.rows, weights_all.cols, reinterpret_cast<float*>(header_+1));
+    weights_all.copyTo(weights_); // in place
+
+    WeightsCheckpointHeader header;
+    header.nb_outputs = weights_all.rows;
+    header.nb_afferents = weights_all.cols-1;
+    header.version = version;
+    *header_ = header;
+}
+
+void SharedWeights::Attach(const std::string &name)
+{
+    Detach();
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open shared memory segment " + name + ": " + strerror(errno));
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < CONTROL_SIZE+sizeof(WeightsCheckpointHeader)) {
+
+        close(fd);
+        ELM_THROW_FILEIO_ERROR("Unrecognized shared memory segment: " + name);
+    }
+
+    Map(fd, static_cast<size_t>(st.st_size));
+
+    if(!IsValid(*header_) || SegmentSize(header_->nb_outputs, header_->nb_afferents) != size_) {
+
+        Detach();
+        ELM_THROW_FILEIO_ERROR("Unrecognized shared memory segment: " + name);
+    }
+
+    weights_ = Mat1f(header_->nb_outputs, header_->nb_afferents+1, reinterpret_cast<float*>(header_+1));
+}
+
+void SharedWeights::Detach()
+{
+    if(addr_ != 0) {
+
+        munmap(addr_, size_);
+    }
+
+    addr_ = 0;
+    size_ = 0;
+    control_ = 0;
+    header_ = 0;
+    weights_.release();
+    base_.release();
+}
+
+void SharedWeights::Unlink(const std::string &name)
+{
+    shm_unlink(name.c_str());
+}
+
+bool SharedWeights::IsAttached() const
+{
+    return addr_ != 0;
+}
+
+int SharedWeights::NbOutputs() const
+{
+    return weights_.rows;
+}
+
+int SharedWeights::NbAfferents() const
+{
+    return IsAttached()? weights_.cols-1 : 0;
+}
+
+unsigned long long SharedWeights::Version() const
+{
+    CheckAttached();
+
+    SegmentLock lock(control_);
+    return header_->version;
+}
+
+unsigned long long SharedWeights::Read(Mat1f &weights_all) const
+{
+    CheckAttached();
+
+    SegmentLock lock(control_);
+    weights_.copyTo(weights_all);
+    return header_->version;
+}
+
+unsigned long long SharedWeights::Add(const Mat1f &delta)
+{
+    CheckAttached();
+    if(delta.rows != weights_.rows || delta.cols != weights_.cols) {
+
+        ELM_THROW_BAD_DIMS("Change does not match shared weights");
+    }
+
+    SegmentLock lock(control_);
+    control_->is_writing = 1;
+    weights_ += delta; // in place
+
+    // keep within the range neurons learn in
+    cv::min(weights_, 0.f, weights_);
+    cv::max(weights_, -ZNeuron::WEIGHT_LIMIT, weights_);
+    control_->is_writing = 0;
+    return ++header_->version;
+}
+
+unsigned long long SharedWeights::NbInterrupted() const
+{
+    CheckAttached();
+
+    SegmentLock lock(control_);
+    return control_->nb_interrupted;
+}
+
+unsigned long long SharedWeights::Pull(LayerZ &layer)
+{
+    const unsigned long long version = Read(base_);
+    layer.Restore(base_);
+    return version;
+}
+
+unsigned long long SharedWeights::Push(LayerZ &layer)
+{
+    CheckAttached();
+    if(!base_.empty()) {
+
+        layer.Flush();
+        Add(layer.WeightsAll()-base_);
+    }
+    return Pull(layer);
+}
+
+unsigned long long SharedWeights::Checkpoint(const std::string &path) const
+{
+    Mat1f weights_all;
+    const unsigned long long version = Read(weights_all);
+    WriteWeightsCheckpoint(path, weights_all, version); // without holding up workers
+    return version;
+}
+
+void SharedWeights::Map(int fd, size_t size)
+{
+    static_assert(sizeof(SharedWeights::Control) <= CONTROL_SIZE, "Control overlaps the checkpoint image, increase CONTROL_SIZE");
+
+    void *addr = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) {
+
+        ELM_THROW_FILEIO_ERROR(std::string("Failed to map shared memory segment: ") + strerror(errno));
+    }
+
+    addr_ = addr;
+    size_ = size;
+    control_ = static_cast<Control*>(addr_);
+    header_ = reinterpret_cast<WeightsCheckpointHeader*>(static_cast<char*>(addr_)+CONTROL_SIZE);
+}
+
+void SharedWeights::CheckAttached() const
+{
+    if(!IsAttached()) {
+
+        ELM_THROW_VALUE_ERROR("Not attached to shared weights, see Create() and Attach()");
+    }
+}
+
+size_t SharedWeights::SegmentSize(int nb_outputs, int nb_afferents)
+{
+    return CONTROL_SIZE+sizeof(WeightsCheckpointHeader)+
+            static_cast<size_t>(nb_outputs)*static_cast<size_t>(nb_afferents+1)*sizeof(float);
+}
@@ -0,0 +1,200 @@
+#ifndef SEM_SHM_SHAREDWEIGHTS_H_
+#define SEM_SHM_SHAREDWEIGHTS_H_
+
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+class LayerZ;
+
+/**
+ * @brief Header of a LayerZ weights checkpoint
+ *
+ * Checkpoint layout (native byte order):
+ *  header, followed by weights of all neurons, one row per neuron, bias first (see LayerZ::WeightsAll()),
+ *  nb_outputs x (nb_afferents+1) floats
+ */
+struct WeightsCheckpointHeader
+{
+    WeightsCheckpointHeader();
+
+    char magic[8];                  ///< format identifier
+    int format_version;             ///< version of layout
+    int nb_outputs;                 ///< no. of neurons
+    int nb_afferents;               ///< no. of afferents, excluding bias
+    int reserved;                   ///< padding, 0
+    unsigned long long version;     ///< no. of updates applied to the weights
+};
+
+/**
+ * @brief Write weights checkpoint to file
+ * @param path to file
+ * @param weights of all neurons, one row per neuron, bias first
+ * @param no. of updates applied to the weights
+ * @throws ExceptionFileIOError on failure to write
+ */
+void WriteWeightsCheckpoint(const std::string &path, const cv::Mat1f &weights_all, unsigned long long version);
+
+/**
+ * @brief Read weights checkpoint from file
+ * @param path to file
+ * @param[out] weights of all neurons, one row per neuron, bias first
+ * @return no. of updates applied to the weights
+ * @throws ExceptionFileIOError on failure to read or unrecognized format
+ */
+unsigned long long ReadWeightsCheckpoint(const std::string &path, cv::Mat1f &weights_all);
+
+/**
+ * @brief Weights of a LayerZ in a POSIX shared memory segment, for training across processes on the same host
+ *
+ * A coordinator creates the segment from its layer's weights, any no. of worker processes attach to it by name.
+ * Each worker keeps learning with its own layer on its own share of the data,
+ * and periodically pushes the change of its weights since its previous pull into the segment,
+ * then pulls the sum of all workers' changes back.
+ * The coordinator reads or checkpoints the segment at any time.
+ * Access is serialized by a process-shared mutex inside the segment.
+ * Weights are kept within [-ZNeuron::WEIGHT_LIMIT, 0] on every Add().
+ *
+ * The mutex is robust: a process dying while holding it does not block the others.
+ * If it died halfway through an Add(), the weights may hold only part of its changes,
+ * the next process to lock counts this in NbInterrupted() and carries on.
+ *
+ * The segment holds a checkpoint image (see WeightsCheckpointHeader) behind the mutex,
+ * such that checkpointing is a single copy.
+ *
+ * Not thread-safe, use one instance per thread.
+ */
+class SharedWeights
+{
+public:
+    static const int FORMAT_VERSION;    ///< = 1, version of checkpoint layout
+
+    SharedWeights();
+
+    /**
+     * @brief Detach, the segment itself lives on until unlinked
+     */
+    ~SharedWeights();
+
+    SharedWeights(const SharedWeights&) = delete;
+    SharedWeights& operator=(const SharedWeights&) = delete;
+
+    /**
+     * @brief Create segment, then attach to it
+     * @param name of segment, e.g. "/sem_weights"
+     * @param initial weights of all neurons, one row per neuron, bias first
+     * @param version of initial weights
+     * @throws ExceptionFileIOError if the segment exists already or cannot be created
+     */
+    void Create(const std::string &name, const cv::Mat1f &weights_all, unsigned long long version=0);
+
+    /**
+     * @brief Attach to segment created by another process
+     * @param name of segment
+     * @throws ExceptionFileIOError if the segment does not exist or has an unrecognized format
+     */
+    void Attach(const std::string &name);
+
+    /**
+     * @brief Unmap segment, no-op if not attached
+     */
+    void Detach();
+
+    /**
+     * @brief Remove segment name, processes still attached keep their mapping
+     * @param name of segment
+     */
+    static void Unlink(const std::string &name);
+
+    bool IsAttached() const;
+
+    int NbOutputs() const;
+
+    int NbAfferents() const;
+
+    /**
+     * @brief get no. of updates applied to the shared weights
+     */
+    unsigned long long Version() const;
+
+    /**
+     * @brief Copy shared weights
+     * @param[out] weights of all neurons, one row per neuron, bias first, allocated unless matching
+     * @return version of weights read
+     */
+    unsigned long long Read(cv::Mat1f &weights_all) const;
+
+    /**
+     * @brief Add to shared weights atomically with respect to other processes
+     * Sums are clamped to [-ZNeuron::WEIGHT_LIMIT, 0]
+     * @param change per weight, one row per neuron, bias first
+     * @return version after adding
+     * @throws ExceptionBadDims on mismatching dimensions
+     */
+    unsigned long long Add(const cv::Mat1f &delta);
+
+    /**
+     * @brief get no. of Add() calls interrupted by their process dying
+     * Non-zero means the weights may hold part of a dead process's changes
+     */
+    unsigned long long NbInterrupted() const;
+
+    /**
+     * @brief Overwrite a layer's weights with the shared weights
+     * The layer's weights from then on serve as reference for the next Push()
+     * @param layer with matching no. of outputs and afferents
+     * @return version pulled
+     */
+    unsigned long long Pull(LayerZ &layer);
+
+    /**
+     * @brief Add what a layer learned since its most recent Pull() to the shared weights, then pull
+     * Pulls first if the layer never pulled
+     * @param layer
+     * @return version after pushing
+     */
+    unsigned long long Push(LayerZ &layer);
+
+    /**
+     * @brief Write consistent copy of shared weights to checkpoint file
+     * @param path to file
+     * @return version written
+     */
+    unsigned long long Checkpoint(const std::string &path) const;
+
+protected:
+    /**
+     * @brief Map segment of an open file descriptor, closes it
+     * @param file descriptor
+     * @param size of segment in bytes
+     */
+    void Map(int fd, size_t size);
+
+    /**
+     * @brief Make sure the segment is mapped
+     * @throws ExceptionValueError if not attached
+     */
+    void CheckAttached() const;
+
+    /**
+     * @brief get size of segment for given dimensions
+     * @param no. of neurons
+     * @param no. of afferents
+     * @return size in bytes
+     */
+    static size_t SegmentSize(int nb_outputs, int nb_afferents);
+
+    struct Control;                     ///< mutex ahead of checkpoint image
+    class SegmentLock;
+    friend class SegmentLock;
+
+    void *addr_;                        ///< start of mapped segment, null if not attached
+    size_t size_;                       ///< size of mapped segment in bytes
+    Control *control_;                  ///< process-shared mutex
+    WeightsCheckpointHeader *header_;   ///< header of checkpoint image
+    cv::Mat1f weights_;                 ///< weights of checkpoint image, refers to segment
+
+    cv::Mat1f base_;                    ///< layer's weights at most recent Pull(), reference for Push()
+};
+
+#endif // SEM_SHM_SHAREDWEIGHTS_H_
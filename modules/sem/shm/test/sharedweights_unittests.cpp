@@ -0,0 +1,281 @@
+#include "sem/shm/sharedweights.h"
+
+#include <cstdio>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "elm/core/exception.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "elm/ts/ts.h"
+#include "elm/ts/fakeevidence.h"
+#include "sem/layers/layer_z.h"
+#include "sem/neuron/zneuron.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const string NAME_INPUT_SPIKES  = "in";
+const string NAME_OUTPUT_SPIKES = "out";
+
+const int NB_AFFERENTS = 20;
+const int NB_OUTPUTS = 4;
+
+class SharedWeightsTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        // unique per process, such that concurrent test runs do not collide
+        stringstream s;
+        s << "/sem_sharedweights_test_" << getpid();
+        name_ = s.str();
+        SharedWeights::Unlink(name_);
+
+        stringstream p;
+        p << "sharedweights_test_" << getpid() << ".bin";
+        path_ = p.str();
+
+        weights_all_ = Mat1f(NB_OUTPUTS, NB_AFFERENTS+1);
+        randn(weights_all_, -1.f, 0.1f);
+    }
+
+    virtual void TearDown()
+    {
+        SharedWeights::Unlink(name_);
+        std::remove(path_.c_str());
+    }
+
+    /**
+     * @brief Create layer spiking on every tick
+     */
+    static void Reset(LayerZ &layer)
+    {
+        PTree params;
+        params.put(LayerZ::PARAM_NB_AFFERENTS, NB_AFFERENTS);
+        params.put(LayerZ::PARAM_NB_OUTPUT_NODES, NB_OUTPUTS);
+        params.put(LayerZ::PARAM_WTA_FREQ, 1e5f);
+        params.put(LayerZ::PARAM_DELTA_T, 1.f);
+
+        LayerConfig config;
+        config.Params(params);
+        config.Input(LayerZ::KEY_INPUT_SPIKES, NAME_INPUT_SPIKES);
+        config.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_OUTPUT_SPIKES);
+        layer.Reset(config);
+        layer.IONames(config);
+    }
+
+    /**
+     * @brief Let layer learn for a few ticks
+     */
+    static void Learn(LayerZ &layer, int stimulus)
+    {
+        FakeEvidence stimuli(NB_AFFERENTS);
+        for(int t=0; t<5; t++) {
+
+            Signal signal;
+            signal.Append(NAME_INPUT_SPIKES, static_cast<Mat1f>(stimuli.next(stimulus)));
+            layer.Activate(signal);
+            layer.Learn();
+        }
+    }
+
+    string name_;           ///< name of segment
+    string path_;           ///< path to checkpoint file
+    Mat1f weights_all_;     ///< initial weights, bias first
+};
+
+TEST_F(SharedWeightsTest, Checkpoint_File)
+{
+    WriteWeightsCheckpoint(path_, weights_all_, 7);
+
+    Mat1f weights_all;
+    EXPECT_EQ(7ULL, ReadWeightsCheckpoint(path_, weights_all));
+    EXPECT_MAT_EQ(weights_all_, weights_all);
+}
+
+TEST_F(SharedWeightsTest, Checkpoint_Invalid)
+{
+    Mat1f weights_all;
+    EXPECT_THROW(ReadWeightsCheckpoint(path_, weights_all), ExceptionFileIOError);
+
+    FILE *f = fopen(path_.c_str(), "wb");
+    ASSERT_TRUE(f != 0);
+    fputs("not a checkpoint, not a checkpoint", f);
+    fclose(f);
+    EXPECT_THROW(ReadWeightsCheckpoint(path_, weights_all), ExceptionFileIOError);
+
+    EXPECT_THROW(WriteWeightsCheckpoint(path_, Mat1f(), 0), ExceptionBadDims);
+}
+
+TEST_F(SharedWeightsTest, CreateAttach)
+{
+    SharedWeights coordinator;
+    EXPECT_FALSE(coordinator.IsAttached());
+    EXPECT_THROW(coordinator.Version(), ExceptionValueError);
+
+    coordinator.Create(name_, weights_all_, 3);
+    EXPECT_TRUE(coordinator.IsAttached());
+    EXPECT_EQ(NB_OUTPUTS, coordinator.NbOutputs());
+    EXPECT_EQ(NB_AFFERENTS, coordinator.NbAfferents());
+
+    SharedWeights worker;
+    worker.Attach(name_);
+    EXPECT_EQ(NB_OUTPUTS, worker.NbOutputs());
+    EXPECT_EQ(NB_AFFERENTS, worker.NbAfferents());
+    EXPECT_EQ(3ULL, worker.Version());
+
+    Mat1f weights_all;
+    EXPECT_EQ(3ULL, worker.Read(weights_all));
+    EXPECT_MAT_EQ(weights_all_, weights_all);
+
+    // writes by one are visible to the other
+    EXPECT_EQ(4ULL, worker.Add(Mat1f(weights_all_.size(), 0.5f)));
+    EXPECT_EQ(4ULL, coordinator.Read(weights_all));
+    EXPECT_MAT_NEAR(weights_all_+0.5f, weights_all, 1e-6);
+
+    EXPECT_THROW(worker.Add(Mat1f::ones(NB_OUTPUTS+1, NB_AFFERENTS+1)), ExceptionBadDims);
+}
+
+/**
+ * @brief Sums are kept within the range neurons learn in
+ */
+TEST_F(SharedWeightsTest, Add_Clamp)
+{
+    SharedWeights coordinator;
+    coordinator.Create(name_, weights_all_);
+
+    Mat1f delta(weights_all_.size(), 0.f);
+    delta.row(0).setTo(10.f);
+    delta.row(1).setTo(-10.f);
+    coordinator.Add(delta);
+
+    Mat1f weights_all;
+    coordinator.Read(weights_all);
+    EXPECT_MAT_EQ(Mat1f::zeros(1, NB_AFFERENTS+1), weights_all.row(0));
+    EXPECT_MAT_EQ(Mat1f(1, NB_AFFERENTS+1, -ZNeuron::WEIGHT_LIMIT), weights_all.row(1));
+    EXPECT_MAT_EQ(weights_all_.rowRange(2, NB_OUTPUTS), weights_all.rowRange(2, NB_OUTPUTS));
+    EXPECT_EQ(0ULL, coordinator.NbInterrupted());
+}
+
+TEST_F(SharedWeightsTest, Create_Invalid)
+{
+    SharedWeights a;
+    a.Create(name_, weights_all_);
+
+    SharedWeights b;
+    EXPECT_THROW(b.Create(name_, weights_all_), ExceptionFileIOError) << "Segment exists already";
+
+    SharedWeights::Unlink(name_);
+    EXPECT_THROW(b.Attach(name_), ExceptionFileIOError) << "Segment no longer exists";
+    EXPECT_TRUE(a.IsAttached()) << "Unlinking keeps existing mappings";
+}
+
+/**
+ * @brief Checkpoint of segment has the same layout as a checkpoint of weights
+ */
+TEST_F(SharedWeightsTest, Checkpoint_Segment)
+{
+    SharedWeights coordinator;
+    coordinator.Create(name_, weights_all_, 5);
+    EXPECT_EQ(5ULL, coordinator.Checkpoint(path_));
+
+    Mat1f weights_all;
+    EXPECT_EQ(5ULL, ReadWeightsCheckpoint(path_, weights_all));
+    EXPECT_MAT_EQ(weights_all_, weights_all);
+}
+
+/**
+ * @brief Shared weights accumulate what each worker learned since its most recent pull
+ */
+TEST_F(SharedWeightsTest, PushPull)
+{
+    LayerZ layer_a, layer_b;
+    Reset(layer_a);
+    Reset(layer_b);
+
+    SharedWeights coordinator;
+    coordinator.Create(name_, layer_a.WeightsAll());
+
+    SharedWeights worker_a, worker_b;
+    worker_a.Attach(name_);
+    worker_b.Attach(name_);
+    worker_a.Pull(layer_a);
+    worker_b.Pull(layer_b);
+    EXPECT_MAT_EQ(layer_a.WeightsAll(), layer_b.WeightsAll());
+
+    const Mat1f initial = layer_a.WeightsAll();
+    Learn(layer_a, 0);
+    Learn(layer_b, 1);
+    const Mat1f delta_a = layer_a.WeightsAll()-initial;
+    const Mat1f delta_b = layer_b.WeightsAll()-initial;
+
+    worker_a.Push(layer_a);
+    EXPECT_EQ(2ULL, worker_b.Push(layer_b));
+
+    Mat1f shared;
+    coordinator.Read(shared);
+    EXPECT_MAT_NEAR(initial+delta_a+delta_b, shared, 1e-5);
+    EXPECT_MAT_EQ(shared, layer_b.WeightsAll()) << "Expecting pull after push.";
+
+    worker_a.Pull(layer_a);
+    EXPECT_MAT_EQ(shared, layer_a.WeightsAll());
+}
+
+/**
+ * @brief Worker processes attach and add to the same segment
+ */
+TEST_F(SharedWeightsTest, Processes)
+{
+    const int NB_WORKERS = 3;
+    const int NB_ADDS = 50;
+    const float DELTA = 1.f/64.f; // exact sums, within weight limits
+
+    SharedWeights coordinator;
+    coordinator.Create(name_, Mat1f(NB_OUTPUTS, NB_AFFERENTS+1, -ZNeuron::WEIGHT_LIMIT));
+
+    vector<pid_t> pids;
+    for(int i=0; i<NB_WORKERS; i++) {
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if(pid == 0) {
+
+            int status = 0;
+            try {
+
+                SharedWeights worker;
+                worker.Attach(name_);
+                for(int j=0; j<NB_ADDS; j++) {
+
+                    worker.Add(Mat1f(NB_OUTPUTS, NB_AFFERENTS+1, DELTA));
+                }
+            }
+            catch(...) {
+
+                status = 1;
+            }
+            _exit(status);
+        }
+        pids.push_back(pid);
+    }
+
+    for(size_t i=0; i<pids.size(); i++) {
+
+        int status;
+        ASSERT_EQ(pids[i], waitpid(pids[i], &status, 0));
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "worker " << i;
+    }
+
+    Mat1f shared;
+    EXPECT_EQ(static_cast<unsigned long long>(NB_WORKERS*NB_ADDS), coordinator.Read(shared));
+    EXPECT_MAT_EQ(Mat1f(NB_OUTPUTS, NB_AFFERENTS+1, -ZNeuron::WEIGHT_LIMIT+NB_WORKERS*NB_ADDS*DELTA), shared);
+    EXPECT_EQ(0ULL, coordinator.NbInterrupted()) << "Expecting every worker to complete its changes";
+}
+
+} // annonymous namespace
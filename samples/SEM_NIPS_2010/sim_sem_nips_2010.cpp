@@ -1,18 +1,108 @@
 /** @file Run SEM simulation (NIPS 2010)
+ *
+ * Usage:
+ *  SEM_NIPS_2010 [<recording>] [--max-ticks T] [--stop-spikes N] [--stop-confidence C]
+ *                              [--converge R] [--mosaic-every M]
+ *
+ * Without options, stimuli are presented for a fixed length, learning runs through all stimuli
+ * and a single weights mosaic is written on Eval(). Options opt into:
+ *  recording: record input and WTA spikes for replay by SEM_replay
+ *  --max-ticks, --stop-spikes, --stop-confidence: adaptive presentation length, see SimulationSEM::Presentation()
+ *  --converge: stop learning once the weight change rate stays below R, see SimulationSEM::StopOnConvergence()
+ *  --mosaic-every: write a weights mosaic every M stimuli during learning, see SimulationSEM::RenderMosaic()
+ *
+ * e.g. SEM_NIPS_2010 --max-ticks 20 --stop-spikes 3 --stop-confidence 0.95 --converge 1e-4 --mosaic-every 1000
  */
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <string>
 
 #include "elm/core/core.h"
+#include "sem/layers/presentationcontroller.h"
 #include "simulationsem.h"
 
 using namespace std;
 
-int main() {
+namespace {
+
+int Usage()
+{
+    cerr << "Usage:" << endl
+         << "  SEM_NIPS_2010 [<recording>] [--max-ticks T] [--stop-spikes N] [--stop-confidence C]" << endl
+         << "                              [--converge R] [--mosaic-every M]" << endl;
+    return 1;
+}
+
+/**
+ * @brief parse --key value pairs
+ * @return false on malformed arguments
+ */
+bool ParseOptions(int argc, char **argv, int start, map<string, string> &options)
+{
+    for(int i=start; i<argc; i+=2) {
+
+        string key(argv[i]);
+        if(key.compare(0, 2, "--") != 0 || i+1 >= argc) {
+
+            return false;
+        }
+        options[key.substr(2)] = argv[i+1];
+    }
+    return true;
+}
+
+double Get(const map<string, string> &options, const string &key, double default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? atof(itr->second.c_str()) : default_value;
+}
+
+bool Has(const map<string, string> &options, const string &key)
+{
+    return options.find(key) != options.end();
+}
+
+} // annonymous namespace
+
+int main(int argc, char **argv) {
 
     cout<<elm::GetVersion()<<endl;
 
+    // optional recording path before any options
+    const bool is_recording = argc > 1 && string(argv[1]).compare(0, 2, "--") != 0;
+
+    map<string, string> options;
+    if(!ParseOptions(argc, argv, is_recording? 2 : 1, options)) {
+
+        return Usage();
+    }
+
     SimulationSEM s;
 
+    if(is_recording) {
+
+        cout<<"Recording spikes to "<<argv[1]<<endl;
+        s.Record(argv[1]);
+    }
+
+    if(Has(options, "max-ticks") || Has(options, "stop-spikes") || Has(options, "stop-confidence")) {
+
+        s.Presentation(static_cast<int>(Get(options, "max-ticks", PresentationController::DEFAULT_MAX_TICKS)),
+                       static_cast<int>(Get(options, "stop-spikes", 0)),
+                       static_cast<float>(Get(options, "stop-confidence", 0.)));
+    }
+
+    if(Has(options, "converge")) {
+
+        s.StopOnConvergence(static_cast<float>(Get(options, "converge", 0.)));
+    }
+
+    if(Has(options, "mosaic-every")) {
+
+        s.RenderMosaic("weights_", static_cast<int>(Get(options, "mosaic-every", 0)));
+    }
+
     cout<<"Learn()"<<endl;
 
     s.Learn();
@@ -1,17 +1,16 @@
 #include "simulationsem.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/filesystem.hpp>
 
-#include <opencv2/highgui/highgui.hpp>
-
 #include "elm/core/signal.h"
-#include "elm/core/cv/mat_utils.h"
 #include "elm/core/inputname.h"
 #include "elm/encoding/populationcode_derivs/mutex_populationcode.h"
 #include "elm/io/readmnist.h"
 #include "elm/layers/layer_y.h"
+#include "sem/io/spikerecording.h"
 #include "sem/layers/layerfactorysem.h"
 #include "sem/layers/layer_z.h"
 
@@ -25,9 +24,16 @@ const string SimulationSEM::NAME_POP_CODE  = "pc";
 const string SimulationSEM::NAME_SPIKES_Y  = "y";
 const string SimulationSEM::NAME_SPIKES_Z  = "z";
 const string SimulationSEM::NAME_WEIGHTS   = "w";
+const string SimulationSEM::NAME_BIAS      = "w0";
+
+const int SimulationSEM::NB_LABELS           = 10;
+const int SimulationSEM::EVAL_SNAPSHOT_EVERY = 10000;
+const int SimulationSEM::MOSAIC_TILE_ROWS    = 28;
 
 SimulationSEM::SimulationSEM()
-    : nb_learners_(40)
+    : nb_learners_(40),
+      mosaic_every_(0),
+      seed_recording_(0)
 {
     pop_code_ = InitPopulationCode();
     y_ = InitLayerY();
@@ -41,7 +47,18 @@ void SimulationSEM::Learn()
     bfs::path p("/media/win/Users/woodstock/dev/data/MNIST/t10k-images.idx3-ubyte");
     r.ReadHeader(p.string().c_str());
 
+    // ground-truth labels for evaluating alongside learning
+    ReadMNISTLabels r_labels;
+    bfs::path p_labels("/media/win/Users/woodstock/dev/data/MNIST/t10k-labels.idx1-ubyte");
+    r_labels.ReadHeader(p_labels.string().c_str());
+
+    eval_.Reset(static_cast<int>(nb_learners_), NB_LABELS);
+    eval_.SnapshotEvery(EVAL_SNAPSHOT_EVERY);
+    convergence_.Reset();
+
     Signal sig;
+    SpikeRecordWriter recorder;
+    SpikeRecordSummary summary;
 
     while(!r.Is_EOF()) {
 
@@ -49,27 +66,115 @@ void SimulationSEM::Learn()
 
         Mat1f img = r.Next();
 
+        Mat label;
+        r_labels.Next().convertTo(label, CV_32S);
+
         sig.Append(NAME_STIMULUS, img);
 
         pop_code_->Activate(sig);
         pop_code_->Response(sig);
 
-        const int T=20;
-        for(int t=0; t<T; t++) {
+        const int nb_snapshots = eval_.Snapshots().rows;
+
+        // present stimulus until WTA activity suggests moving on
+        presentation_.Start();
+        bool is_done = false;
+        while(!is_done) {
 
             y_->Activate(sig);
             y_->Response(sig);
 
             if(!z_) {
 
-                z_ = InitLearners(static_cast<int>(sig.MostRecentMat1f(NAME_SPIKES_Y).total()), 10);
+                const int nb_afferents = static_cast<int>(sig.MostRecentMat1f(NAME_SPIKES_Y).total());
+                const int len_history = 10;
+
+                // while recording, learners draw from their own generator seeded like in a replay,
+                // such that LayerY's draws don't interleave with the WTA's
+                const RNG rng_caller = theRNG();
+                if(!path_recording_.empty()) {
+
+                    theRNG() = RNG(seed_recording_);
+                }
+
+                z_ = InitLearners(nb_afferents, len_history);
+
+                if(!path_recording_.empty()) {
+
+                    rng_recording_ = theRNG();
+                    theRNG() = rng_caller;
+
+                    SpikeRecordHeader header;
+                    header.nb_afferents = nb_afferents;
+                    header.nb_outputs   = static_cast<int>(nb_learners_);
+                    header.len_history  = len_history;
+                    header.wta_f        = LayerZ::DEFAULT_WTA_FREQ;
+                    header.delta_t      = LayerZ::DEFAULT_DELTA_T;
+                    header.seed         = seed_recording_;
+                    recorder.Open(path_recording_, header);
+
+                    summary.checksum_initial = WeightChecksum();
+                }
+            }
+
+            if(recorder.IsOpen()) {
+
+                std::swap(theRNG(), rng_recording_);
             }
 
             z_->Activate(sig);
             dynamic_pointer_cast<base_LearningLayer>(z_)->Learn();
+
+            if(recorder.IsOpen()) {
+
+                std::swap(theRNG(), rng_recording_);
+            }
+
+            z_->Response(sig);
+
+            eval_.Update(sig.MostRecentMat1f(NAME_SPIKES_Z), label.at<int>(0));
+
+            if(recorder.IsOpen()) {
+
+                recorder.Tick(sig.MostRecentMat1f(NAME_SPIKES_Y), sig.MostRecentMat1f(NAME_SPIKES_Z));
+            }
+
+            is_done = presentation_.Tick(sig.MostRecentMat1f(NAME_SPIKES_Z),
+                                         presentation_.NeedsStateDistr()?
+                                             dynamic_pointer_cast<LayerZ>(z_)->StateDistr() : Mat1f());
+        }
+
+        if(eval_.Snapshots().rows > nb_snapshots) {
+
+            PrintEvaluation();
         }
 
         z_->Clear(); // clear before moving on to the next stimulus
+        if(recorder.IsOpen()) {
+
+            recorder.Clear();
+        }
+
+        if(mosaic_every_ > 0 && presentation_.NbPresentations() % mosaic_every_ == 0) {
+
+            SubmitMosaic();
+        }
+
+        if(convergence_.Check(dynamic_pointer_cast<LayerZ>(z_)->WeightChangeRate())) {
+
+            cout<<"Converged after "<<convergence_.NbChecks()<<" stimuli."<<endl;
+            break;
+        }
+    }
+
+    cout<<"Presented "<<presentation_.NbPresentations()<<" stimuli in "
+        <<presentation_.TotalTicks()<<" ticks."<<endl;
+
+    if(recorder.IsOpen()) {
+
+        summary.checksum_final = WeightChecksum();
+        recorder.Close(summary);
+        path_recording_.clear();
     }
 }
 
@@ -100,11 +205,53 @@ void SimulationSEM::Test()
     }
 }
 
+void SimulationSEM::Record(const string &path, unsigned long long seed)
+{
+    path_recording_ = path;
+    seed_recording_ = seed;
+}
+
+void SimulationSEM::Presentation(int max_ticks, int nb_spikes, float confidence)
+{
+    presentation_ = PresentationController(max_ticks, nb_spikes, confidence);
+}
+
+void SimulationSEM::RenderMosaic(const string &path_prefix, int every)
+{
+    mosaic_.reset(); // finish rendering under the previous prefix
+    mosaic_.reset(new MosaicRenderer(path_prefix, MOSAIC_TILE_ROWS));
+    mosaic_every_ = every;
+}
+
+void SimulationSEM::StopOnConvergence(float threshold, int patience, int warm_up)
+{
+    convergence_ = ConvergenceMonitor(threshold, patience, warm_up);
+}
+
+const OnlineClusterEval& SimulationSEM::Evaluation() const
+{
+    return eval_;
+}
+
+void SimulationSEM::PrintEvaluation() const
+{
+    cout<<"WTA spikes: "<<eval_.NbSamples()
+        <<", H(label|winner): "<<eval_.ConditionalEntropy()<<" bits"
+        <<", accuracy: "<<eval_.Accuracy()<<endl;
+}
+
 void SimulationSEM::Eval()
 {
-    Signal signal;
-    z_->Response(signal);
-    SimulationSEM::VisualizeOnOffWeights(signal.MostRecentMat1f(NAME_WEIGHTS));
+    PrintEvaluation();
+    cout<<"neuron labels: "<<eval_.NeuronLabels()<<endl;
+
+    if(!mosaic_) {
+
+        RenderMosaic("weights_", 0);
+    }
+    SubmitMosaic();
+    mosaic_->Flush();
+    cout<<"Wrote weights mosaic "<<mosaic_->Path(dynamic_pointer_cast<LayerZ>(z_)->WeightsVersion())<<endl;
 }
 
 LayerShared SimulationSEM::InitPopulationCode() const
@@ -144,30 +291,22 @@ LayerShared SimulationSEM::InitLearners(int nb_features, int history_length) con
     cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_SPIKES_Y);
     cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_SPIKES_Z);
     cfg.Output(LayerZ::KEY_OUTPUT_WEIGHTS, NAME_WEIGHTS);
+    cfg.Output(LayerZ::KEY_OUTPUT_BIAS, NAME_BIAS);
 
     return LayerFactorySEM::CreateShared("LayerZ", cfg, cfg);
 }
 
-void SimulationSEM::VisualizeOnOffWeights(const Mat1f &weights)
+double SimulationSEM::WeightChecksum() const
 {
-    // these weights are interlaced in wether they represent on or off activity
-    // we'll reshape the matrix for easier visualization
-    Mat1f weights_exp;
-    exp(weights, weights_exp); // weights are initially in log scale
-
-    for(size_t i=0; i<nb_learners_; i++) {
-
-        Mat1f w = weights_exp.row(i);
-        w = w.reshape(1, static_cast<int>(w.total()/2.));
-
-        Mat1f w_on = w.col(0);
-        Mat1f w_off = w.col(1);
-
-        //cout<<w_on.t()<<endl;
-        //cout<<w_off.t()<<endl;
+    Signal signal;
+    z_->Response(signal);
+    return ::WeightChecksum(signal.MostRecentMat1f(NAME_WEIGHTS), signal.MostRecentMat1f(NAME_BIAS));
+}
 
-        imshow("on", elm::ConvertTo8U(w_on).reshape(1, 28));
-        imshow("off", elm::ConvertTo8U(w_off).reshape(1, 28));
-        waitKey();
-    }
+void SimulationSEM::SubmitMosaic()
+{
+    shared_ptr<LayerZ> z = dynamic_pointer_cast<LayerZ>(z_);
+    z->Flush(); // apply pending silent updates of event-driven mode
+    z->Publish();
+    mosaic_->Submit(z->Snapshot());
 }
@@ -9,6 +9,10 @@
 
 #include "elm/core/base_Layer.h"
 #include "elm/core/typedefs.h"
+#include "sem/eval/convergencemonitor.h"
+#include "sem/eval/onlineclustereval.h"
+#include "sem/io/mosaicrenderer.h"
+#include "sem/layers/presentationcontroller.h"
 
 class SimulationSEM
 {
@@ -21,6 +25,54 @@ public:
 
     void Eval();
 
+    /**
+     * @brief Record input spikes and WTA spikes of the next Learn() call
+     * The recording can be replayed headlessly by the SEM_replay sample.
+     * Learners then draw from their own random number generator, seeded before initializing them,
+     * such that the replayed layer's WTA reproduces the recorded spikes.
+     * @param path to recording file
+     * @param seed for initializing learners
+     */
+    void Record(const std::string &path, unsigned long long seed=2010);
+
+    /**
+     * @brief Set how long each stimulus is presented
+     * Presentations have a fixed length of PresentationController::DEFAULT_MAX_TICKS by default
+     * @param max. no. of ticks per stimulus
+     * @param no. of WTA spikes to move on to the next stimulus, 0 to disable
+     * @param min. posterior confidence to move on to the next stimulus, 0 to disable
+     * @see PresentationController
+     */
+    void Presentation(int max_ticks, int nb_spikes, float confidence);
+
+    /**
+     * @brief Stop learning once weights stop moving
+     * The weight change rate of the learners is checked after every stimulus
+     * @param threshold on layer's weight change rate, <= 0 to disable
+     * @param no. of consecutive stimuli below threshold
+     * @param no. of initial stimuli before checking
+     * @see LayerZ::WeightChangeRate()
+     */
+    void StopOnConvergence(float threshold,
+                           int patience=ConvergenceMonitor::DEFAULT_PATIENCE,
+                           int warm_up=ConvergenceMonitor::DEFAULT_WARM_UP);
+
+    /**
+     * @brief Write a mosaic of all learners' on/off weights to disk during Learn() and on Eval()
+     * Rendering runs on a background thread, learning only hands over a snapshot of the weights.
+     * Eval() writes to "weights_<version>.png" unless set otherwise.
+     * @param prefix of mosaic files, followed by weights version and ".png"
+     * @param no. of stimuli between mosaics during Learn(), 0 for Eval() only
+     * @see MosaicRenderer
+     */
+    void RenderMosaic(const std::string &path_prefix, int every);
+
+    /**
+     * @brief get online evaluation of clustering quality from the most recent Learn() call
+     * @return reference to evaluator
+     */
+    const OnlineClusterEval& Evaluation() const;
+
 protected:
     // static members
     static const std::string NAME_STIMULUS;
@@ -28,6 +80,11 @@ protected:
     static const std::string NAME_SPIKES_Y;
     static const std::string NAME_SPIKES_Z;
     static const std::string NAME_WEIGHTS;
+    static const std::string NAME_BIAS;
+
+    static const int NB_LABELS;             ///< no. of ground-truth classes
+    static const int EVAL_SNAPSHOT_EVERY;   ///< no. of WTA spikes between evaluation snapshots
+    static const int MOSAIC_TILE_ROWS;      ///< no. of image rows per learner in weights mosaic
 
     // methods
     /**
@@ -50,7 +107,21 @@ protected:
      */
     elm::LayerShared InitLearners(int nb_features, int history_length) const;
 
-    void VisualizeOnOffWeights(const cv::Mat1f &weights);
+    /**
+     * @brief Hand snapshot of learners' current weights over to the mosaic renderer
+     */
+    void SubmitMosaic();
+
+    /**
+     * @brief Print most recent evaluation snapshot
+     */
+    void PrintEvaluation() const;
+
+    /**
+     * @brief Checksum of learners' current weights and bias
+     * @return checksum
+     */
+    double WeightChecksum() const;
 
     // members
     elm::LayerShared pop_code_;
@@ -58,5 +129,16 @@ protected:
     elm::LayerShared z_;
     size_t nb_learners_;   ///< no. of learners (e.g. ZNeurons)
 
+    OnlineClusterEval eval_;            ///< winner-vs-label evaluation alongside learning
+    ConvergenceMonitor convergence_;    ///< early stopping, disabled by default
+    PresentationController presentation_;   ///< presentation length per stimulus
+
+    std::unique_ptr<MosaicRenderer> mosaic_;    ///< background renderer of weights mosaic, null until needed
+    int mosaic_every_;                  ///< no. of stimuli between mosaics during learning, 0 for none
+
+    std::string path_recording_;        ///< destination of spike recording, empty for no recording
+    unsigned long long seed_recording_; ///< seed for initializing learners when recording
+    cv::RNG rng_recording_;             ///< learners' own random number generator while recording
+
 };
 #endif // SIMULATIONSEM_H_
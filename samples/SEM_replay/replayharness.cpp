@@ -0,0 +1,305 @@
+#include "replayharness.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "elm/core/exception.h"
+#include "elm/core/signal.h"
+#include "sem/neuron/zneuron.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+const string ReplayHarness::NAME_SPIKES_IN  = "spikes_in";
+const string ReplayHarness::NAME_SPIKES_OUT = "spikes_out";
+
+LayerZReplay::LayerZReplay()
+    : LayerZ()
+{
+}
+
+bool LayerZReplay::Activate(const Signal &signal, int winner)
+{
+    if(winner >= static_cast<int>(z_.size())) {
+
+        ELM_THROW_BAD_DIMS("Recorded winner exceeds no. of neurons.");
+    }
+
+    LayerZ::Activate(signal);
+
+    const int nb_spiking = countNonZero(spikes_out_);
+    return (winner < 0)? nb_spiking == 0 : nb_spiking == 1 && spikes_out_(winner) != 0.f;
+}
+
+double LayerZReplay::Checksum() const
+{
+    Mat1f weights(static_cast<int>(z_.size()), nb_afferents_);
+    Mat1f bias(1, static_cast<int>(z_.size()));
+    for(int i=0; i<static_cast<int>(z_.size()); i++) {
+
+        shared_ptr<ZNeuron> z = static_pointer_cast<ZNeuron>(z_[i]);
+        z->Weights().copyTo(weights.row(i));
+        bias(i) = z->Bias()(0);
+    }
+    return WeightChecksum(weights, bias);
+}
+
+ReplayResult::ReplayResult()
+    : nb_ticks(0),
+      nb_spike_mismatches(0),
+      seconds(0.),
+      checksum_initial(0.),
+      checksum_final(0.),
+      checksum_spikes(0.),
+      is_initial_match(false),
+      is_final_match(false),
+      is_spikes_match(false)
+{
+}
+
+double SpikeChecksum(unsigned long long tick, int winner)
+{
+    return static_cast<double>(winner+1) * static_cast<double>(tick % 97 + 1);
+}
+
+ReplayGolden::ReplayGolden()
+    : nb_stimuli(0),
+      ticks_per_stimulus(0),
+      density(0.f),
+      nb_ticks(0),
+      checksum_initial(0.),
+      checksum_final(0.),
+      checksum_spikes(0.)
+{
+}
+
+void ReplayGolden::Read(const string &path)
+{
+    ifstream in(path.c_str());
+    if(!in) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open golden run " + path);
+    }
+
+    map<string, string> entries;
+    string line;
+    while(getline(in, line)) {
+
+        istringstream fields(line);
+        string key, value;
+        if((fields >> key >> value) && key[0] != '#') {
+
+            entries[key] = value;
+        }
+    }
+
+    const char *KEYS[] = {"afferents", "outputs", "history", "wta-f", "delta-t", "seed",
+                          "stimuli", "ticks", "density",
+                          "nb_ticks", "checksum_initial", "checksum_final", "checksum_spikes"};
+    for(size_t i=0; i<sizeof(KEYS)/sizeof(char*); i++) {
+
+        if(entries.find(KEYS[i]) == entries.end()) {
+
+            ELM_THROW_FILEIO_ERROR("Golden run " + path + " is missing entry " + KEYS[i]);
+        }
+    }
+
+    istringstream(entries["afferents"]) >> header.nb_afferents;
+    istringstream(entries["outputs"]) >> header.nb_outputs;
+    istringstream(entries["history"]) >> header.len_history;
+    istringstream(entries["wta-f"]) >> header.wta_f;
+    istringstream(entries["delta-t"]) >> header.delta_t;
+    istringstream(entries["seed"]) >> header.seed;
+    istringstream(entries["stimuli"]) >> nb_stimuli;
+    istringstream(entries["ticks"]) >> ticks_per_stimulus;
+    istringstream(entries["density"]) >> density;
+    istringstream(entries["nb_ticks"]) >> nb_ticks;
+    istringstream(entries["checksum_initial"]) >> checksum_initial;
+    istringstream(entries["checksum_final"]) >> checksum_final;
+    istringstream(entries["checksum_spikes"]) >> checksum_spikes;
+}
+
+void ReplayGolden::Write(const string &path) const
+{
+    ofstream out(path.c_str());
+    if(!out) {
+
+        ELM_THROW_FILEIO_ERROR("Failed to open golden run " + path);
+    }
+
+    out.precision(17);
+    out << "# SEM_replay golden run, regenerate on the reference build with:" << endl
+        << "# SEM_replay golden <file> [record options]" << endl
+        << "afferents " << header.nb_afferents << endl
+        << "outputs " << header.nb_outputs << endl
+        << "history " << header.len_history << endl
+        << "wta-f " << header.wta_f << endl
+        << "delta-t " << header.delta_t << endl
+        << "seed " << header.seed << endl
+        << "stimuli " << nb_stimuli << endl
+        << "ticks " << ticks_per_stimulus << endl
+        << "density " << density << endl
+        << "nb_ticks " << nb_ticks << endl
+        << "checksum_initial " << checksum_initial << endl
+        << "checksum_final " << checksum_final << endl
+        << "checksum_spikes " << checksum_spikes << endl;
+}
+
+bool ReplayGolden::IsMatch(const ReplayResult &result, double tolerance) const
+{
+    return result.nb_ticks == nb_ticks &&
+            result.is_spikes_match &&
+            result.checksum_spikes == checksum_spikes &&
+            abs(result.checksum_initial-checksum_initial) <= tolerance*max(1., abs(checksum_initial)) &&
+            abs(result.checksum_final-checksum_final) <= tolerance*max(1., abs(checksum_final));
+}
+
+ReplayHarness::ReplayHarness()
+{
+}
+
+LayerConfig ReplayHarness::Config(const SpikeRecordHeader &header)
+{
+    PTree params;
+    params.put(LayerZ::PARAM_NB_AFFERENTS, header.nb_afferents);
+    params.put(LayerZ::PARAM_NB_OUTPUT_NODES, header.nb_outputs);
+    params.put(LayerZ::PARAM_LEN_HISTORY, header.len_history);
+    params.put(LayerZ::PARAM_WTA_FREQ, header.wta_f);
+    params.put(LayerZ::PARAM_DELTA_T, header.delta_t);
+
+    LayerConfig cfg;
+    cfg.Params(params);
+    cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_SPIKES_IN);
+    cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_SPIKES_OUT);
+    return cfg;
+}
+
+SpikeRecordSummary ReplayHarness::Record(const string &path,
+                                         const SpikeRecordHeader &header,
+                                         int nb_stimuli,
+                                         int ticks_per_stimulus,
+                                         float density) const
+{
+    // input generator independent of layer's random number generator
+    RNG rng(header.seed+1);
+
+    const int NB_PROTOTYPES = 4;
+    Mat1f prototypes(NB_PROTOTYPES, header.nb_afferents);
+    for(int r=0; r<NB_PROTOTYPES; r++) {
+
+        for(int c=0; c<header.nb_afferents; c++) {
+
+            // afferents either likely or unlikely to spike, averaging the requested density
+            prototypes(r, c) = (rng.uniform(0.f, 1.f) < density)? 0.9f : 0.1f*density;
+        }
+    }
+
+    LayerConfig cfg = Config(header);
+    theRNG() = RNG(header.seed); // before constructing the layer, same as when created through the factory
+    LayerZReplay layer;
+    layer.Reset(cfg);
+    layer.IONames(cfg);
+
+    SpikeRecordWriter writer;
+    writer.Open(path, header);
+
+    SpikeRecordSummary summary;
+    summary.checksum_initial = layer.Checksum();
+
+    Signal signal;
+    Mat1f spikes_in(1, header.nb_afferents);
+    for(int s=0; s<nb_stimuli; s++) {
+
+        Mat1f p = prototypes.row(rng.uniform(0, NB_PROTOTYPES));
+
+        for(int t=0; t<ticks_per_stimulus; t++) {
+
+            for(int i=0; i<header.nb_afferents; i++) {
+
+                spikes_in(i) = (rng.uniform(0.f, 1.f) < p(i))? 1.f : 0.f;
+            }
+
+            signal.Clear();
+            signal.Append(NAME_SPIKES_IN, spikes_in);
+
+            layer.Activate(signal);
+            layer.Response(signal);
+            layer.Learn();
+
+            writer.Tick(spikes_in, signal.MostRecentMat1f(NAME_SPIKES_OUT));
+        }
+
+        layer.Clear();
+        writer.Clear();
+    }
+
+    summary.checksum_final = layer.Checksum();
+    writer.Close(summary);
+
+    return summary;
+}
+
+ReplayResult ReplayHarness::Replay(const string &path, double tolerance) const
+{
+    typedef chrono::steady_clock Clock;
+
+    SpikeRecordReader reader;
+    reader.Open(path);
+    const SpikeRecordHeader &header = reader.Header();
+
+    LayerConfig cfg = Config(header);
+    theRNG() = RNG(header.seed); // before constructing the layer, same as when created through the factory
+    LayerZReplay layer;
+    layer.Reset(cfg);
+    layer.IONames(cfg);
+
+    ReplayResult result;
+    result.checksum_initial = layer.Checksum();
+
+    Signal signal;
+    Mat1f spikes_in;
+    int winner;
+    SpikeRecordReader::Event e;
+    while((e = reader.Next(spikes_in, winner)) != SpikeRecordReader::EVENT_END) {
+
+        if(e == SpikeRecordReader::EVENT_CLEAR) {
+
+            layer.Clear();
+            continue;
+        }
+
+        signal.Clear();
+        signal.Append(NAME_SPIKES_IN, spikes_in);
+
+        Clock::time_point t0 = Clock::now();
+        const bool is_spike_match = layer.Activate(signal, winner);
+        layer.Learn();
+        result.seconds += chrono::duration<double>(Clock::now()-t0).count();
+
+        if(!is_spike_match) {
+
+            result.nb_spike_mismatches++;
+        }
+        result.checksum_spikes += SpikeChecksum(result.nb_ticks, winner);
+        result.nb_ticks++;
+    }
+
+    const SpikeRecordSummary &summary = reader.Summary();
+    result.checksum_final = layer.Checksum();
+    result.is_initial_match = result.checksum_initial == summary.checksum_initial;
+    result.is_final_match = result.nb_ticks == summary.nb_ticks &&
+            abs(result.checksum_final-summary.checksum_final) <= tolerance*max(1., abs(summary.checksum_final));
+    result.is_spikes_match = result.nb_spike_mismatches == 0;
+
+    return result;
+}
+
+ReplayResult ReplayHarness::Run(const ReplayGolden &golden, const string &path, double tolerance) const
+{
+    Record(path, golden.header, golden.nb_stimuli, golden.ticks_per_stimulus, golden.density);
+    return Replay(path, tolerance);
+}
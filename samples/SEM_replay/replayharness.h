@@ -0,0 +1,171 @@
+#ifndef REPLAYHARNESS_H_
+#define REPLAYHARNESS_H_
+
+#include <string>
+
+#include "elm/core/layerconfig.h"
+#include "sem/io/spikerecording.h"
+#include "sem/layers/layer_z.h"
+
+/**
+ * @brief LayerZ comparing the spikes of its WTA circuit against a recording
+ */
+class LayerZReplay : public LayerZ
+{
+public:
+    LayerZReplay();
+
+    using LayerZ::Activate;
+
+    /**
+     * @brief Activate layer and compare its output spikes against recorded ones
+     * @param signal with input spikes
+     * @param index of recorded WTA winner, -1 for none
+     * @return true if the layer produced the recorded spikes
+     * @throws ExceptionBadDims for recorded winner exceeding no. of neurons
+     */
+    bool Activate(const elm::Signal &signal, int winner);
+
+    /**
+     * @brief Checksum of current weights and bias
+     * @see WeightChecksum()
+     */
+    double Checksum() const;
+};
+
+/**
+ * @brief Results of a replay run
+ */
+struct ReplayResult
+{
+    ReplayResult();
+
+    unsigned long long nb_ticks;    ///< no. of replayed ticks
+    unsigned long long nb_spike_mismatches; ///< no. of ticks with output spikes deviating from the recording
+    double seconds;                 ///< time spent in layer computations
+    double checksum_initial;        ///< checksum of weights before replay
+    double checksum_final;          ///< checksum of weights after replay
+    double checksum_spikes;         ///< checksum of recorded WTA spikes, see SpikeChecksum()
+    bool is_initial_match;          ///< initial weights match the recording
+    bool is_final_match;            ///< final weights match the recording within tolerance
+    bool is_spikes_match;           ///< output spikes match the recording on every tick
+};
+
+/**
+ * @brief Reference run checked in with the sources, for detecting drift across builds
+ *
+ * Text file of "key value" lines, '#' starts a comment line.
+ * Holds the configuration of a synthetic run and the checksums it produced on a reference build.
+ */
+struct ReplayGolden
+{
+    ReplayGolden();
+
+    /**
+     * @brief Read golden run from file
+     * @param path to file
+     * @throws ExceptionFileIOError on failure to open file or missing entries
+     */
+    void Read(const std::string &path);
+
+    /**
+     * @brief Write golden run to file
+     * @param path to file
+     * @throws ExceptionFileIOError on failure to open file
+     */
+    void Write(const std::string &path) const;
+
+    /**
+     * @brief Compare replay results against golden run
+     * @param results of replaying a recording of the golden configuration
+     * @param relative tolerance for comparing weight checksums
+     * @return true on match, spikes are compared exactly
+     */
+    bool IsMatch(const ReplayResult &result, double tolerance) const;
+
+    SpikeRecordHeader header;       ///< configuration of layer and seed
+    int nb_stimuli;                 ///< no. of stimuli
+    int ticks_per_stimulus;         ///< no. of ticks per stimulus
+    float density;                  ///< fraction of afferents spiking per tick
+    unsigned long long nb_ticks;    ///< no. of ticks
+    double checksum_initial;        ///< checksum of weights before the first tick
+    double checksum_final;          ///< checksum of weights after the last tick
+    double checksum_spikes;         ///< checksum of WTA spikes, see SpikeChecksum()
+};
+
+/**
+ * @brief Checksum contribution of a tick's WTA spike, sum over all ticks for a run's checksum
+ *
+ * Winners are weighted by the tick's position, such that spikes shifted in time are detected as well.
+ *
+ * @param index of tick
+ * @param index of WTA winner, -1 for none
+ * @return checksum contribution
+ */
+double SpikeChecksum(unsigned long long tick, int winner);
+
+/**
+ * @brief Record a deterministic synthetic run through LayerZ and replay it headlessly
+ *
+ * Recording seeds cv::theRNG() before initializing the layer and
+ * generates input spikes from a separately seeded generator.
+ * Replay re-initializes the layer from the same seed,
+ * such that the WTA circuit reproduces the recorded spikes and the final weights.
+ * Any deviating spike is reported as drift.
+ *
+ * Recordings are only replayable if the layer had cv::theRNG() to itself while recording,
+ * as in Record() and SimulationSEM::Record() of the SEM_NIPS_2010 sample.
+ */
+class ReplayHarness
+{
+public:
+    static const std::string NAME_SPIKES_IN;
+    static const std::string NAME_SPIKES_OUT;
+
+    ReplayHarness();
+
+    /**
+     * @brief Record a synthetic run
+     *
+     * Each stimulus is one of few random prototypes, afferents spike
+     * following a Bernoulli distribution given by the prototype.
+     *
+     * @param path to recording file
+     * @param configuration of layer and seed
+     * @param no. of stimuli
+     * @param no. of ticks per stimulus
+     * @param fraction of afferents spiking per tick
+     * @return summary of recorded run
+     */
+    SpikeRecordSummary Record(const std::string &path,
+                              const SpikeRecordHeader &header,
+                              int nb_stimuli,
+                              int ticks_per_stimulus,
+                              float density) const;
+
+    /**
+     * @brief Replay recorded run
+     * @param path to recording file
+     * @param relative tolerance for comparing final checksum
+     * @return replay results
+     */
+    ReplayResult Replay(const std::string &path, double tolerance) const;
+
+    /**
+     * @brief Record and replay the configuration of a golden run
+     * @param golden run, only its configuration is used
+     * @param path to recording file
+     * @param relative tolerance for comparing final checksum of replay and recording
+     * @return replay results, to compare against the golden run
+     */
+    ReplayResult Run(const ReplayGolden &golden, const std::string &path, double tolerance) const;
+
+    /**
+     * @brief Create layer configuration from recording header
+     * @param header
+     * @return layer configuration
+     */
+    static elm::LayerConfig Config(const SpikeRecordHeader &header);
+};
+
+#endif // REPLAYHARNESS_H_
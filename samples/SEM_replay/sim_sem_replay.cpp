@@ -0,0 +1,239 @@
+/** @file Record and replay spike streams through LayerZ
+ *
+ * Deterministic end-to-end regression runs independent of MNIST.
+ *
+ * Usage:
+ *  SEM_replay record <file> [--stimuli N] [--ticks T] [--density P]
+ *                           [--afferents A] [--outputs O] [--history H]
+ *                           [--wta-f F] [--delta-t D] [--seed S]
+ *  SEM_replay replay <file> [--tolerance R] [--max-seconds S]
+ *  SEM_replay golden <golden> [record options] [--recording R]
+ *  SEM_replay verify <golden> [--recording R] [--tolerance R] [--max-seconds S]
+ *
+ * Replay reports throughput and the final weight checksum.
+ * It exits with non-zero status on behavior drift (checksum or spike mismatch)
+ * or on exceeding the optional time budget (slowdown).
+ *
+ * golden records and replays a run with the portable scalar kernels and writes its checksums,
+ * verify repeats the golden run's configuration and compares against these checksums,
+ * such that drift across builds is detected, not only between recording and replay of the same build.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "elm/core/core.h"
+#include "sem/neuron/simdkernels.h"
+#include "replayharness.h"
+
+using namespace std;
+
+namespace {
+
+const int EXIT_DRIFT    = 1;
+const int EXIT_SLOWDOWN = 2;
+const int EXIT_USAGE    = 3;
+
+int Usage()
+{
+    cerr << "Usage:" << endl
+         << "  SEM_replay record <file> [--stimuli N] [--ticks T] [--density P]" << endl
+         << "                           [--afferents A] [--outputs O] [--history H]" << endl
+         << "                           [--wta-f F] [--delta-t D] [--seed S]" << endl
+         << "  SEM_replay replay <file> [--tolerance R] [--max-seconds S]" << endl
+         << "  SEM_replay golden <golden> [record options] [--recording R]" << endl
+         << "  SEM_replay verify <golden> [--recording R] [--tolerance R] [--max-seconds S]" << endl;
+    return EXIT_USAGE;
+}
+
+/**
+ * @brief parse --key value pairs
+ * @return false on malformed arguments
+ */
+bool ParseOptions(int argc, char **argv, int start, map<string, string> &options)
+{
+    for(int i=start; i<argc; i+=2) {
+
+        string key(argv[i]);
+        if(key.compare(0, 2, "--") != 0 || i+1 >= argc) {
+
+            return false;
+        }
+        options[key.substr(2)] = argv[i+1];
+    }
+    return true;
+}
+
+double Get(const map<string, string> &options, const string &key, double default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? atof(itr->second.c_str()) : default_value;
+}
+
+string Get(const map<string, string> &options, const string &key, const string &default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? itr->second : default_value;
+}
+
+/**
+ * @brief get configuration of synthetic run from record options
+ */
+ReplayGolden GetRun(const map<string, string> &options)
+{
+    ReplayGolden run;
+    run.header.nb_afferents = static_cast<int>(Get(options, "afferents", 784));
+    run.header.nb_outputs   = static_cast<int>(Get(options, "outputs", 40));
+    run.header.len_history  = static_cast<int>(Get(options, "history", 10));
+    run.header.wta_f        = static_cast<float>(Get(options, "wta-f", 100.));
+    run.header.delta_t      = static_cast<float>(Get(options, "delta-t", 1.));
+    run.header.seed         = static_cast<unsigned long long>(Get(options, "seed", 2010));
+
+    run.nb_stimuli          = static_cast<int>(Get(options, "stimuli", 200));
+    run.ticks_per_stimulus  = static_cast<int>(Get(options, "ticks", 20));
+    run.density             = static_cast<float>(Get(options, "density", 0.1));
+    return run;
+}
+
+void Print(const ReplayResult &result)
+{
+    cout<<"Replayed "<<result.nb_ticks<<" ticks in "<<result.seconds<<" s"<<endl;
+    cout<<"throughput: "<<((result.seconds > 0.)? result.nb_ticks/result.seconds : 0.)<<" ticks/s"<<endl;
+    cout.precision(17);
+    cout<<"checksum initial: "<<result.checksum_initial<<endl;
+    cout<<"checksum final:   "<<result.checksum_final<<endl;
+    cout<<"checksum spikes:  "<<result.checksum_spikes<<endl;
+}
+
+/**
+ * @brief check replay for drift against its recording
+ * @return exit status
+ */
+int CheckDrift(const ReplayResult &result)
+{
+    if(!result.is_initial_match) {
+
+        cerr<<"Behavior drift: initial weights differ from recording."<<endl;
+        return EXIT_DRIFT;
+    }
+
+    if(!result.is_spikes_match) {
+
+        cerr<<"Behavior drift: output spikes differ from recording on "
+            <<result.nb_spike_mismatches<<" ticks."<<endl;
+        return EXIT_DRIFT;
+    }
+
+    if(!result.is_final_match) {
+
+        cerr<<"Behavior drift: final weights differ from recording."<<endl;
+        return EXIT_DRIFT;
+    }
+    return 0;
+}
+
+} // annonymous namespace
+
+int main(int argc, char **argv) {
+
+    cout<<elm::GetVersion()<<endl;
+
+    map<string, string> options;
+    if(argc < 3 || !ParseOptions(argc, argv, 3, options)) {
+
+        return Usage();
+    }
+
+    const string mode(argv[1]);
+    const string path(argv[2]);
+    ReplayHarness harness;
+
+    const double tolerance   = Get(options, "tolerance", 1e-6);
+    const double max_seconds = Get(options, "max-seconds", -1.);
+    const string recording   = Get(options, "recording", string("sem_replay.bin"));
+
+    if(mode == "record") {
+
+        ReplayGolden run = GetRun(options);
+        SpikeRecordSummary summary = harness.Record(path, run.header, run.nb_stimuli, run.ticks_per_stimulus, run.density);
+
+        cout<<"Recorded "<<summary.nb_ticks<<" ticks, "
+            <<summary.nb_spikes<<" WTA spikes to "<<path<<endl;
+        cout.precision(17);
+        cout<<"checksum initial: "<<summary.checksum_initial<<endl;
+        cout<<"checksum final:   "<<summary.checksum_final<<endl;
+    }
+    else if(mode == "golden") {
+
+        SIMDKernels::Select(SIMDKernels::SCALAR); // reference results, independent of the host's instruction set
+
+        ReplayGolden golden = GetRun(options);
+        ReplayResult result = harness.Run(golden, recording, tolerance);
+        Print(result);
+
+        int status = CheckDrift(result);
+        if(status != 0) {
+
+            return status;
+        }
+
+        golden.nb_ticks         = result.nb_ticks;
+        golden.checksum_initial = result.checksum_initial;
+        golden.checksum_final   = result.checksum_final;
+        golden.checksum_spikes  = result.checksum_spikes;
+        golden.Write(path);
+
+        cout<<"Wrote golden run to "<<path<<endl;
+    }
+    else if(mode == "verify") {
+
+        SIMDKernels::Select(SIMDKernels::SCALAR); // same kernels as the golden run
+
+        ReplayGolden golden;
+        golden.Read(path);
+        ReplayResult result = harness.Run(golden, recording, tolerance);
+        Print(result);
+
+        int status = CheckDrift(result);
+        if(status != 0) {
+
+            return status;
+        }
+
+        if(!golden.IsMatch(result, tolerance)) {
+
+            cerr<<"Behavior drift: results differ from golden run "<<path<<endl;
+            return EXIT_DRIFT;
+        }
+
+        if(max_seconds > 0. && result.seconds > max_seconds) {
+
+            cerr<<"Slowdown: replay took longer than "<<max_seconds<<" s."<<endl;
+            return EXIT_SLOWDOWN;
+        }
+    }
+    else if(mode == "replay") {
+
+        ReplayResult result = harness.Replay(path, tolerance);
+        Print(result);
+
+        int status = CheckDrift(result);
+        if(status != 0) {
+
+            return status;
+        }
+
+        if(max_seconds > 0. && result.seconds > max_seconds) {
+
+            cerr<<"Slowdown: replay took longer than "<<max_seconds<<" s."<<endl;
+            return EXIT_SLOWDOWN;
+        }
+    }
+    else {
+
+        return Usage();
+    }
+
+    return 0;
+}
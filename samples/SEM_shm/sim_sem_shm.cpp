@@ -0,0 +1,263 @@
+/** @file Train LayerZ with several worker processes sharing their weights through POSIX shared memory
+ *
+ * The coordinator creates the shared weights segment, forks the workers and
+ * checkpoints the segment periodically until all workers are done.
+ * Each worker streams its own shard of synthetic stimuli through its own layer
+ * and pushes what it learned into the segment every few stimuli (see SharedWeights).
+ * The checkpoint can be inspected with ReadWeightsCheckpoint().
+ *
+ * Usage:
+ *  SEM_shm [--workers W] [--afferents A] [--clusters K] [--sparsity S] [--noise N]
+ *          [--stimuli N] [--ticks T] [--outputs O] [--push-every P]
+ *          [--checkpoint PATH] [--checkpoint-sec C] [--seed S]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/core.h"
+#include "elm/core/exception.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "sem/layers/layer_z.h"
+#include "sem/shm/sharedweights.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int EXIT_USAGE = 3;
+
+const string NAME_SPIKES_IN  = "spikes_in";
+const string NAME_SPIKES_OUT = "spikes_out";
+
+int Usage()
+{
+    cerr << "Usage:" << endl
+         << "  SEM_shm [--workers W] [--afferents A] [--clusters K] [--sparsity S] [--noise N]" << endl
+         << "          [--stimuli N] [--ticks T] [--outputs O] [--push-every P]" << endl
+         << "          [--checkpoint PATH] [--checkpoint-sec C] [--seed S]" << endl;
+    return EXIT_USAGE;
+}
+
+/**
+ * @brief parse --key value pairs
+ * @return false on malformed arguments
+ */
+bool ParseOptions(int argc, char **argv, int start, map<string, string> &options)
+{
+    for(int i=start; i<argc; i+=2) {
+
+        string key(argv[i]);
+        if(key.compare(0, 2, "--") != 0 || i+1 >= argc) {
+
+            return false;
+        }
+        options[key.substr(2)] = argv[i+1];
+    }
+    return true;
+}
+
+double Get(const map<string, string> &options, const string &key, double default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? atof(itr->second.c_str()) : default_value;
+}
+
+string Get(const map<string, string> &options, const string &key, const string &default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? itr->second : default_value;
+}
+
+/**
+ * @brief Worker's settings, identical across workers except for the shard
+ */
+struct WorkerSettings
+{
+    string name;            ///< name of shared weights segment
+    LayerConfig cfg;        ///< layer configuration
+    Mat1f prototypes;       ///< binary cluster prototypes, one row per cluster
+    float noise;            ///< probability of flipping an afferent per stimulus
+    int nb_stimuli;         ///< no. of stimuli per worker
+    int ticks;              ///< no. of ticks per stimulus
+    int push_every;         ///< no. of stimuli between pushes
+    unsigned long long seed;///< seed of worker's shard
+};
+
+/**
+ * @brief Learn on own shard of stimuli, pushing to shared weights
+ * @param settings
+ * @return exit status of worker process
+ */
+int Work(const WorkerSettings &settings)
+{
+    try {
+
+        SharedWeights shared;
+        shared.Attach(settings.name);
+
+        RNG rng(settings.seed);
+        theRNG() = RNG(settings.seed+1);
+
+        LayerZ layer;
+        layer.Reset(settings.cfg);
+        layer.IONames(settings.cfg);
+        shared.Pull(layer); // start from coordinator's weights
+
+        Signal signal;
+        Mat1f spikes_in(1, settings.prototypes.cols);
+        for(int s=0; s<settings.nb_stimuli; s++) {
+
+            const Mat1f prototype = settings.prototypes.row(rng.uniform(0, settings.prototypes.rows));
+            for(int i=0; i<spikes_in.cols; i++) {
+
+                const bool is_flipped = rng.uniform(0.f, 1.f) < settings.noise;
+                spikes_in(i) = is_flipped? 1.f-prototype(i) : prototype(i);
+            }
+
+            for(int t=0; t<settings.ticks; t++) {
+
+                signal.Clear();
+                signal.Append(NAME_SPIKES_IN, spikes_in);
+                layer.Activate(signal);
+                layer.Learn();
+            }
+            layer.Clear();
+
+            if((s+1) % settings.push_every == 0 || s+1 == settings.nb_stimuli) {
+
+                shared.Push(layer);
+            }
+        }
+    }
+    catch(const std::exception &e) {
+
+        cerr << "worker " << getpid() << ": " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // annonymous namespace
+
+int main(int argc, char **argv) {
+
+    typedef chrono::steady_clock Clock;
+
+    cout<<elm::GetVersion()<<endl;
+
+    map<string, string> options;
+    if(!ParseOptions(argc, argv, 1, options)) {
+
+        return Usage();
+    }
+
+    const int nb_workers    = max(1, static_cast<int>(Get(options, "workers", 4)));
+    const int nb_afferents  = static_cast<int>(Get(options, "afferents", 784));
+    const int nb_clusters   = static_cast<int>(Get(options, "clusters", 10));
+    const float sparsity    = static_cast<float>(Get(options, "sparsity", 0.1));
+    const int nb_outputs    = static_cast<int>(Get(options, "outputs", 40));
+    const string path       = Get(options, "checkpoint", string("sem_weights.bin"));
+    const double checkpoint_sec = Get(options, "checkpoint-sec", 5.);
+    const unsigned long long seed = static_cast<unsigned long long>(Get(options, "seed", 2010));
+
+    WorkerSettings settings;
+    settings.noise          = static_cast<float>(Get(options, "noise", 0.05));
+    settings.nb_stimuli     = static_cast<int>(Get(options, "stimuli", 1000));
+    settings.ticks          = static_cast<int>(Get(options, "ticks", 20));
+    settings.push_every     = max(1, static_cast<int>(Get(options, "push-every", 10)));
+
+    PTree params;
+    params.put(LayerZ::PARAM_NB_AFFERENTS, nb_afferents);
+    params.put(LayerZ::PARAM_NB_OUTPUT_NODES, nb_outputs);
+    settings.cfg.Params(params);
+    settings.cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_SPIKES_IN);
+    settings.cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_SPIKES_OUT);
+
+    // all workers learn the same clusters
+    RNG rng(seed);
+    settings.prototypes = Mat1f(nb_clusters, nb_afferents);
+    rng.fill(settings.prototypes, RNG::UNIFORM, 0.f, 1.f);
+    settings.prototypes = static_cast<Mat1f>(settings.prototypes < sparsity)/255.f;
+
+    stringstream s;
+    s << "/sem_weights_" << getpid();
+    settings.name = s.str();
+
+    theRNG() = RNG(seed+1);
+    LayerZ layer;
+    layer.Reset(settings.cfg);
+
+    SharedWeights shared;
+    shared.Create(settings.name, layer.WeightsAll());
+
+    cout<<"workers: "<<nb_workers<<", afferents: "<<nb_afferents<<", clusters: "<<nb_clusters
+        <<", outputs: "<<nb_outputs<<", segment: "<<settings.name<<endl;
+
+    vector<pid_t> pids;
+    for(int w=0; w<nb_workers; w++) {
+
+        settings.seed = seed+2*(w+1); // own shard
+        pid_t pid = fork();
+        if(pid == 0) {
+
+            _exit(Work(settings));
+        }
+        else if(pid < 0) {
+
+            cerr << "Failed to fork worker " << w << endl;
+            break;
+        }
+        pids.push_back(pid);
+    }
+
+    // checkpoint periodically until all workers are done
+    int nb_failed = 0;
+    size_t nb_running = pids.size();
+    Clock::time_point t0 = Clock::now();
+    Clock::time_point last_checkpoint = t0;
+    while(nb_running > 0) {
+
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if(pid > 0) {
+
+            nb_running--;
+            if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+
+                nb_failed++;
+            }
+            continue;
+        }
+
+        if(chrono::duration<double>(Clock::now()-last_checkpoint).count() >= checkpoint_sec) {
+
+            last_checkpoint = Clock::now();
+            cout<<"checkpoint: version "<<shared.Checkpoint(path)
+                <<" after "<<chrono::duration<double>(last_checkpoint-t0).count()<<" s"<<endl;
+        }
+        usleep(10000);
+    }
+
+    const unsigned long long version = shared.Checkpoint(path);
+    SharedWeights::Unlink(settings.name);
+
+    cout<<"Wrote version "<<version<<" to "<<path
+        <<" after "<<chrono::duration<double>(Clock::now()-t0).count()<<" s"
+        <<", failed workers: "<<nb_failed<<endl;
+
+    return (nb_failed == 0 && pids.size() == static_cast<size_t>(nb_workers))? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/** @file Sweep LayerZ hyperparameters in a single pass over MNIST
+ *
+ * Each image is read and encoded into input spikes once,
+ * the same spike raster is then presented to one LayerZ per grid point,
+ * all grid points running in parallel (see LayerZSweep).
+ * Each value list is comma-separated, the grid is their cartesian product.
+ * Input spikes are encoded at 1 msec per tick irrespective of the swept delta_t.
+ *
+ * Usage:
+ *  SEM_sweep --images PATH --labels PATH
+ *            [--wta-f F,...] [--history H,...] [--delta-t D,...] [--outputs O,...]
+ *            [--ticks T] [--presentation-spikes K] [--presentation-confidence P]
+ *            [--stimuli N] [--report-every N] [--seed S]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/core.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "elm/encoding/populationcode_derivs/mutex_populationcode.h"
+#include "elm/io/readmnist.h"
+#include "elm/layers/layer_y.h"
+#include "sem/layers/layerfactorysem.h"
+#include "sem/layers/layerzsweep.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int EXIT_USAGE = 3;
+
+const string NAME_STIMULUS  = "stimulus";
+const string NAME_POP_CODE  = "pc";
+const string NAME_SPIKES_Y  = "y";
+
+const int NB_LABELS = 10;
+
+int Usage()
+{
+    cerr << "Usage:" << endl
+         << "  SEM_sweep --images PATH --labels PATH" << endl
+         << "            [--wta-f F,...] [--history H,...] [--delta-t D,...] [--outputs O,...]" << endl
+         << "            [--ticks T] [--presentation-spikes K] [--presentation-confidence P]" << endl
+         << "            [--stimuli N] [--report-every N] [--seed S]" << endl;
+    return EXIT_USAGE;
+}
+
+/**
+ * @brief parse --key value pairs
+ * @return false on malformed arguments
+ */
+bool ParseOptions(int argc, char **argv, int start, map<string, string> &options)
+{
+    for(int i=start; i<argc; i+=2) {
+
+        string key(argv[i]);
+        if(key.compare(0, 2, "--") != 0 || i+1 >= argc) {
+
+            return false;
+        }
+        options[key.substr(2)] = argv[i+1];
+    }
+    return true;
+}
+
+double Get(const map<string, string> &options, const string &key, double default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? atof(itr->second.c_str()) : default_value;
+}
+
+string Get(const map<string, string> &options, const string &key, const string &default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? itr->second : default_value;
+}
+
+/**
+ * @brief Sweep axis from a comma-separated list of values
+ * @param layer parameter key
+ * @param comma-separated values
+ * @return axis
+ */
+LayerZSweep::Axis SplitAxis(const string &key, const string &values)
+{
+    LayerZSweep::Axis axis;
+    axis.first = key;
+
+    stringstream s(values);
+    string value;
+    while(getline(s, value, ',')) {
+
+        if(!value.empty()) {
+
+            axis.second.push_back(value);
+        }
+    }
+    return axis;
+}
+
+string Describe(const PTree &params)
+{
+    stringstream s;
+    s << "wta_f: " << params.get<string>(LayerZ::PARAM_WTA_FREQ)
+      << ", history: " << params.get<string>(LayerZ::PARAM_LEN_HISTORY)
+      << ", delta_t: " << params.get<string>(LayerZ::PARAM_DELTA_T)
+      << ", outputs: " << params.get<string>(LayerZ::PARAM_NB_OUTPUT_NODES);
+    return s.str();
+}
+
+void PrintEvaluation(const LayerZSweep &sweep)
+{
+    for(int i=0; i<sweep.NbInstances(); i++) {
+
+        const OnlineClusterEval &eval = sweep.Evaluation(i);
+        const PresentationController &presentation = sweep.Presentation(i);
+        cout<<"  ["<<i<<"] "<<Describe(sweep.Params(i))
+            <<" | WTA spikes: "<<eval.NbSamples()
+            <<", H(label|winner): "<<eval.ConditionalEntropy()<<" bits"
+            <<", accuracy: "<<eval.Accuracy()
+            <<", ticks/stimulus: "<<presentation.TotalTicks()/static_cast<double>(max(1ULL, presentation.NbPresentations()))
+            <<endl;
+    }
+}
+
+} // annonymous namespace
+
+int main(int argc, char **argv) {
+
+    typedef chrono::steady_clock Clock;
+
+    cout<<elm::GetVersion()<<endl;
+
+    map<string, string> options;
+    if(!ParseOptions(argc, argv, 1, options) ||
+            options.find("images") == options.end() ||
+            options.find("labels") == options.end()) {
+
+        return Usage();
+    }
+
+    const int ticks         = static_cast<int>(Get(options, "ticks", 20));
+    const int presentation_spikes = static_cast<int>(Get(options, "presentation-spikes", 0));
+    const float presentation_confidence = static_cast<float>(Get(options, "presentation-confidence", 0.));
+    const int nb_stimuli    = static_cast<int>(Get(options, "stimuli", -1));
+    const int report_every  = max(1, static_cast<int>(Get(options, "report-every", 1000)));
+    const unsigned long long seed = static_cast<unsigned long long>(Get(options, "seed", 2010));
+
+    ReadMNISTImages r;
+    r.ReadHeader(Get(options, "images", string()).c_str());
+
+    ReadMNISTLabels r_labels;
+    r_labels.ReadHeader(Get(options, "labels", string()).c_str());
+
+    // encoding, shared by all grid points
+    LayerConfig cfg_pc;
+    cfg_pc.Input(MutexPopulationCode::KEY_INPUT_STIMULUS, NAME_STIMULUS);
+    cfg_pc.Output(MutexPopulationCode::KEY_OUTPUT_POP_CODE, NAME_POP_CODE);
+    LayerShared pop_code = LayerFactorySEM::CreateShared("MutexPopulationCode", cfg_pc, cfg_pc);
+
+    PTree params_y;
+    params_y.put(LayerY::PARAM_FREQ, 1000.f);
+    params_y.put(LayerY::PARAM_DELTA_T_MSEC, 1.f);
+    LayerConfig cfg_y;
+    cfg_y.Params(params_y);
+    LayerIONames io_y;
+    io_y.Input(LayerY::KEY_INPUT_STIMULUS, NAME_POP_CODE);
+    io_y.Output(LayerY::KEY_OUTPUT_RESPONSE, NAME_SPIKES_Y);
+    LayerShared y = LayerFactorySEM::CreateShared("LayerY", cfg_y, io_y);
+
+    vector<LayerZSweep::Axis> axes;
+    axes.push_back(SplitAxis(LayerZ::PARAM_WTA_FREQ, Get(options, "wta-f", string("1000"))));
+    axes.push_back(SplitAxis(LayerZ::PARAM_LEN_HISTORY, Get(options, "history", string("10"))));
+    axes.push_back(SplitAxis(LayerZ::PARAM_DELTA_T, Get(options, "delta-t", string("1"))));
+    axes.push_back(SplitAxis(LayerZ::PARAM_NB_OUTPUT_NODES, Get(options, "outputs", string("40"))));
+
+    LayerZSweep sweep;
+    Signal sig;
+    Mat1f raster;
+
+    theRNG() = RNG(seed);
+
+    double seconds_encode = 0.;
+    double seconds_sweep = 0.;
+    int s = 0;
+    while(!r.Is_EOF() && (nb_stimuli < 0 || s < nb_stimuli)) {
+
+        Clock::time_point t0 = Clock::now();
+
+        sig.Clear();
+
+        Mat1f img = r.Next();
+
+        Mat label;
+        r_labels.Next().convertTo(label, CV_32S);
+
+        sig.Append(NAME_STIMULUS, img);
+
+        pop_code->Activate(sig);
+        pop_code->Response(sig);
+
+        // encode once for all grid points
+        for(int t=0; t<ticks; t++) {
+
+            y->Activate(sig);
+            y->Response(sig);
+
+            Mat1f spikes_y = sig.MostRecentMat1f(NAME_SPIKES_Y);
+            if(raster.empty()) {
+
+                raster = Mat1f(ticks, static_cast<int>(spikes_y.total()));
+            }
+            spikes_y.reshape(1, 1).copyTo(raster.row(t));
+        }
+
+        if(sweep.NbInstances() == 0) {
+
+            PTree base;
+            base.put(LayerZ::PARAM_NB_AFFERENTS, raster.cols);
+            sweep.Reset(LayerZSweep::Grid(base, axes), NB_LABELS,
+                        PresentationController(ticks, presentation_spikes, presentation_confidence));
+
+            cout<<"Sweeping "<<sweep.NbInstances()<<" configurations over "<<raster.cols<<" afferents."<<endl;
+        }
+
+        Clock::time_point t1 = Clock::now();
+        sweep.Present(raster, label.at<int>(0));
+        Clock::time_point t2 = Clock::now();
+
+        seconds_encode += chrono::duration<double>(t1-t0).count();
+        seconds_sweep += chrono::duration<double>(t2-t1).count();
+
+        if(++s % report_every == 0) {
+
+            cout<<"stimuli: "<<s<<endl;
+            PrintEvaluation(sweep);
+        }
+    }
+
+    cout<<"Presented "<<s<<" stimuli, encoding: "<<seconds_encode<<" s"
+        <<", sweep: "<<seconds_sweep<<" s"<<endl;
+    PrintEvaluation(sweep);
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+/** @file Stream synthetic spiking stimuli through LayerZ
+ *
+ * Measures throughput and convergence at scales beyond MNIST,
+ * without requiring any dataset on disk.
+ *
+ * Usage:
+ *  SEM_synthetic [--afferents A] [--clusters K] [--sparsity S] [--noise N]
+ *                [--mode bernoulli|poisson] [--rate R]
+ *                [--stimuli N] [--ticks T] [--presentation-spikes K] [--presentation-confidence P]
+ *                [--outputs O] [--history H]
+ *                [--wta-f F] [--delta-t D] [--adaptive-rate 0|1] [--event-driven 0|1] [--seed S] [--report-every N]
+ *                [--stop-threshold R] [--stop-patience N] [--stop-warm-up N]
+ *
+ * Convergence is reported by an online evaluation of WTA spikes against the ground-truth clusters,
+ * as the conditional entropy of clusters given the winning neuron and
+ * the accuracy of assigning each neuron its majority cluster.
+ * Each stimulus is presented for up to T ticks, or until K WTA spikes
+ * or a confident posterior over neurons when enabled.
+ * With a stop threshold, streaming ends early once the layer's weight change rate
+ * stayed below it for a no. of consecutive stimuli.
+ * Finally reports accuracy of 8 and 16-bit quantized weights against float.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "elm/core/core.h"
+#include "elm/core/layerconfig.h"
+#include "elm/core/signal.h"
+#include "sem/eval/convergencemonitor.h"
+#include "sem/eval/onlineclustereval.h"
+#include "sem/layers/layer_z.h"
+#include "sem/layers/presentationcontroller.h"
+#include "sem/layers/quantizedweights.h"
+#include "syntheticspikes.h"
+
+using namespace std;
+using namespace cv;
+using namespace elm;
+
+namespace {
+
+const int EXIT_USAGE = 3;
+
+const string NAME_SPIKES_IN  = "spikes_in";
+const string NAME_SPIKES_OUT = "spikes_out";
+
+const int NB_QUANTIZATION_SAMPLES = 1000; ///< no. of stimuli for comparing quantized against float potentials
+
+int Usage()
+{
+    cerr << "Usage:" << endl
+         << "  SEM_synthetic [--afferents A] [--clusters K] [--sparsity S] [--noise N]" << endl
+         << "                [--mode bernoulli|poisson] [--rate R]" << endl
+         << "                [--stimuli N] [--ticks T] [--presentation-spikes K] [--presentation-confidence P]" << endl
+         << "                [--outputs O] [--history H]" << endl
+         << "                [--wta-f F] [--delta-t D] [--adaptive-rate 0|1] [--event-driven 0|1] [--seed S] [--report-every N]" << endl
+         << "                [--stop-threshold R] [--stop-patience N] [--stop-warm-up N]" << endl;
+    return EXIT_USAGE;
+}
+
+/**
+ * @brief parse --key value pairs
+ * @return false on malformed arguments
+ */
+bool ParseOptions(int argc, char **argv, int start, map<string, string> &options)
+{
+    for(int i=start; i<argc; i+=2) {
+
+        string key(argv[i]);
+        if(key.compare(0, 2, "--") != 0 || i+1 >= argc) {
+
+            return false;
+        }
+        options[key.substr(2)] = argv[i+1];
+    }
+    return true;
+}
+
+double Get(const map<string, string> &options, const string &key, double default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? atof(itr->second.c_str()) : default_value;
+}
+
+string Get(const map<string, string> &options, const string &key, const string &default_value)
+{
+    map<string, string>::const_iterator itr = options.find(key);
+    return (itr != options.end())? itr->second : default_value;
+}
+
+} // annonymous namespace
+
+int main(int argc, char **argv) {
+
+    typedef chrono::steady_clock Clock;
+
+    cout<<elm::GetVersion()<<endl;
+
+    map<string, string> options;
+    if(!ParseOptions(argc, argv, 1, options)) {
+
+        return Usage();
+    }
+
+    const int nb_afferents  = static_cast<int>(Get(options, "afferents", 784));
+    const int nb_clusters   = static_cast<int>(Get(options, "clusters", 10));
+    const float sparsity    = static_cast<float>(Get(options, "sparsity", 0.1));
+    const float noise       = static_cast<float>(Get(options, "noise", 0.1));
+    const float rate        = static_cast<float>(Get(options, "rate", 40.));
+    const int nb_stimuli    = static_cast<int>(Get(options, "stimuli", 1000));
+    const int ticks         = static_cast<int>(Get(options, "ticks", 20));
+    const int presentation_spikes = static_cast<int>(Get(options, "presentation-spikes", 0));
+    const float presentation_confidence = static_cast<float>(Get(options, "presentation-confidence", 0.));
+    const int nb_outputs    = static_cast<int>(Get(options, "outputs", 40));
+    const int len_history   = static_cast<int>(Get(options, "history", 10));
+    const float wta_f       = static_cast<float>(Get(options, "wta-f", 1000.));
+    const float delta_t     = static_cast<float>(Get(options, "delta-t", 1.));
+    const bool is_adaptive_rate = Get(options, "adaptive-rate", 0.) != 0.;
+    const bool is_event_driven = Get(options, "event-driven", 0.) != 0.;
+    const unsigned long long seed = static_cast<unsigned long long>(Get(options, "seed", 2010));
+    const int report_every  = max(1, static_cast<int>(Get(options, "report-every", 100)));
+    const float stop_threshold = static_cast<float>(Get(options, "stop-threshold", 0.));
+    const int stop_patience = static_cast<int>(Get(options, "stop-patience", 100));
+    const int stop_warm_up  = static_cast<int>(Get(options, "stop-warm-up", 100));
+
+    SyntheticSpikes generator(nb_afferents, nb_clusters, sparsity, noise, seed);
+    generator.Presentation(SyntheticSpikes::ParseMode(Get(options, "mode", string("bernoulli"))),
+                           rate, delta_t);
+
+    PTree params;
+    params.put(LayerZ::PARAM_NB_AFFERENTS, nb_afferents);
+    params.put(LayerZ::PARAM_NB_OUTPUT_NODES, nb_outputs);
+    params.put(LayerZ::PARAM_LEN_HISTORY, len_history);
+    params.put(LayerZ::PARAM_WTA_FREQ, wta_f);
+    params.put(LayerZ::PARAM_DELTA_T, delta_t);
+    params.put(LayerZ::PARAM_ADAPTIVE_RATE, is_adaptive_rate);
+    params.put(LayerZ::PARAM_EVENT_DRIVEN, is_event_driven);
+
+    LayerConfig cfg;
+    cfg.Params(params);
+    cfg.Input(LayerZ::KEY_INPUT_SPIKES, NAME_SPIKES_IN);
+    cfg.Output(LayerZ::KEY_OUTPUT_SPIKES, NAME_SPIKES_OUT);
+
+    theRNG() = RNG(seed+1); // layer weights independent of generated stimuli
+    LayerZ layer;
+    layer.Reset(cfg);
+    layer.IONames(cfg);
+
+    cout<<"afferents: "<<nb_afferents<<", clusters: "<<nb_clusters
+        <<", sparsity: "<<sparsity<<", noise: "<<noise<<endl;
+
+    OnlineClusterEval eval(nb_outputs, nb_clusters);
+    ConvergenceMonitor convergence(stop_threshold, stop_patience, stop_warm_up);
+    PresentationController presentation(ticks, presentation_spikes, presentation_confidence);
+
+    Signal signal;
+    Mat1f spikes_in;
+
+    double seconds = 0.;
+    unsigned long long nb_ticks = 0;
+    for(int s=0; s<nb_stimuli; s++) {
+
+        const int label = generator.NextStimulus();
+
+        presentation.Start();
+        bool is_done = false;
+        while(!is_done) {
+
+            generator.NextTick(spikes_in);
+
+            signal.Clear();
+            signal.Append(NAME_SPIKES_IN, spikes_in);
+
+            Clock::time_point t0 = Clock::now();
+            layer.Activate(signal);
+            layer.Response(signal);
+            layer.Learn();
+            seconds += chrono::duration<double>(Clock::now()-t0).count();
+
+            eval.Update(signal.MostRecentMat1f(NAME_SPIKES_OUT), label);
+            nb_ticks++;
+
+            is_done = presentation.Tick(layer.Spikes(),
+                                        presentation.NeedsStateDistr()? layer.StateDistr() : Mat1f());
+        }
+
+        layer.Clear();
+
+        const bool is_converged = convergence.Check(layer.WeightChangeRate());
+
+        if((s+1) % report_every == 0 || is_converged) {
+
+            cout<<"stimuli: "<<s+1
+                <<", throughput: "<<((seconds > 0.)? nb_ticks/seconds : 0.)<<" ticks/s"
+                <<", ticks/stimulus: "<<nb_ticks/static_cast<double>(s+1)
+                <<", WTA spikes: "<<eval.NbSamples()
+                <<", H(cluster|winner): "<<eval.ConditionalEntropy()<<" bits"
+                <<", accuracy: "<<eval.Accuracy()
+                <<", weight change rate: "<<layer.WeightChangeRate()
+                <<endl;
+        }
+
+        if(is_converged) {
+
+            cout<<"Converged after "<<s+1<<" stimuli."<<endl;
+            break;
+        }
+    }
+
+    cout<<"Processed "<<nb_ticks<<" ticks in "<<seconds<<" s"<<endl;
+
+    // accuracy of integer inference against float potentials
+    layer.Flush();
+    const Mat1f weights = layer.Weights();
+    const Mat1f bias = layer.Bias();
+
+    const int DEPTHS[] = {QuantizedWeights::DEPTH_8, QuantizedWeights::DEPTH_16};
+    QuantizedWeights q[2];
+    QuantizationReport reports[2];
+    for(int d=0; d<2; d++) {
+
+        q[d] = layer.Quantize(DEPTHS[d]);
+    }
+
+    // one sample at a time, such that memory does not grow with the no. of afferents times samples
+    for(int r=0; r<NB_QUANTIZATION_SAMPLES; r++) {
+
+        generator.NextStimulus();
+        generator.NextTick(spikes_in);
+        for(int d=0; d<2; d++) {
+
+            q[d].Compare(weights, bias, spikes_in.reshape(1, 1), reports[d]);
+        }
+    }
+
+    for(int d=0; d<2; d++) {
+
+        cout<<DEPTHS[d]<<"-bit weights: "<<q[d].NbBytes()<<" bytes"
+            <<" ("<<weights.total()*sizeof(float)<<" as float)"
+            <<", max. |u error|: "<<reports[d].max_abs_error
+            <<", mean |u error|: "<<reports[d].mean_abs_error
+            <<", winner agreement: "<<reports[d].winner_agreement
+            <<endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "syntheticspikes.h"
+
+#include <cmath>
+
+#include "elm/core/exception.h"
+
+using namespace std;
+using namespace cv;
+
+SyntheticSpikes::SyntheticSpikes(int nb_afferents, int nb_clusters, float sparsity, float noise, unsigned long long seed)
+    : nb_afferents_(nb_afferents),
+      noise_(noise),
+      rng_(seed),
+      label_(-1),
+      mode_(MODE_BERNOULLI),
+      p_spike_(1.f)
+{
+    if(nb_afferents < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of afferents must be > 0");
+    }
+
+    if(nb_clusters < 1) {
+
+        ELM_THROW_VALUE_ERROR("No. of clusters must be > 0");
+    }
+
+    if(sparsity <= 0.f || sparsity > 1.f) {
+
+        ELM_THROW_VALUE_ERROR("Sparsity must be in (0, 1]");
+    }
+
+    if(noise < 0.f || noise > 1.f) {
+
+        ELM_THROW_VALUE_ERROR("Noise must be in [0, 1]");
+    }
+
+    mark_.assign(nb_afferents_, 0);
+
+    const int nb_active = max(1, static_cast<int>(sparsity*nb_afferents_));
+    prototypes_.resize(nb_clusters);
+    for(int k=0; k<nb_clusters; k++) {
+
+        SampleIndices(nb_active, prototypes_[k]);
+    }
+}
+
+void SyntheticSpikes::Presentation(Mode mode, float rate, float delta_t_msec)
+{
+    if(mode == MODE_POISSON && (rate < 0.f || delta_t_msec <= 0.f)) {
+
+        ELM_THROW_VALUE_ERROR("Rate must be >= 0 and time resolution > 0");
+    }
+
+    mode_ = mode;
+    p_spike_ = (mode == MODE_POISSON)? 1.f-exp(-rate*delta_t_msec*1e-3f) : 1.f;
+}
+
+void SyntheticSpikes::SampleIndices(int n, vector<int> &indices)
+{
+    // Floyd's algorithm for sampling n distinct values in O(n)
+    indices.clear();
+    for(int j=nb_afferents_-n; j<nb_afferents_; j++) {
+
+        int t = rng_.uniform(0, j+1);
+        if(mark_[t] != 0) {
+
+            t = j;
+        }
+        mark_[t] = 1;
+        indices.push_back(t);
+    }
+
+    for(size_t i=0; i<indices.size(); i++) {
+
+        mark_[indices[i]] = 0;
+    }
+}
+
+int SyntheticSpikes::NextStimulus()
+{
+    label_ = rng_.uniform(0, static_cast<int>(prototypes_.size()));
+    const vector<int> &prototype = prototypes_[label_];
+
+    // drop afferents of the prototype
+    stimulus_.clear();
+    for(size_t i=0; i<prototype.size(); i++) {
+
+        if(rng_.uniform(0.f, 1.f) >= noise_) {
+
+            stimulus_.push_back(prototype[i]);
+            mark_[prototype[i]] = 1;
+        }
+    }
+
+    // replace them with background afferents
+    int nb_dropped = static_cast<int>(prototype.size()-stimulus_.size());
+    for(int i=0; i<nb_dropped; i++) {
+
+        int idx = rng_.uniform(0, nb_afferents_);
+        if(mark_[idx] == 0) {
+
+            stimulus_.push_back(idx);
+            mark_[idx] = 1;
+        }
+    }
+
+    for(size_t i=0; i<stimulus_.size(); i++) {
+
+        mark_[stimulus_[i]] = 0;
+    }
+
+    return label_;
+}
+
+void SyntheticSpikes::NextTick(Mat1f &spikes)
+{
+    if(spikes.rows != 1 || spikes.cols != nb_afferents_ || !spikes.isContinuous()) {
+
+        spikes = Mat1f::zeros(1, nb_afferents_);
+        spiking_.clear();
+    }
+
+    // only reset what was set on the previous tick
+    float *p = spikes.ptr<float>(0);
+    for(size_t i=0; i<spiking_.size(); i++) {
+
+        p[spiking_[i]] = 0.f;
+    }
+
+    spiking_.clear();
+    for(size_t i=0; i<stimulus_.size(); i++) {
+
+        if(mode_ == MODE_BERNOULLI || rng_.uniform(0.f, 1.f) < p_spike_) {
+
+            spiking_.push_back(stimulus_[i]);
+            p[stimulus_[i]] = 1.f;
+        }
+    }
+}
+
+int SyntheticSpikes::Label() const
+{
+    return label_;
+}
+
+int SyntheticSpikes::NbAfferents() const
+{
+    return nb_afferents_;
+}
+
+int SyntheticSpikes::NbClusters() const
+{
+    return static_cast<int>(prototypes_.size());
+}
+
+SyntheticSpikes::Mode SyntheticSpikes::ParseMode(const string &name)
+{
+    if(name == "bernoulli") {
+
+        return MODE_BERNOULLI;
+    }
+    else if(name == "poisson") {
+
+        return MODE_POISSON;
+    }
+
+    ELM_THROW_VALUE_ERROR("Unknown presentation mode: " + name);
+}
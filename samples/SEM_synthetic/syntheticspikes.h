@@ -0,0 +1,105 @@
+#ifndef SYNTHETICSPIKES_H_
+#define SYNTHETICSPIKES_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @brief Generator of spiking stimuli with known ground-truth clusters
+ *
+ * Each cluster is a sparse binary prototype over the afferents.
+ * A stimulus is drawn from a mixture of Bernoulli distributions:
+ * pick a cluster, keep each of its active afferents with probability (1-noise)
+ * and switch on as many background afferents as were dropped on average.
+ * The stimulus is then presented over several ticks, either as
+ * the same binary pattern on every tick or as Poisson spike trains
+ * with active afferents firing at a given rate.
+ *
+ * Prototypes and stimuli are kept as index lists, such that memory and
+ * time per tick scale with the no. of active afferents rather than
+ * the dimensionality (up to millions of afferents).
+ */
+class SyntheticSpikes
+{
+public:
+    /** How a stimulus is presented over ticks
+     */
+    enum Mode {
+        MODE_BERNOULLI = 0, ///< active afferents spike on every tick
+        MODE_POISSON        ///< active afferents spike at a Poisson rate
+    };
+
+    /**
+     * @brief Construct generator and draw cluster prototypes
+     * @param no. of afferents
+     * @param no. of clusters
+     * @param fraction of afferents active in a cluster prototype, in (0, 1]
+     * @param fraction of a prototype's active afferents replaced by background afferents per stimulus, in [0, 1]
+     * @param seed for random number generator
+     * @throws ExceptionValueError on invalid parameters
+     */
+    SyntheticSpikes(int nb_afferents, int nb_clusters, float sparsity, float noise, unsigned long long seed);
+
+    /**
+     * @brief Set presentation mode
+     * @param mode
+     * @param firing rate of active afferents [Hz], Poisson mode only
+     * @param time resolution [milliseconds], Poisson mode only
+     */
+    void Presentation(Mode mode, float rate=40.f, float delta_t_msec=1.f);
+
+    /**
+     * @brief Draw next stimulus
+     * @return ground-truth cluster label of the stimulus
+     */
+    int NextStimulus();
+
+    /**
+     * @brief Generate spikes of current stimulus for a single tick
+     * @param[out] spikes as 0/1 row vector, pass the same buffer on every call for O(active) updates
+     */
+    void NextTick(cv::Mat1f &spikes);
+
+    /**
+     * @brief get ground-truth label of current stimulus
+     * @return cluster label, -1 before first stimulus
+     */
+    int Label() const;
+
+    int NbAfferents() const;
+
+    int NbClusters() const;
+
+    /**
+     * @brief parse presentation mode from string
+     * @param name ("bernoulli" or "poisson")
+     * @return mode
+     * @throws ExceptionValueError on unknown mode
+     */
+    static Mode ParseMode(const std::string &name);
+
+protected:
+    /**
+     * @brief sample distinct afferent indices
+     * @param no. of indices to sample
+     * @param[out] indices
+     */
+    void SampleIndices(int n, std::vector<int> &indices);
+
+    int nb_afferents_;                          ///< dimensionality of stimuli
+    float noise_;                               ///< fraction of afferents replaced per stimulus
+    cv::RNG rng_;                               ///< random number generator
+
+    std::vector<std::vector<int> > prototypes_; ///< active afferents per cluster
+    std::vector<int> stimulus_;                 ///< active afferents of current stimulus
+    std::vector<int> spiking_;                  ///< afferents spiking on previous tick
+    std::vector<unsigned char> mark_;           ///< scratch flags per afferent, all zero between calls
+    int label_;                                 ///< cluster of current stimulus
+
+    Mode mode_;                                 ///< presentation mode
+    float p_spike_;                             ///< spiking probability per tick in Poisson mode
+};
+
+#endif // SYNTHETICSPIKES_H_